@@ -0,0 +1,128 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef APT_ATOMIC_H
+#define APT_ATOMIC_H
+
+/**
+ * @file apt_atomic.h
+ * @brief Atomic Loads and Stores with Acquire/Release Ordering
+ */ 
+
+/**
+ * apr_atomic_read32() and apr_atomic_set32() give no ordering guarantees,
+ * which single-producer/single-consumer queues depend on. The producer
+ * publishes its position with a release store after filling the slots,
+ * and the consumer reads the position with an acquire load before reading
+ * the slots (and the other way around for the consumer position).
+ */
+
+#include <apr_atomic.h>
+#include "apt.h"
+
+#if defined(_MSC_VER) && !defined(__ATOMIC_ACQUIRE) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#endif
+
+APT_BEGIN_EXTERN_C
+
+/** Load 32-bit value with acquire semantics */
+static APR_INLINE apr_uint32_t apt_atomic_load32_acquire(const volatile apr_uint32_t *mem)
+{
+#if defined(__ATOMIC_ACQUIRE)
+	return __atomic_load_n(mem,__ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	/* loads are not reordered with other loads on x86, keep the compiler from doing so */
+	apr_uint32_t val = *mem;
+	_ReadWriteBarrier();
+	return val;
+#else
+	return apr_atomic_cas32((volatile apr_uint32_t*)mem,0,0);
+#endif
+}
+
+/** Store 32-bit value with release semantics */
+static APR_INLINE void apt_atomic_store32_release(volatile apr_uint32_t *mem, apr_uint32_t val)
+{
+#if defined(__ATOMIC_RELEASE)
+	__atomic_store_n(mem,val,__ATOMIC_RELEASE);
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	/* stores are not reordered with other stores on x86, keep the compiler from doing so */
+	_ReadWriteBarrier();
+	*mem = val;
+#else
+	apr_atomic_xchg32(mem,val);
+#endif
+}
+
+/** Load pointer with acquire semantics */
+static APR_INLINE void* apt_atomic_loadptr_acquire(void *volatile *mem)
+{
+#if defined(__ATOMIC_ACQUIRE)
+	return __atomic_load_n(mem,__ATOMIC_ACQUIRE);
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	void *val = *mem;
+	_ReadWriteBarrier();
+	return val;
+#else
+	return apr_atomic_casptr((volatile void**)mem,NULL,NULL);
+#endif
+}
+
+/** Store pointer with release semantics */
+static APR_INLINE void apt_atomic_storeptr_release(void *volatile *mem, void *val)
+{
+#if defined(__ATOMIC_RELEASE)
+	__atomic_store_n(mem,val,__ATOMIC_RELEASE);
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	_ReadWriteBarrier();
+	*mem = val;
+#else
+	apr_atomic_xchgptr((volatile void**)mem,val);
+#endif
+}
+
+#if (defined(__ATOMIC_ACQ_REL) && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8)) || \
+	(defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64)))
+/** 64-bit compare-and-swap is available (used to tag pointers of lock-free lists against ABA) */
+#define APT_ATOMIC_CAS64_SUPPORT
+
+/** Load 64-bit value with acquire semantics */
+static APR_INLINE apr_uint64_t apt_atomic_load64_acquire(volatile apr_uint64_t *mem)
+{
+#if defined(__ATOMIC_ACQUIRE)
+	return __atomic_load_n(mem,__ATOMIC_ACQUIRE);
+#else
+	/* plain 64-bit loads are not atomic on x86 */
+	return (apr_uint64_t)_InterlockedCompareExchange64((volatile __int64*)mem,0,0);
+#endif
+}
+
+/** Compare 64-bit value to cmp and swap it with val if equal, return the original value */
+static APR_INLINE apr_uint64_t apt_atomic_cas64(volatile apr_uint64_t *mem, apr_uint64_t val, apr_uint64_t cmp)
+{
+#if defined(__ATOMIC_ACQ_REL)
+	__atomic_compare_exchange_n(mem,&cmp,val,0,__ATOMIC_ACQ_REL,__ATOMIC_ACQUIRE);
+	return cmp;
+#else
+	return (apr_uint64_t)_InterlockedCompareExchange64((volatile __int64*)mem,(__int64)val,(__int64)cmp);
+#endif
+}
+#endif
+
+APT_END_EXTERN_C
+
+#endif /* APT_ATOMIC_H */
@@ -27,6 +27,9 @@
 
 APT_BEGIN_EXTERN_C
 
+/** Default max number of messages queued to consumer task */
+#define APT_CONSUMER_TASK_DEFAULT_QUEUE_SIZE 1024
+
 /** Opaque consumer task declaration */
 typedef struct apt_consumer_task_t apt_consumer_task_t;
 
@@ -41,6 +44,21 @@ APT_DECLARE(apt_consumer_task_t*) apt_consumer_task_create(
 									apt_task_msg_pool_t *msg_pool,
 									apr_pool_t *pool);
 
+/**
+ * Create consumer task with the specified size of the message queue.
+ * @param obj the external object to associate with the task
+ * @param msg_pool the pool of task messages
+ * @param queue_size the max number of queued messages (rounded up to power of two)
+ * @param pool the pool to allocate memory from
+ * @remark Messages are queued lock-free; the task is woken up only if it waits for messages
+ *         and processes all the queued messages per wakeup.
+ */
+APT_DECLARE(apt_consumer_task_t*) apt_consumer_task_create_ex(
+									void *obj,
+									apt_task_msg_pool_t *msg_pool,
+									apr_size_t queue_size,
+									apr_pool_t *pool);
+
 /**
  * Get task base.
  * @param task the consumer task to get base for
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef APT_FILE_CACHE_H
+#define APT_FILE_CACHE_H
+
+/**
+ * @file apt_file_cache.h
+ * @brief Cache of Memory-Mapped Files
+ */
+
+/**
+ * Files are mapped into memory read-only on first use and shared by all
+ * the users of the cache. An entry stays mapped while it is referenced;
+ * unreferenced entries are kept for reuse and evicted in the least recently
+ * used order once the mapped size exceeds the limit of the cache.
+ * Files are assumed not to change while cached.
+ */
+
+#include "apt.h"
+
+APT_BEGIN_EXTERN_C
+
+/** Default limit of the mapped size of the cache (bytes) */
+#define APT_FILE_CACHE_DEFAULT_MAX_SIZE (64 * 1024 * 1024)
+
+/** Opaque file cache declaration */
+typedef struct apt_file_cache_t apt_file_cache_t;
+
+/** Opaque entry (mapped file) of file cache declaration */
+typedef struct apt_file_cache_entry_t apt_file_cache_entry_t;
+
+/** File cache statistics */
+typedef struct apt_file_cache_stats_t apt_file_cache_stats_t;
+
+/** File cache statistics */
+struct apt_file_cache_stats_t {
+	/** Number of lookups served by the mapped entries */
+	apr_size_t hits;
+	/** Number of lookups which mapped the file */
+	apr_size_t misses;
+	/** Number of entries unmapped to stay within the limit */
+	apr_size_t evictions;
+	/** Number of entries currently mapped */
+	apr_size_t entry_count;
+	/** Total size of the entries currently mapped (bytes) */
+	apr_size_t mapped_size;
+};
+
+/**
+ * Create file cache.
+ * @param max_size the limit of the total size of the unreferenced entries kept mapped
+ * @param pool the pool to allocate memory from
+ */
+APT_DECLARE(apt_file_cache_t*) apt_file_cache_create(apr_size_t max_size, apr_pool_t *pool);
+
+/**
+ * Destroy file cache, all the entries must be released.
+ * @param cache the cache to destroy
+ */
+APT_DECLARE(void) apt_file_cache_destroy(apt_file_cache_t *cache);
+
+/**
+ * Acquire (map on first use) the file.
+ * @param cache the cache to acquire the file from
+ * @param file_path the path of the file
+ * @param data the mapped content of the file to return
+ * @param size the size of the file to return
+ * @return the referenced entry or NULL if the file cannot be mapped
+ * @remark The content stays valid until the entry is released and may be read from any thread.
+ */
+APT_DECLARE(apt_file_cache_entry_t*) apt_file_cache_acquire(apt_file_cache_t *cache, const char *file_path, const void **data, apr_size_t *size);
+
+/**
+ * Release the entry acquired before.
+ * @param cache the cache the entry is acquired from
+ * @param entry the entry to release
+ */
+APT_DECLARE(void) apt_file_cache_release(apt_file_cache_t *cache, apt_file_cache_entry_t *entry);
+
+/**
+ * Invalidate the file, e.g. before removing it.
+ * @param cache the cache to invalidate the file in
+ * @param file_path the path of the file
+ * @return TRUE if the file is not mapped anymore, FALSE if it is still referenced
+ * @remark A referenced file is unmapped on the last release and cannot be acquired meanwhile.
+ * Mapped files cannot be removed on some platforms (e.g. Windows).
+ */
+APT_DECLARE(apt_bool_t) apt_file_cache_invalidate(apt_file_cache_t *cache, const char *file_path);
+
+/**
+ * Get statistics of file cache.
+ * @param cache the cache to get statistics of
+ * @param stats the statistics to fill
+ */
+APT_DECLARE(void) apt_file_cache_stats_get(apt_file_cache_t *cache, apt_file_cache_stats_t *stats);
+
+APT_END_EXTERN_C
+
+#endif /* APT_FILE_CACHE_H */
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef APT_FILE_WRITER_H
+#define APT_FILE_WRITER_H
+
+/**
+ * @file apt_file_writer.h
+ * @brief Asynchronous File Writer
+ */
+
+/**
+ * The writer owns a background thread, which flushes the data of all the
+ * files opened on the writer to disk. Each file has a fixed-size lock-free
+ * ring written by a single thread (e.g. the media thread); the data which
+ * doesn't fit in the ring is dropped and counted instead of blocking.
+ * Files are opened and closed by control threads.
+ */
+
+#include <apr_time.h>
+#include "apt.h"
+
+APT_BEGIN_EXTERN_C
+
+/** Default size of the ring of each file (bytes) */
+#define APT_FILE_WRITER_DEFAULT_BUFFER_SIZE 65536
+
+/** Default interval the background thread flushes the files at (usec) */
+#define APT_FILE_WRITER_DEFAULT_INTERVAL    100000
+
+/** Opaque file writer declaration */
+typedef struct apt_file_writer_t apt_file_writer_t;
+
+/** Opaque file (of file writer) declaration */
+typedef struct apt_file_writer_file_t apt_file_writer_file_t;
+
+/** File writer statistics */
+typedef struct apt_file_writer_stats_t apt_file_writer_stats_t;
+
+/** Handler raised once the file is flushed and closed */
+typedef void (*apt_file_writer_close_handler_f)(void *obj);
+
+/** File writer statistics */
+struct apt_file_writer_stats_t {
+	/** Number of bytes written to disk */
+	apr_uint64_t written_bytes;
+	/** Number of bytes dropped because the ring of the file was full */
+	apr_uint64_t dropped_bytes;
+	/** Number of write calls issued to disk */
+	apr_uint64_t write_calls;
+};
+
+/**
+ * Create file writer.
+ * @param buffer_size the size of the ring of each file (rounded up to the power of two)
+ * @param interval the interval the files are flushed at (usec)
+ * @param pool the pool to allocate memory from
+ */
+APT_DECLARE(apt_file_writer_t*) apt_file_writer_create(apr_size_t buffer_size, apr_interval_time_t interval, apr_pool_t *pool);
+
+/**
+ * Start the background thread of file writer.
+ * @param writer the writer to start
+ */
+APT_DECLARE(apt_bool_t) apt_file_writer_start(apt_file_writer_t *writer);
+
+/**
+ * Stop the background thread of file writer, flush and close the remaining files.
+ * @param writer the writer to stop
+ */
+APT_DECLARE(apt_bool_t) apt_file_writer_stop(apt_file_writer_t *writer);
+
+/**
+ * Open (create or truncate) file for writing.
+ * @param writer the writer to open file on
+ * @param file_path the path of the file
+ * @return the opened file or NULL on error
+ */
+APT_DECLARE(apt_file_writer_file_t*) apt_file_writer_open(apt_file_writer_t *writer, const char *file_path);
+
+/**
+ * Queue data to write to the file; never blocks.
+ * @param file the file to write to
+ * @param data the data to write
+ * @param size the size of the data
+ * @return FALSE if the data has been dropped as the ring of the file is full
+ */
+APT_DECLARE(apt_bool_t) apt_file_writer_write(apt_file_writer_file_t *file, const void *data, apr_size_t size);
+
+/**
+ * Close the file once the queued data is written. The file must not be used after the call.
+ * @param file the file to close
+ */
+APT_DECLARE(void) apt_file_writer_close(apt_file_writer_file_t *file);
+
+/**
+ * Close the file once the queued data is written and raise the handler then; never blocks.
+ * The file must not be used after the call.
+ * @param file the file to close
+ * @param handler the handler to raise once the file is closed
+ * @param obj the object to raise the handler with
+ * @remark The handler is raised from the background thread, or from the calling
+ * thread if the writer is not running.
+ */
+APT_DECLARE(void) apt_file_writer_close_ex(apt_file_writer_file_t *file, apt_file_writer_close_handler_f handler, void *obj);
+
+/**
+ * Get statistics of file writer.
+ * @param writer the writer to get statistics of
+ * @param stats the statistics to fill
+ */
+APT_DECLARE(void) apt_file_writer_stats_get(apt_file_writer_t *writer, apt_file_writer_stats_t *stats);
+
+APT_END_EXTERN_C
+
+#endif /* APT_FILE_WRITER_H */
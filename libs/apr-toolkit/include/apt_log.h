@@ -121,6 +121,28 @@ typedef enum {
 	APT_LOG_MASKING_ENCRYPTED  /**< encrypt private data */
 } apt_log_masking_e;
 
+/** Overflow policy of the asynchronous logger */
+typedef enum {
+	APT_LOG_OVERFLOW_DROP, /**< drop the record, which doesn't fit in the queue, and count it */
+	APT_LOG_OVERFLOW_SYNC  /**< write the record, which doesn't fit in the queue, on the calling thread */
+} apt_log_overflow_e;
+
+/** Default number of records queued by the asynchronous logger */
+#define APT_LOG_ASYNC_DEFAULT_QUEUE_SIZE 1024
+
+/** Asynchronous logger statistics */
+typedef struct apt_log_async_stats_t apt_log_async_stats_t;
+
+/** Asynchronous logger statistics */
+struct apt_log_async_stats_t {
+	/** Number of records written by the background thread */
+	apr_size_t written;
+	/** Number of records dropped on overflow */
+	apr_size_t dropped;
+	/** Number of records written on the calling thread on overflow */
+	apr_size_t overflowed;
+};
+
 /** Opaque logger declaration */
 typedef struct apt_logger_t apt_logger_t;
 
@@ -218,6 +240,33 @@ APT_DECLARE(apt_bool_t) apt_syslog_open(const char *prefix, const char *config_f
  */
 APT_DECLARE(apt_bool_t) apt_syslog_close(void);
 
+/**
+ * Start asynchronous logging.
+ * @param queue_size the max number of records queued (rounded up to power of two)
+ * @param overflow the policy applied to the records, which don't fit in the queue
+ * @param pool the memory pool to use
+ * @remark The calling thread formats the message into the lock-free queue; the
+ *         header is composed and the output is written by a background thread.
+ */
+APT_DECLARE(apt_bool_t) apt_log_async_open(apr_size_t queue_size, apt_log_overflow_e overflow, apr_pool_t *pool);
+
+/**
+ * Stop asynchronous logging, write the queued records.
+ */
+APT_DECLARE(apt_bool_t) apt_log_async_close(void);
+
+/**
+ * Get statistics of asynchronous logging.
+ * @param stats the statistics to fill
+ */
+APT_DECLARE(apt_bool_t) apt_log_async_stats_get(apt_log_async_stats_t *stats);
+
+/**
+ * Translate the overflow policy string to enum.
+ * @param str the string to translate
+ */
+APT_DECLARE(apt_log_overflow_e) apt_log_overflow_translate(const char *str);
+
 /**
  * Set the logging output mode.
  * @param mode the mode to set
@@ -102,6 +102,14 @@ APT_DECLARE(void*) apt_poller_task_object_get(const apt_poller_task_t *task);
  */
 APT_DECLARE(apt_bool_t) apt_poller_task_descriptor_add(const apt_poller_task_t *task, const apr_pollfd_t *descriptor);
 
+/**
+ * Add descriptor to pollset with flags.
+ * @param task the task which holds the pollset
+ * @param descriptor the descriptor to add
+ * @param flags the mask of APT_POLLSET_EDGE_TRIGGERED
+ */
+APT_DECLARE(apt_bool_t) apt_poller_task_descriptor_add_ex(const apt_poller_task_t *task, const apr_pollfd_t *descriptor, apr_uint32_t flags);
+
 /**
  * Remove descriptor from pollset.
  * @param task the task which holds the pollset
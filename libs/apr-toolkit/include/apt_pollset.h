@@ -28,6 +28,10 @@
  * apt_pollset_t is an extension of apr_pollset_t and provides
  * pollset wakeup capabilities the similar way as it's implemented
  * in APR-1.4 trunk
+ *
+ * On Linux the pollset is implemented on top of epoll directly and
+ * the wakeup is signalled via eventfd. Wakeups signalled while the
+ * previous one is not consumed by the poller yet are coalesced.
  */
 
 #include <apr_poll.h>
@@ -35,6 +39,9 @@
 
 APT_BEGIN_EXTERN_C
 
+/** Flag to register descriptor edge-triggered, if supported by the pollset */
+#define APT_POLLSET_EDGE_TRIGGERED 0x01
+
 /** Opaque pollset declaration */
 typedef struct apt_pollset_t apt_pollset_t;
 
@@ -58,6 +65,17 @@ APT_DECLARE(apt_bool_t) apt_pollset_destroy(apt_pollset_t *pollset);
  */
 APT_DECLARE(apt_bool_t) apt_pollset_add(apt_pollset_t *pollset, const apr_pollfd_t *descriptor);
 
+/**
+ * Add pollset descriptor to a pollset with flags.
+ * @param pollset the pollset to add the descriptor to
+ * @param descriptor the descriptor to add
+ * @param flags the mask of APT_POLLSET_EDGE_TRIGGERED
+ * @remark The descriptor added edge-triggered is signalled only once per
+ *         new data, so it must be read until it would block. Pollsets which
+ *         don't support the flag register the descriptor level-triggered.
+ */
+APT_DECLARE(apt_bool_t) apt_pollset_add_ex(apt_pollset_t *pollset, const apr_pollfd_t *descriptor, apr_uint32_t flags);
+
 /**
  * Remove pollset descriptor from a pollset.
  * @param pollset the pollset to remove the descriptor from
@@ -81,6 +99,7 @@ APT_DECLARE(apr_status_t) apt_pollset_poll(
 /**
  * Interrupt the blocked poll call.
  * @param pollset the pollset to use
+ * @remark The call is coalesced with the wakeup not yet matched by apt_pollset_is_wakeup().
  */
 APT_DECLARE(apt_bool_t) apt_pollset_wakeup(apt_pollset_t *pollset);
 
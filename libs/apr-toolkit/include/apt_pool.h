@@ -42,6 +42,70 @@ APT_DECLARE(apr_pool_t*) apt_pool_create(void);
  */
 APT_DECLARE(apr_pool_t*) apt_subpool_create(apr_pool_t *parent);
 
+
+/** Default max number of pools kept by pool recycler */
+#define APT_POOL_RECYCLER_DEFAULT_MAX_COUNT     64
+/** Default max size of free memory kept per recycled pool (bytes) */
+#define APT_POOL_RECYCLER_DEFAULT_MAX_FREE_SIZE (64 * 1024)
+
+/** Opaque pool recycler declaration */
+typedef struct apt_pool_recycler_t apt_pool_recycler_t;
+
+/** Pool recycler statistics */
+typedef struct apt_pool_recycler_stats_t apt_pool_recycler_stats_t;
+
+/** Pool recycler statistics */
+struct apt_pool_recycler_stats_t {
+	/** Number of pools acquired */
+	apr_size_t acquired;
+	/** Number of pools acquired from the recycled ones */
+	apr_size_t reused;
+	/** Number of released pools destroyed as the limit of recycled pools is reached */
+	apr_size_t discarded;
+	/** Number of pools currently recycled */
+	apr_size_t free_count;
+};
+
+/**
+ * Create pool recycler.
+ * @param name the name of the recycler (component) to log
+ * @param max_count the max number of released pools to keep for reuse
+ * @param max_free_size the max size of free memory to keep per released pool
+ * @param pool the pool to allocate memory from
+ * @remark Pools created by apt_pool_create() come with an own allocator and
+ *         a mutex. The recycler keeps released pools together with their
+ *         allocators and free memory, and hands out subpools of them, so
+ *         the short-lived pools of sessions and connections are set up
+ *         without allocator and mutex creation.
+ */
+APT_DECLARE(apt_pool_recycler_t*) apt_pool_recycler_create(const char *name, apr_size_t max_count, apr_size_t max_free_size, apr_pool_t *pool);
+
+/**
+ * Destroy pool recycler, all the acquired pools must be released.
+ * @param recycler the recycler to destroy
+ */
+APT_DECLARE(void) apt_pool_recycler_destroy(apt_pool_recycler_t *recycler);
+
+/**
+ * Acquire pool, either recycled or new one.
+ * @param recycler the recycler to acquire the pool from
+ */
+APT_DECLARE(apr_pool_t*) apt_pool_recycler_acquire(apt_pool_recycler_t *recycler);
+
+/**
+ * Release pool acquired before, instead of apr_pool_destroy().
+ * @param recycler the recycler the pool is acquired from
+ * @param pool the pool to release
+ */
+APT_DECLARE(void) apt_pool_recycler_release(apt_pool_recycler_t *recycler, apr_pool_t *pool);
+
+/**
+ * Get statistics of pool recycler.
+ * @param recycler the recycler to get statistics of
+ * @param stats the statistics to fill
+ */
+APT_DECLARE(void) apt_pool_recycler_stats_get(apt_pool_recycler_t *recycler, apt_pool_recycler_stats_t *stats);
+
 APT_END_EXTERN_C
 
 #endif /* APT_POOL_H */
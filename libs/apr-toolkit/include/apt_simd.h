@@ -0,0 +1,55 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef APT_SIMD_H
+#define APT_SIMD_H
+
+/**
+ * @file apt_simd.h
+ * @brief SIMD Instruction Set Selection
+ */ 
+
+/**
+ * Instruction sets are selected at compile time according to the target
+ * architecture and compiler flags (e.g. -mavx2). Define APT_NO_SIMD to
+ * fall back to the portable (scalar) implementations.
+ */
+
+#include "apt.h"
+
+#ifndef APT_NO_SIMD
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+/** SSE2 instruction set is available */
+#define APT_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(APT_SIMD_SSE2) && defined(__AVX2__)
+/** AVX2 instruction set is available */
+#define APT_SIMD_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+/** NEON instruction set is available */
+#define APT_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#endif /* APT_NO_SIMD */
+
+#endif /* APT_SIMD_H */
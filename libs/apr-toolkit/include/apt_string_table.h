@@ -36,8 +36,20 @@ struct apt_str_table_item_t {
 	apt_str_t  value;
 	/** Index of the unique (key) character to compare */
 	apr_size_t key;
+	/** Seed of the perfect hash of the strings hashed to the index of this item (0 if the table is not hashed) */
+	apr_uint16_t hash_seed;
+	/** Id of the string placed at the index of this item by the perfect hash */
+	apr_uint16_t hash_id;
 };
 
+/**
+ * String tables generated by strtablegen carry a minimal perfect hash.
+ * A string is hashed with seed 0 to the index of the item, which holds the
+ * seed of the second hash; the second hash gives the index of the item,
+ * which holds the id of the string. Tables without the hash (all the seeds
+ * are 0) are looked up by the key characters.
+ */
+
 
 /**
  * Get the string by a given id.
@@ -57,6 +69,13 @@ APT_DECLARE(const apt_str_t*) apt_string_table_str_get(const apt_str_table_item_
  */
 APT_DECLARE(apr_size_t) apt_string_table_id_find(const apt_str_table_item_t table[], apr_size_t size, const apt_str_t *value);
 
+/**
+ * Hash the string (case insensitive) as the perfect hash of string tables does.
+ * @param value the string to hash
+ * @param seed the seed of the hash
+ */
+APT_DECLARE(apr_uint32_t) apt_string_table_hash(const apt_str_t *value, apr_uint32_t seed);
+
 
 APT_END_EXTERN_C
 
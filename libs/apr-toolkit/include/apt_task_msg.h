@@ -44,6 +44,9 @@ typedef enum {
 	CORE_TASK_MSG_BRINGONLINE_COMPLETE, /**< bring-online-complete message */
 } apt_core_task_msg_type_e;
 
+/** Default number of messages the static pool preallocates and grows by */
+#define APT_TASK_MSG_POOL_DEFAULT_SIZE 64
+
 /** Opaque task message declaration */
 typedef struct apt_task_msg_t apt_task_msg_t;
 /** Opaque task message pool declaration */
@@ -65,7 +68,14 @@ struct apt_task_msg_t {
 /** Create pool of task messages with dynamic allocation of messages (no actual pool is created) */
 APT_DECLARE(apt_task_msg_pool_t*) apt_task_msg_pool_create_dynamic(apr_size_t msg_size, apr_pool_t *pool);
 
-/** Create pool of task messages with static allocation of messages */
+/**
+ * Create pool of task messages with static allocation of messages.
+ * @param msg_size the size of the context specific data of the message
+ * @param msg_pool_size the number of messages to preallocate and to grow the pool by when exhausted
+ * @param pool the pool to allocate memory from
+ * @remark Released messages are cached per thread and recycled via a lock-free list,
+ *         messages may be acquired and released from any thread.
+ */
 APT_DECLARE(apt_task_msg_pool_t*) apt_task_msg_pool_create_static(apr_size_t msg_size, apr_size_t msg_pool_size, apr_pool_t *pool);
 
 /** Destroy pool of task messages */
@@ -60,6 +60,12 @@ APT_DECLARE(void*) apt_message_parser_object_get(apt_message_parser_t *parser);
 /** Set verbose mode for the parser */
 APT_DECLARE(void) apt_message_parser_verbose_set(apt_message_parser_t *parser, apt_bool_t verbose);
 
+/** Get the part of the message body remaining to receive (if the body is being parsed), to receive it in place */
+APT_DECLARE(apr_size_t) apt_message_parser_body_window_get(apt_message_parser_t *parser, char **buf);
+
+/** Advance the body being parsed by the data received in place */
+APT_DECLARE(void) apt_message_parser_body_window_advance(apt_message_parser_t *parser, apr_size_t length);
+
 
 /** Create message generator */
 APT_DECLARE(apt_message_generator_t*) apt_message_generator_create(void *obj, const apt_message_generator_vtable_t *vtable, apr_pool_t *pool);
@@ -67,6 +73,9 @@ APT_DECLARE(apt_message_generator_t*) apt_message_generator_create(void *obj, co
 /** Generate message */
 APT_DECLARE(apt_message_status_e) apt_message_generator_run(apt_message_generator_t *generator, void *message, apt_text_stream_t *stream);
 
+/** Generate message start line and header section only, return the body to send as is */
+APT_DECLARE(apt_message_status_e) apt_message_generator_header_run(apt_message_generator_t *generator, void *message, apt_text_stream_t *stream, apt_str_t *body);
+
 /** Get external object associated with generator */
 APT_DECLARE(void*) apt_message_generator_object_get(apt_message_generator_t *generator);
 
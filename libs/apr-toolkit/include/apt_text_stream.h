@@ -52,6 +52,32 @@ struct apt_text_stream_t {
 	apt_bool_t  is_eos;
 };
 
+/** Receive buffer declaration */
+typedef struct apt_text_rx_buffer_t apt_text_rx_buffer_t;
+
+/** Receive buffer of text stream, which grows on demand and shrinks back when idle */
+struct apt_text_rx_buffer_t {
+	/** Initial buffer (allocated by the owner) */
+	char       *initial;
+	/** Size of the initial buffer */
+	apr_size_t  initial_size;
+	/** Current buffer (either initial or grown one allocated on the heap) */
+	char       *buf;
+	/** Size of the current buffer */
+	apr_size_t  size;
+	/** Max size to grow the buffer up to */
+	apr_size_t  max_size;
+};
+
+
+/**
+ * Enable or disable vectorized (SSE2/AVX2/NEON) scanning of text streams.
+ * @param enable whether to search delimiters for a block of chars at once
+ * @return FALSE if vectorized scanning is requested, but not supported by the build
+ * @remark Vectorized scanning is enabled by default, if supported. The results
+ *         of reading are the same either way, this is meant for benchmarking.
+ */
+APT_DECLARE(apt_bool_t) apt_text_scan_vectorized_set(apt_bool_t enable);
 
 /**
  * Read entire line of the text stream.
@@ -214,6 +240,38 @@ static APR_INLINE apt_bool_t apt_text_is_eos(const apt_text_stream_t *stream)
 /** Scroll text stream */
 APT_DECLARE(apt_bool_t) apt_text_stream_scroll(apt_text_stream_t *stream);
 
+/**
+ * Initialize receive buffer and the text stream on top of it.
+ * @param buffer the buffer to initialize
+ * @param stream the stream to receive into the buffer
+ * @param initial the initial buffer of size + 1 bytes
+ * @param size the size of the initial buffer
+ * @param max_size the max size to grow the buffer up to
+ */
+APT_DECLARE(void) apt_text_rx_buffer_init(apt_text_rx_buffer_t *buffer, apt_text_stream_t *stream, char *initial, apr_size_t size, apr_size_t max_size);
+
+/**
+ * Grow receive buffer geometrically to fit the required size (up to the max size), keeping the data of the stream.
+ * @param buffer the buffer to grow
+ * @param stream the stream received into the buffer
+ * @param required_size the size required to fit the stream data and the rest of the message
+ * @return TRUE if the buffer has grown
+ */
+APT_DECLARE(apt_bool_t) apt_text_rx_buffer_grow(apt_text_rx_buffer_t *buffer, apt_text_stream_t *stream, apr_size_t required_size);
+
+/**
+ * Shrink receive buffer back to the initial one, if the stream holds no data.
+ * @param buffer the buffer to shrink
+ * @param stream the stream received into the buffer
+ */
+APT_DECLARE(void) apt_text_rx_buffer_shrink(apt_text_rx_buffer_t *buffer, apt_text_stream_t *stream);
+
+/**
+ * Release the grown receive buffer, if any.
+ * @param buffer the buffer to release
+ */
+APT_DECLARE(void) apt_text_rx_buffer_release(apt_text_rx_buffer_t *buffer);
+
 /** Parse id at resource string */
 APT_DECLARE(apt_bool_t) apt_id_resource_parse(const apt_str_t *str, char separator, apt_str_t *id, apt_str_t *resource, apr_pool_t *pool);
 /** Generate id at resource string */
@@ -15,17 +15,44 @@
  */
 
 #include <apr_time.h>
-#include <apr_queue.h>
+#include <apr_thread_proc.h>
+#include <apr_thread_mutex.h>
+#include <apr_thread_cond.h>
 #include "apt_consumer_task.h"
+#include "apt_atomic.h"
 #include "apt_log.h"
 
+/** Max size of the message queue */
+#define MAX_CONSUMER_TASK_QUEUE_SIZE 0x100000
+
+/** Slot of the message queue */
+typedef struct apt_consumer_task_slot_t apt_consumer_task_slot_t;
+
+struct apt_consumer_task_slot_t {
+	/** Position the slot is ready to be written (pos) or read (pos + 1) at */
+	volatile apr_uint32_t  seq;
+	/** Queued message */
+	apt_task_msg_t        *msg;
+};
+
 struct apt_consumer_task_t {
-	void              *obj;
-	apt_task_t        *base;
-	apr_queue_t       *msg_queue;
-#if APR_HAS_QUEUE_TIMEOUT
-	apt_timer_queue_t *timer_queue;
-#endif
+	void                     *obj;
+	apt_task_t               *base;
+
+	/** Bounded multi-producer/single-consumer queue of messages */
+	apt_consumer_task_slot_t *slots;
+	apr_uint32_t              mask;
+	/** Position claimed by the producers */
+	volatile apr_uint32_t     enqueue_pos;
+	/** Position owned by the consumer */
+	apr_uint32_t              dequeue_pos;
+
+	/** Set while the consumer is about to sleep or sleeping, producers wake it up only then */
+	volatile apr_uint32_t     waiting;
+	apr_thread_mutex_t       *guard;
+	apr_thread_cond_t        *wakeup;
+
+	apt_timer_queue_t        *timer_queue;
 };
 
 static apt_bool_t apt_consumer_task_msg_signal(apt_task_t *task, apt_task_msg_t *msg);
@@ -35,12 +62,38 @@ APT_DECLARE(apt_consumer_task_t*) apt_consumer_task_create(
 									void *obj,
 									apt_task_msg_pool_t *msg_pool,
 									apr_pool_t *pool)
+{
+	return apt_consumer_task_create_ex(obj,msg_pool,APT_CONSUMER_TASK_DEFAULT_QUEUE_SIZE,pool);
+}
+
+APT_DECLARE(apt_consumer_task_t*) apt_consumer_task_create_ex(
+									void *obj,
+									apt_task_msg_pool_t *msg_pool,
+									apr_size_t queue_size,
+									apr_pool_t *pool)
 {
 	apt_task_vtable_t *vtable;
+	apr_uint32_t size = 1;
+	apr_uint32_t i;
 	apt_consumer_task_t *consumer_task = apr_palloc(pool,sizeof(apt_consumer_task_t));
 	consumer_task->obj = obj;
-	consumer_task->msg_queue = NULL;
-	if(apr_queue_create(&consumer_task->msg_queue,1024,pool) != APR_SUCCESS) {
+
+	while(size < queue_size && size < MAX_CONSUMER_TASK_QUEUE_SIZE) {
+		size <<= 1;
+	}
+	consumer_task->slots = apr_palloc(pool,sizeof(apt_consumer_task_slot_t) * size);
+	for(i = 0; i < size; i++) {
+		consumer_task->slots[i].seq = i;
+		consumer_task->slots[i].msg = NULL;
+	}
+	consumer_task->mask = size - 1;
+	consumer_task->enqueue_pos = 0;
+	consumer_task->dequeue_pos = 0;
+	consumer_task->waiting = FALSE;
+	consumer_task->guard = NULL;
+	consumer_task->wakeup = NULL;
+	if(apr_thread_mutex_create(&consumer_task->guard,APR_THREAD_MUTEX_UNNESTED,pool) != APR_SUCCESS ||
+		apr_thread_cond_create(&consumer_task->wakeup,pool) != APR_SUCCESS) {
 		return NULL;
 	}
 	
@@ -55,10 +108,7 @@ APT_DECLARE(apt_consumer_task_t*) apt_consumer_task_create(
 		vtable->signal_msg = apt_consumer_task_msg_signal;
 	}
 
-#if APR_HAS_QUEUE_TIMEOUT
 	consumer_task->timer_queue = apt_timer_queue_create(pool);
-#endif
-
 	return consumer_task;
 }
 
@@ -83,30 +133,108 @@ APT_DECLARE(apt_timer_t*) apt_consumer_task_timer_create(
 									void *obj, 
 									apr_pool_t *pool)
 {
-#if APR_HAS_QUEUE_TIMEOUT
 	return apt_timer_create(task->timer_queue,proc,obj,pool);
-#else
-	return NULL;
-#endif
+}
+
+/** Queue the message, FALSE if the queue is full */
+static apt_bool_t apt_consumer_task_msg_push(apt_consumer_task_t *consumer_task, apt_task_msg_t *msg)
+{
+	apt_consumer_task_slot_t *slot;
+	apr_uint32_t pos = apt_atomic_load32_acquire(&consumer_task->enqueue_pos);
+	apr_uint32_t seq;
+	apr_uint32_t cur;
+
+	for(;;) {
+		slot = &consumer_task->slots[pos & consumer_task->mask];
+		seq = apt_atomic_load32_acquire(&slot->seq);
+		if(seq == pos) {
+			cur = apr_atomic_cas32(&consumer_task->enqueue_pos,pos + 1,pos);
+			if(cur == pos) {
+				break;
+			}
+			pos = cur;
+		}
+		else if((apr_int32_t)(seq - pos) < 0) {
+			/* the slot is not read yet */
+			return FALSE;
+		}
+		else {
+			/* the slot is claimed by another producer */
+			pos = apt_atomic_load32_acquire(&consumer_task->enqueue_pos);
+		}
+	}
+
+	slot->msg = msg;
+	apt_atomic_store32_release(&slot->seq,pos + 1);
+	return TRUE;
+}
+
+/** Dequeue the next message (consumer) */
+static apt_task_msg_t* apt_consumer_task_msg_pop(apt_consumer_task_t *consumer_task)
+{
+	apt_consumer_task_slot_t *slot = &consumer_task->slots[consumer_task->dequeue_pos & consumer_task->mask];
+	apt_task_msg_t *msg;
+	if(apt_atomic_load32_acquire(&slot->seq) != consumer_task->dequeue_pos + 1) {
+		return NULL;
+	}
+	msg = slot->msg;
+	/* release the slot for the position of the next round */
+	apt_atomic_store32_release(&slot->seq,consumer_task->dequeue_pos + consumer_task->mask + 1);
+	consumer_task->dequeue_pos++;
+	return msg;
+}
+
+/** Check whether there is a message to dequeue (consumer) */
+static APR_INLINE apt_bool_t apt_consumer_task_msg_pending(apt_consumer_task_t *consumer_task)
+{
+	apt_consumer_task_slot_t *slot = &consumer_task->slots[consumer_task->dequeue_pos & consumer_task->mask];
+	return apt_atomic_load32_acquire(&slot->seq) == consumer_task->dequeue_pos + 1 ? TRUE : FALSE;
 }
 
 static apt_bool_t apt_consumer_task_msg_signal(apt_task_t *task, apt_task_msg_t *msg)
 {
 	apt_consumer_task_t *consumer_task = apt_task_object_get(task);
-	return (apr_queue_push(consumer_task->msg_queue,msg) == APR_SUCCESS) ? TRUE : FALSE;
+	while(apt_consumer_task_msg_push(consumer_task,msg) == FALSE) {
+		/* the queue is full, wait for the consumer to catch up */
+		apr_thread_yield();
+	}
+
+	/* the full barrier of CAS orders the read of the flag after the write of the message;
+	the consumer sets the flag before it checks the queue the last time */
+	if(apr_atomic_cas32(&consumer_task->waiting,FALSE,FALSE) == TRUE) {
+		apr_thread_mutex_lock(consumer_task->guard);
+		apr_thread_cond_signal(consumer_task->wakeup);
+		apr_thread_mutex_unlock(consumer_task->guard);
+	}
+	return TRUE;
+}
+
+/** Wait for messages up to the timeout (-1 is infinite) */
+static void apt_consumer_task_wait(apt_consumer_task_t *consumer_task, apr_interval_time_t timeout)
+{
+	apr_thread_mutex_lock(consumer_task->guard);
+	apr_atomic_xchg32(&consumer_task->waiting,TRUE);
+	/* a message queued meanwhile is either seen here or followed by a signal */
+	if(apt_consumer_task_msg_pending(consumer_task) == FALSE) {
+		if(timeout >= 0) {
+			apr_thread_cond_timedwait(consumer_task->wakeup,consumer_task->guard,timeout);
+		}
+		else {
+			apr_thread_cond_wait(consumer_task->wakeup,consumer_task->guard);
+		}
+	}
+	apr_atomic_xchg32(&consumer_task->waiting,FALSE);
+	apr_thread_mutex_unlock(consumer_task->guard);
 }
 
 static apt_bool_t apt_consumer_task_run(apt_task_t *task)
 {
-	apr_status_t rv;
-	void *msg;
+	apt_task_msg_t *msg;
 	apt_bool_t *running;
 	apt_consumer_task_t *consumer_task;
-#if APR_HAS_QUEUE_TIMEOUT
 	apr_interval_time_t timeout;
 	apr_uint32_t queue_timeout;
 	apr_time_t time_now, time_last = 0;
-#endif
 	const char *task_name;
 
 	consumer_task = apt_task_object_get(task);
@@ -121,42 +249,36 @@ static apt_bool_t apt_consumer_task_run(apt_task_t *task)
 	}
 
 	while(*running) {
-#if APR_HAS_QUEUE_TIMEOUT
 		if(apt_timer_queue_timeout_get(consumer_task->timer_queue,&queue_timeout) == TRUE) {
 			timeout = (apr_interval_time_t)queue_timeout * 1000;
 			time_last = apr_time_now();
-			apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Wait for Messages [%s] timeout [%u]",
-				task_name, queue_timeout);
-			rv = apr_queue_timedpop(consumer_task->msg_queue,timeout,&msg);
 		}
-		else
-		{
+		else {
 			timeout = -1;
-			apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Wait for Messages [%s]",task_name);
-			rv = apr_queue_pop(consumer_task->msg_queue,&msg);
 		}
-#else
-		apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Wait for Messages [%s]",task_name);
-		rv = apr_queue_pop(consumer_task->msg_queue,&msg);
-#endif
-		if(rv == APR_SUCCESS) {
-			if(msg) {
-				apt_task_msg_t *task_msg = msg;
-				apt_task_msg_process(consumer_task->base,task_msg);
+
+		if(apt_consumer_task_msg_pending(consumer_task) == FALSE) {
+			if(timeout != -1) {
+				apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Wait for Messages [%s] timeout [%u]",
+					task_name, queue_timeout);
+			}
+			else {
+				apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Wait for Messages [%s]",task_name);
 			}
+			apt_consumer_task_wait(consumer_task,timeout);
 		}
-		else if(rv != APR_TIMEUP) {
-			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Pop Message [%s] status: %d",task_name,rv);
+
+		/* process all the pending messages per wakeup */
+		while(*running && (msg = apt_consumer_task_msg_pop(consumer_task)) != NULL) {
+			apt_task_msg_process(consumer_task->base,msg);
 		}
 
-#if APR_HAS_QUEUE_TIMEOUT
 		if(timeout != -1) {
 			time_now = apr_time_now();
 			if(time_now > time_last) {
 				apt_timer_queue_advance(consumer_task->timer_queue,(apr_uint32_t)((time_now - time_last)/1000));
 			}
 		}
-#endif
 	}
 	return TRUE;
 }
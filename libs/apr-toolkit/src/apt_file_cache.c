@@ -0,0 +1,241 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef WIN32
+#pragma warning(disable: 4127)
+#endif
+#include <apr_ring.h>
+#include <apr_hash.h>
+#include <apr_mmap.h>
+#include <apr_file_io.h>
+#include <apr_thread_mutex.h>
+#include "apt_file_cache.h"
+#include "apt_log.h"
+
+/** Entry (mapped file) of file cache */
+struct apt_file_cache_entry_t {
+	/** Ring entry of the list of unreferenced entries */
+	APR_RING_ENTRY(apt_file_cache_entry_t) link;
+	/** Pool the entry is allocated and mapped in, destroyed on eviction */
+	apr_pool_t                            *pool;
+	/** File path (key of the entry) */
+	const char                            *path;
+	/** Mapping of the file */
+	apr_mmap_t                            *mmap;
+	/** Number of references */
+	apr_size_t                             ref_count;
+	/** Set once the file is invalidated, the entry is unmapped on the last release */
+	apt_bool_t                             invalidated;
+};
+
+/** List of entries */
+APR_RING_HEAD(apt_file_cache_head_t, apt_file_cache_entry_t);
+
+/** Cache of memory-mapped files */
+struct apt_file_cache_t {
+	/** Pool to allocate memory from */
+	apr_pool_t                   *pool;
+	/** Limit of the mapped size */
+	apr_size_t                    max_size;
+	/** Guards the entries and the statistics */
+	apr_thread_mutex_t           *guard;
+	/** Table of entries by file path */
+	apr_hash_t                   *entries;
+	/** Unreferenced entries, least recently used first */
+	struct apt_file_cache_head_t  lru;
+	/** Statistics */
+	apt_file_cache_stats_t        stats;
+};
+
+APT_DECLARE(apt_file_cache_t*) apt_file_cache_create(apr_size_t max_size, apr_pool_t *pool)
+{
+	apt_file_cache_t *cache = apr_palloc(pool,sizeof(apt_file_cache_t));
+	cache->pool = pool;
+	cache->max_size = max_size;
+	cache->guard = NULL;
+	if(apr_thread_mutex_create(&cache->guard,APR_THREAD_MUTEX_DEFAULT,pool) != APR_SUCCESS) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create File Cache");
+		return NULL;
+	}
+	cache->entries = apr_hash_make(pool);
+	APR_RING_INIT(&cache->lru, apt_file_cache_entry_t, link);
+	memset(&cache->stats,0,sizeof(cache->stats));
+	return cache;
+}
+
+/** Unmap the entry (guarded) */
+static void apt_file_cache_entry_destroy(apt_file_cache_t *cache, apt_file_cache_entry_t *entry)
+{
+	apr_hash_set(cache->entries,entry->path,APR_HASH_KEY_STRING,NULL);
+	cache->stats.entry_count--;
+	cache->stats.mapped_size -= entry->mmap->size;
+	/* the mapping is deleted by the cleanup of the pool */
+	apr_pool_destroy(entry->pool);
+}
+
+/** Evict the least recently used entries to fit the mapped size in the limit (guarded) */
+static void apt_file_cache_evict(apt_file_cache_t *cache)
+{
+	apt_file_cache_entry_t *entry;
+	while(cache->stats.mapped_size > cache->max_size &&
+		!APR_RING_EMPTY(&cache->lru, apt_file_cache_entry_t, link)) {
+		entry = APR_RING_FIRST(&cache->lru);
+		APR_RING_REMOVE(entry,link);
+		apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Evict Cached File [%s]",entry->path);
+		apt_file_cache_entry_destroy(cache,entry);
+		cache->stats.evictions++;
+	}
+}
+
+/** Map the file into a new entry (guarded) */
+static apt_file_cache_entry_t* apt_file_cache_entry_create(apt_file_cache_t *cache, const char *file_path)
+{
+	apt_file_cache_entry_t *entry;
+	apr_pool_t *pool;
+	apr_file_t *file;
+	apr_finfo_t finfo;
+	apr_status_t status;
+
+	apr_pool_create(&pool,cache->pool);
+	if(apr_file_open(&file,file_path,APR_READ | APR_BINARY,APR_OS_DEFAULT,pool) != APR_SUCCESS) {
+		apr_pool_destroy(pool);
+		return NULL;
+	}
+
+	entry = apr_palloc(pool,sizeof(apt_file_cache_entry_t));
+	entry->pool = pool;
+	entry->path = apr_pstrdup(pool,file_path);
+	entry->mmap = NULL;
+	entry->ref_count = 0;
+	entry->invalidated = FALSE;
+	APR_RING_ELEM_INIT(entry,link);
+
+	status = apr_file_info_get(&finfo,APR_FINFO_SIZE,file);
+	if(status == APR_SUCCESS && finfo.size > 0) {
+		status = apr_mmap_create(&entry->mmap,file,0,(apr_size_t)finfo.size,APR_MMAP_READ,pool);
+	}
+	/* the mapping outlives the file handle */
+	apr_file_close(file);
+	if(!entry->mmap) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Map File [%s]",file_path);
+		apr_pool_destroy(pool);
+		return NULL;
+	}
+
+	apr_hash_set(cache->entries,entry->path,APR_HASH_KEY_STRING,entry);
+	cache->stats.entry_count++;
+	cache->stats.mapped_size += entry->mmap->size;
+	return entry;
+}
+
+APT_DECLARE(void) apt_file_cache_destroy(apt_file_cache_t *cache)
+{
+	apt_file_cache_entry_t *entry;
+	apr_thread_mutex_lock(cache->guard);
+	while(!APR_RING_EMPTY(&cache->lru, apt_file_cache_entry_t, link)) {
+		entry = APR_RING_FIRST(&cache->lru);
+		APR_RING_REMOVE(entry,link);
+		apt_file_cache_entry_destroy(cache,entry);
+	}
+	if(cache->stats.entry_count) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Destroy File Cache with %"APR_SIZE_T_FMT" Referenced Entries",
+			cache->stats.entry_count);
+	}
+	apr_thread_mutex_unlock(cache->guard);
+	apr_thread_mutex_destroy(cache->guard);
+	cache->guard = NULL;
+}
+
+APT_DECLARE(apt_file_cache_entry_t*) apt_file_cache_acquire(apt_file_cache_t *cache, const char *file_path, const void **data, apr_size_t *size)
+{
+	apt_file_cache_entry_t *entry;
+
+	/* a miss maps the file under the lock: the cache is used from control
+	threads, and concurrent misses of the same file must map it once */
+	apr_thread_mutex_lock(cache->guard);
+	entry = apr_hash_get(cache->entries,file_path,APR_HASH_KEY_STRING);
+	if(entry && entry->invalidated == TRUE) {
+		/* the file is about to be removed */
+		apr_thread_mutex_unlock(cache->guard);
+		return NULL;
+	}
+	if(entry) {
+		if(!entry->ref_count) {
+			APR_RING_REMOVE(entry,link);
+		}
+		cache->stats.hits++;
+	}
+	else {
+		entry = apt_file_cache_entry_create(cache,file_path);
+		if(entry) {
+			cache->stats.misses++;
+		}
+	}
+
+	if(entry) {
+		entry->ref_count++;
+		*data = entry->mmap->mm;
+		*size = entry->mmap->size;
+		/* make room for the new entry among the unreferenced ones */
+		apt_file_cache_evict(cache);
+	}
+	apr_thread_mutex_unlock(cache->guard);
+	return entry;
+}
+
+APT_DECLARE(void) apt_file_cache_release(apt_file_cache_t *cache, apt_file_cache_entry_t *entry)
+{
+	apr_thread_mutex_lock(cache->guard);
+	if(entry->ref_count && --entry->ref_count == 0) {
+		if(entry->invalidated == TRUE) {
+			apt_file_cache_entry_destroy(cache,entry);
+		}
+		else {
+			APR_RING_INSERT_TAIL(&cache->lru,entry,apt_file_cache_entry_t,link);
+			apt_file_cache_evict(cache);
+		}
+	}
+	apr_thread_mutex_unlock(cache->guard);
+}
+
+APT_DECLARE(apt_bool_t) apt_file_cache_invalidate(apt_file_cache_t *cache, const char *file_path)
+{
+	apt_file_cache_entry_t *entry;
+	apt_bool_t status = TRUE;
+
+	apr_thread_mutex_lock(cache->guard);
+	entry = apr_hash_get(cache->entries,file_path,APR_HASH_KEY_STRING);
+	if(entry) {
+		if(!entry->ref_count) {
+			APR_RING_REMOVE(entry,link);
+			apt_file_cache_entry_destroy(cache,entry);
+		}
+		else {
+			/* still read by the users, unmap on the last release */
+			entry->invalidated = TRUE;
+			status = FALSE;
+		}
+	}
+	apr_thread_mutex_unlock(cache->guard);
+	return status;
+}
+
+APT_DECLARE(void) apt_file_cache_stats_get(apt_file_cache_t *cache, apt_file_cache_stats_t *stats)
+{
+	apr_thread_mutex_lock(cache->guard);
+	*stats = cache->stats;
+	apr_thread_mutex_unlock(cache->guard);
+}
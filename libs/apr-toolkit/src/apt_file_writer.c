@@ -0,0 +1,432 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef WIN32
+#pragma warning(disable: 4127)
+#endif
+#include <apr_ring.h>
+#include <apr_file_io.h>
+#include <apr_thread_proc.h>
+#include <apr_thread_mutex.h>
+#include <apr_thread_cond.h>
+#include "apt_file_writer.h"
+#include "apt_atomic.h"
+#include "apt_log.h"
+
+/** File of file writer */
+struct apt_file_writer_file_t {
+	/** Ring entry */
+	APR_RING_ENTRY(apt_file_writer_file_t) link;
+	/** Back pointer to writer */
+	apt_file_writer_t                     *writer;
+	/** Pool the file is allocated from, destroyed once released by both the user and the background thread */
+	apr_pool_t                            *pool;
+	/** File handle */
+	apr_file_t                            *file;
+	/** File path (allocated from the pool of the file) */
+	const char                            *path;
+
+	/** Ring of the data to write (writer->buffer_size bytes) */
+	char                                  *data;
+	/** Total number of bytes queued, owned by the producer */
+	volatile apr_uint32_t                  write_pos;
+	/** Total number of bytes written to disk, owned by the background thread */
+	volatile apr_uint32_t                  read_pos;
+	/** Total number of bytes dropped, owned by the producer */
+	volatile apr_uint32_t                  dropped;
+	/** Set once the file is closed by the user */
+	volatile apr_uint32_t                  closing;
+	/** Handler raised once the file is flushed and closed, set before closing */
+	apt_file_writer_close_handler_f        close_handler;
+	/** Object to raise the handler with */
+	void                                  *close_obj;
+	/** Set once the file is flushed and closed (guarded by writer->guard) */
+	apt_bool_t                             closed;
+	/** Number of references held by the user and the background thread (guarded by writer->guard) */
+	apr_uint32_t                           ref_count;
+};
+
+/** List of files */
+APR_RING_HEAD(apt_file_writer_head_t, apt_file_writer_file_t);
+
+/** Asynchronous file writer */
+struct apt_file_writer_t {
+	/** Pool to allocate memory from */
+	apr_pool_t                    *pool;
+	/** Size of the ring of each file (power of two) */
+	apr_uint32_t                   buffer_size;
+	/** Interval the files are flushed at */
+	apr_interval_time_t            interval;
+
+	/** Background thread */
+	apr_thread_t                  *thread;
+	/** Guards the lists below, the pool and the statistics */
+	apr_thread_mutex_t            *guard;
+	/** Wakes the background thread up on stop and on close with a handler */
+	apr_thread_cond_t             *wakeup;
+	/** Whether the background thread should keep running */
+	apt_bool_t                     running;
+
+	/** Files opened, but not taken by the background thread yet */
+	struct apt_file_writer_head_t  pending_files;
+	/** Files taken by the background thread (owned by the background thread) */
+	struct apt_file_writer_head_t  files;
+	/** Files flushed and closed, to be released (owned by the background thread) */
+	struct apt_file_writer_head_t  closed_files;
+	/** Statistics */
+	apt_file_writer_stats_t        stats;
+};
+
+
+APT_DECLARE(apt_file_writer_t*) apt_file_writer_create(apr_size_t buffer_size, apr_interval_time_t interval, apr_pool_t *pool)
+{
+	apt_file_writer_t *writer = apr_palloc(pool,sizeof(apt_file_writer_t));
+	writer->pool = pool;
+	writer->buffer_size = 1;
+	while(writer->buffer_size < buffer_size && writer->buffer_size < 0x40000000) {
+		writer->buffer_size <<= 1;
+	}
+	writer->interval = interval;
+	writer->thread = NULL;
+	writer->guard = NULL;
+	writer->wakeup = NULL;
+	writer->running = FALSE;
+	APR_RING_INIT(&writer->pending_files, apt_file_writer_file_t, link);
+	APR_RING_INIT(&writer->files, apt_file_writer_file_t, link);
+	APR_RING_INIT(&writer->closed_files, apt_file_writer_file_t, link);
+	memset(&writer->stats,0,sizeof(writer->stats));
+
+	if(apr_thread_mutex_create(&writer->guard,APR_THREAD_MUTEX_UNNESTED,pool) != APR_SUCCESS ||
+		apr_thread_cond_create(&writer->wakeup,pool) != APR_SUCCESS) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create File Writer");
+		return NULL;
+	}
+	return writer;
+}
+
+/** Write the queued data of the file to disk */
+static void apt_file_writer_drain(apt_file_writer_file_t *file, apt_file_writer_stats_t *stats)
+{
+	apr_uint32_t write_pos = apt_atomic_load32_acquire(&file->write_pos);
+	apr_uint32_t read_pos = file->read_pos;
+	apr_uint32_t offset;
+	apr_size_t size;
+
+	while(read_pos != write_pos) {
+		/* up to the end of the ring at once */
+		offset = read_pos & (file->writer->buffer_size - 1);
+		size = write_pos - read_pos;
+		if(size > file->writer->buffer_size - offset) {
+			size = file->writer->buffer_size - offset;
+		}
+		if(apr_file_write_full(file->file,file->data + offset,size,NULL) == APR_SUCCESS) {
+			stats->written_bytes += size;
+		}
+		else {
+			stats->dropped_bytes += size;
+		}
+		stats->write_calls++;
+		read_pos += (apr_uint32_t)size;
+	}
+	apt_atomic_store32_release(&file->read_pos,read_pos);
+}
+
+/** Write the rest of the queued data of the file to disk and close it */
+static void apt_file_writer_file_close(apt_file_writer_file_t *file, apt_file_writer_stats_t *stats)
+{
+	apr_uint32_t dropped;
+	apt_file_writer_drain(file,stats);
+	dropped = apt_atomic_load32_acquire(&file->dropped);
+	if(dropped) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Dropped %u bytes of File [%s]",dropped,file->path);
+	}
+	stats->dropped_bytes += dropped;
+	apr_file_close(file->file);
+	file->file = NULL;
+}
+
+/** Flush the files taken, move the closed ones to the list of closed files (background thread) */
+static void apt_file_writer_flush(apt_file_writer_t *writer, apt_bool_t force_close, apt_file_writer_stats_t *stats)
+{
+	apt_file_writer_file_t *file;
+	apt_file_writer_file_t *next;
+	apr_uint32_t closing;
+
+	for(file = APR_RING_FIRST(&writer->files); file != APR_RING_SENTINEL(&writer->files, apt_file_writer_file_t, link); file = next) {
+		next = APR_RING_NEXT(file,link);
+		/* check before draining, so that nothing queued before close is missed */
+		closing = apt_atomic_load32_acquire(&file->closing);
+		if(closing || force_close) {
+			apt_file_writer_file_close(file,stats);
+			APR_RING_REMOVE(file,link);
+			APR_RING_INSERT_TAIL(&writer->closed_files,file,apt_file_writer_file_t,link);
+		}
+		else {
+			apt_file_writer_drain(file,stats);
+		}
+	}
+}
+
+/** Raise the close handler of the file, if any (without holding the lock) */
+static void apt_file_writer_file_closed(apt_file_writer_file_t *file)
+{
+	if(file->close_handler) {
+		file->close_handler(file->close_obj);
+	}
+}
+
+/** Release a reference to the file, the caller must hold writer->guard */
+static void apt_file_writer_file_release(apt_file_writer_file_t *file)
+{
+	file->ref_count--;
+	if(!file->ref_count) {
+		/* nobody refers to the file anymore, the memory is never reused */
+		apr_pool_destroy(file->pool);
+	}
+}
+
+static void* APR_THREAD_FUNC apt_file_writer_run(apr_thread_t *thread, void *data)
+{
+	apt_file_writer_t *writer = data;
+	apt_file_writer_file_t *file;
+	apt_file_writer_file_t *next;
+	apt_file_writer_stats_t stats;
+	apt_bool_t running = TRUE;
+
+	while(running == TRUE) {
+		apr_thread_mutex_lock(writer->guard);
+		if(writer->running == TRUE) {
+			apr_thread_cond_timedwait(writer->wakeup,writer->guard,writer->interval);
+		}
+		running = writer->running;
+		APR_RING_CONCAT(&writer->files,&writer->pending_files,apt_file_writer_file_t,link);
+		apr_thread_mutex_unlock(writer->guard);
+
+		/* disk is accessed without holding the lock */
+		memset(&stats,0,sizeof(stats));
+		apt_file_writer_flush(writer,running == TRUE ? FALSE : TRUE,&stats);
+
+		apr_thread_mutex_lock(writer->guard);
+		for(file = APR_RING_FIRST(&writer->closed_files);
+				file != APR_RING_SENTINEL(&writer->closed_files, apt_file_writer_file_t, link);
+					file = next) {
+			next = APR_RING_NEXT(file,link);
+			file->closed = TRUE;
+			if(apt_atomic_load32_acquire(&file->closing) == FALSE) {
+				/* closed on stop, the handler is raised by the user on close */
+				APR_RING_REMOVE(file,link);
+				apt_file_writer_file_release(file);
+			}
+		}
+		writer->stats.written_bytes += stats.written_bytes;
+		writer->stats.dropped_bytes += stats.dropped_bytes;
+		writer->stats.write_calls += stats.write_calls;
+		apr_thread_mutex_unlock(writer->guard);
+
+		if(APR_RING_EMPTY(&writer->closed_files, apt_file_writer_file_t, link)) {
+			continue;
+		}
+
+		/* the handlers are raised without holding the lock */
+		for(file = APR_RING_FIRST(&writer->closed_files);
+				file != APR_RING_SENTINEL(&writer->closed_files, apt_file_writer_file_t, link);
+					file = APR_RING_NEXT(file,link)) {
+			apt_file_writer_file_closed(file);
+		}
+
+		apr_thread_mutex_lock(writer->guard);
+		while(!APR_RING_EMPTY(&writer->closed_files, apt_file_writer_file_t, link)) {
+			file = APR_RING_FIRST(&writer->closed_files);
+			APR_RING_REMOVE(file,link);
+			apt_file_writer_file_release(file);
+		}
+		apr_thread_mutex_unlock(writer->guard);
+	}
+	return NULL;
+}
+
+APT_DECLARE(apt_bool_t) apt_file_writer_start(apt_file_writer_t *writer)
+{
+	if(writer->thread) {
+		return FALSE;
+	}
+	writer->running = TRUE;
+	if(apr_thread_create(&writer->thread,NULL,apt_file_writer_run,writer,writer->pool) != APR_SUCCESS) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Start File Writer");
+		writer->running = FALSE;
+		writer->thread = NULL;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+APT_DECLARE(apt_bool_t) apt_file_writer_stop(apt_file_writer_t *writer)
+{
+	apr_status_t rv;
+	if(!writer->thread) {
+		return FALSE;
+	}
+
+	apr_thread_mutex_lock(writer->guard);
+	writer->running = FALSE;
+	apr_thread_cond_signal(writer->wakeup);
+	apr_thread_mutex_unlock(writer->guard);
+
+	apr_thread_join(&rv,writer->thread);
+	writer->thread = NULL;
+	return TRUE;
+}
+
+APT_DECLARE(apt_file_writer_file_t*) apt_file_writer_open(apt_file_writer_t *writer, const char *file_path)
+{
+	apt_file_writer_file_t *file;
+	apr_pool_t *pool = NULL;
+
+	/* file objects are not recycled, so that a stale handle never refers to another file */
+	apr_thread_mutex_lock(writer->guard);
+	apr_pool_create(&pool,writer->pool);
+	apr_thread_mutex_unlock(writer->guard);
+
+	file = apr_palloc(pool,sizeof(apt_file_writer_file_t));
+	file->writer = writer;
+	file->pool = pool;
+	file->file = NULL;
+	file->path = apr_pstrdup(pool,file_path);
+	file->data = apr_palloc(pool,writer->buffer_size);
+	file->write_pos = 0;
+	file->read_pos = 0;
+	file->dropped = 0;
+	file->closing = FALSE;
+	file->close_handler = NULL;
+	file->close_obj = NULL;
+	file->closed = FALSE;
+	/* one reference is held by the user, another one by the background thread */
+	file->ref_count = 2;
+	if(apr_file_open(
+			&file->file,
+			file_path,
+			APR_WRITE | APR_CREATE | APR_TRUNCATE | APR_BINARY,
+			APR_OS_DEFAULT,
+			pool) != APR_SUCCESS) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Open File [%s] for Writing",file_path);
+		apr_thread_mutex_lock(writer->guard);
+		apr_pool_destroy(pool);
+		apr_thread_mutex_unlock(writer->guard);
+		return NULL;
+	}
+
+	APR_RING_ELEM_INIT(file,link);
+	apr_thread_mutex_lock(writer->guard);
+	APR_RING_INSERT_TAIL(&writer->pending_files,file,apt_file_writer_file_t,link);
+	apr_thread_mutex_unlock(writer->guard);
+	return file;
+}
+
+APT_DECLARE(apt_bool_t) apt_file_writer_write(apt_file_writer_file_t *file, const void *data, apr_size_t size)
+{
+	apr_uint32_t buffer_size = file->writer->buffer_size;
+	apr_uint32_t write_pos = file->write_pos;
+	apr_uint32_t offset = write_pos & (buffer_size - 1);
+	apr_size_t tail_size = buffer_size - offset;
+
+	if(size > buffer_size - (write_pos - apt_atomic_load32_acquire(&file->read_pos))) {
+		/* the background thread is behind, drop rather than wait */
+		apt_atomic_store32_release(&file->dropped,file->dropped + (apr_uint32_t)size);
+		return FALSE;
+	}
+
+	if(size <= tail_size) {
+		memcpy(file->data + offset,data,size);
+	}
+	else {
+		memcpy(file->data + offset,data,tail_size);
+		memcpy(file->data,(const char*)data + tail_size,size - tail_size);
+	}
+	apt_atomic_store32_release(&file->write_pos,write_pos + (apr_uint32_t)size);
+	return TRUE;
+}
+
+APT_DECLARE(void) apt_file_writer_close(apt_file_writer_file_t *file)
+{
+	apt_file_writer_close_ex(file,NULL,NULL);
+}
+
+APT_DECLARE(void) apt_file_writer_close_ex(apt_file_writer_file_t *file, apt_file_writer_close_handler_f handler, void *obj)
+{
+	apt_file_writer_t *writer = file->writer;
+	apt_file_writer_file_t *it;
+	apt_bool_t pending = FALSE;
+	apt_bool_t closed = FALSE;
+
+	file->close_handler = handler;
+	file->close_obj = obj;
+	/* the background thread writes the rest and closes the file */
+	apt_atomic_store32_release(&file->closing,TRUE);
+
+	apr_thread_mutex_lock(writer->guard);
+	if(file->closed == TRUE) {
+		/* already closed on stop of the writer */
+		closed = TRUE;
+	}
+	else if(writer->running == FALSE) {
+		/* no background thread to take the file over, close it here if not taken yet */
+		for(it = APR_RING_FIRST(&writer->pending_files);
+				it != APR_RING_SENTINEL(&writer->pending_files, apt_file_writer_file_t, link);
+					it = APR_RING_NEXT(it,link)) {
+			if(it == file) {
+				APR_RING_REMOVE(file,link);
+				file->ref_count--;
+				pending = TRUE;
+				break;
+			}
+		}
+	}
+	else if(handler) {
+		/* wake the background thread up rather than delay the handler till the next interval */
+		apr_thread_cond_signal(writer->wakeup);
+	}
+	apr_thread_mutex_unlock(writer->guard);
+
+	if(pending == TRUE) {
+		apt_file_writer_stats_t stats;
+		memset(&stats,0,sizeof(stats));
+		apt_file_writer_file_close(file,&stats);
+		apt_file_writer_file_closed(file);
+
+		apr_thread_mutex_lock(writer->guard);
+		writer->stats.written_bytes += stats.written_bytes;
+		writer->stats.dropped_bytes += stats.dropped_bytes;
+		writer->stats.write_calls += stats.write_calls;
+		apt_file_writer_file_release(file);
+		apr_thread_mutex_unlock(writer->guard);
+		return;
+	}
+
+	if(closed == TRUE) {
+		apt_file_writer_file_closed(file);
+	}
+
+	apr_thread_mutex_lock(writer->guard);
+	apt_file_writer_file_release(file);
+	apr_thread_mutex_unlock(writer->guard);
+}
+
+APT_DECLARE(void) apt_file_writer_stats_get(apt_file_writer_t *writer, apt_file_writer_stats_t *stats)
+{
+	apr_thread_mutex_lock(writer->guard);
+	*stats = writer->stats;
+	apr_thread_mutex_unlock(writer->guard);
+}
@@ -28,11 +28,18 @@
 #include <apr_portable.h>
 #include <apr_hash.h>
 #include <apr_xml.h>
+#include <apr_thread_proc.h>
+#include <apr_thread_mutex.h>
+#include <apr_thread_cond.h>
 #include "apt_pool.h"
+#include "apt_atomic.h"
 #include "apt_log.h"
 
 #define MAX_LOG_ENTRY_SIZE 4096
 #define MAX_PRIORITY_NAME_LENGTH 9
+#define MAX_LOG_ASYNC_QUEUE_SIZE 0x10000
+/* interval the background thread writes the queued records at (usec) */
+#define LOG_ASYNC_INTERVAL 10000
 
 static const char priority_snames[APT_PRIO_COUNT][MAX_PRIORITY_NAME_LENGTH+1] =
 {
@@ -50,6 +57,8 @@ typedef struct apt_log_file_data_t apt_log_file_data_t;
 typedef struct apt_log_file_settings_t apt_log_file_settings_t;
 typedef struct apt_log_file_entry_t apt_log_file_entry_t;
 typedef struct apt_syslog_settings_t apt_syslog_settings_t;
+typedef struct apt_log_record_t apt_log_record_t;
+typedef struct apt_log_async_t apt_log_async_t;
 
 struct apt_log_file_entry_t {
 	APR_RING_ENTRY(apt_log_file_entry_t) link;
@@ -86,6 +95,35 @@ struct apt_log_file_data_t {
 	apt_log_file_settings_t   settings;
 };
 
+/* record queued by the calling thread */
+struct apt_log_record_t {
+	volatile apr_uint32_t     seq;                /* position the record is ready to be written or read at */
+	apt_log_priority_e        priority;
+	apr_time_t                time;
+	unsigned long             thread_id;
+	apr_size_t                mark_length;        /* length of the file:line mark leading the data */
+	apr_size_t                length;
+	char                      data[MAX_LOG_ENTRY_SIZE];
+};
+
+/* bounded multi-producer/single-consumer queue of records and its background thread */
+struct apt_log_async_t {
+	apt_log_record_t         *records;
+	apr_uint32_t              mask;
+	apt_log_overflow_e        overflow;
+	volatile apr_uint32_t     enqueue_pos;        /* claimed by the producers */
+	volatile apr_uint32_t     dequeue_pos;        /* advanced by the background thread */
+	volatile apr_uint32_t     producers;          /* number of producers, which have taken the queue */
+	volatile apr_uint32_t     written;
+	volatile apr_uint32_t     dropped;
+	volatile apr_uint32_t     overflowed;
+	apr_uint32_t              reported_dropped;
+	apr_thread_t             *thread;
+	apr_thread_mutex_t       *guard;
+	apr_thread_cond_t        *wakeup;
+	apt_bool_t                running;
+};
+
 struct apt_log_source_t {
 	const char               *name;
 	apt_log_priority_e        priority;
@@ -99,6 +137,7 @@ struct apt_logger_t {
 	apt_log_ext_handler_f     ext_handler;
 	apt_log_file_data_t      *file_data;
 	apt_bool_t                syslog;
+	apt_log_async_t          *async;
 };
 
 static apt_logger_t *apt_logger = NULL;
@@ -113,7 +152,8 @@ static apt_bool_t apt_log_file_link_current(const apt_log_file_data_t *file_data
 static void apt_log_files_purge(const apt_log_file_data_t *file_data);
 static void apt_log_files_populate(apt_log_file_data_t *file_data);
 static void apt_log_file_entries_clear(apt_log_file_data_t *file_data);
-static apt_bool_t apt_log_file_dump(apt_log_file_data_t *file_data, const char *log_entry, apr_size_t size);
+static apt_bool_t apt_log_file_dump(apt_log_file_data_t *file_data, const char *log_entry, apr_size_t size, apt_bool_t flush);
+static void apt_log_file_flush(apt_log_file_data_t *file_data);
 static apr_xml_doc* apt_log_doc_parse(const char *file_path, apr_pool_t *pool);
 
 static void apt_log_file_settings_init(apt_log_file_settings_t *settings)
@@ -133,6 +173,7 @@ static apt_logger_t* apt_log_instance_alloc(apr_pool_t *pool)
 	logger->ext_handler = NULL;
 	logger->file_data = NULL;
 	logger->syslog = FALSE;
+	logger->async = NULL;
 
 	/* Create hash for custom log sources */
 	logger->log_sources = apr_hash_make(pool);
@@ -229,6 +270,31 @@ static apt_bool_t apt_log_file_settings_load(apt_log_file_settings_t *settings,
 	return TRUE;
 }
 
+static apt_bool_t apt_log_async_load(const apr_xml_elem *elem, apr_pool_t *pool)
+{
+	const apr_xml_attr *attr;
+	apt_bool_t enable = FALSE;
+	apr_size_t queue_size = APT_LOG_ASYNC_DEFAULT_QUEUE_SIZE;
+	apt_log_overflow_e overflow = APT_LOG_OVERFLOW_DROP;
+
+	for(attr = elem->attr; attr; attr = attr->next) {
+		if(strcasecmp(attr->name,"enable") == 0) {
+			enable = strcasecmp(attr->value,"true") == 0 ? TRUE : FALSE;
+		}
+		else if(strcasecmp(attr->name,"queue-size") == 0) {
+			queue_size = atol(attr->value);
+		}
+		else if(strcasecmp(attr->name,"overflow") == 0) {
+			overflow = apt_log_overflow_translate(attr->value);
+		}
+	}
+
+	if(enable == FALSE) {
+		return TRUE;
+	}
+	return apt_log_async_open(queue_size,overflow,pool);
+}
+
 APT_DECLARE(apt_bool_t) apt_log_instance_load(const char *config_file, apr_pool_t *pool)
 {
 	apr_xml_doc *doc;
@@ -259,6 +325,10 @@ APT_DECLARE(apt_bool_t) apt_log_instance_load(const char *config_file, apr_pool_
 
 	/* Navigate through document */
 	for(elem = root->first_child; elem; elem = elem->next) {
+		if(strcasecmp(elem->name,"async") == 0) {
+			apt_log_async_load(elem,pool);
+			continue;
+		}
 		if(!elem->first_cdata.first || !elem->first_cdata.first->text) 
 			continue;
 
@@ -293,6 +363,10 @@ APT_DECLARE(apt_bool_t) apt_log_instance_destroy()
 		return FALSE;
 	}
 
+	if(apt_logger->async) {
+		apt_log_async_close();
+	}
+
 	if(apt_logger->file_data) {
 		apt_log_file_close();
 	}
@@ -745,6 +819,13 @@ APT_DECLARE(apt_log_masking_e) apt_log_masking_translate(const char *str)
 	return APT_LOG_MASKING_NONE;
 }
 
+APT_DECLARE(apt_log_overflow_e) apt_log_overflow_translate(const char *str)
+{
+	if(strcasecmp(str, "SYNC") == 0)
+		return APT_LOG_OVERFLOW_SYNC;
+	return APT_LOG_OVERFLOW_DROP;
+}
+
 #define APT_MASKED_CONTENT "*** masked ***"
 
 APT_DECLARE(const char*) apt_log_data_mask(const char *data_in, apr_size_t *length, apr_pool_t *pool)
@@ -837,15 +918,11 @@ static APR_INLINE unsigned long apt_thread_id_get(void)
 #endif
 }
 
-static apt_bool_t apt_do_log(apt_log_source_t *log_source, const char *file, int line, apt_log_priority_e priority, const char *format, va_list arg_ptr)
+static apr_size_t apt_log_header_compose(char *log_entry, apr_size_t max_size, apr_time_t time, unsigned long thread_id, const char *mark, apr_size_t mark_length, apt_log_priority_e priority)
 {
-	char log_entry[MAX_LOG_ENTRY_SIZE];
-	apr_size_t max_size = MAX_LOG_ENTRY_SIZE - 2;
 	apr_size_t offset = 0;
-	apr_size_t data_offset;
 	apr_time_exp_t result;
-	apr_time_t now = apr_time_now();
-	apr_time_exp_lt(&result,now);
+	apr_time_exp_lt(&result,time);
 
 	if(apt_logger->header & APT_LOG_HEADER_DATE) {
 		offset += apr_snprintf(log_entry+offset,max_size-offset,"%4d-%02d-%02d ",
@@ -860,27 +937,28 @@ static apt_bool_t apt_do_log(apt_log_source_t *log_source, const char *file, int
 							result.tm_sec,
 							result.tm_usec);
 	}
-	if(apt_logger->header & APT_LOG_HEADER_MARK) {
-		offset += apr_snprintf(log_entry+offset,max_size-offset,"%s:%03d ",file,line);
+	if(mark_length) {
+		memcpy(log_entry+offset,mark,mark_length);
+		offset += mark_length;
 	}
 	if(apt_logger->header & APT_LOG_HEADER_THREAD) {
-		offset += apr_snprintf(log_entry+offset,max_size-offset,"%05lu ",apt_thread_id_get());
+		offset += apr_snprintf(log_entry+offset,max_size-offset,"%05lu ",thread_id);
 	}
 	if(apt_logger->header & APT_LOG_HEADER_PRIORITY) {
 		memcpy(log_entry+offset,priority_snames[priority],MAX_PRIORITY_NAME_LENGTH);
 		offset += MAX_PRIORITY_NAME_LENGTH;
 	}
+	return offset;
+}
 
-	data_offset = offset;
-	offset += apr_vsnprintf(log_entry+offset,max_size-offset,format,arg_ptr);
-	log_entry[offset++] = '\n';
-	log_entry[offset] = '\0';
+static void apt_log_entry_output(const char *log_entry, apr_size_t size, apr_size_t data_offset, apt_log_priority_e priority, apt_bool_t flush)
+{
 	if((apt_logger->mode & APT_LOG_OUTPUT_CONSOLE) == APT_LOG_OUTPUT_CONSOLE) {
-		fwrite(log_entry,offset,1,stdout);
+		fwrite(log_entry,size,1,stdout);
 	}
 	
 	if((apt_logger->mode & APT_LOG_OUTPUT_FILE) == APT_LOG_OUTPUT_FILE && apt_logger->file_data) {
-		apt_log_file_dump(apt_logger->file_data,log_entry,offset);
+		apt_log_file_dump(apt_logger->file_data,log_entry,size,flush);
 	}
 
 #ifndef WIN32
@@ -888,6 +966,284 @@ static apt_bool_t apt_do_log(apt_log_source_t *log_source, const char *file, int
 		syslog(priority,"%s",log_entry + data_offset);
 	}
 #endif
+}
+
+/** Queue the record of the calling thread, FALSE if the queue is full */
+static apt_bool_t apt_log_async_put(apt_log_async_t *async, const char *file, int line, apt_log_priority_e priority, const char *format, va_list arg_ptr)
+{
+	apt_log_record_t *record;
+	apr_size_t max_size = MAX_LOG_ENTRY_SIZE - 2;
+	apr_size_t offset = 0;
+	apr_uint32_t pos = apt_atomic_load32_acquire(&async->enqueue_pos);
+	apr_uint32_t seq;
+	apr_uint32_t cur;
+
+	/* claim the record at the enqueue position */
+	for(;;) {
+		record = &async->records[pos & async->mask];
+		seq = apt_atomic_load32_acquire(&record->seq);
+		if(seq == pos) {
+			cur = apr_atomic_cas32(&async->enqueue_pos,pos + 1,pos);
+			if(cur == pos) {
+				break;
+			}
+			pos = cur;
+		}
+		else if((apr_int32_t)(seq - pos) < 0) {
+			/* the record is not read yet */
+			return FALSE;
+		}
+		else {
+			/* the record is claimed by another thread */
+			pos = apt_atomic_load32_acquire(&async->enqueue_pos);
+		}
+	}
+
+	record->priority = priority;
+	record->time = apr_time_now();
+	record->thread_id = apt_thread_id_get();
+	/* the mark is formatted here, the file name may belong to a plugin unloaded by the time the record is read */
+	if(apt_logger->header & APT_LOG_HEADER_MARK) {
+		offset += apr_snprintf(record->data,max_size,"%s:%03d ",file,line);
+	}
+	record->mark_length = offset;
+	offset += apr_vsnprintf(record->data+offset,max_size-offset,format,arg_ptr);
+	record->length = offset;
+	apt_atomic_store32_release(&record->seq,pos + 1);
+
+	if(apt_atomic_load32_acquire(&async->dequeue_pos) == pos) {
+		/* the queue has been empty, the background thread may be waiting */
+		apr_thread_mutex_lock(async->guard);
+		apr_thread_cond_signal(async->wakeup);
+		apr_thread_mutex_unlock(async->guard);
+	}
+	return TRUE;
+}
+
+/** Check whether the record at the dequeue position is ready to be written */
+static APR_INLINE apt_bool_t apt_log_async_ready(apt_log_async_t *async)
+{
+	const apt_log_record_t *record = &async->records[async->dequeue_pos & async->mask];
+	return apt_atomic_load32_acquire(&record->seq) == async->dequeue_pos + 1 ? TRUE : FALSE;
+}
+
+static void apt_log_record_output(const apt_log_record_t *record, apt_bool_t flush)
+{
+	char log_entry[MAX_LOG_ENTRY_SIZE];
+	apr_size_t max_size = MAX_LOG_ENTRY_SIZE - 2;
+	apr_size_t offset;
+	apr_size_t data_offset;
+	apr_size_t length;
+
+	data_offset = apt_log_header_compose(log_entry,max_size,record->time,record->thread_id,
+						record->data,record->mark_length,record->priority);
+	length = record->length - record->mark_length;
+	if(length > max_size - data_offset) {
+		length = max_size - data_offset;
+	}
+	memcpy(log_entry+data_offset,record->data+record->mark_length,length);
+	offset = data_offset + length;
+	log_entry[offset++] = '\n';
+	log_entry[offset] = '\0';
+	apt_log_entry_output(log_entry,offset,data_offset,record->priority,flush);
+}
+
+/** Write the queued records (background thread) */
+static void apt_log_async_drain(apt_log_async_t *async)
+{
+	apt_log_record_t *record;
+	apr_uint32_t written = 0;
+	apr_uint32_t dropped;
+
+	while(apt_log_async_ready(async) == TRUE) {
+		record = &async->records[async->dequeue_pos & async->mask];
+		apt_log_record_output(record,FALSE);
+		/* release the record for the position of the next round */
+		apt_atomic_store32_release(&record->seq,async->dequeue_pos + async->mask + 1);
+		apt_atomic_store32_release(&async->dequeue_pos,async->dequeue_pos + 1);
+		written++;
+	}
+
+	dropped = apt_atomic_load32_acquire(&async->dropped);
+	if(dropped != async->reported_dropped) {
+		apt_log_record_t notice;
+		notice.priority = APT_PRIO_WARNING;
+		notice.time = apr_time_now();
+		notice.thread_id = apt_thread_id_get();
+		notice.mark_length = 0;
+		notice.length = apr_snprintf(notice.data,sizeof(notice.data),"Dropped %u Log Records on Overflow",
+							dropped - async->reported_dropped);
+		async->reported_dropped = dropped;
+		apt_log_record_output(&notice,FALSE);
+		written++;
+	}
+
+	if(written) {
+		if((apt_logger->mode & APT_LOG_OUTPUT_FILE) == APT_LOG_OUTPUT_FILE && apt_logger->file_data) {
+			apt_log_file_flush(apt_logger->file_data);
+		}
+		apt_atomic_store32_release(&async->written,async->written + written);
+	}
+}
+
+static void* APR_THREAD_FUNC apt_log_async_run(apr_thread_t *thread, void *data)
+{
+	apt_log_async_t *async = data;
+	apt_bool_t running = TRUE;
+
+	while(running == TRUE) {
+		apr_thread_mutex_lock(async->guard);
+		/* producers signal under the lock after queueing into the empty queue, so no wakeup is missed */
+		if(async->running == TRUE && apt_log_async_ready(async) == FALSE) {
+			apr_thread_cond_timedwait(async->wakeup,async->guard,LOG_ASYNC_INTERVAL);
+		}
+		running = async->running;
+		apr_thread_mutex_unlock(async->guard);
+
+		apt_log_async_drain(async);
+	}
+	return NULL;
+}
+
+APT_DECLARE(apt_bool_t) apt_log_async_open(apr_size_t queue_size, apt_log_overflow_e overflow, apr_pool_t *pool)
+{
+	apt_log_async_t *async;
+	apr_uint32_t size = 1;
+	apr_uint32_t i;
+
+	if(!apt_logger || apt_logger->async) {
+		return FALSE;
+	}
+
+	while(size < queue_size && size < MAX_LOG_ASYNC_QUEUE_SIZE) {
+		size <<= 1;
+	}
+
+	async = apr_palloc(pool,sizeof(apt_log_async_t));
+	async->records = apr_palloc(pool,sizeof(apt_log_record_t) * size);
+	for(i = 0; i < size; i++) {
+		async->records[i].seq = i;
+	}
+	async->mask = size - 1;
+	async->overflow = overflow;
+	async->enqueue_pos = 0;
+	async->dequeue_pos = 0;
+	async->producers = 0;
+	async->written = 0;
+	async->dropped = 0;
+	async->overflowed = 0;
+	async->reported_dropped = 0;
+	async->thread = NULL;
+	async->guard = NULL;
+	async->wakeup = NULL;
+	async->running = TRUE;
+
+	if(apr_thread_mutex_create(&async->guard,APR_THREAD_MUTEX_UNNESTED,pool) != APR_SUCCESS ||
+		apr_thread_cond_create(&async->wakeup,pool) != APR_SUCCESS) {
+		return FALSE;
+	}
+	if(apr_thread_create(&async->thread,NULL,apt_log_async_run,async,pool) != APR_SUCCESS) {
+		return FALSE;
+	}
+
+	apt_logger->async = async;
+	return TRUE;
+}
+
+APT_DECLARE(apt_bool_t) apt_log_async_close()
+{
+	apt_log_async_t *async;
+	apr_status_t rv;
+	if(!apt_logger || !apt_logger->async) {
+		return FALSE;
+	}
+
+	/* further records are written on the calling thread */
+	async = apt_logger->async;
+	apr_atomic_xchgptr((volatile void**)&apt_logger->async,NULL);
+
+	/* wait for the producers, which have taken the queue before, to finish queueing */
+	while(apt_atomic_load32_acquire(&async->producers)) {
+		apr_thread_yield();
+	}
+
+	apr_thread_mutex_lock(async->guard);
+	async->running = FALSE;
+	apr_thread_cond_signal(async->wakeup);
+	apr_thread_mutex_unlock(async->guard);
+
+	/* the background thread writes the queued records before exit */
+	apr_thread_join(&rv,async->thread);
+	async->thread = NULL;
+	apr_thread_cond_destroy(async->wakeup);
+	apr_thread_mutex_destroy(async->guard);
+	return TRUE;
+}
+
+APT_DECLARE(apt_bool_t) apt_log_async_stats_get(apt_log_async_stats_t *stats)
+{
+	apt_log_async_t *async;
+	if(!apt_logger || !apt_logger->async) {
+		return FALSE;
+	}
+	async = apt_logger->async;
+	stats->written = apt_atomic_load32_acquire(&async->written);
+	stats->dropped = apt_atomic_load32_acquire(&async->dropped);
+	stats->overflowed = apt_atomic_load32_acquire(&async->overflowed);
+	return TRUE;
+}
+
+/** Take the queue of records (if any) for the calling producer */
+static APR_INLINE apt_log_async_t* apt_log_async_acquire(void)
+{
+	apt_log_async_t *async = apt_atomic_loadptr_acquire((void**)&apt_logger->async);
+	if(async) {
+		apr_atomic_inc32(&async->producers);
+		if(apt_atomic_loadptr_acquire((void**)&apt_logger->async) != async) {
+			/* the queue is being closed */
+			apr_atomic_dec32(&async->producers);
+			return NULL;
+		}
+	}
+	return async;
+}
+
+static apt_bool_t apt_do_log(apt_log_source_t *log_source, const char *file, int line, apt_log_priority_e priority, const char *format, va_list arg_ptr)
+{
+	char log_entry[MAX_LOG_ENTRY_SIZE];
+	char mark[256];
+	apr_size_t max_size = MAX_LOG_ENTRY_SIZE - 2;
+	apr_size_t mark_length = 0;
+	apr_size_t offset;
+	apr_size_t data_offset;
+	apt_log_async_t *async = apt_log_async_acquire();
+
+	if(async) {
+		apt_bool_t queued = apt_log_async_put(async,file,line,priority,format,arg_ptr);
+		apt_bool_t drop = (queued == FALSE && async->overflow == APT_LOG_OVERFLOW_DROP) ? TRUE : FALSE;
+		if(queued == FALSE) {
+			apr_atomic_inc32(drop == TRUE ? &async->dropped : &async->overflowed);
+		}
+		apr_atomic_dec32(&async->producers);
+
+		if(queued == TRUE) {
+			return TRUE;
+		}
+		if(drop == TRUE) {
+			return FALSE;
+		}
+	}
+
+	if(apt_logger->header & APT_LOG_HEADER_MARK) {
+		mark_length = apr_snprintf(mark,sizeof(mark),"%s:%03d ",file,line);
+	}
+	offset = apt_log_header_compose(log_entry,max_size,apr_time_now(),apt_thread_id_get(),mark,mark_length,priority);
+
+	data_offset = offset;
+	offset += apr_vsnprintf(log_entry+offset,max_size-offset,format,arg_ptr);
+	log_entry[offset++] = '\n';
+	log_entry[offset] = '\0';
+	apt_log_entry_output(log_entry,offset,data_offset,priority,TRUE);
 	return TRUE;
 }
 
@@ -1102,7 +1458,7 @@ static apt_bool_t apt_log_file_rotate(apt_log_file_data_t *file_data)
 	return apt_log_file_create(file_data);
 }
 
-static apt_bool_t apt_log_file_dump(apt_log_file_data_t *file_data, const char *log_entry, apr_size_t size)
+static apt_bool_t apt_log_file_dump(apt_log_file_data_t *file_data, const char *log_entry, apr_size_t size, apt_bool_t flush)
 {
 	apr_thread_mutex_lock(file_data->mutex);
 
@@ -1118,12 +1474,21 @@ static apt_bool_t apt_log_file_dump(apt_log_file_data_t *file_data, const char *
 	}
 	/* write to log file */
 	fwrite(log_entry,1,size,file_data->file);
-	fflush(file_data->file);
+	if(flush == TRUE) {
+		fflush(file_data->file);
+	}
 
 	apr_thread_mutex_unlock(file_data->mutex);
 	return TRUE;
 }
 
+static void apt_log_file_flush(apt_log_file_data_t *file_data)
+{
+	apr_thread_mutex_lock(file_data->mutex);
+	fflush(file_data->file);
+	apr_thread_mutex_unlock(file_data->mutex);
+}
+
 static apr_xml_doc* apt_log_doc_parse(const char *file_path, apr_pool_t *pool)
 {
 	apr_xml_parser *parser = NULL;
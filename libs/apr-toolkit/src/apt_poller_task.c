@@ -167,6 +167,15 @@ APT_DECLARE(apt_bool_t) apt_poller_task_descriptor_add(const apt_poller_task_t *
 	return FALSE;
 }
 
+/** Add descriptor to pollset with flags */
+APT_DECLARE(apt_bool_t) apt_poller_task_descriptor_add_ex(const apt_poller_task_t *task, const apr_pollfd_t *descriptor, apr_uint32_t flags)
+{
+	if(task->pollset) {
+		return apt_pollset_add_ex(task->pollset,descriptor,flags);
+	}
+	return FALSE;
+}
+
 /** Remove descriptor from pollset */
 APT_DECLARE(apt_bool_t) apt_poller_task_descriptor_remove(const apt_poller_task_t *task, const apr_pollfd_t *descriptor)
 {
@@ -15,26 +15,313 @@
  */
 
 #include <apr_poll.h>
+#include <apr_atomic.h>
 #include "apt_pollset.h"
 #include "apt_log.h"
 
+#if defined(__linux__) && !defined(APT_POLLSET_NO_EPOLL)
+/** Use epoll directly instead of APR pollset, and eventfd for wakeup */
+#define APT_POLLSET_EPOLL
+#endif
+
+#ifdef APT_POLLSET_EPOLL
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <apr_ring.h>
+#include <apr_portable.h>
+
+/** Element of epoll based pollset */
+typedef struct apt_pollset_elem_t apt_pollset_elem_t;
+
+struct apt_pollset_elem_t {
+	/** Ring entry of the list of added or free elements */
+	APR_RING_ENTRY(apt_pollset_elem_t) link;
+	/** Copy of the added descriptor */
+	apr_pollfd_t                       pfd;
+};
+
+/** List of elements */
+APR_RING_HEAD(apt_pollset_elem_head_t, apt_pollset_elem_t);
+#endif
+
 struct apt_pollset_t {
+#ifdef APT_POLLSET_EPOLL
+	/** Epoll descriptor */
+	int                            epoll_fd;
+	/** Eventfd descriptor used for wakeup */
+	int                            wakeup_fd;
+	/** Max number of descriptors */
+	apr_uint32_t                   size;
+	/** Events returned by epoll */
+	struct epoll_event            *events;
+	/** Signalled descriptors returned to the caller */
+	apr_pollfd_t                  *result_set;
+	/** Added elements */
+	struct apt_pollset_elem_head_t query_ring;
+	/** Free elements for reuse */
+	struct apt_pollset_elem_head_t free_ring;
+#else
 	/** APR pollset */
-	apr_pollset_t *base;
+	apr_pollset_t                 *base;
 #ifdef WIN32
 	/** Socket descriptors used for wakeup */
-	apr_socket_t  *wakeup_pipe[2];
+	apr_socket_t                  *wakeup_pipe[2];
 #else
 	/** Pipe descriptors used for wakeup */
-	apr_file_t    *wakeup_pipe[2];
+	apr_file_t                    *wakeup_pipe[2];
+#endif
 #endif
 	/** Builtin wakeup poll descriptor */
-	apr_pollfd_t   wakeup_pfd;
+	apr_pollfd_t                   wakeup_pfd;
+	/** Set once wakeup is signalled until the poller consumes it */
+	volatile apr_uint32_t          wakeup_pending;
 
 	/** Pool to allocate memory from */
-	apr_pool_t    *pool;
+	apr_pool_t                    *pool;
 };
 
+#ifdef APT_POLLSET_EPOLL
+
+/** Create interruptable pollset on top of epoll */
+APT_DECLARE(apt_pollset_t*) apt_pollset_create(apr_uint32_t size, apr_pool_t *pool)
+{
+	struct epoll_event event;
+	apt_pollset_t *pollset = apr_palloc(pool,sizeof(apt_pollset_t));
+	pollset->pool = pool;
+	pollset->wakeup_pending = FALSE;
+	/* +1 is builtin wakeup descriptor */
+	pollset->size = size + 1;
+	pollset->events = apr_palloc(pool,sizeof(struct epoll_event) * pollset->size);
+	pollset->result_set = apr_palloc(pool,sizeof(apr_pollfd_t) * pollset->size);
+	APR_RING_INIT(&pollset->query_ring, apt_pollset_elem_t, link);
+	APR_RING_INIT(&pollset->free_ring, apt_pollset_elem_t, link);
+
+	memset(&pollset->wakeup_pfd,0,sizeof(pollset->wakeup_pfd));
+	pollset->wakeup_pfd.desc_type = APR_NO_DESC;
+	pollset->wakeup_pfd.reqevents = APR_POLLIN;
+	pollset->wakeup_pfd.rtnevents = APR_POLLIN;
+	pollset->wakeup_pfd.client_data = pollset;
+
+	pollset->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if(pollset->epoll_fd < 0) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Epoll [%d]",errno);
+		return NULL;
+	}
+
+	pollset->wakeup_fd = eventfd(0,EFD_NONBLOCK | EFD_CLOEXEC);
+	if(pollset->wakeup_fd < 0) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Wakeup Eventfd [%d]",errno);
+		close(pollset->epoll_fd);
+		return NULL;
+	}
+
+	/* the wakeup descriptor is the only one with no element */
+	memset(&event,0,sizeof(event));
+	event.events = EPOLLIN;
+	event.data.ptr = NULL;
+	if(epoll_ctl(pollset->epoll_fd,EPOLL_CTL_ADD,pollset->wakeup_fd,&event) != 0) {
+		close(pollset->wakeup_fd);
+		close(pollset->epoll_fd);
+		return NULL;
+	}
+	return pollset;
+}
+
+/** Destroy pollset */
+APT_DECLARE(apt_bool_t) apt_pollset_destroy(apt_pollset_t *pollset)
+{
+	if(pollset->wakeup_fd >= 0) {
+		close(pollset->wakeup_fd);
+		pollset->wakeup_fd = -1;
+	}
+	if(pollset->epoll_fd >= 0) {
+		close(pollset->epoll_fd);
+		pollset->epoll_fd = -1;
+	}
+	return TRUE;
+}
+
+/** Get OS descriptor of pollset descriptor */
+static int apt_pollset_os_desc_get(const apr_pollfd_t *descriptor)
+{
+	int fd = -1;
+	if(descriptor->desc_type == APR_POLL_SOCKET) {
+		apr_os_sock_t sock;
+		if(apr_os_sock_get(&sock,descriptor->desc.s) == APR_SUCCESS) {
+			fd = sock;
+		}
+	}
+	else if(descriptor->desc_type == APR_POLL_FILE) {
+		apr_os_file_t file;
+		if(apr_os_file_get(&file,descriptor->desc.f) == APR_SUCCESS) {
+			fd = file;
+		}
+	}
+	return fd;
+}
+
+/** Translate APR poll events to epoll events */
+static APR_INLINE apr_uint32_t apt_pollset_epoll_events_get(apr_int16_t reqevents)
+{
+	apr_uint32_t events = 0;
+	if(reqevents & APR_POLLIN)
+		events |= EPOLLIN;
+	if(reqevents & APR_POLLPRI)
+		events |= EPOLLPRI;
+	if(reqevents & APR_POLLOUT)
+		events |= EPOLLOUT;
+	return events;
+}
+
+/** Translate epoll events to APR poll events */
+static APR_INLINE apr_int16_t apt_pollset_apr_events_get(apr_uint32_t events)
+{
+	apr_int16_t rtnevents = 0;
+	if(events & EPOLLIN)
+		rtnevents |= APR_POLLIN;
+	if(events & EPOLLPRI)
+		rtnevents |= APR_POLLPRI;
+	if(events & EPOLLOUT)
+		rtnevents |= APR_POLLOUT;
+	if(events & EPOLLERR)
+		rtnevents |= APR_POLLERR;
+	if(events & EPOLLHUP)
+		rtnevents |= APR_POLLHUP;
+	return rtnevents;
+}
+
+/** Add pollset descriptor to a pollset */
+APT_DECLARE(apt_bool_t) apt_pollset_add_ex(apt_pollset_t *pollset, const apr_pollfd_t *descriptor, apr_uint32_t flags)
+{
+	struct epoll_event event;
+	apt_pollset_elem_t *elem;
+	int fd = apt_pollset_os_desc_get(descriptor);
+	if(fd < 0) {
+		return FALSE;
+	}
+
+	if(!APR_RING_EMPTY(&pollset->free_ring, apt_pollset_elem_t, link)) {
+		elem = APR_RING_FIRST(&pollset->free_ring);
+		APR_RING_REMOVE(elem,link);
+	}
+	else {
+		elem = apr_palloc(pollset->pool,sizeof(apt_pollset_elem_t));
+		APR_RING_ELEM_INIT(elem,link);
+	}
+	elem->pfd = *descriptor;
+
+	memset(&event,0,sizeof(event));
+	event.events = apt_pollset_epoll_events_get(descriptor->reqevents);
+	if(flags & APT_POLLSET_EDGE_TRIGGERED) {
+		event.events |= EPOLLET;
+	}
+	event.data.ptr = elem;
+	if(epoll_ctl(pollset->epoll_fd,EPOLL_CTL_ADD,fd,&event) != 0) {
+		APR_RING_INSERT_TAIL(&pollset->free_ring,elem,apt_pollset_elem_t,link);
+		return FALSE;
+	}
+	APR_RING_INSERT_TAIL(&pollset->query_ring,elem,apt_pollset_elem_t,link);
+	return TRUE;
+}
+
+/** Remove pollset descriptor from a pollset */
+APT_DECLARE(apt_bool_t) apt_pollset_remove(apt_pollset_t *pollset, const apr_pollfd_t *descriptor)
+{
+	struct epoll_event event;
+	apt_pollset_elem_t *elem;
+	int fd = apt_pollset_os_desc_get(descriptor);
+	if(fd < 0) {
+		return FALSE;
+	}
+
+	for(elem = APR_RING_FIRST(&pollset->query_ring);
+			elem != APR_RING_SENTINEL(&pollset->query_ring, apt_pollset_elem_t, link);
+				elem = APR_RING_NEXT(elem,link)) {
+		if(elem->pfd.desc.s == descriptor->desc.s) {
+			/* the event is required by kernels prior to 2.6.9 */
+			memset(&event,0,sizeof(event));
+			epoll_ctl(pollset->epoll_fd,EPOLL_CTL_DEL,fd,&event);
+			/* signalled descriptors are returned as copies, so the element can be reused right away */
+			APR_RING_REMOVE(elem,link);
+			APR_RING_INSERT_TAIL(&pollset->free_ring,elem,apt_pollset_elem_t,link);
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/** Block for activity on the descriptor(s) in a pollset */
+APT_DECLARE(apr_status_t) apt_pollset_poll(
+								apt_pollset_t *pollset,
+								apr_interval_time_t timeout,
+								apr_int32_t *num,
+								const apr_pollfd_t **descriptors)
+{
+	apt_pollset_elem_t *elem;
+	int i;
+	int ret = epoll_wait(
+				pollset->epoll_fd,
+				pollset->events,
+				(int)pollset->size,
+				timeout < 0 ? -1 : (int)(timeout / 1000));
+	*num = 0;
+	if(ret < 0) {
+		return APR_FROM_OS_ERROR(errno);
+	}
+	if(ret == 0) {
+		return APR_TIMEUP;
+	}
+
+	for(i = 0; i < ret; i++) {
+		elem = pollset->events[i].data.ptr;
+		if(elem) {
+			pollset->result_set[i] = elem->pfd;
+			pollset->result_set[i].rtnevents = apt_pollset_apr_events_get(pollset->events[i].events);
+		}
+		else {
+			pollset->result_set[i] = pollset->wakeup_pfd;
+		}
+	}
+	*num = ret;
+	*descriptors = pollset->result_set;
+	return APR_SUCCESS;
+}
+
+/** Signal wakeup (the wakeup is not pending) */
+static apt_bool_t apt_pollset_wakeup_signal(apt_pollset_t *pollset)
+{
+	apr_uint64_t value = 1;
+	ssize_t ret;
+	do {
+		ret = write(pollset->wakeup_fd,&value,sizeof(value));
+	}
+	while(ret < 0 && errno == EINTR);
+
+	/* EAGAIN means the counter is saturated, the poller is signalled anyway */
+	return (ret == sizeof(value) || (ret < 0 && errno == EAGAIN)) ? TRUE : FALSE;
+}
+
+/** Consume signalled wakeup */
+static void apt_pollset_wakeup_consume(apt_pollset_t *pollset)
+{
+	apr_uint64_t value;
+	ssize_t ret;
+	do {
+		ret = read(pollset->wakeup_fd,&value,sizeof(value));
+	}
+	while(ret < 0 && errno == EINTR);
+}
+
+/** Match against builtin wake up descriptor */
+static APR_INLINE apt_bool_t apt_pollset_wakeup_match(apt_pollset_t *pollset, const apr_pollfd_t *descriptor)
+{
+	return (descriptor->desc_type == APR_NO_DESC && descriptor->client_data == pollset) ? TRUE : FALSE;
+}
+
+#else
+
 static apt_bool_t apt_wakeup_pipe_create(apt_pollset_t *pollset);
 static apt_bool_t apt_wakeup_pipe_destroy(apt_pollset_t *pollset);
 
@@ -43,6 +330,7 @@ APT_DECLARE(apt_pollset_t*) apt_pollset_create(apr_uint32_t size, apr_pool_t *po
 {
 	apt_pollset_t *pollset = apr_palloc(pool,sizeof(apt_pollset_t));
 	pollset->pool = pool;
+	pollset->wakeup_pending = FALSE;
 	memset(&pollset->wakeup_pfd,0,sizeof(pollset->wakeup_pfd));
 	
 	/* create pollset with max number of descriptors size+1, 
@@ -79,8 +367,9 @@ APT_DECLARE(apt_bool_t) apt_pollset_destroy(apt_pollset_t *pollset)
 }
 
 /** Add pollset descriptor to a pollset */
-APT_DECLARE(apt_bool_t) apt_pollset_add(apt_pollset_t *pollset, const apr_pollfd_t *descriptor)
+APT_DECLARE(apt_bool_t) apt_pollset_add_ex(apt_pollset_t *pollset, const apr_pollfd_t *descriptor, apr_uint32_t flags)
 {
+	/* APR pollset is level-triggered, which is fine for edge-triggered users too */
 	return (apr_pollset_add(pollset->base,descriptor) == APR_SUCCESS) ? TRUE : FALSE;
 }
 
@@ -100,8 +389,8 @@ APT_DECLARE(apr_status_t) apt_pollset_poll(
 	return apr_pollset_poll(pollset->base,timeout,num,descriptors);
 }
 
-/** Interrupt the blocked poll call */
-APT_DECLARE(apt_bool_t) apt_pollset_wakeup(apt_pollset_t *pollset)
+/** Signal wakeup (the wakeup is not pending) */
+static apt_bool_t apt_pollset_wakeup_signal(apt_pollset_t *pollset)
 {
 	apt_bool_t status = TRUE;
 #ifdef WIN32
@@ -118,40 +407,71 @@ APT_DECLARE(apt_bool_t) apt_pollset_wakeup(apt_pollset_t *pollset)
 	return status;
 }
 
-/** Match against builtin wake up descriptor in a pollset */
-APT_DECLARE(apt_bool_t) apt_pollset_is_wakeup(apt_pollset_t *pollset, const apr_pollfd_t *descriptor)
+/** Consume signalled wakeup */
+static void apt_pollset_wakeup_consume(apt_pollset_t *pollset)
 {
-	apt_bool_t status = FALSE;
-#ifdef WIN32
-	if(descriptor->desc.s == pollset->wakeup_pipe[0]) {
-		char rb[512];
-		apr_size_t nr = sizeof(rb);
+	char rb[512];
+	apr_size_t nr = sizeof(rb);
 
-		/* simply read out from the input side of the pipe all the data. */
-		while(apr_socket_recv(pollset->wakeup_pipe[0], rb, &nr) == APR_SUCCESS) {
-			if(nr != sizeof(rb)) {
-				break;
-			}
+	/* simply read out from the input side of the pipe all the data. */
+#ifdef WIN32
+	while(apr_socket_recv(pollset->wakeup_pipe[0], rb, &nr) == APR_SUCCESS) {
+		if(nr != sizeof(rb)) {
+			break;
 		}
-		status = TRUE;
 	}
 #else
-	if(descriptor->desc.f == pollset->wakeup_pipe[0]) {
-		char rb[512];
-		apr_size_t nr = sizeof(rb);
-
-		/* simply read out from the input side of the pipe all the data. */
-		while(apr_file_read(pollset->wakeup_pipe[0], rb, &nr) == APR_SUCCESS) {
-			if(nr != sizeof(rb)) {
-				break;
-			}
+	while(apr_file_read(pollset->wakeup_pipe[0], rb, &nr) == APR_SUCCESS) {
+		if(nr != sizeof(rb)) {
+			break;
 		}
-		status = TRUE;
 	}
 #endif
-	return status;
 }
 
+/** Match against builtin wake up descriptor */
+static APR_INLINE apt_bool_t apt_pollset_wakeup_match(apt_pollset_t *pollset, const apr_pollfd_t *descriptor)
+{
+#ifdef WIN32
+	return (descriptor->desc.s == pollset->wakeup_pipe[0]) ? TRUE : FALSE;
+#else
+	return (descriptor->desc.f == pollset->wakeup_pipe[0]) ? TRUE : FALSE;
+#endif
+}
+
+#endif
+
+/** Add pollset descriptor to a pollset */
+APT_DECLARE(apt_bool_t) apt_pollset_add(apt_pollset_t *pollset, const apr_pollfd_t *descriptor)
+{
+	return apt_pollset_add_ex(pollset,descriptor,0);
+}
+
+/** Interrupt the blocked poll call */
+APT_DECLARE(apt_bool_t) apt_pollset_wakeup(apt_pollset_t *pollset)
+{
+	/* coalesce with the wakeup signalled before, but not consumed by the poller yet */
+	if(apr_atomic_cas32(&pollset->wakeup_pending,TRUE,FALSE) != FALSE) {
+		return TRUE;
+	}
+	return apt_pollset_wakeup_signal(pollset);
+}
+
+/** Match against builtin wake up descriptor in a pollset */
+APT_DECLARE(apt_bool_t) apt_pollset_is_wakeup(apt_pollset_t *pollset, const apr_pollfd_t *descriptor)
+{
+	if(apt_pollset_wakeup_match(pollset,descriptor) == FALSE) {
+		return FALSE;
+	}
+
+	/* consume the signal first, then allow the next one; the caller processes
+	whatever was queued before the wakeups coalesced with this one */
+	apt_pollset_wakeup_consume(pollset);
+	apr_atomic_xchg32(&pollset->wakeup_pending,FALSE);
+	return TRUE;
+}
+
+#ifndef APT_POLLSET_EPOLL
 #ifdef WIN32
 static apr_status_t socket_pipe_create(apr_socket_t **rd, apr_socket_t **wr, apr_pool_t *pool)
 {
@@ -321,3 +641,5 @@ static apt_bool_t apt_wakeup_pipe_destroy(apt_pollset_t *pollset)
 }
 
 #endif
+
+#endif
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <apr_thread_mutex.h>
 #include "apt_pool.h"
 #include "apt_log.h"
 
@@ -53,3 +54,111 @@ APT_DECLARE(apr_pool_t*) apt_subpool_create(apr_pool_t *parent)
 	apr_pool_create(&pool,parent);
 	return pool;
 }
+
+/** Pool recycler */
+struct apt_pool_recycler_t {
+	/** Name of the recycler */
+	const char         *name;
+	/** Max size of free memory kept per recycled pool */
+	apr_size_t          max_free_size;
+	/** Max number of recycled pools */
+	apr_size_t          max_count;
+	/** Recycled pools (the parents of the acquired subpools) */
+	apr_pool_t        **free_pools;
+	/** Guards the recycled pools and the statistics */
+	apr_thread_mutex_t *guard;
+	/** Statistics */
+	apt_pool_recycler_stats_t stats;
+};
+
+APT_DECLARE(apt_pool_recycler_t*) apt_pool_recycler_create(const char *name, apr_size_t max_count, apr_size_t max_free_size, apr_pool_t *pool)
+{
+	apt_pool_recycler_t *recycler = apr_palloc(pool,sizeof(apt_pool_recycler_t));
+	recycler->name = name;
+	recycler->max_free_size = max_free_size;
+	recycler->max_count = max_count;
+	recycler->free_pools = apr_palloc(pool,sizeof(apr_pool_t*) * (max_count ? max_count : 1));
+	recycler->guard = NULL;
+	if(apr_thread_mutex_create(&recycler->guard,APR_THREAD_MUTEX_DEFAULT,pool) != APR_SUCCESS) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Pool Recycler [%s]",name);
+		return NULL;
+	}
+	memset(&recycler->stats,0,sizeof(recycler->stats));
+	return recycler;
+}
+
+APT_DECLARE(void) apt_pool_recycler_destroy(apt_pool_recycler_t *recycler)
+{
+	apt_pool_recycler_stats_t *stats = &recycler->stats;
+	apr_thread_mutex_lock(recycler->guard);
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Destroy Pool Recycler [%s] acquired [%"APR_SIZE_T_FMT"] reused [%"APR_SIZE_T_FMT"] discarded [%"APR_SIZE_T_FMT"]",
+		recycler->name,
+		stats->acquired,
+		stats->reused,
+		stats->discarded);
+	while(stats->free_count) {
+		apr_pool_destroy(recycler->free_pools[--stats->free_count]);
+	}
+	apr_thread_mutex_unlock(recycler->guard);
+	apr_thread_mutex_destroy(recycler->guard);
+	recycler->guard = NULL;
+}
+
+APT_DECLARE(apr_pool_t*) apt_pool_recycler_acquire(apt_pool_recycler_t *recycler)
+{
+	apr_pool_t *parent = NULL;
+	apr_pool_t *pool = NULL;
+
+	apr_thread_mutex_lock(recycler->guard);
+	recycler->stats.acquired++;
+	if(recycler->stats.free_count) {
+		parent = recycler->free_pools[--recycler->stats.free_count];
+		recycler->stats.reused++;
+	}
+	apr_thread_mutex_unlock(recycler->guard);
+
+	if(!parent) {
+		parent = apt_pool_create();
+		if(!parent) {
+			return NULL;
+		}
+#ifdef OWN_ALLOCATOR_PER_POOL
+		/* blocks freed by the subpools above the limit go back to the system */
+		apr_allocator_max_free_set(apr_pool_allocator_get(parent),recycler->max_free_size);
+#endif
+	}
+
+	/* the subpool takes its blocks from the free memory of the parent */
+	if(apr_pool_create(&pool,parent) != APR_SUCCESS) {
+		apr_pool_destroy(parent);
+		return NULL;
+	}
+	return pool;
+}
+
+APT_DECLARE(void) apt_pool_recycler_release(apt_pool_recycler_t *recycler, apr_pool_t *pool)
+{
+	apr_pool_t *parent = apr_pool_parent_get(pool);
+	apr_pool_destroy(pool);
+
+	apr_thread_mutex_lock(recycler->guard);
+	if(recycler->stats.free_count < recycler->max_count) {
+		recycler->free_pools[recycler->stats.free_count++] = parent;
+		parent = NULL;
+	}
+	else {
+		recycler->stats.discarded++;
+	}
+	apr_thread_mutex_unlock(recycler->guard);
+
+	if(parent) {
+		apr_pool_destroy(parent);
+	}
+}
+
+APT_DECLARE(void) apt_pool_recycler_stats_get(apt_pool_recycler_t *recycler, apt_pool_recycler_stats_t *stats)
+{
+	apr_thread_mutex_lock(recycler->guard);
+	*stats = recycler->stats;
+	apr_thread_mutex_unlock(recycler->guard);
+}
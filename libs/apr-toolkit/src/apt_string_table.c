@@ -26,9 +26,43 @@ APT_DECLARE(const apt_str_t*) apt_string_table_str_get(const apt_str_table_item_
 	return NULL;
 }
 
+/* Hash the string (case insensitive) */
+APT_DECLARE(apr_uint32_t) apt_string_table_hash(const apt_str_t *value, apr_uint32_t seed)
+{
+	/* FNV-1a over the characters folded to lower case followed by the finalizer of MurmurHash3.
+	Folding by 0x20 keeps strings equal with no case compare hashed equally,
+	other strings it merges are told apart by the compare of the found item. */
+	apr_uint32_t hash = 2166136261U ^ seed;
+	apr_size_t i;
+	for(i=0; i<value->length; i++) {
+		hash ^= (apr_uint32_t)((unsigned char)value->buf[i] | 0x20);
+		hash *= 16777619U;
+	}
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6BU;
+	hash ^= hash >> 13;
+	hash *= 0xC2B2AE35U;
+	hash ^= hash >> 16;
+	return hash;
+}
+
 /* Find the id associated with a given string from the table */
 APT_DECLARE(apr_size_t) apt_string_table_id_find(const apt_str_table_item_t table[], apr_size_t size, const apt_str_t *value)
 {
+	/* Tables generated with the perfect hash are looked up in two hashes
+	followed by a single compare, regardless of the size of the table. */
+	if(size) {
+		const apt_str_table_item_t *bucket = &table[apt_string_table_hash(value,0) % size];
+		if(bucket->hash_seed) {
+			apr_size_t id = table[apt_string_table_hash(value,bucket->hash_seed) % size].hash_id;
+			if(id < size && apt_string_compare(&table[id].value,value) == TRUE) {
+				return id;
+			}
+			/* no match found, return invalid id */
+			return size;
+		}
+	}
+
 	/* Key character is stored within each apt_string_table_item.
 	At first, key characters must be matched in a loop crossing the items.
 	Then whole strings should be compared only for the matched item.
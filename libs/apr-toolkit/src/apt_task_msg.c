@@ -15,7 +15,11 @@
  */
 
 #include <stdlib.h>
+#include <apr_ring.h>
+#include <apr_thread_proc.h>
+#include <apr_thread_mutex.h>
 #include "apt_task_msg.h"
+#include "apt_atomic.h"
 
 /** Abstract pool of task messages to allocate task messages from */
 struct apt_task_msg_pool_t {
@@ -73,13 +77,304 @@ APT_DECLARE(apt_task_msg_pool_t*) apt_task_msg_pool_create_dynamic(apr_size_t ms
 }
 
 
-/** Static allocation of messages from message pool (not implemented yet) */
-APT_DECLARE(apt_task_msg_pool_t*) apt_task_msg_pool_create_static(apr_size_t msg_size, apr_size_t pool_size, apr_pool_t *pool)
+/** Static allocation of messages from preallocated slabs, recycled via lock-free list */
+typedef struct apt_msg_pool_static_t apt_msg_pool_static_t;
+typedef struct apt_msg_node_t apt_msg_node_t;
+typedef struct apt_msg_cache_t apt_msg_cache_t;
+
+/** Max number of slabs the pool grows to, further messages are allocated dynamically */
+#define MAX_MSG_POOL_SLAB_COUNT 256
+/** Max number of released messages cached per thread */
+#define MSG_POOL_CACHE_SIZE     32
+/** Index of the node allocated dynamically (out of the slabs) */
+#define MSG_NODE_DYNAMIC        0xFFFFFFFF
+
+/** Task message preceded by the link of the free list */
+struct apt_msg_node_t {
+	/** Index + 1 of the next free node, 0 terminates the list */
+	apr_uint32_t   next;
+	/** Index of the node */
+	apr_uint32_t   index;
+	/** Task message (the data follows) */
+	apt_task_msg_t msg;
+};
+
+/** Per-thread cache of released nodes */
+struct apt_msg_cache_t {
+	/** Ring entry of the list of caches of the pool */
+	APR_RING_ENTRY(apt_msg_cache_t) link;
+	/** Pool the cache belongs to */
+	apt_msg_pool_static_t          *static_pool;
+	/** Number of cached nodes */
+	apr_size_t                      count;
+	/** Cached nodes */
+	apt_msg_node_t                 *nodes[MSG_POOL_CACHE_SIZE];
+};
+
+struct apt_msg_pool_static_t {
+	/** Size of the node */
+	apr_size_t              node_size;
+	/** Number of nodes per slab */
+	apr_uint32_t            slab_size;
+	/** Number of slabs allocated */
+	apr_uint32_t            slab_count;
+	/** Slabs of nodes, never freed until the pool is destroyed */
+	char                   *slabs[MAX_MSG_POOL_SLAB_COUNT];
+	/** Head of the free list: ABA tag (high 32 bits) and index + 1 of the first node */
+	volatile apr_uint64_t   head;
+	/** Guards growth, the list of caches (and the free list if 64-bit CAS is not available) */
+	apr_thread_mutex_t     *guard;
+	/** Key of the per-thread cache */
+	apr_threadkey_t        *cache_key;
+	/** Caches of the threads */
+	APR_RING_HEAD(apt_msg_cache_head_t, apt_msg_cache_t) caches;
+};
+
+static APR_INLINE apt_msg_node_t* static_pool_node_get(apt_msg_pool_static_t *static_pool, apr_uint32_t index)
+{
+	return (apt_msg_node_t*)(static_pool->slabs[index / static_pool->slab_size] +
+		(index % static_pool->slab_size) * static_pool->node_size);
+}
+
+/** Push the chain of nodes linked from the first to the last one to the free list */
+static void static_pool_chain_push(apt_msg_pool_static_t *static_pool, apt_msg_node_t *first, apt_msg_node_t *last)
+{
+#ifdef APT_ATOMIC_CAS64_SUPPORT
+	apr_uint64_t head = apt_atomic_load64_acquire(&static_pool->head);
+	apr_uint64_t cur;
+	for(;;) {
+		last->next = (apr_uint32_t)head;
+		cur = apt_atomic_cas64(&static_pool->head,((head >> 32) + 1) << 32 | (first->index + 1),head);
+		if(cur == head) {
+			break;
+		}
+		head = cur;
+	}
+#else
+	apr_thread_mutex_lock(static_pool->guard);
+	last->next = (apr_uint32_t)static_pool->head;
+	static_pool->head = first->index + 1;
+	apr_thread_mutex_unlock(static_pool->guard);
+#endif
+}
+
+/** Pop a node from the free list */
+static apt_msg_node_t* static_pool_pop(apt_msg_pool_static_t *static_pool)
 {
-	return NULL;
+	apt_msg_node_t *node;
+#ifdef APT_ATOMIC_CAS64_SUPPORT
+	apr_uint64_t head = apt_atomic_load64_acquire(&static_pool->head);
+	apr_uint64_t cur;
+	for(;;) {
+		if(!(apr_uint32_t)head) {
+			return NULL;
+		}
+		/* the node may be popped and reused meanwhile, the tag makes CAS fail then */
+		node = static_pool_node_get(static_pool,(apr_uint32_t)head - 1);
+		cur = apt_atomic_cas64(&static_pool->head,((head >> 32) + 1) << 32 | node->next,head);
+		if(cur == head) {
+			break;
+		}
+		head = cur;
+	}
+#else
+	apr_thread_mutex_lock(static_pool->guard);
+	if(!static_pool->head) {
+		apr_thread_mutex_unlock(static_pool->guard);
+		return NULL;
+	}
+	node = static_pool_node_get(static_pool,(apr_uint32_t)static_pool->head - 1);
+	static_pool->head = node->next;
+	apr_thread_mutex_unlock(static_pool->guard);
+#endif
+	return node;
 }
 
+/** Allocate a new slab, return its first node and push the rest to the free list */
+static apt_msg_node_t* static_pool_grow(apt_msg_pool_static_t *static_pool)
+{
+	apt_msg_node_t *first;
+	apt_msg_node_t *node = NULL;
+	apr_uint32_t base;
+	apr_uint32_t i;
+	char *slab;
 
+	apr_thread_mutex_lock(static_pool->guard);
+	if(static_pool->slab_count == MAX_MSG_POOL_SLAB_COUNT) {
+		apr_thread_mutex_unlock(static_pool->guard);
+		return NULL;
+	}
+	slab = malloc(static_pool->node_size * static_pool->slab_size);
+	if(!slab) {
+		apr_thread_mutex_unlock(static_pool->guard);
+		return NULL;
+	}
+	base = static_pool->slab_count * static_pool->slab_size;
+	for(i = 0; i < static_pool->slab_size; i++) {
+		node = (apt_msg_node_t*)(slab + i * static_pool->node_size);
+		node->index = base + i;
+		node->next = base + i + 2;
+	}
+	/* the slab is published before its nodes are */
+	static_pool->slabs[static_pool->slab_count++] = slab;
+	apr_thread_mutex_unlock(static_pool->guard);
+
+	first = (apt_msg_node_t*)slab;
+	if(static_pool->slab_size > 1) {
+		static_pool_chain_push(static_pool,(apt_msg_node_t*)(slab + static_pool->node_size),node);
+	}
+	return first;
+}
+
+/** Get the cache of the calling thread */
+static apt_msg_cache_t* static_pool_cache_get(apt_msg_pool_static_t *static_pool)
+{
+	void *data = NULL;
+	apt_msg_cache_t *cache;
+	apr_threadkey_private_get(&data,static_pool->cache_key);
+	if(data) {
+		return data;
+	}
+
+	cache = malloc(sizeof(apt_msg_cache_t));
+	if(!cache) {
+		return NULL;
+	}
+	cache->static_pool = static_pool;
+	cache->count = 0;
+	APR_RING_ELEM_INIT(cache,link);
+	apr_thread_mutex_lock(static_pool->guard);
+	APR_RING_INSERT_TAIL(&static_pool->caches,cache,apt_msg_cache_t,link);
+	apr_thread_mutex_unlock(static_pool->guard);
+	apr_threadkey_private_set(cache,static_pool->cache_key);
+	return cache;
+}
+
+/** Return the cached nodes to the free list on exit of the thread */
+static void static_pool_cache_destroy(void *data)
+{
+	apt_msg_cache_t *cache = data;
+	apt_msg_pool_static_t *static_pool = cache->static_pool;
+	apr_size_t i;
+	for(i = 0; i < cache->count; i++) {
+		static_pool_chain_push(static_pool,cache->nodes[i],cache->nodes[i]);
+	}
+	apr_thread_mutex_lock(static_pool->guard);
+	APR_RING_REMOVE(cache,link);
+	apr_thread_mutex_unlock(static_pool->guard);
+	free(cache);
+}
+
+static apt_task_msg_t* static_pool_acquire_msg(apt_task_msg_pool_t *task_msg_pool)
+{
+	apt_msg_pool_static_t *static_pool = task_msg_pool->obj;
+	apt_msg_cache_t *cache = static_pool_cache_get(static_pool);
+	apt_msg_node_t *node = NULL;
+
+	if(cache && cache->count) {
+		node = cache->nodes[--cache->count];
+	}
+	else {
+		node = static_pool_pop(static_pool);
+		if(!node) {
+			node = static_pool_grow(static_pool);
+			if(!node) {
+				/* all the slabs are in use */
+				node = malloc(static_pool->node_size);
+				node->index = MSG_NODE_DYNAMIC;
+			}
+		}
+	}
+
+	node->msg.msg_pool = task_msg_pool;
+	node->msg.type = TASK_MSG_USER;
+	node->msg.sub_type = 0;
+	return &node->msg;
+}
+
+static void static_pool_release_msg(apt_task_msg_t *task_msg)
+{
+	apt_msg_pool_static_t *static_pool = task_msg->msg_pool->obj;
+	apt_msg_node_t *node = (apt_msg_node_t*)((char*)task_msg - APR_OFFSETOF(apt_msg_node_t,msg));
+	apt_msg_cache_t *cache;
+
+	if(node->index == MSG_NODE_DYNAMIC) {
+		free(node);
+		return;
+	}
+
+	cache = static_pool_cache_get(static_pool);
+	if(cache && cache->count < MSG_POOL_CACHE_SIZE) {
+		cache->nodes[cache->count++] = node;
+		return;
+	}
+	static_pool_chain_push(static_pool,node,node);
+}
+
+static apr_status_t static_pool_cleanup(void *data)
+{
+	apt_msg_pool_static_t *static_pool = data;
+	apt_msg_cache_t *cache;
+	apr_uint32_t i;
+
+	/* no cache is destroyed on thread exit any more */
+	apr_threadkey_private_delete(static_pool->cache_key);
+	apr_thread_mutex_lock(static_pool->guard);
+	while(!APR_RING_EMPTY(&static_pool->caches, apt_msg_cache_t, link)) {
+		cache = APR_RING_FIRST(&static_pool->caches);
+		APR_RING_REMOVE(cache,link);
+		free(cache);
+	}
+	for(i = 0; i < static_pool->slab_count; i++) {
+		free(static_pool->slabs[i]);
+		static_pool->slabs[i] = NULL;
+	}
+	static_pool->slab_count = 0;
+	static_pool->head = 0;
+	apr_thread_mutex_unlock(static_pool->guard);
+	return APR_SUCCESS;
+}
+
+static void static_pool_destroy(apt_task_msg_pool_t *task_msg_pool)
+{
+	apr_pool_cleanup_run(task_msg_pool->pool,task_msg_pool->obj,static_pool_cleanup);
+}
+
+APT_DECLARE(apt_task_msg_pool_t*) apt_task_msg_pool_create_static(apr_size_t msg_size, apr_size_t pool_size, apr_pool_t *pool)
+{
+	apt_task_msg_pool_t *task_msg_pool = apr_palloc(pool,sizeof(apt_task_msg_pool_t));
+	apt_msg_pool_static_t *static_pool = apr_palloc(pool,sizeof(apt_msg_pool_static_t));
+	apt_msg_node_t *node;
+
+	static_pool->node_size = APR_ALIGN_DEFAULT(APR_OFFSETOF(apt_msg_node_t,msg) + msg_size + sizeof(apt_task_msg_t) - 1);
+	static_pool->slab_size = pool_size ? (apr_uint32_t)pool_size : 1;
+	static_pool->slab_count = 0;
+	static_pool->head = 0;
+	static_pool->guard = NULL;
+	static_pool->cache_key = NULL;
+	APR_RING_INIT(&static_pool->caches, apt_msg_cache_t, link);
+	if(apr_thread_mutex_create(&static_pool->guard,APR_THREAD_MUTEX_DEFAULT,pool) != APR_SUCCESS) {
+		return NULL;
+	}
+	if(apr_threadkey_private_create(&static_pool->cache_key,static_pool_cache_destroy,pool) != APR_SUCCESS) {
+		apr_thread_mutex_destroy(static_pool->guard);
+		return NULL;
+	}
+	apr_pool_cleanup_register(pool,static_pool,static_pool_cleanup,apr_pool_cleanup_null);
+
+	/* preallocate the first slab */
+	node = static_pool_grow(static_pool);
+	if(node) {
+		static_pool_chain_push(static_pool,node,node);
+	}
+
+	task_msg_pool->pool = pool;
+	task_msg_pool->obj = static_pool;
+	task_msg_pool->acquire_msg = static_pool_acquire_msg;
+	task_msg_pool->release_msg = static_pool_release_msg;
+	task_msg_pool->destroy = static_pool_destroy;
+	return task_msg_pool;
+}
 
 APT_DECLARE(void) apt_task_msg_pool_destroy(apt_task_msg_pool_t *msg_pool)
 {
@@ -19,51 +19,153 @@
 #include <apr_uuid.h>
 #include "apt_text_stream.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+#define APT_TEXT_SCAN_SSE2
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && (defined(__aarch64__) || defined(_M_ARM64))
+#include <arm_neon.h>
+#define APT_TEXT_SCAN_NEON
+#endif
+
+#if defined(APT_TEXT_SCAN_SSE2) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 #define TOKEN_TRUE  "true"
 #define TOKEN_FALSE "false"
 #define TOKEN_TRUE_LENGTH  (sizeof(TOKEN_TRUE)-1)
 #define TOKEN_FALSE_LENGTH (sizeof(TOKEN_FALSE)-1)
 
+/** Whether delimiters are searched for a block of chars at once */
+#if defined(APT_TEXT_SCAN_SSE2) || defined(APT_TEXT_SCAN_NEON)
+static apt_bool_t vectorized_scan = TRUE;
+#else
+static apt_bool_t vectorized_scan = FALSE;
+#endif
 
-/** Navigate through the lines of the text stream (message) */
-APT_DECLARE(apt_bool_t) apt_text_line_read(apt_text_stream_t *stream, apt_str_t *line)
+#ifdef APT_TEXT_SCAN_SSE2
+/** Get the index of the lowest set bit of the non-zero mask */
+static APR_INLINE unsigned int apt_text_mask_index(unsigned int mask)
 {
-	char *pos = stream->pos;
-	apt_bool_t status = FALSE;
-	line->length = 0;
-	line->buf = pos;
-	/* while not end of stream */
-	while(pos < stream->end) {
-		if(*pos == APT_TOKEN_CR) {
-			/* end of line detected */
-			line->length = pos - line->buf;
-			pos++;
-			if(pos < stream->end && *pos == APT_TOKEN_LF) {
-				pos++;
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index,mask);
+	return (unsigned int)index;
+#else
+	return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+#endif
+
+/** Find the first char equal to c1, c2 or c3 in [pos,end), return end if none */
+static APR_INLINE char* apt_text_chr3_find(char *pos, const char *end, char c1, char c2, char c3)
+{
+	if(vectorized_scan == TRUE) {
+#if defined(APT_TEXT_SCAN_SSE2)
+#ifdef __AVX2__
+		const __m256i w1 = _mm256_set1_epi8(c1);
+		const __m256i w2 = _mm256_set1_epi8(c2);
+		const __m256i w3 = _mm256_set1_epi8(c3);
+#endif
+		const __m128i v1 = _mm_set1_epi8(c1);
+		const __m128i v2 = _mm_set1_epi8(c2);
+		const __m128i v3 = _mm_set1_epi8(c3);
+		__m128i block;
+		unsigned int mask;
+#ifdef __AVX2__
+		__m256i wblock;
+		while(end - pos >= 32) {
+			wblock = _mm256_loadu_si256((const __m256i*)pos);
+			mask = (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(
+					_mm256_or_si256(_mm256_cmpeq_epi8(wblock,w1),_mm256_cmpeq_epi8(wblock,w2)),
+					_mm256_cmpeq_epi8(wblock,w3)));
+			if(mask) {
+				return pos + apt_text_mask_index(mask);
 			}
-			status = TRUE;
-			break;
+			pos += 32;
 		}
-		else if(*pos == APT_TOKEN_LF) {
-			/* end of line detected */
-			line->length = pos - line->buf;
-			pos++;
-			status = TRUE;
+#endif
+		while(end - pos >= 16) {
+			block = _mm_loadu_si128((const __m128i*)pos);
+			mask = (unsigned int)_mm_movemask_epi8(_mm_or_si128(
+					_mm_or_si128(_mm_cmpeq_epi8(block,v1),_mm_cmpeq_epi8(block,v2)),
+					_mm_cmpeq_epi8(block,v3)));
+			if(mask) {
+				return pos + apt_text_mask_index(mask);
+			}
+			pos += 16;
+		}
+#elif defined(APT_TEXT_SCAN_NEON)
+		const uint8x16_t v1 = vdupq_n_u8((uint8_t)c1);
+		const uint8x16_t v2 = vdupq_n_u8((uint8_t)c2);
+		const uint8x16_t v3 = vdupq_n_u8((uint8_t)c3);
+		uint8x16_t block;
+		while(end - pos >= 16) {
+			block = vld1q_u8((const uint8_t*)pos);
+			if(vmaxvq_u8(vorrq_u8(vorrq_u8(vceqq_u8(block,v1),vceqq_u8(block,v2)),vceqq_u8(block,v3)))) {
+				/* the char is in the block, locate it below */
+				break;
+			}
+			pos += 16;
+		}
+#endif
+	}
+
+	while(pos < end) {
+		if(*pos == c1 || *pos == c2 || *pos == c3) {
 			break;
 		}
 		pos++;
 	}
+	return pos;
+}
 
-	if(status == TRUE) {
-		/* advance stream pos */
-		stream->pos = pos;
+/** Find the first CR or LF in [pos,end), return end if none */
+static APR_INLINE char* apt_text_eol_find(char *pos, const char *end)
+{
+	return apt_text_chr3_find(pos,end,APT_TOKEN_CR,APT_TOKEN_LF,APT_TOKEN_LF);
+}
+
+/** Skip the end of line the pos points to (CR, LF or CRLF) */
+static APR_INLINE char* apt_text_eol_skip(char *pos, const char *end)
+{
+	if(*pos++ == APT_TOKEN_CR) {
+		if(pos < end && *pos == APT_TOKEN_LF) {
+			pos++;
+		}
 	}
-	else {
+	return pos;
+}
+
+/** Enable or disable vectorized scanning of text streams */
+APT_DECLARE(apt_bool_t) apt_text_scan_vectorized_set(apt_bool_t enable)
+{
+#if defined(APT_TEXT_SCAN_SSE2) || defined(APT_TEXT_SCAN_NEON)
+	vectorized_scan = enable;
+	return TRUE;
+#else
+	return enable == TRUE ? FALSE : TRUE;
+#endif
+}
+
+/** Navigate through the lines of the text stream (message) */
+APT_DECLARE(apt_bool_t) apt_text_line_read(apt_text_stream_t *stream, apt_str_t *line)
+{
+	char *pos = apt_text_eol_find(stream->pos,stream->end);
+	line->buf = stream->pos;
+	line->length = pos - line->buf;
+	if(pos == stream->end) {
 		/* end of stream is reached, do not advance stream pos, but set is_eos flag */
 		stream->is_eos = TRUE;
-		line->length = pos - line->buf;
+		return FALSE;
 	}
-	return status;
+
+	/* end of line detected, advance stream pos */
+	stream->pos = apt_text_eol_skip(pos,stream->end);
+	return TRUE;
 }
 
 /** To be used to navigate through the header fields (name:value pairs) of the text stream (message) 
@@ -81,68 +183,56 @@ APT_DECLARE(apt_bool_t) apt_text_line_read(apt_text_stream_t *stream, apt_str_t
 APT_DECLARE(apt_bool_t) apt_text_header_read(apt_text_stream_t *stream, apt_pair_t *pair)
 {
 	char *pos = stream->pos;
-	apt_bool_t status = FALSE;
+	const char *end = stream->end;
 	apt_string_reset(&pair->name);
 	apt_string_reset(&pair->value);
-	/* while not end of stream */
-	while(pos < stream->end) {
-		if(*pos == APT_TOKEN_CR) {
-			/* end of line detected */
-			if(pair->value.buf) {
-				/* set length of the value */
-				pair->value.length = pos - pair->value.buf;
-			}
-			pos++;
-			if(pos < stream->end && *pos == APT_TOKEN_LF) {
-				pos++;
-			}
-			status = TRUE;
-			break;
-		}
-		else if(*pos == APT_TOKEN_LF) {
-			/* end of line detected */
-			if(pair->value.buf) {
-				/* set length of the value */
-				pair->value.length = pos - pair->value.buf;
+
+	/* skip preceding white spaces (SHOULD NOT be any WSP, though) */
+	while(pos < end && apt_text_is_wsp(*pos) == TRUE) pos++;
+
+	if(pos < end && *pos != APT_TOKEN_CR && *pos != APT_TOKEN_LF) {
+		/* read name up to the first ':' following the first char of the name */
+		pair->name.buf = pos;
+		do {
+			pos = apt_text_chr3_find(pos,end,':',APT_TOKEN_CR,APT_TOKEN_LF);
+			if(pos == end || *pos != ':') {
+				break;
 			}
+			/* set length of the name */
+			pair->name.length = pos - pair->name.buf;
 			pos++;
-			status = TRUE;
-			break;
-		}
-		else if(!pair->name.length) {
-			/* skip preceding white spaces (SHOULD NOT be any WSP, though) and read name */
-			if(!pair->name.buf && apt_text_is_wsp(*pos) == FALSE) {
-				pair->name.buf = pos;
-			}
-			if(*pos == ':') {
-				/* set length of the name */
-				pair->name.length = pos - pair->name.buf;
-			}
 		}
-		else if(!pair->value.length) {
+		while(!pair->name.length);
+
+		if(pair->name.length) {
 			/* skip preceding white spaces and read value */
-			if(!pair->value.buf && apt_text_is_wsp(*pos) == FALSE) {
+			while(pos < end && apt_text_is_wsp(*pos) == TRUE) pos++;
+			if(pos < end && *pos != APT_TOKEN_CR && *pos != APT_TOKEN_LF) {
 				pair->value.buf = pos;
+				pos = apt_text_eol_find(pos,end);
 			}
 		}
-		pos++;
 	}
 
-	if(status == TRUE) {
-		/* advance stream pos regardless it's a valid header or not */
-		stream->pos = pos;
-		
-		/* if length == 0 && buf => header is malformed */
-		if(!pair->name.length && pair->name.buf) {
-			status = FALSE;
-		}
-	}
-	else {
+	if(pos == end) {
 		/* end of stream is reached, do not advance stream pos, but set is_eos flag */
 		stream->is_eos = TRUE;
+		return FALSE;
 	}
 
-	return status;
+	/* end of line detected */
+	if(pair->value.buf) {
+		/* set length of the value */
+		pair->value.length = pos - pair->value.buf;
+	}
+	/* advance stream pos regardless it's a valid header or not */
+	stream->pos = apt_text_eol_skip(pos,end);
+
+	/* if length == 0 && buf => header is malformed */
+	if(!pair->name.length && pair->name.buf) {
+		return FALSE;
+	}
+	return TRUE;
 }
 
 
@@ -156,7 +246,7 @@ APT_DECLARE(apt_bool_t) apt_text_field_read(apt_text_stream_t *stream, char sepa
 
 	field->buf = pos;
 	field->length = 0;
-	while(pos < stream->end && *pos != separator) pos++;
+	pos = apt_text_chr3_find(pos,stream->end,separator,separator,separator);
 
 	field->length = pos - field->buf;
 	if(pos < stream->end) {
@@ -188,6 +278,76 @@ APT_DECLARE(apt_bool_t) apt_text_stream_scroll(apt_text_stream_t *stream)
 	return TRUE;
 }
 
+/** Initialize receive buffer and the text stream on top of it */
+APT_DECLARE(void) apt_text_rx_buffer_init(apt_text_rx_buffer_t *buffer, apt_text_stream_t *stream, char *initial, apr_size_t size, apr_size_t max_size)
+{
+	buffer->initial = initial;
+	buffer->initial_size = size;
+	buffer->buf = initial;
+	buffer->size = size;
+	buffer->max_size = max_size;
+	apt_text_stream_init(stream,buffer->buf,buffer->size);
+}
+
+/** Grow receive buffer to fit the required size, keeping the data of the stream */
+APT_DECLARE(apt_bool_t) apt_text_rx_buffer_grow(apt_text_rx_buffer_t *buffer, apt_text_stream_t *stream, apr_size_t required_size)
+{
+	apr_size_t offset;
+	apr_size_t size = buffer->size;
+	char *buf;
+	if(required_size <= size || size >= buffer->max_size) {
+		return FALSE;
+	}
+
+	while(size < required_size && size < buffer->max_size) {
+		size *= 2;
+	}
+	if(size > buffer->max_size) {
+		size = buffer->max_size;
+	}
+
+	buf = malloc(size + 1);
+	if(!buf) {
+		return FALSE;
+	}
+
+	/* move the data received so far to the new buffer */
+	offset = stream->pos - stream->text.buf;
+	memcpy(buf,stream->text.buf,offset);
+	if(buffer->buf != buffer->initial) {
+		free(buffer->buf);
+	}
+	buffer->buf = buf;
+	buffer->size = size;
+
+	apt_text_stream_init(stream,buffer->buf,buffer->size);
+	stream->pos += offset;
+	return TRUE;
+}
+
+/** Shrink receive buffer back to the initial one, if the stream holds no data */
+APT_DECLARE(void) apt_text_rx_buffer_shrink(apt_text_rx_buffer_t *buffer, apt_text_stream_t *stream)
+{
+	if(buffer->buf == buffer->initial || stream->pos != stream->text.buf) {
+		return;
+	}
+
+	free(buffer->buf);
+	buffer->buf = buffer->initial;
+	buffer->size = buffer->initial_size;
+	apt_text_stream_init(stream,buffer->buf,buffer->size);
+}
+
+/** Release the grown receive buffer, if any */
+APT_DECLARE(void) apt_text_rx_buffer_release(apt_text_rx_buffer_t *buffer)
+{
+	if(buffer->buf != buffer->initial) {
+		free(buffer->buf);
+		buffer->buf = buffer->initial;
+		buffer->size = buffer->initial_size;
+	}
+}
+
 /** Parse id@resource string */
 APT_DECLARE(apt_bool_t) apt_id_resource_parse(const apt_str_t *str, char separator, apt_str_t *id, apt_str_t *resource, apr_pool_t *pool)
 {
@@ -38,14 +38,58 @@ typedef enum {
 	MPF_DETECTOR_EVENT_NOINPUT     /**< noinput event occurred */
 } mpf_detector_event_e;
 
+/** Decision counters of the energy gate applied ahead of the VAD */
+typedef struct mpf_activity_detector_stats_t mpf_activity_detector_stats_t;
 
-/** Create activity detector */
+/** Decision counters of the energy gate applied ahead of the VAD */
+struct mpf_activity_detector_stats_t {
+	/** Number of frames classified as silence by energy */
+	apr_size_t silence_gated;
+	/** Number of frames classified as voice by energy */
+	apr_size_t voice_gated;
+	/** Number of frames passed to the VAD */
+	apr_size_t vad_processed;
+};
+
+
+/**
+ * Create activity detector using the specified VAD backend.
+ * @param backend_name the name of the backend (see mpf_vad_backend.h), NULL for the default one
+ * @param pool the pool to allocate memory from
+ */
+MPF_DECLARE(mpf_activity_detector_t*) mpf_activity_detector_create_ex(const char *backend_name, apr_pool_t *pool);
+
+/** Create activity detector using the default VAD backend */
 MPF_DECLARE(mpf_activity_detector_t*) mpf_activity_detector_create(apr_pool_t *pool);
 
 /** Reset activity detector */
 MPF_DECLARE(void) mpf_activity_detector_reset(mpf_activity_detector_t *detector);
 
-/** Set threshold of voice activity (silence) level */
+/**
+ * Set codec descriptor of the audio stream to analyze.
+ * @remark The VAD state is reinitialized only if the sampling rate changes.
+ */
+MPF_DECLARE(void) mpf_activity_detector_codec_set(mpf_activity_detector_t *detector, const mpf_codec_descriptor_t *descriptor);
+
+/** Set backend specific parameter of the VAD (see mpf_vad_backend.h) */
+MPF_DECLARE(apt_bool_t) mpf_activity_detector_param_set(mpf_activity_detector_t *detector, const char *name, apr_size_t value);
+
+/** Set aggressiveness mode of the VAD (0 .. 3, more aggressive is more restrictive in reporting speech) */
+MPF_DECLARE(void) mpf_activity_detector_vad_mode_set(mpf_activity_detector_t *detector, int vad_mode);
+
+/**
+ * Set energy gates applied ahead of the VAD.
+ * @param detector the activity detector
+ * @param silence_gate the RMS amplitude (0 .. 32767) below which frames are silent without running the VAD
+ * @param voice_gate the RMS amplitude (0 .. 32767) above which frames are voiced without running the VAD
+ * @remark Either gate is disabled if set to 0.
+ */
+MPF_DECLARE(void) mpf_activity_detector_energy_gate_set(mpf_activity_detector_t *detector, apr_size_t silence_gate, apr_size_t voice_gate);
+
+/** Get decision counters of the energy gate */
+MPF_DECLARE(void) mpf_activity_detector_stats_get(const mpf_activity_detector_t *detector, mpf_activity_detector_stats_t *stats);
+
+/** Set threshold of voice activity (silence) level used by the energy backend */
 MPF_DECLARE(void) mpf_activity_detector_level_set(mpf_activity_detector_t *detector, apr_size_t level_threshold);
 
 /** Set noinput timeout */
@@ -26,31 +26,45 @@
 
 APT_BEGIN_EXTERN_C
 
+/** Default capacity of buffer in bytes */
+#define MPF_BUFFER_DEFAULT_CAPACITY 65536
+
 /** Opaque media buffer declaration */
 typedef struct mpf_buffer_t mpf_buffer_t;
 
+/**
+ * Buffer is a fixed-capacity single-producer/single-consumer ring.
+ * Audio, events and restart requests are written by one thread (e.g. a plugin
+ * worker) and frames are read by another one (the media engine) without locking.
+ */
 
-/** Create buffer */
+/** Create buffer of default capacity */
 mpf_buffer_t* mpf_buffer_create(apr_pool_t *pool);
 
+/** Create buffer of specified capacity (rounded up to the power of two) in bytes */
+mpf_buffer_t* mpf_buffer_create_ex(apr_size_t capacity, apr_pool_t *pool);
+
 /** Destroy buffer */
 void mpf_buffer_destroy(mpf_buffer_t *buffer);
 
-/** Restart buffer */
+/** Restart buffer; the data written so far is discarded on the next read (producer side) */
 apt_bool_t mpf_buffer_restart(mpf_buffer_t *buffer);
 
-/** Write audio chunk to buffer */
+/** Write audio chunk to buffer; FALSE if there is not enough space to write the whole chunk (producer side) */
 apt_bool_t mpf_buffer_audio_write(mpf_buffer_t *buffer, void *data, apr_size_t size);
 
-/** Write event to buffer */
+/** Write event to buffer; FALSE if too many events are pending (producer side) */
 apt_bool_t mpf_buffer_event_write(mpf_buffer_t *buffer, mpf_frame_type_e event_type);
 
-/** Read media frame from buffer */
+/** Read media frame from buffer (consumer side) */
 apt_bool_t mpf_buffer_frame_read(mpf_buffer_t *buffer, mpf_frame_t *media_frame);
 
 /** Get size of buffer **/
 apr_size_t mpf_buffer_get_size(const mpf_buffer_t *buffer);
 
+/** Get free space of buffer (the size of audio chunk which can be written) **/
+apr_size_t mpf_buffer_get_space(const mpf_buffer_t *buffer);
+
 APT_END_EXTERN_C
 
 #endif /* MPF_BUFFER_H */
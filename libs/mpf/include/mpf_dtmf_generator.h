@@ -46,6 +46,11 @@ typedef enum mpf_dtmf_generator_band_e {
 /** Opaque MPF DTMF generator structure definition */
 typedef struct mpf_dtmf_generator_t mpf_dtmf_generator_t;
 
+/**
+ * Build the tone tables shared by all generators. Called once at media
+ * engine start; subsequent calls are no-ops.
+ */
+MPF_DECLARE(void) mpf_dtmf_generator_tables_init(void);
 
 /**
  * Create MPF DTMF generator (advanced).
@@ -30,9 +30,23 @@ APT_BEGIN_EXTERN_C
 typedef struct mpf_frame_buffer_t mpf_frame_buffer_t;
 
 
-/** Create frame buffer */
+/** Frame buffer synchronization mode */
+typedef enum {
+	/** Any number of writers and readers, guarded by mutex */
+	MPF_FRAME_BUFFER_LOCKED,
+	/** Single writer and single reader (e.g. application and media threads), lock-free */
+	MPF_FRAME_BUFFER_SPSC
+} mpf_frame_buffer_mode_e;
+
+/** Create frame buffer guarded by mutex */
 mpf_frame_buffer_t* mpf_frame_buffer_create(apr_size_t frame_size, apr_size_t frame_count, apr_pool_t *pool);
 
+/**
+ * Create frame buffer of specified mode. In the SPSC mode restart may only be
+ * requested by the writer; the reader applies it on the next read.
+ */
+mpf_frame_buffer_t* mpf_frame_buffer_create_ex(apr_size_t frame_size, apr_size_t frame_count, mpf_frame_buffer_mode_e mode, apr_pool_t *pool);
+
 /** Destroy frame buffer */
 void mpf_frame_buffer_destroy(mpf_frame_buffer_t *buffer);
 
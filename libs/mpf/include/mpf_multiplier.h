@@ -34,6 +34,9 @@ APT_BEGIN_EXTERN_C
  * @param codec_manager the codec manager
  * @param name the informative name used for debugging
  * @param pool the pool to allocate memory from
+ * @remark The frame read from the source is decoded at most once and encoded at most
+ * once per distinct sink codec. Sinks of the same codec get the same frame by
+ * reference and must not modify it; a sink that needs to alter data must copy it.
  */
 MPF_DECLARE(mpf_object_t*) mpf_multiplier_create(
 								mpf_audio_stream_t *source,
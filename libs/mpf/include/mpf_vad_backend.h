@@ -0,0 +1,78 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MPF_VAD_BACKEND_H
+#define MPF_VAD_BACKEND_H
+
+/**
+ * @file mpf_vad_backend.h
+ * @brief MPF Voice Activity Detection Backends
+ */ 
+
+#include "mpf.h"
+
+APT_BEGIN_EXTERN_C
+
+/** Name of the backend based on average signal level */
+#define MPF_VAD_BACKEND_ENERGY "energy"
+/** Name of the backend based on the WebRTC GMM VAD */
+#define MPF_VAD_BACKEND_WEBRTC "webrtc"
+
+/** Parameter of the energy backend: average absolute level threshold (0 .. 32767) */
+#define MPF_VAD_PARAM_LEVEL    "level"
+/** Parameter of the WebRTC backend: aggressiveness mode (0 .. 3) */
+#define MPF_VAD_PARAM_MODE     "mode"
+
+/** Opaque VAD backend state */
+typedef void mpf_vad_state_t;
+
+/** Declaration of VAD backend */
+typedef struct mpf_vad_backend_t mpf_vad_backend_t;
+
+/** VAD backend interface */
+struct mpf_vad_backend_t {
+	/** Name the backend is selected by */
+	const char *name;
+
+	/** Virtual create: allocate the backend state from the pool (NULL on failure) */
+	mpf_vad_state_t* (*create)(apr_pool_t *pool);
+	/** Virtual open: prepare the state for the sampling rate (FALSE if unsupported) */
+	apt_bool_t (*open)(mpf_vad_state_t *state, apr_uint16_t sampling_rate);
+	/** Virtual reset: discard the history accumulated so far */
+	void (*reset)(mpf_vad_state_t *state);
+	/** Virtual param set: set backend specific parameter (FALSE if not supported) */
+	apt_bool_t (*param_set)(mpf_vad_state_t *state, const char *name, apr_size_t value);
+	/** Virtual process: classify samples of a frame, return TRUE if voice is present */
+	apt_bool_t (*process)(mpf_vad_state_t *state, const apr_int16_t *samples, apr_size_t count);
+};
+
+/**
+ * Register external VAD backend.
+ * @param backend the backend to register (must outlive its use), create, open and process are mandatory
+ * @remark Backends are expected to be registered on startup (e.g. on plugin load),
+ *         before activity detectors are created.
+ */
+MPF_DECLARE(apt_bool_t) mpf_vad_backend_register(const mpf_vad_backend_t *backend);
+
+/** Find VAD backend by name */
+MPF_DECLARE(const mpf_vad_backend_t*) mpf_vad_backend_find(const char *name);
+
+/** Get VAD backend by index, used to enumerate backends (NULL if out of range) */
+MPF_DECLARE(const mpf_vad_backend_t*) mpf_vad_backend_get(apr_size_t index);
+
+APT_END_EXTERN_C
+
+#endif /* MPF_VAD_BACKEND_H */
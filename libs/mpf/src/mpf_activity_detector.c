@@ -16,7 +16,8 @@
 
 #include "mpf_activity_detector.h"
 #include "apt_log.h"
-#include "webrtc/common_audio/vad/include/webrtc_vad.h"
+#include "apt_simd.h"
+#include "mpf_vad_backend.h"
 
 /** Detector states */
 typedef enum {
@@ -26,11 +27,15 @@ typedef enum {
 	DETECTOR_STATE_INACTIVITY_TRANSITION /**< inactivity detection is in-progress */
 } mpf_detector_state_e;
 
+/** Default sampling rate the detector is initialized with */
+#define MPF_ACTIVITY_DETECTOR_DEFAULT_RATE 8000
+/** Default RMS amplitude below which a frame is considered silent without running the VAD (about -66 dBFS) */
+#define MPF_ACTIVITY_DETECTOR_DEFAULT_SILENCE_GATE 16
+/** Default RMS amplitude above which a frame is considered voiced without running the VAD (about -12 dBFS) */
+#define MPF_ACTIVITY_DETECTOR_DEFAULT_VOICE_GATE 8192
+
 /** Activity detector */
 struct mpf_activity_detector_t {
-	/* voice activity (silence) level threshold */
-	apr_size_t           level_threshold;
-
 	/* period of activity required to complete transition to active state */
 	apr_size_t           speech_timeout;
 	/* period of inactivity required to complete transition to inactive state */
@@ -42,18 +47,83 @@ struct mpf_activity_detector_t {
 	mpf_detector_state_e state;
 	/* duration spent in current state  */
 	apr_size_t           duration;
+
+	/* selected VAD backend */
+	const mpf_vad_backend_t *backend;
+	/* state of the selected backend */
+	mpf_vad_state_t     *backend_state;
+	/* energy backend used if the selected one cannot be applied */
+	mpf_vad_state_t     *fallback_state;
+	/* backend frames are currently passed to (either selected or fallback one) */
+	const mpf_vad_backend_t *active_backend;
+	/* state of the active backend */
+	mpf_vad_state_t     *active_state;
+	/* sampling rate of the audio stream */
+	apr_uint16_t         sampling_rate;
+
+	/* RMS amplitude below which frames are silent (0 - disabled) */
+	apr_size_t           silence_gate;
+	/* RMS amplitude above which frames are voiced (0 - disabled) */
+	apr_size_t           voice_gate;
+	/* decisions of the energy gate */
+	mpf_activity_detector_stats_t stats;
 };
 
-/** Create activity detector */
+/** Open the selected backend for the current sampling rate, fall back to the energy backend on failure */
+static void mpf_activity_detector_backend_open(mpf_activity_detector_t *detector)
+{
+	if(detector->backend_state && detector->backend->open(detector->backend_state,detector->sampling_rate) == TRUE) {
+		detector->active_backend = detector->backend;
+		detector->active_state = detector->backend_state;
+		return;
+	}
+
+	apt_log(MPF_LOG_MARK,APT_PRIO_NOTICE,"Fallback to [%s] VAD Backend [%d]",
+		MPF_VAD_BACKEND_ENERGY,
+		detector->sampling_rate);
+	detector->active_backend = mpf_vad_backend_find(MPF_VAD_BACKEND_ENERGY);
+	detector->active_state = detector->fallback_state;
+	detector->active_backend->open(detector->active_state,detector->sampling_rate);
+}
+
+/** Create activity detector using the default VAD backend */
 MPF_DECLARE(mpf_activity_detector_t*) mpf_activity_detector_create(apr_pool_t *pool)
 {
+	return mpf_activity_detector_create_ex(NULL,pool);
+}
+
+/** Create activity detector using the specified VAD backend */
+MPF_DECLARE(mpf_activity_detector_t*) mpf_activity_detector_create_ex(const char *backend_name, apr_pool_t *pool)
+{
+	const mpf_vad_backend_t *energy_backend = mpf_vad_backend_find(MPF_VAD_BACKEND_ENERGY);
 	mpf_activity_detector_t *detector = apr_palloc(pool,sizeof(mpf_activity_detector_t));
-	detector->level_threshold = 30; /* 0 .. 255 */
 	detector->speech_timeout = 200; /* 0.2 s */
 	detector->silence_timeout = 200; /* 0.2 s */
 	detector->noinput_timeout = 5000; /* 5 s */
 	detector->duration = 0;
 	detector->state = DETECTOR_STATE_INACTIVITY;
+
+	detector->sampling_rate = MPF_ACTIVITY_DETECTOR_DEFAULT_RATE;
+	detector->silence_gate = MPF_ACTIVITY_DETECTOR_DEFAULT_SILENCE_GATE;
+	detector->voice_gate = MPF_ACTIVITY_DETECTOR_DEFAULT_VOICE_GATE;
+	memset(&detector->stats,0,sizeof(detector->stats));
+
+	if(!backend_name) {
+		backend_name = MPF_VAD_BACKEND_WEBRTC;
+	}
+	detector->backend = mpf_vad_backend_find(backend_name);
+	if(!detector->backend) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"No Such VAD Backend [%s]",backend_name);
+		detector->backend = energy_backend;
+	}
+	detector->backend_state = detector->backend->create(pool);
+	if(detector->backend == energy_backend) {
+		detector->fallback_state = detector->backend_state;
+	}
+	else {
+		detector->fallback_state = energy_backend->create(pool);
+	}
+	mpf_activity_detector_backend_open(detector);
 	return detector;
 }
 
@@ -62,12 +132,61 @@ MPF_DECLARE(void) mpf_activity_detector_reset(mpf_activity_detector_t *detector)
 {
 	detector->duration = 0;
 	detector->state = DETECTOR_STATE_INACTIVITY;
+	if(detector->active_backend->reset) {
+		detector->active_backend->reset(detector->active_state);
+	}
+}
+
+/** Set codec descriptor of the audio stream to analyze */
+MPF_DECLARE(void) mpf_activity_detector_codec_set(mpf_activity_detector_t *detector, const mpf_codec_descriptor_t *descriptor)
+{
+	if(!descriptor || !descriptor->sampling_rate || descriptor->sampling_rate == detector->sampling_rate) {
+		return;
+	}
+	detector->sampling_rate = descriptor->sampling_rate;
+	mpf_activity_detector_backend_open(detector);
+}
+
+/** Set parameter of the VAD backend */
+MPF_DECLARE(apt_bool_t) mpf_activity_detector_param_set(mpf_activity_detector_t *detector, const char *name, apr_size_t value)
+{
+	apt_bool_t status = FALSE;
+	if(detector->backend_state && detector->backend->param_set) {
+		status = detector->backend->param_set(detector->backend_state,name,value);
+	}
+	if(detector->fallback_state != detector->backend_state) {
+		/* keep the fallback backend configured as well */
+		mpf_vad_backend_find(MPF_VAD_BACKEND_ENERGY)->param_set(detector->fallback_state,name,value);
+	}
+	return status;
+}
+
+/** Set aggressiveness mode of the VAD */
+MPF_DECLARE(void) mpf_activity_detector_vad_mode_set(mpf_activity_detector_t *detector, int vad_mode)
+{
+	if(vad_mode < 0) {
+		return;
+	}
+	mpf_activity_detector_param_set(detector,MPF_VAD_PARAM_MODE,vad_mode);
+}
+
+/** Set energy gates applied ahead of the VAD */
+MPF_DECLARE(void) mpf_activity_detector_energy_gate_set(mpf_activity_detector_t *detector, apr_size_t silence_gate, apr_size_t voice_gate)
+{
+	detector->silence_gate = silence_gate;
+	detector->voice_gate = voice_gate;
+}
+
+/** Get decision counters of the energy gate */
+MPF_DECLARE(void) mpf_activity_detector_stats_get(const mpf_activity_detector_t *detector, mpf_activity_detector_stats_t *stats)
+{
+	*stats = detector->stats;
 }
 
 /** Set threshold of voice activity (silence) level */
 MPF_DECLARE(void) mpf_activity_detector_level_set(mpf_activity_detector_t *detector, apr_size_t level_threshold)
 {
-	detector->level_threshold = level_threshold;
+	mpf_activity_detector_param_set(detector,MPF_VAD_PARAM_LEVEL,level_threshold);
 }
 
 /** Set noinput timeout */
@@ -96,162 +215,80 @@ static APR_INLINE void mpf_activity_detector_state_change(mpf_activity_detector_
 	apt_log(MPF_LOG_MARK,APT_PRIO_INFO,"Activity Detector state changed [%d]",state);
 }
 
-/*static apr_size_t mpf_activity_detector_level_calculate(const mpf_frame_t *frame)
+/** Calculate sum of squared samples */
+static apr_uint64_t mpf_samples_energy_calculate(const apr_int16_t *buf, apr_size_t samples)
 {
-	apr_size_t sum = 0;
-	apr_size_t count = frame->codec_frame.size/2;
-	const apr_int16_t *cur = frame->codec_frame.buffer;
-	const apr_int16_t *end = cur + count;
-
-	for(; cur < end; cur++) {
-		if(*cur < 0) {
-			sum -= *cur;
-		}
-		else {
-			sum += *cur;
-		}
+	apr_uint64_t energy = 0;
+	apr_size_t i = 0;
+#if defined(APT_SIMD_SSE2)
+	apr_uint64_t lanes[2];
+	__m128i zero = _mm_setzero_si128();
+	__m128i acc = _mm_setzero_si128();
+#if defined(APT_SIMD_AVX2)
+	__m256i zero256 = _mm256_setzero_si256();
+	__m256i acc256 = _mm256_setzero_si256();
+	for(; i + 16 <= samples; i += 16) {
+		__m256i x = _mm256_loadu_si256((const __m256i*)(buf + i));
+		/* pairwise sums of squares fit in 32-bit unsigned lanes, widen them to 64-bit */
+		__m256i sq = _mm256_madd_epi16(x,x);
+		acc256 = _mm256_add_epi64(acc256,_mm256_unpacklo_epi32(sq,zero256));
+		acc256 = _mm256_add_epi64(acc256,_mm256_unpackhi_epi32(sq,zero256));
 	}
-
-	return sum / count;
-}*/
-
-static apr_size_t mpf_activity_detector_level_calculate(const mpf_frame_t *frame)
-{
-  apr_size_t samplesCount = frame->codec_frame.size/2;
-  int per_ms_frames = 20;
-  apr_size_t sampleRate = 8000;
-  size_t samples = sampleRate * per_ms_frames / 1000;
-  if (samples == 0) return -1;
-  size_t nTotal = (samplesCount / samples);
-  int16_t *input = frame->codec_frame.buffer;
-  VadInst *vadInst;
-  if (WebRtcVad_Create(&vadInst)) {
-    return -1;
-  }
-  int status = WebRtcVad_Init(vadInst);
-  if (status != 0) {
-    WebRtcVad_Free(vadInst);
-    return -1;
-  }
-  int16_t vad_mode = 1;
-  status = WebRtcVad_set_mode(vadInst, vad_mode);
-  if (status != 0) {
-    WebRtcVad_Free(vadInst);
-    return -1;
-  }
-  int cnt = 0;
-  int i  = 0;
-  if(nTotal > 0) {
-    for (i = 0; i < nTotal; i++) {
-    //int keep_weight = 0;
-    int nVadRet = WebRtcVad_Process(vadInst, sampleRate, input, samples);
-   // printf("==========%d=============== \n", nVadRet);
-    if (nVadRet == -1) {
-      WebRtcVad_Free(vadInst);
-      return -1;
-    } else {
-      if (nVadRet >= 1) {
-        cnt++;
-      } 
-   }
-    input += samples;
-   }
-   WebRtcVad_Free(vadInst);
-  if (cnt < nTotal/10) {
-    return 0;
-  } else {
-    return 1;
-  }
- }
- 
- if(nTotal == 0) {
-   int nVadRet = WebRtcVad_Process(vadInst, sampleRate, input, samplesCount);
-   //printf("==========%d=============== \n", nVadRet);
-   WebRtcVad_Free(vadInst);
-   return nVadRet;
- }
-
- return 0;
+	acc = _mm_add_epi64(_mm256_castsi256_si128(acc256),_mm256_extracti128_si256(acc256,1));
+#endif
+	for(; i + 8 <= samples; i += 8) {
+		__m128i x = _mm_loadu_si128((const __m128i*)(buf + i));
+		__m128i sq = _mm_madd_epi16(x,x);
+		acc = _mm_add_epi64(acc,_mm_unpacklo_epi32(sq,zero));
+		acc = _mm_add_epi64(acc,_mm_unpackhi_epi32(sq,zero));
+	}
+	_mm_storeu_si128((__m128i*)lanes,acc);
+	energy = lanes[0] + lanes[1];
+#elif defined(APT_SIMD_NEON)
+	int64x2_t acc = vdupq_n_s64(0);
+	for(; i + 8 <= samples; i += 8) {
+		int16x8_t x = vld1q_s16(buf + i);
+		acc = vpadalq_s32(acc,vmull_s16(vget_low_s16(x),vget_low_s16(x)));
+		acc = vpadalq_s32(acc,vmull_s16(vget_high_s16(x),vget_high_s16(x)));
+	}
+	energy = (apr_uint64_t)(vgetq_lane_s64(acc,0) + vgetq_lane_s64(acc,1));
+#endif
+	for(; i < samples; i++) {
+		energy += (apr_uint64_t)((apr_int32_t)buf[i] * buf[i]);
+	}
+	return energy;
 }
 
-MPF_DECLARE(mpf_detector_event_e) mpf_activity_detector_process(mpf_activity_detector_t *detector, const mpf_frame_t *frame)
+/** Classify the frame by energy, pass it to the VAD backend only if the energy is ambiguous */
+static apt_bool_t mpf_activity_detector_voice_detect(mpf_activity_detector_t *detector, const mpf_frame_t *frame)
 {
-    mpf_detector_event_e det_event = MPF_DETECTOR_EVENT_NONE;
-    apr_size_t level = 0;
-    if((frame->type & MEDIA_FRAME_TYPE_AUDIO) == MEDIA_FRAME_TYPE_AUDIO) {     
-        level = mpf_activity_detector_level_calculate(frame);
-#if 0
-        apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Activity Detector --------------------- [%"APR_SIZE_T_FMT"]",level);
-#endif
-    }
+	const apr_int16_t *samples = frame->codec_frame.buffer;
+	apr_size_t count = frame->codec_frame.size / sizeof(apr_int16_t);
+	apr_uint64_t energy = mpf_samples_energy_calculate(samples,count);
 
-    if(detector->state == DETECTOR_STATE_INACTIVITY) {
-        if(level >= 1) {
-   //         apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Activity Detector ----DETECTOR_STATE_ACTIVITY_TRANSITION---------------- [%"APR_SIZE_T_FMT"]",level);
-            mpf_activity_detector_state_change(detector, DETECTOR_STATE_ACTIVITY_TRANSITION);
-        }
-        else {
-            detector->duration += CODEC_FRAME_TIME_BASE;
-            if(detector->duration >= detector->noinput_timeout) {
-                det_event = MPF_DETECTOR_EVENT_NOINPUT;
-            }
-        }
-    }
-    else if(detector->state == DETECTOR_STATE_ACTIVITY_TRANSITION) {
-        if(level >= 1) {
-            detector->duration += CODEC_FRAME_TIME_BASE;
-     //       apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Activity Detector ----DETECTOR_STATE_ACTIVITY-------11111--------- [%"APR_SIZE_T_FMT"]",level);
-            if(detector->duration >= detector->speech_timeout) {
-                det_event = MPF_DETECTOR_EVENT_ACTIVITY;
-                mpf_activity_detector_state_change(detector, DETECTOR_STATE_ACTIVITY);
-            }
-        }
-        else {
-            mpf_activity_detector_state_change(detector,DETECTOR_STATE_INACTIVITY);
-        }
-    }
-    else if(detector->state == DETECTOR_STATE_ACTIVITY) {
-        if(level >= 1) {
-       //     apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Activity Detector ----DETECTOR_STATE_ACTIVITY--------2222-------- [%"APR_SIZE_T_FMT"]",level);
-            detector->duration += CODEC_FRAME_TIME_BASE;
-        } else {
-         //   apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Activity Detector ----DETECTOR_STATE_INACTIVITY_TRANSITION---------------- [%"APR_SIZE_T_FMT"]",level);
-            mpf_activity_detector_state_change(detector,DETECTOR_STATE_INACTIVITY_TRANSITION);
-        }
-    }
-    else if(detector->state == DETECTOR_STATE_INACTIVITY_TRANSITION) {
-        if(level >= 1) {
-            mpf_activity_detector_state_change(detector,DETECTOR_STATE_ACTIVITY);
-        }
-        else {
-            detector->duration += CODEC_FRAME_TIME_BASE;
-            if(detector->duration >= detector->silence_timeout) {
-           //     apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Activity Detector ----DETECTOR_STATE_INACTIVITY---------------- [%"APR_SIZE_T_FMT"]",level);
-                det_event = MPF_DETECTOR_EVENT_INACTIVITY;
-                mpf_activity_detector_state_change(detector,DETECTOR_STATE_INACTIVITY);
-            }
-        }
-    }
-    return det_event;
+	/* skip the VAD for clearly silent or clearly voiced frames */
+	if(energy < (apr_uint64_t)detector->silence_gate * detector->silence_gate * count) {
+		detector->stats.silence_gated++;
+		return FALSE;
+	}
+	if(detector->voice_gate && energy >= (apr_uint64_t)detector->voice_gate * detector->voice_gate * count) {
+		detector->stats.voice_gated++;
+		return TRUE;
+	}
+	detector->stats.vad_processed++;
+	return detector->active_backend->process(detector->active_state,samples,count);
 }
 
-/** Process current frame */
-/*MPF_DECLARE(mpf_detector_event_e) mpf_activity_detector_process(mpf_activity_detector_t *detector, const mpf_frame_t *frame)
+MPF_DECLARE(mpf_detector_event_e) mpf_activity_detector_process(mpf_activity_detector_t *detector, const mpf_frame_t *frame)
 {
 	mpf_detector_event_e det_event = MPF_DETECTOR_EVENT_NONE;
-
-	apr_size_t level = 0;
+	apt_bool_t voice = FALSE;
 	if((frame->type & MEDIA_FRAME_TYPE_AUDIO) == MEDIA_FRAME_TYPE_AUDIO) {
-		level = mpf_activity_detector_level_calculate(frame);
-#if 0
-		apt_log(MPF_LOG_MARK,APT_PRIO_INFO,"Activity Detector [%"APR_SIZE_T_FMT"],[%"APR_SIZE_T_FMT"]",level,detector->level_threshold);
-	} else {
-		apt_log(MPF_LOG_MARK,APT_PRIO_INFO,"Activity Detector [%"APR_SIZE_T_FMT"][%"APR_SIZE_T_FMT"],frame type [%d]",level,detector->level_threshold,frame->type);
-#endif
+		voice = mpf_activity_detector_voice_detect(detector,frame);
 	}
 
 	if(detector->state == DETECTOR_STATE_INACTIVITY) {
-		if(level >= detector->level_threshold) {
+		if(voice == TRUE) {
 			mpf_activity_detector_state_change(detector,DETECTOR_STATE_ACTIVITY_TRANSITION);
 		}
 		else {
@@ -262,7 +299,7 @@ MPF_DECLARE(mpf_detector_event_e) mpf_activity_detector_process(mpf_activity_det
 		}
 	}
 	else if(detector->state == DETECTOR_STATE_ACTIVITY_TRANSITION) {
-		if(level >= detector->level_threshold) {
+		if(voice == TRUE) {
 			detector->duration += CODEC_FRAME_TIME_BASE;
 			if(detector->duration >= detector->speech_timeout) {
 				det_event = MPF_DETECTOR_EVENT_ACTIVITY;
@@ -274,7 +311,7 @@ MPF_DECLARE(mpf_detector_event_e) mpf_activity_detector_process(mpf_activity_det
 		}
 	}
 	else if(detector->state == DETECTOR_STATE_ACTIVITY) {
-		if(level >= detector->level_threshold) {
+		if(voice == TRUE) {
 			detector->duration += CODEC_FRAME_TIME_BASE;
 		}
 		else {
@@ -282,7 +319,7 @@ MPF_DECLARE(mpf_detector_event_e) mpf_activity_detector_process(mpf_activity_det
 		}
 	}
 	else if(detector->state == DETECTOR_STATE_INACTIVITY_TRANSITION) {
-		if(level >= detector->level_threshold) {
+		if(voice == TRUE) {
 			mpf_activity_detector_state_change(detector,DETECTOR_STATE_ACTIVITY);
 		}
 		else {
@@ -293,6 +330,5 @@ MPF_DECLARE(mpf_detector_event_e) mpf_activity_detector_process(mpf_activity_det
 			}
 		}
 	}
-
 	return det_event;
-}*/
\ No newline at end of file
+}
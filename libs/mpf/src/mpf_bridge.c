@@ -194,6 +194,8 @@ MPF_DECLARE(mpf_object_t*) mpf_bridge_create(
 	}
 
 	if(mpf_codec_descriptors_match(source->rx_descriptor,sink->tx_descriptor) == TRUE) {
+		/* sink accepts the codec of the source as is (e.g. an engine advertising PCMU in its capabilities),
+		pass encoded frames through without decoding and encoding them back */
 		return mpf_null_bridge_create(source,sink,codec_manager,name,pool);
 	}
 
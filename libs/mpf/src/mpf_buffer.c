@@ -14,163 +14,200 @@
  * limitations under the License.
  */
 
-#ifdef WIN32
-#pragma warning(disable: 4127)
-#endif
-#include <apr_ring.h>
 #include "mpf_buffer.h"
+#include "apt_atomic.h"
 
-typedef struct mpf_chunk_t mpf_chunk_t;
+/** Number of events (and restart requests) the buffer can hold */
+#define MPF_BUFFER_EVENT_QUEUE_SIZE 32
 
-struct mpf_chunk_t {
-	APR_RING_ENTRY(mpf_chunk_t) link;
-	mpf_frame_t                 frame;
+typedef struct mpf_buffer_event_t mpf_buffer_event_t;
+
+/** Event marker positioned between audio bytes */
+struct mpf_buffer_event_t {
+	/** Write position the event is attached to */
+	apr_uint32_t     pos;
+	/** Type of the event or MEDIA_FRAME_TYPE_NONE for restart request */
+	mpf_frame_type_e type;
 };
 
+/**
+ * Single-producer/single-consumer byte ring.
+ *
+ * Positions are free-running and wrap around at 2^32; the capacity is a power of
+ * two, so that a position is masked to get the offset in the ring. The producer
+ * owns write_pos and event_write_pos, the consumer owns read_pos and event_read_pos.
+ * Restart requests travel in the event queue, so that only the consumer ever moves
+ * read_pos.
+ */
 struct mpf_buffer_t {
-	APR_RING_HEAD(mpf_chunk_head_t, mpf_chunk_t) head;
-	mpf_chunk_t                                 *cur_chunk;
-	apr_size_t                                   remaining_chunk_size;
-	apr_thread_mutex_t                          *guard;
-	apr_pool_t                                  *pool;
-	apr_size_t                                   size; /* total size */
+	/** Audio bytes */
+	char                   *data;
+	/** Capacity of the ring in bytes */
+	apr_uint32_t            capacity;
+	/** Total number of bytes written */
+	volatile apr_uint32_t   write_pos;
+	/** Total number of bytes read or discarded */
+	volatile apr_uint32_t   read_pos;
+
+	/** Event markers */
+	mpf_buffer_event_t      events[MPF_BUFFER_EVENT_QUEUE_SIZE];
+	/** Total number of events written */
+	volatile apr_uint32_t   event_write_pos;
+	/** Total number of events read or discarded */
+	volatile apr_uint32_t   event_read_pos;
 };
 
 mpf_buffer_t* mpf_buffer_create(apr_pool_t *pool)
+{
+	return mpf_buffer_create_ex(MPF_BUFFER_DEFAULT_CAPACITY,pool);
+}
+
+mpf_buffer_t* mpf_buffer_create_ex(apr_size_t capacity, apr_pool_t *pool)
 {
 	mpf_buffer_t *buffer = apr_palloc(pool,sizeof(mpf_buffer_t));
-	buffer->pool = pool;
-	buffer->cur_chunk = NULL;
-	buffer->remaining_chunk_size = 0;
-	buffer->size = 0;
-	APR_RING_INIT(&buffer->head, mpf_chunk_t, link);
-	apr_thread_mutex_create(&buffer->guard,APR_THREAD_MUTEX_UNNESTED,pool);
+	buffer->capacity = 1;
+	while(buffer->capacity < capacity && buffer->capacity < 0x40000000) {
+		buffer->capacity <<= 1;
+	}
+	buffer->data = apr_palloc(pool,buffer->capacity);
+	buffer->write_pos = 0;
+	buffer->read_pos = 0;
+	buffer->event_write_pos = 0;
+	buffer->event_read_pos = 0;
 	return buffer;
 }
 
 void mpf_buffer_destroy(mpf_buffer_t *buffer)
 {
-	if(buffer->guard) {
-		apr_thread_mutex_destroy(buffer->guard);
-		buffer->guard = NULL;
-	}
+	/* nothing to release, the ring is allocated from the pool */
 }
 
-apt_bool_t mpf_buffer_restart(mpf_buffer_t *buffer)
+static APR_INLINE apt_bool_t mpf_buffer_event_put(mpf_buffer_t *buffer, mpf_frame_type_e event_type)
 {
-	apr_thread_mutex_lock(buffer->guard);
-	buffer->cur_chunk = NULL;
-	buffer->remaining_chunk_size = 0;
-	buffer->size = 0;
-	APR_RING_INIT(&buffer->head, mpf_chunk_t, link);
-	apr_thread_mutex_unlock(buffer->guard);
+	mpf_buffer_event_t *event;
+	apr_uint32_t event_write_pos = buffer->event_write_pos;
+	if(event_write_pos - apt_atomic_load32_acquire(&buffer->event_read_pos) >= MPF_BUFFER_EVENT_QUEUE_SIZE) {
+		/* event queue is full */
+		return FALSE;
+	}
+
+	event = &buffer->events[event_write_pos % MPF_BUFFER_EVENT_QUEUE_SIZE];
+	event->pos = buffer->write_pos;
+	event->type = event_type;
+	apt_atomic_store32_release(&buffer->event_write_pos,event_write_pos + 1);
 	return TRUE;
 }
 
-static APR_INLINE apt_bool_t mpf_buffer_chunk_write(mpf_buffer_t *buffer, mpf_chunk_t *chunk)
+apt_bool_t mpf_buffer_restart(mpf_buffer_t *buffer)
 {
-	APR_RING_INSERT_TAIL(&buffer->head,chunk,mpf_chunk_t,link);
-	return TRUE;
+	/* the consumer discards everything written so far, once it gets to the request */
+	return mpf_buffer_event_put(buffer,MEDIA_FRAME_TYPE_NONE);
 }
 
-static APR_INLINE mpf_chunk_t* mpf_buffer_chunk_read(mpf_buffer_t *buffer)
+apt_bool_t mpf_buffer_audio_write(mpf_buffer_t *buffer, void *data, apr_size_t size)
 {
-	mpf_chunk_t *chunk = NULL;
-	if(!APR_RING_EMPTY(&buffer->head,mpf_chunk_t,link)) {
-		chunk = APR_RING_FIRST(&buffer->head);
-		APR_RING_REMOVE(chunk,link);
+	apr_uint32_t write_pos = buffer->write_pos;
+	apr_uint32_t offset = write_pos & (buffer->capacity - 1);
+	apr_size_t tail_size = buffer->capacity - offset;
+
+	if(size > buffer->capacity - (write_pos - apt_atomic_load32_acquire(&buffer->read_pos))) {
+		/* not enough space; nothing is written, the producer should retry later */
+		return FALSE;
+	}
+
+	if(size <= tail_size) {
+		memcpy(buffer->data + offset,data,size);
 	}
-	return chunk;
+	else {
+		memcpy(buffer->data + offset,data,tail_size);
+		memcpy(buffer->data,(const char*)data + tail_size,size - tail_size);
+	}
+	apt_atomic_store32_release(&buffer->write_pos,write_pos + (apr_uint32_t)size);
+	return TRUE;
 }
 
-apt_bool_t mpf_buffer_audio_write(mpf_buffer_t *buffer, void *data, apr_size_t size)
+apt_bool_t mpf_buffer_event_write(mpf_buffer_t *buffer, mpf_frame_type_e event_type)
 {
-	mpf_chunk_t *chunk;
-	apt_bool_t status;
-	apr_thread_mutex_lock(buffer->guard);
-
-	chunk = apr_palloc(buffer->pool,sizeof(mpf_chunk_t));
-	APR_RING_ELEM_INIT(chunk,link);
-	chunk->frame.codec_frame.buffer = apr_palloc(buffer->pool,size);
-	memcpy(chunk->frame.codec_frame.buffer,data,size);
-	chunk->frame.codec_frame.size = size;
-	chunk->frame.type = MEDIA_FRAME_TYPE_AUDIO;
-	status = mpf_buffer_chunk_write(buffer,chunk);
-	
-	buffer->size += size;
-	apr_thread_mutex_unlock(buffer->guard);
-	return status;
+	return mpf_buffer_event_put(buffer,event_type);
 }
 
-apt_bool_t mpf_buffer_event_write(mpf_buffer_t *buffer, mpf_frame_type_e event_type)
+/** Apply the latest pending restart request, if any */
+static APR_INLINE void mpf_buffer_restart_apply(mpf_buffer_t *buffer, apr_uint32_t event_write_pos)
 {
-	mpf_chunk_t *chunk;
-	apt_bool_t status;
-	apr_thread_mutex_lock(buffer->guard);
-
-	chunk = apr_palloc(buffer->pool,sizeof(mpf_chunk_t));
-	APR_RING_ELEM_INIT(chunk,link);
-	chunk->frame.codec_frame.buffer = NULL;
-	chunk->frame.codec_frame.size = 0;
-	chunk->frame.type = event_type;
-	status = mpf_buffer_chunk_write(buffer,chunk);
-	
-	apr_thread_mutex_unlock(buffer->guard);
-	return status;
+	apr_uint32_t event_pos;
+	for(event_pos = event_write_pos; event_pos != buffer->event_read_pos; event_pos--) {
+		const mpf_buffer_event_t *event = &buffer->events[(event_pos - 1) % MPF_BUFFER_EVENT_QUEUE_SIZE];
+		if(event->type == MEDIA_FRAME_TYPE_NONE) {
+			/* drop the audio and events preceding the request */
+			apt_atomic_store32_release(&buffer->event_read_pos,event_pos);
+			apt_atomic_store32_release(&buffer->read_pos,event->pos);
+			break;
+		}
+	}
 }
 
 apt_bool_t mpf_buffer_frame_read(mpf_buffer_t *buffer, mpf_frame_t *media_frame)
 {
-	mpf_codec_frame_t *dest;
-	mpf_codec_frame_t *src;
-	apr_size_t remaining_frame_size = media_frame->codec_frame.size;
-	apr_thread_mutex_lock(buffer->guard);
-	do {
-		if(!buffer->cur_chunk) {
-			buffer->cur_chunk = mpf_buffer_chunk_read(buffer);
-			if(!buffer->cur_chunk) {
-				/* buffer is empty */
-				break;
-			}
-			buffer->remaining_chunk_size = buffer->cur_chunk->frame.codec_frame.size;
+	mpf_codec_frame_t *dest = &media_frame->codec_frame;
+	apr_uint32_t write_pos = apt_atomic_load32_acquire(&buffer->write_pos);
+	/* events are loaded after audio, so that no event attached to the audio can be missed */
+	apr_uint32_t event_write_pos = apt_atomic_load32_acquire(&buffer->event_write_pos);
+	apr_uint32_t read_pos;
+	apr_uint32_t offset;
+	apr_size_t size;
+	apr_size_t tail_size;
+
+	if(event_write_pos != buffer->event_read_pos) {
+		mpf_buffer_restart_apply(buffer,event_write_pos);
+	}
+
+	read_pos = buffer->read_pos;
+	size = write_pos - read_pos;
+	if((apr_int32_t)(write_pos - read_pos) < 0) {
+		/* restart request is ahead of the audio seen */
+		size = 0;
+	}
+	else if(size > dest->size) {
+		size = dest->size;
+	}
+
+	/* events attached to the audio being read, or to the end of the audio if the frame isn't filled up */
+	while(buffer->event_read_pos != event_write_pos) {
+		const mpf_buffer_event_t *event = &buffer->events[buffer->event_read_pos % MPF_BUFFER_EVENT_QUEUE_SIZE];
+		apr_uint32_t distance = event->pos - read_pos;
+		if(distance > size || distance >= dest->size) {
+			break;
 		}
+		media_frame->type |= event->type;
+		apt_atomic_store32_release(&buffer->event_read_pos,buffer->event_read_pos + 1);
+	}
 
-		dest = &media_frame->codec_frame;
-		src = &buffer->cur_chunk->frame.codec_frame;
-		media_frame->type |= buffer->cur_chunk->frame.type;
-		if(remaining_frame_size < buffer->remaining_chunk_size) {
-			/* copy remaining_frame_size */
-			memcpy(
-				(char*)dest->buffer + dest->size - remaining_frame_size,
-				(char*)src->buffer + src->size - buffer->remaining_chunk_size,
-				remaining_frame_size);
-			buffer->remaining_chunk_size -= remaining_frame_size;
-			buffer->size -= remaining_frame_size;
-			remaining_frame_size = 0;
+	if(size) {
+		offset = read_pos & (buffer->capacity - 1);
+		tail_size = buffer->capacity - offset;
+		if(size <= tail_size) {
+			memcpy(dest->buffer,buffer->data + offset,size);
 		}
 		else {
-			/* copy remaining_chunk_size and proceed to the next chunk */
-			memcpy(
-				(char*)dest->buffer + dest->size - remaining_frame_size,
-				(char*)src->buffer + src->size - buffer->remaining_chunk_size,
-				buffer->remaining_chunk_size);
-			remaining_frame_size -= buffer->remaining_chunk_size;
-			buffer->size -= buffer->remaining_chunk_size;
-			buffer->remaining_chunk_size = 0;
-			buffer->cur_chunk = NULL;
+			memcpy(dest->buffer,buffer->data + offset,tail_size);
+			memcpy((char*)dest->buffer + tail_size,buffer->data,size - tail_size);
 		}
+		media_frame->type |= MEDIA_FRAME_TYPE_AUDIO;
+		apt_atomic_store32_release(&buffer->read_pos,read_pos + (apr_uint32_t)size);
 	}
-	while(remaining_frame_size);
 
-	if(remaining_frame_size) {
-		apr_size_t offset = media_frame->codec_frame.size - remaining_frame_size;
-		memset((char*)media_frame->codec_frame.buffer + offset, 0, remaining_frame_size);
+	if(size < dest->size) {
+		memset((char*)dest->buffer + size, 0, dest->size - size);
 	}
-	apr_thread_mutex_unlock(buffer->guard);
 	return TRUE;
 }
 
 apr_size_t mpf_buffer_get_size(const mpf_buffer_t *buffer)
 {
-	return buffer->size;
+	return apt_atomic_load32_acquire(&buffer->write_pos) - apt_atomic_load32_acquire(&buffer->read_pos);
+}
+
+apr_size_t mpf_buffer_get_space(const mpf_buffer_t *buffer)
+{
+	return buffer->capacity - mpf_buffer_get_size(buffer);
 }
@@ -160,13 +160,20 @@ static mpf_codec_attribs_t* mpf_codec_capabilities_attribs_find(const mpf_codec_
 {
 	int i;
 	mpf_codec_attribs_t *attribs;
+	mpf_codec_attribs_t *matched_attribs = NULL;
 	for(i=0; i<capabilities->attrib_arr->nelts; i++) {
 		attribs = &APR_ARRAY_IDX(capabilities->attrib_arr,i,mpf_codec_attribs_t);
 		if(mpf_sampling_rate_check(descriptor->sampling_rate,attribs->sample_rates) == TRUE) {
-			return attribs;
+			if(apt_string_compare(&attribs->name,&descriptor->name) == TRUE) {
+				/* the very same codec is supported, no transcoding is required (passthrough) */
+				return attribs;
+			}
+			if(!matched_attribs) {
+				matched_attribs = attribs;
+			}
 		}
 	}
-	return NULL;
+	return matched_attribs;
 }
 
 /** Match codec list with specified capabilities */
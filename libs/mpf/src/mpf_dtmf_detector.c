@@ -18,6 +18,7 @@
 #include "apr_thread_mutex.h"
 #include "apt_log.h"
 #include "mpf_named_event.h"
+#include "apt_simd.h"
 #include <math.h>
 
 #ifndef M_PI
@@ -44,16 +45,24 @@
  *
  * Then energy of frequency f in the signal is:
  * X(f)X'(f) = s(t-2)^2 + s(t-1)^2 - coef*s(t-2)*s(t-1)
+ *
+ * The filters of all the DTMF frequencies are run in fixed point side by side
+ * (one SIMD lane per frequency): coef is Q14, s(t) is integer and the product
+ * coef * s(t-1) is rounded down. s(t) stays within 32 bits for full scale input
+ * over the window at sampling rates up to 48 kHz.
  */
 typedef struct goertzel_state_t {
-	/** coef = cos(2*pi*f_tone/f_sampling) */
-	double coef;
-	/** s(t-2) or resulting energy @see goertzel_state_t */
-	double s1;
+	/** coef = cos(2*pi*f_tone/f_sampling), Q14 */
+	apr_int32_t coef[DTMF_FREQUENCIES];
+	/** s(t-2) @see goertzel_state_t */
+	apr_int32_t s1[DTMF_FREQUENCIES];
 	/** s(t-1) @see goertzel_state_t */
-	double s2;
+	apr_int32_t s2[DTMF_FREQUENCIES];
 } goertzel_state_t;
 
+/** Number of fractional bits of Goertzel coefficients */
+#define GOERTZEL_COEF_SHIFT     14
+
 /** DTMF frequencies */
 static const double dtmf_freqs[DTMF_FREQUENCIES] = {
 	 697,  770,  852,  941,  /* Row frequencies */
@@ -79,9 +88,9 @@ struct mpf_dtmf_detector_t {
 	/** Number of lost digits due to full buffer */
 	apr_size_t                     lost_digits;
 	/** Frequency analyzators */
-	struct goertzel_state_t        energies[DTMF_FREQUENCIES];
+	struct goertzel_state_t        goertzel;
 	/** Total energy of signal */
-	double                         totenergy;
+	apr_uint64_t                   totenergy;
 	/** Number of samples in a window */
 	apr_size_t                     wsamples;
 	/** Number of samples processed */
@@ -120,10 +129,10 @@ MPF_DECLARE(struct mpf_dtmf_detector_t *) mpf_dtmf_detector_create_ex(
 	if (det->band & MPF_DTMF_DETECTOR_INBAND) {
 		apr_size_t i;
 		for (i = 0; i < DTMF_FREQUENCIES; i++) {
-			det->energies[i].coef = 2 * cos(2 * M_PI * dtmf_freqs[i] /
-				stream->tx_descriptor->sampling_rate);
-			det->energies[i].s1 = 0;
-			det->energies[i].s2 = 0;
+			det->goertzel.coef[i] = (apr_int32_t) floor(0.5 + (1 << GOERTZEL_COEF_SHIFT) *
+				2 * cos(2 * M_PI * dtmf_freqs[i] / stream->tx_descriptor->sampling_rate));
+			det->goertzel.s1[i] = 0;
+			det->goertzel.s2[i] = 0;
 		}
 		det->nsamples = 0;
 		det->wsamples = GOERTZEL_SAMPLES_8K * (stream->tx_descriptor->sampling_rate / 8000);
@@ -178,19 +187,117 @@ static APR_INLINE void mpf_dtmf_detector_add_digit(
 	apr_thread_mutex_unlock(detector->mutex);
 }
 
-static APR_INLINE void goertzel_sample(
+#if defined(APT_SIMD_SSE2) && !defined(APT_SIMD_AVX2)
+/** Multiply packed 32-bit integers keeping the low 32 bits of the products (SSE2 lacks pmulld) */
+static APR_INLINE __m128i goertzel_mullo_epi32(__m128i a, __m128i b)
+{
+	__m128i even = _mm_mul_epu32(a, b);
+	__m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+	return _mm_unpacklo_epi32(
+		_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+		_mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+/** Advance 4 filters by one sample */
+static APR_INLINE void goertzel_step_sse2(__m128i x, __m128i coef, __m128i *s1, __m128i *s2)
+{
+	/* coef * s(t-1) >> 14 split into high and low 16 bits of s(t-1) to stay within 32 bits */
+	__m128i hi = goertzel_mullo_epi32(_mm_srai_epi32(*s2, 16), coef);
+	__m128i lo = goertzel_mullo_epi32(_mm_and_si128(*s2, _mm_set1_epi32(0xFFFF)), coef);
+	__m128i s = _mm_sub_epi32(_mm_add_epi32(x, _mm_add_epi32(
+		_mm_slli_epi32(hi, 16 - GOERTZEL_COEF_SHIFT),
+		_mm_srai_epi32(lo, GOERTZEL_COEF_SHIFT))), *s1);
+	*s1 = *s2;
+	*s2 = s;
+}
+#endif
+
+/** Run all the filters over the samples (the window must not end within the samples) */
+static void goertzel_samples(
 								struct mpf_dtmf_detector_t *detector,
-								apr_int16_t sample)
+								const apr_int16_t *samples,
+								apr_size_t count)
 {
+	goertzel_state_t *state = &detector->goertzel;
+	apr_uint64_t totenergy = 0;
+	apr_size_t n;
+#if defined(APT_SIMD_AVX2)
+	const __m256i mask = _mm256_set1_epi32(0xFFFF);
+	__m256i coef = _mm256_loadu_si256((const __m256i*)state->coef);
+	__m256i s1 = _mm256_loadu_si256((const __m256i*)state->s1);
+	__m256i s2 = _mm256_loadu_si256((const __m256i*)state->s2);
+	for (n = 0; n < count; n++) {
+		__m256i x = _mm256_set1_epi32(samples[n]);
+		/* coef * s(t-1) >> 14 split into high and low 16 bits of s(t-1) to stay within 32 bits */
+		__m256i hi = _mm256_mullo_epi32(_mm256_srai_epi32(s2, 16), coef);
+		__m256i lo = _mm256_mullo_epi32(_mm256_and_si256(s2, mask), coef);
+		__m256i s = _mm256_sub_epi32(_mm256_add_epi32(x, _mm256_add_epi32(
+			_mm256_slli_epi32(hi, 16 - GOERTZEL_COEF_SHIFT),
+			_mm256_srai_epi32(lo, GOERTZEL_COEF_SHIFT))), s1);
+		s1 = s2;
+		s2 = s;
+		totenergy += (apr_int32_t)samples[n] * samples[n];
+	}
+	_mm256_storeu_si256((__m256i*)state->s1, s1);
+	_mm256_storeu_si256((__m256i*)state->s2, s2);
+#elif defined(APT_SIMD_SSE2)
+	__m128i coef_lo = _mm_loadu_si128((const __m128i*)state->coef);
+	__m128i coef_hi = _mm_loadu_si128((const __m128i*)(state->coef + 4));
+	__m128i s1_lo = _mm_loadu_si128((const __m128i*)state->s1);
+	__m128i s1_hi = _mm_loadu_si128((const __m128i*)(state->s1 + 4));
+	__m128i s2_lo = _mm_loadu_si128((const __m128i*)state->s2);
+	__m128i s2_hi = _mm_loadu_si128((const __m128i*)(state->s2 + 4));
+	for (n = 0; n < count; n++) {
+		__m128i x = _mm_set1_epi32(samples[n]);
+		goertzel_step_sse2(x, coef_lo, &s1_lo, &s2_lo);
+		goertzel_step_sse2(x, coef_hi, &s1_hi, &s2_hi);
+		totenergy += (apr_int32_t)samples[n] * samples[n];
+	}
+	_mm_storeu_si128((__m128i*)state->s1, s1_lo);
+	_mm_storeu_si128((__m128i*)(state->s1 + 4), s1_hi);
+	_mm_storeu_si128((__m128i*)state->s2, s2_lo);
+	_mm_storeu_si128((__m128i*)(state->s2 + 4), s2_hi);
+#elif defined(APT_SIMD_NEON)
+	const int32x4_t mask = vdupq_n_s32(0xFFFF);
+	int32x4_t coef[2], s1[2], s2[2];
 	apr_size_t i;
-	double s;
-	for (i = 0; i < DTMF_FREQUENCIES; i++) {
-		s = detector->energies[i].s1;
-		detector->energies[i].s1 = detector->energies[i].s2;
-		detector->energies[i].s2 = sample +
-			detector->energies[i].coef * detector->energies[i].s1 - s;
+	for (i = 0; i < 2; i++) {
+		coef[i] = vld1q_s32(state->coef + 4 * i);
+		s1[i] = vld1q_s32(state->s1 + 4 * i);
+		s2[i] = vld1q_s32(state->s2 + 4 * i);
+	}
+	for (n = 0; n < count; n++) {
+		int32x4_t x = vdupq_n_s32(samples[n]);
+		for (i = 0; i < 2; i++) {
+			/* coef * s(t-1) >> 14 split into high and low 16 bits of s(t-1) to stay within 32 bits */
+			int32x4_t hi = vmulq_s32(vshrq_n_s32(s2[i], 16), coef[i]);
+			int32x4_t lo = vmulq_s32(vandq_s32(s2[i], mask), coef[i]);
+			int32x4_t s = vsubq_s32(vaddq_s32(x, vaddq_s32(
+				vshlq_n_s32(hi, 16 - GOERTZEL_COEF_SHIFT),
+				vshrq_n_s32(lo, GOERTZEL_COEF_SHIFT))), s1[i]);
+			s1[i] = s2[i];
+			s2[i] = s;
+		}
+		totenergy += (apr_int32_t)samples[n] * samples[n];
+	}
+	for (i = 0; i < 2; i++) {
+		vst1q_s32(state->s1 + 4 * i, s1[i]);
+		vst1q_s32(state->s2 + 4 * i, s2[i]);
+	}
+#else
+	apr_size_t i;
+	apr_int32_t s;
+	for (n = 0; n < count; n++) {
+		for (i = 0; i < DTMF_FREQUENCIES; i++) {
+			s = state->s1[i];
+			state->s1[i] = state->s2[i];
+			state->s2[i] = samples[n] + (apr_int32_t)
+				(((apr_int64_t)state->coef[i] * state->s1[i]) >> GOERTZEL_COEF_SHIFT) - s;
+		}
+		totenergy += (apr_int32_t)samples[n] * samples[n];
 	}
-	detector->totenergy += sample * sample;
+#endif
+	detector->totenergy += totenergy;
 }
 
 static void goertzel_energies_digit(struct mpf_dtmf_detector_t *detector)
@@ -201,9 +308,10 @@ static void goertzel_energies_digit(struct mpf_dtmf_detector_t *detector)
 
 	/* Calculate energies and maxims */
 	for (i = 0; i < DTMF_FREQUENCIES; i++) {
-		double eng = detector->energies[i].s1 * detector->energies[i].s1 +
-			detector->energies[i].s2 * detector->energies[i].s2 -
-			detector->energies[i].coef * detector->energies[i].s1 * detector->energies[i].s2;
+		double s1 = detector->goertzel.s1[i];
+		double s2 = detector->goertzel.s2[i];
+		double coef = (double) detector->goertzel.coef[i] / (1 << GOERTZEL_COEF_SHIFT);
+		double eng = s1 * s1 + s2 * s2 - coef * s1 * s2;
 		if (i < DTMF_FREQUENCIES/2) {
 			if (eng > reng) {
 				rmax = i;
@@ -233,7 +341,7 @@ static void goertzel_energies_digit(struct mpf_dtmf_detector_t *detector)
 		 */
 	} else if ((ceng < reng) && (ceng < reng * 0.158)) {  /* twist > 8db, error */
 		/* Reverse twist check failed */
-	} else if (0.25 * detector->totenergy > (reng + ceng)) {  /* 16db */
+	} else if (0.25 * (double) detector->totenergy > (reng + ceng)) {  /* 16db */
 		/* Signal energy to total energy ratio test failed */
 	} else {
 		if (cmax >= DTMF_FREQUENCIES/2 && cmax < DTMF_FREQUENCIES)
@@ -254,8 +362,8 @@ static void goertzel_energies_digit(struct mpf_dtmf_detector_t *detector)
 
 	/* Reset Goertzel's detectors */
 	for (i = 0; i < DTMF_FREQUENCIES; i++) {
-		detector->energies[i].s1 = 0;
-		detector->energies[i].s2 = 0;
+		detector->goertzel.s1[i] = 0;
+		detector->goertzel.s2[i] = 0;
 	}
 	detector->totenergy = 0;
 }
@@ -280,12 +388,20 @@ MPF_DECLARE(void) mpf_dtmf_detector_get_frame(
 	}
 
 	if ((detector->band & MPF_DTMF_DETECTOR_INBAND) && (frame->type & MEDIA_FRAME_TYPE_AUDIO)) {
-		apr_int16_t *samples = frame->codec_frame.buffer;
-		apr_size_t i;
+		const apr_int16_t *samples = frame->codec_frame.buffer;
+		apr_size_t count = frame->codec_frame.size / 2;
+		apr_size_t chunk;
 
-		for (i = 0; i < frame->codec_frame.size / 2; i++) {
-			goertzel_sample(detector, samples[i]);
-			if (++detector->nsamples >= detector->wsamples) {
+		while (count) {
+			/* process up to the end of the current window */
+			chunk = detector->wsamples - detector->nsamples;
+			if (chunk > count)
+				chunk = count;
+			goertzel_samples(detector, samples, chunk);
+			samples += chunk;
+			count -= chunk;
+			detector->nsamples += chunk;
+			if (detector->nsamples >= detector->wsamples) {
 				goertzel_energies_digit(detector);
 				detector->nsamples = 0;
 			}
@@ -49,24 +49,37 @@ typedef enum mpf_dtmf_generator_state_e {
 	DTMF_GEN_STATE_SILENCE
 } mpf_dtmf_generator_state_e;
 
+/** Number of bits addressing the sine wave table */
+#define DTMF_SINE_TABLE_BITS  10
+
+/** Number of entries in the sine wave table (one full period) */
+#define DTMF_SINE_TABLE_SIZE  (1 << DTMF_SINE_TABLE_BITS)
+
+/** Shift turning the 32-bit oscillator phase into a table index */
+#define DTMF_SINE_PHASE_SHIFT (32 - DTMF_SINE_TABLE_BITS)
+
 /**
- * Sine wave generator (second-order IIR filter) state:
+ * Fixed-point oscillator (phase accumulator) state:
  *
- * s(t) = Amp*sin(2*pi*f_tone/f_sampling*t)
+ * s(t) = table[phase(t) >> DTMF_SINE_PHASE_SHIFT]; phase(t) = phase(t-1) + step
  *
- * s(t) = coef * s(t-1) - s(t-2); s(0)=0; s(1)=Amp*sin(2*pi*f_tone/f_sampling)
+ * The phase wraps around at 2^32, which corresponds to 2*pi.
  */
 typedef struct sine_state_t {
-	/** coef = cos(2*pi*f_tone/f_sampling) */
-	double coef;
-	/** s(t-2) @see sine_state_t */
-	double s1;
-	/** s(t-1) @see sine_state_t */
-	double s2;
+	/** step = 2^32 * f_tone / f_sampling */
+	apr_uint32_t step;
+	/** Current phase @see sine_state_t */
+	apr_uint32_t phase;
 } sine_state_t;
 
+/** One period of the sine wave scaled to DTMF_SINE_AMPLITUDE, shared by all generators */
+static apr_int16_t dtmf_sine_table[DTMF_SINE_TABLE_SIZE];
+
+/** Whether the sine wave table has been built */
+static volatile apt_bool_t dtmf_sine_table_built = FALSE;
+
 /** Mapping event_id to frequency pair */
-static const double dtmf_freq[DTMF_EVENT_ID_MAX+1][2] = {
+static const apr_uint32_t dtmf_freq[DTMF_EVENT_ID_MAX+1][2] = {
 	{941, 1336},  /* 0 */
 	{697, 1209},  /* 1 */
 	{697, 1336},  /* 2 */
@@ -124,6 +137,26 @@ struct mpf_dtmf_generator_t {
 };
 
 
+static APR_INLINE apr_uint32_t dtmf_sine_step_calculate(apr_uint32_t freq, apr_uint32_t sample_rate)
+{
+	/* Round to nearest to keep the frequency error below 2^-32 of the sampling rate */
+	return (apr_uint32_t) ((((apr_uint64_t) freq << 32) + sample_rate / 2) / sample_rate);
+}
+
+
+MPF_DECLARE(void) mpf_dtmf_generator_tables_init(void)
+{
+	apr_size_t i;
+
+	if (dtmf_sine_table_built) return;
+	for (i = 0; i < DTMF_SINE_TABLE_SIZE; i++) {
+		double value = DTMF_SINE_AMPLITUDE * sin(2 * M_PI * i / DTMF_SINE_TABLE_SIZE);
+		dtmf_sine_table[i] = (apr_int16_t) (value < 0 ? value - 0.5 : value + 0.5);
+	}
+	dtmf_sine_table_built = TRUE;
+}
+
+
 MPF_DECLARE(struct mpf_dtmf_generator_t *) mpf_dtmf_generator_create_ex(
 								const struct mpf_audio_stream_t *stream,
 								enum mpf_dtmf_generator_band_e band,
@@ -139,6 +172,9 @@ MPF_DECLARE(struct mpf_dtmf_generator_t *) mpf_dtmf_generator_create_ex(
 	if (!stream->rx_event_descriptor) flg_band &= ~MPF_DTMF_GENERATOR_OUTBAND;
 	if (!flg_band) return NULL;
 
+	/* Normally done once at engine start; cheap no-op otherwise */
+	mpf_dtmf_generator_tables_init();
+
 	gen = apr_palloc(pool, sizeof(struct mpf_dtmf_generator_t));
 	if (!gen) return NULL;
 	status = apr_thread_mutex_create(&gen->mutex, APR_THREAD_MUTEX_DEFAULT, pool);
@@ -218,17 +254,12 @@ MPF_DECLARE(apt_bool_t) mpf_dtmf_generator_put_frame(
 			generator->new_segment = FALSE;
 			/* Initialize tone generator */
 			if (generator->band & MPF_DTMF_GENERATOR_INBAND) {
-				double omega;
-
-				omega = 2 * M_PI * dtmf_freq[generator->event_id][0] / generator->sample_rate_audio;
-				generator->sine1.s1 = 0;
-				generator->sine1.s2 = DTMF_SINE_AMPLITUDE * sin(omega);
-				generator->sine1.coef = 2 * cos(omega);
-
-				omega = 2 * M_PI * dtmf_freq[generator->event_id][1] / generator->sample_rate_audio;
-				generator->sine2.s1 = 0;
-				generator->sine2.s2 = DTMF_SINE_AMPLITUDE * sin(omega);
-				generator->sine2.coef = 2 * cos(omega);
+				generator->sine1.phase = 0;
+				generator->sine1.step = dtmf_sine_step_calculate(
+					dtmf_freq[generator->event_id][0], generator->sample_rate_audio);
+				generator->sine2.phase = 0;
+				generator->sine2.step = dtmf_sine_step_calculate(
+					dtmf_freq[generator->event_id][1], generator->sample_rate_audio);
 			}
 		}
 	}
@@ -241,19 +272,22 @@ MPF_DECLARE(apt_bool_t) mpf_dtmf_generator_put_frame(
 		if (generator->band & MPF_DTMF_GENERATOR_INBAND) {
 			apr_size_t i;
 			apr_int16_t *samples = (apr_int16_t *) frame->codec_frame.buffer;
-			double s;
+			apr_size_t count = frame->codec_frame.size / 2;
+			apr_uint32_t phase1 = generator->sine1.phase;
+			apr_uint32_t phase2 = generator->sine2.phase;
+			const apr_uint32_t step1 = generator->sine1.step;
+			const apr_uint32_t step2 = generator->sine2.step;
 
 			frame->type |= MEDIA_FRAME_TYPE_AUDIO;
-			/* Tone generator */
-			for (i = 0; i < frame->codec_frame.size / 2; i++) {
-				s = generator->sine1.s1;
-				generator->sine1.s1 = generator->sine1.s2;
-				generator->sine1.s2 = generator->sine1.coef * generator->sine1.s1 - s;
-				samples[i] = (apr_int16_t) (s + generator->sine2.s1);
-				s = generator->sine2.s1;
-				generator->sine2.s1 = generator->sine2.s2;
-				generator->sine2.s2 = generator->sine2.coef * generator->sine2.s1 - s;
+			/* Tone generator: two table lookups per sample, the phase carries over frames */
+			for (i = 0; i < count; i++) {
+				samples[i] = (apr_int16_t) (dtmf_sine_table[phase1 >> DTMF_SINE_PHASE_SHIFT] +
+					dtmf_sine_table[phase2 >> DTMF_SINE_PHASE_SHIFT]);
+				phase1 += step1;
+				phase2 += step2;
 			}
+			generator->sine1.phase = phase1;
+			generator->sine2.phase = phase2;
 		}
 		if (generator->band & MPF_DTMF_GENERATOR_OUTBAND) {
 			generator->since_last_event += CODEC_FRAME_TIME_BASE;
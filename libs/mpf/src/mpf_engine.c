@@ -21,6 +21,7 @@
 #include "mpf_scheduler.h"
 #include "mpf_codec_descriptor.h"
 #include "mpf_codec_manager.h"
+#include "mpf_dtmf_generator.h"
 #include "apt_obj_list.h"
 #include "apt_cyclic_queue.h"
 #include "apt_log.h"
@@ -63,7 +64,7 @@ MPF_DECLARE(mpf_engine_t*) mpf_engine_create(const char *id, apr_pool_t *pool)
 	engine->context_factory = NULL;
 	engine->codec_manager = NULL;
 
-	msg_pool = apt_task_msg_pool_create_dynamic(sizeof(mpf_message_container_t),pool);
+	msg_pool = apt_task_msg_pool_create_static(sizeof(mpf_message_container_t),APT_TASK_MSG_POOL_DEFAULT_SIZE,pool);
 
 	apt_log(MPF_LOG_MARK,APT_PRIO_NOTICE,"Create Media Engine [%s]",id);
 	engine->task = apt_task_create(engine,msg_pool,pool);
@@ -73,6 +74,9 @@ MPF_DECLARE(mpf_engine_t*) mpf_engine_create(const char *id, apr_pool_t *pool)
 
 	apt_task_name_set(engine->task,id);
 
+	/* build tone tables up front, so that generators never compute waveforms */
+	mpf_dtmf_generator_tables_init();
+
 	vtable = apt_task_vtable_get(engine->task);
 	if(vtable) {
 		vtable->destroy = mpf_engine_destroy;
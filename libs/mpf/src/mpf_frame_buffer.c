@@ -15,17 +15,25 @@
  */
 
 #include "mpf_frame_buffer.h"
+#include "apt_atomic.h"
 
+/**
+ * Positions are free-running and wrap around at 2^32. In the SPSC mode the writer
+ * owns write_pos and discard_pos, the reader owns read_pos, and each side publishes
+ * its position with a release store after it is done with the frame.
+ */
 struct mpf_frame_buffer_t {
-	apr_byte_t         *raw_data;
-	mpf_frame_t        *frames;
-	apr_size_t          frame_count;
-	apr_size_t          frame_size;
+	apr_byte_t            *raw_data;
+	mpf_frame_t           *frames;
+	apr_size_t             frame_count;
+	apr_size_t             frame_size;
 
-	apr_size_t          write_pos;
-	apr_size_t          read_pos;
+	volatile apr_uint32_t  write_pos;
+	volatile apr_uint32_t  read_pos;
+	/** Write position the reader should skip to (SPSC mode restart) */
+	volatile apr_uint32_t  discard_pos;
 
-	apr_thread_mutex_t *guard;
+	apr_thread_mutex_t    *guard;
 	apr_pool_t         *pool;
 
 #ifdef MPF_FRAME_BUFFER_DEBUG
@@ -36,6 +44,11 @@ struct mpf_frame_buffer_t {
 
 
 mpf_frame_buffer_t* mpf_frame_buffer_create(apr_size_t frame_size, apr_size_t frame_count, apr_pool_t *pool)
+{
+	return mpf_frame_buffer_create_ex(frame_size,frame_count,MPF_FRAME_BUFFER_LOCKED,pool);
+}
+
+mpf_frame_buffer_t* mpf_frame_buffer_create_ex(apr_size_t frame_size, apr_size_t frame_count, mpf_frame_buffer_mode_e mode, apr_pool_t *pool)
 {
 	apr_size_t i;
 	mpf_frame_t *frame;
@@ -53,8 +66,11 @@ mpf_frame_buffer_t* mpf_frame_buffer_create(apr_size_t frame_size, apr_size_t fr
 		frame->codec_frame.buffer = buffer->raw_data + i*buffer->frame_size;
 	}
 
-	buffer->write_pos = buffer->read_pos = 0;
-	apr_thread_mutex_create(&buffer->guard,APR_THREAD_MUTEX_UNNESTED,pool);
+	buffer->write_pos = buffer->read_pos = buffer->discard_pos = 0;
+	buffer->guard = NULL;
+	if(mode == MPF_FRAME_BUFFER_LOCKED) {
+		apr_thread_mutex_create(&buffer->guard,APR_THREAD_MUTEX_UNNESTED,pool);
+	}
 
 #ifdef MPF_FRAME_BUFFER_DEBUG
 	buffer->utt_in = NULL;
@@ -103,7 +119,15 @@ void mpf_frame_buffer_destroy(mpf_frame_buffer_t *buffer)
 
 apt_bool_t mpf_frame_buffer_restart(mpf_frame_buffer_t *buffer)
 {
+	if(!buffer->guard) {
+		/* the reader skips the frames written so far, on the next read */
+		apt_atomic_store32_release(&buffer->discard_pos,buffer->write_pos);
+		return TRUE;
+	}
+
+	apr_thread_mutex_lock(buffer->guard);
 	buffer->write_pos = buffer->read_pos;
+	apr_thread_mutex_unlock(buffer->guard);
 	return TRUE;
 }
 
@@ -118,6 +142,8 @@ apt_bool_t mpf_frame_buffer_write(mpf_frame_buffer_t *buffer, const mpf_frame_t
 	mpf_frame_t *write_frame;
 	void *data = frame->codec_frame.buffer;
 	apr_size_t size = frame->codec_frame.size;
+	apr_uint32_t write_pos;
+	apr_uint32_t read_pos;
 
 #ifdef MPF_FRAME_BUFFER_DEBUG
 	if(buffer->utt_in) {
@@ -125,9 +151,13 @@ apt_bool_t mpf_frame_buffer_write(mpf_frame_buffer_t *buffer, const mpf_frame_t
 	}
 #endif
 
-	apr_thread_mutex_lock(buffer->guard);
-	while(buffer->write_pos - buffer->read_pos < buffer->frame_count && size >= buffer->frame_size) {
-		write_frame = mpf_frame_buffer_frame_get(buffer,buffer->write_pos);
+	if(buffer->guard) {
+		apr_thread_mutex_lock(buffer->guard);
+	}
+	write_pos = buffer->write_pos;
+	read_pos = apt_atomic_load32_acquire(&buffer->read_pos);
+	while(write_pos - read_pos < buffer->frame_count && size >= buffer->frame_size) {
+		write_frame = mpf_frame_buffer_frame_get(buffer,write_pos);
 		write_frame->type = frame->type;
 		write_frame->codec_frame.size = buffer->frame_size;
 		memcpy(
@@ -137,20 +167,39 @@ apt_bool_t mpf_frame_buffer_write(mpf_frame_buffer_t *buffer, const mpf_frame_t
 
 		data = (char*)data + buffer->frame_size;
 		size -= buffer->frame_size;
-		buffer->write_pos ++;
+		write_pos ++;
 	}
+	/* publish all the frames written at once */
+	apt_atomic_store32_release(&buffer->write_pos,write_pos);
 
-	apr_thread_mutex_unlock(buffer->guard);
+	if(buffer->guard) {
+		apr_thread_mutex_unlock(buffer->guard);
+	}
 	/* if size != 0 => non frame alligned or buffer is full */
 	return size == 0 ? TRUE : FALSE;
 }
 
 apt_bool_t mpf_frame_buffer_read(mpf_frame_buffer_t *buffer, mpf_frame_t *media_frame)
 {
-	apr_thread_mutex_lock(buffer->guard);
-	if(buffer->write_pos > buffer->read_pos) {
+	apr_uint32_t write_pos;
+	apr_uint32_t read_pos;
+
+	if(buffer->guard) {
+		apr_thread_mutex_lock(buffer->guard);
+	}
+	write_pos = apt_atomic_load32_acquire(&buffer->write_pos);
+	read_pos = buffer->read_pos;
+	if(!buffer->guard) {
+		apr_uint32_t discard_pos = apt_atomic_load32_acquire(&buffer->discard_pos);
+		if(discard_pos - read_pos <= write_pos - read_pos) {
+			/* restart requested, drop the frames preceding the request */
+			read_pos = discard_pos;
+		}
+	}
+
+	if(write_pos != read_pos) {
 		/* normal read */
-		mpf_frame_t *src_media_frame = mpf_frame_buffer_frame_get(buffer,buffer->read_pos);
+		mpf_frame_t *src_media_frame = mpf_frame_buffer_frame_get(buffer,read_pos);
 		media_frame->type = src_media_frame->type;
 		media_frame->marker = src_media_frame->marker;
 		if(media_frame->type & MEDIA_FRAME_TYPE_AUDIO) {
@@ -170,13 +219,18 @@ apt_bool_t mpf_frame_buffer_read(mpf_frame_buffer_t *buffer, mpf_frame_t *media_
 		}
 		src_media_frame->type = MEDIA_FRAME_TYPE_NONE;
 		src_media_frame->marker = MPF_MARKER_NONE;
-		buffer->read_pos ++;
+		read_pos ++;
 	}
 	else {
 		/* underflow */
 		media_frame->type = MEDIA_FRAME_TYPE_NONE;
 		media_frame->marker = MPF_MARKER_NONE;
 	}
-	apr_thread_mutex_unlock(buffer->guard);
+	/* hand the frame back to the writer */
+	apt_atomic_store32_release(&buffer->read_pos,read_pos);
+
+	if(buffer->guard) {
+		apr_thread_mutex_unlock(buffer->guard);
+	}
 	return TRUE;
 }
@@ -19,8 +19,12 @@
 #include "mpf_decoder.h"
 #include "mpf_resampler.h"
 #include "mpf_codec_manager.h"
+#include "apt_simd.h"
 #include "apt_log.h"
 
+/** Min number of sources to accumulate samples in 32-bit lanes and saturate once */
+#define MPF_MIXER_ACCUMULATOR_MIN_SOURCES 3
+
 typedef struct mpf_mixer_t mpf_mixer_t;
 
 /** MPF mixer derived from MPF object */
@@ -38,48 +42,188 @@ struct mpf_mixer_t {
 	mpf_frame_t          frame;
 	/** Mixed frame to write to audio sink */
 	mpf_frame_t          mix_frame;
+	/** Accumulator of samples (used if number of sources is large enough) */
+	apr_int32_t         *accumulator;
 };
 
-static apt_bool_t mpf_frames_mix(mpf_frame_t *mix_frame, const mpf_frame_t *frame)
+static APR_INLINE apr_int16_t mpf_sample_saturate(apr_int32_t sample)
 {
-	apr_size_t i;
-	apr_int16_t *mix_buf = mix_frame->codec_frame.buffer;
-	const apr_int16_t *buf = frame->codec_frame.buffer;
-	apr_size_t samples = frame->codec_frame.size / sizeof(apr_int16_t);
+	if(sample > 32767) {
+		return 32767;
+	}
+	if(sample < -32768) {
+		return -32768;
+	}
+	return (apr_int16_t)sample;
+}
 
-	if(mix_frame->codec_frame.size != frame->codec_frame.size) {
-		return FALSE;
+/** Add samples with saturation (mix_buf += buf) */
+static void mpf_samples_saturate_add(apr_int16_t *mix_buf, const apr_int16_t *buf, apr_size_t samples)
+{
+	apr_size_t i = 0;
+#if defined(APT_SIMD_AVX2)
+	for(; i + 16 <= samples; i += 16) {
+		__m256i x = _mm256_loadu_si256((const __m256i*)(mix_buf + i));
+		__m256i y = _mm256_loadu_si256((const __m256i*)(buf + i));
+		_mm256_storeu_si256((__m256i*)(mix_buf + i),_mm256_adds_epi16(x,y));
 	}
+#endif
+#if defined(APT_SIMD_SSE2)
+	for(; i + 8 <= samples; i += 8) {
+		__m128i x = _mm_loadu_si128((const __m128i*)(mix_buf + i));
+		__m128i y = _mm_loadu_si128((const __m128i*)(buf + i));
+		_mm_storeu_si128((__m128i*)(mix_buf + i),_mm_adds_epi16(x,y));
+	}
+#elif defined(APT_SIMD_NEON)
+	for(; i + 8 <= samples; i += 8) {
+		vst1q_s16(mix_buf + i,vqaddq_s16(vld1q_s16(mix_buf + i),vld1q_s16(buf + i)));
+	}
+#endif
+	for(; i < samples; i++) {
+		mix_buf[i] = mpf_sample_saturate((apr_int32_t)mix_buf[i] + buf[i]);
+	}
+}
 
-	if((frame->type & MEDIA_FRAME_TYPE_AUDIO) == MEDIA_FRAME_TYPE_AUDIO) {
-		for(i=0; i<samples; i++) {
-			/* overflow MUST be considered */
-			mix_buf[i] = mix_buf[i] + buf[i];
-		}
-		mix_frame->type |= MEDIA_FRAME_TYPE_AUDIO;
+/** Widen samples to 32-bit lanes (acc = buf) */
+static void mpf_samples_widen(apr_int32_t *acc, const apr_int16_t *buf, apr_size_t samples)
+{
+	apr_size_t i = 0;
+#if defined(APT_SIMD_AVX2)
+	for(; i + 8 <= samples; i += 8) {
+		__m256i x = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(buf + i)));
+		_mm256_storeu_si256((__m256i*)(acc + i),x);
 	}
+#endif
+#if defined(APT_SIMD_SSE2)
+	for(; i + 8 <= samples; i += 8) {
+		__m128i x = _mm_loadu_si128((const __m128i*)(buf + i));
+		_mm_storeu_si128((__m128i*)(acc + i),_mm_srai_epi32(_mm_unpacklo_epi16(x,x),16));
+		_mm_storeu_si128((__m128i*)(acc + i + 4),_mm_srai_epi32(_mm_unpackhi_epi16(x,x),16));
+	}
+#elif defined(APT_SIMD_NEON)
+	for(; i + 8 <= samples; i += 8) {
+		int16x8_t x = vld1q_s16(buf + i);
+		vst1q_s32(acc + i,vmovl_s16(vget_low_s16(x)));
+		vst1q_s32(acc + i + 4,vmovl_s16(vget_high_s16(x)));
+	}
+#endif
+	for(; i < samples; i++) {
+		acc[i] = buf[i];
+	}
+}
 
-	return TRUE;
+/** Accumulate samples in 32-bit lanes (acc += buf) */
+static void mpf_samples_accumulate(apr_int32_t *acc, const apr_int16_t *buf, apr_size_t samples)
+{
+	apr_size_t i = 0;
+#if defined(APT_SIMD_AVX2)
+	for(; i + 8 <= samples; i += 8) {
+		__m256i x = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(buf + i)));
+		__m256i a = _mm256_loadu_si256((const __m256i*)(acc + i));
+		_mm256_storeu_si256((__m256i*)(acc + i),_mm256_add_epi32(a,x));
+	}
+#endif
+#if defined(APT_SIMD_SSE2)
+	for(; i + 8 <= samples; i += 8) {
+		__m128i x = _mm_loadu_si128((const __m128i*)(buf + i));
+		__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x,x),16);
+		__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x,x),16);
+		_mm_storeu_si128((__m128i*)(acc + i),_mm_add_epi32(_mm_loadu_si128((const __m128i*)(acc + i)),lo));
+		_mm_storeu_si128((__m128i*)(acc + i + 4),_mm_add_epi32(_mm_loadu_si128((const __m128i*)(acc + i + 4)),hi));
+	}
+#elif defined(APT_SIMD_NEON)
+	for(; i + 8 <= samples; i += 8) {
+		int16x8_t x = vld1q_s16(buf + i);
+		vst1q_s32(acc + i,vaddw_s16(vld1q_s32(acc + i),vget_low_s16(x)));
+		vst1q_s32(acc + i + 4,vaddw_s16(vld1q_s32(acc + i + 4),vget_high_s16(x)));
+	}
+#endif
+	for(; i < samples; i++) {
+		acc[i] += buf[i];
+	}
+}
+
+/** Narrow accumulated samples with saturation (mix_buf = acc) */
+static void mpf_samples_saturate_narrow(apr_int16_t *mix_buf, const apr_int32_t *acc, apr_size_t samples)
+{
+	apr_size_t i = 0;
+#if defined(APT_SIMD_AVX2)
+	for(; i + 16 <= samples; i += 16) {
+		__m256i lo = _mm256_loadu_si256((const __m256i*)(acc + i));
+		__m256i hi = _mm256_loadu_si256((const __m256i*)(acc + i + 8));
+		/* packs operates within 128-bit lanes, restore the order of 64-bit quarters */
+		__m256i x = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo,hi),0xD8);
+		_mm256_storeu_si256((__m256i*)(mix_buf + i),x);
+	}
+#endif
+#if defined(APT_SIMD_SSE2)
+	for(; i + 8 <= samples; i += 8) {
+		__m128i lo = _mm_loadu_si128((const __m128i*)(acc + i));
+		__m128i hi = _mm_loadu_si128((const __m128i*)(acc + i + 4));
+		_mm_storeu_si128((__m128i*)(mix_buf + i),_mm_packs_epi32(lo,hi));
+	}
+#elif defined(APT_SIMD_NEON)
+	for(; i + 8 <= samples; i += 8) {
+		int16x8_t x = vcombine_s16(vqmovn_s32(vld1q_s32(acc + i)),vqmovn_s32(vld1q_s32(acc + i + 4)));
+		vst1q_s16(mix_buf + i,x);
+	}
+#endif
+	for(; i < samples; i++) {
+		mix_buf[i] = mpf_sample_saturate(acc[i]);
+	}
 }
 
 static apt_bool_t mpf_mixer_process(mpf_object_t *object)
 {
 	apr_size_t i;
+	apr_size_t mixed = 0;
+	apr_size_t samples;
+	mpf_frame_t *frame;
 	mpf_audio_stream_t *source;
 	mpf_mixer_t *mixer = (mpf_mixer_t*) object;
+	apr_int16_t *mix_buf = mixer->mix_frame.codec_frame.buffer;
 
-	mixer->mix_frame.type = MEDIA_FRAME_TYPE_NONE;
-	mixer->mix_frame.marker = MPF_MARKER_NONE;
-	memset(mixer->mix_frame.codec_frame.buffer,0,mixer->mix_frame.codec_frame.size);
+	samples = mixer->mix_frame.codec_frame.size / sizeof(apr_int16_t);
 	for(i=0; i<mixer->source_count; i++) {
 		source = mixer->source_arr[i];
-		if(source) {
-			mixer->frame.type = MEDIA_FRAME_TYPE_NONE;
-			mixer->frame.marker = MPF_MARKER_NONE;
-			source->vtable->read_frame(source,&mixer->frame);
-			mpf_frames_mix(&mixer->mix_frame,&mixer->frame);
+		if(!source) {
+			continue;
+		}
+
+		/* the first frame containing audio is read directly into the mixed frame */
+		frame = mixed ? &mixer->frame : &mixer->mix_frame;
+		frame->type = MEDIA_FRAME_TYPE_NONE;
+		frame->marker = MPF_MARKER_NONE;
+		source->vtable->read_frame(source,frame);
+		if((frame->type & MEDIA_FRAME_TYPE_AUDIO) != MEDIA_FRAME_TYPE_AUDIO ||
+			frame->codec_frame.size != mixer->mix_frame.codec_frame.size) {
+			continue;
+		}
+
+		if(mixed) {
+			if(mixer->accumulator) {
+				if(mixed == 1) {
+					mpf_samples_widen(mixer->accumulator,mix_buf,samples);
+				}
+				mpf_samples_accumulate(mixer->accumulator,frame->codec_frame.buffer,samples);
+			}
+			else {
+				mpf_samples_saturate_add(mix_buf,frame->codec_frame.buffer,samples);
+			}
 		}
+		mixed++;
 	}
+
+	if(!mixed) {
+		/* none of the sources provided audio, generate silence */
+		memset(mix_buf,0,mixer->mix_frame.codec_frame.size);
+	}
+	else if(mixed > 1 && mixer->accumulator) {
+		mpf_samples_saturate_narrow(mix_buf,mixer->accumulator,samples);
+	}
+
+	mixer->mix_frame.type = mixed ? MEDIA_FRAME_TYPE_AUDIO : MEDIA_FRAME_TYPE_NONE;
+	mixer->mix_frame.marker = MPF_MARKER_NONE;
 	mixer->sink->vtable->write_frame(mixer->sink,&mixer->mix_frame);
 	return TRUE;
 }
@@ -154,6 +298,7 @@ MPF_DECLARE(mpf_object_t*) mpf_mixer_create(
 	mixer->source_arr = NULL;
 	mixer->source_count = 0;
 	mixer->sink = NULL;
+	mixer->accumulator = NULL;
 	mpf_object_init(&mixer->base,name);
 	mixer->base.process = mpf_mixer_process;
 	mixer->base.destroy = mpf_mixer_destroy;
@@ -204,5 +349,9 @@ MPF_DECLARE(mpf_object_t*) mpf_mixer_create(
 	mixer->frame.codec_frame.buffer = apr_palloc(pool,frame_size);
 	mixer->mix_frame.codec_frame.size = frame_size;
 	mixer->mix_frame.codec_frame.buffer = apr_palloc(pool,frame_size);
+	if(source_count >= MPF_MIXER_ACCUMULATOR_MIN_SOURCES) {
+		/* accumulate samples in 32-bit lanes and saturate once rather than per each source */
+		mixer->accumulator = apr_palloc(pool,frame_size / sizeof(apr_int16_t) * sizeof(apr_int32_t));
+	}
 	return &mixer->base;
 }
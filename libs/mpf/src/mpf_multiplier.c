@@ -15,13 +15,22 @@
  */
 
 #include "mpf_multiplier.h"
-#include "mpf_encoder.h"
-#include "mpf_decoder.h"
-#include "mpf_resampler.h"
+#include "mpf_stream.h"
 #include "mpf_codec_manager.h"
 #include "apt_log.h"
 
 typedef struct mpf_multiplier_t mpf_multiplier_t;
+typedef struct mpf_shared_frame_t mpf_shared_frame_t;
+
+/** Media frame shared (by reference) by the sinks of the same codec */
+struct mpf_shared_frame_t {
+	/** Codec the frame is encoded with (NULL for linear PCM) */
+	mpf_codec_t                  *codec;
+	/** Codec descriptor of the frame */
+	mpf_codec_descriptor_t       *descriptor;
+	/** Media frame */
+	mpf_frame_t                   frame;
+};
 
 /** MPF multiplier derived from MPF object */
 struct mpf_multiplier_t {
@@ -31,33 +40,83 @@ struct mpf_multiplier_t {
 	mpf_audio_stream_t  *source;
 	/** Array of audio sinks */
 	mpf_audio_stream_t **sink_arr;
+	/** Array of frames to write to audio sinks (a frame per sink) */
+	mpf_shared_frame_t **sink_frame_arr;
 	/** Number of audio sinks */
 	apr_size_t           sink_count;
 
-	/** Media frame used to read data from source and write it to sinks */
-	mpf_frame_t          frame;
+	/** Media frame used to read data from source (encoded unless source is linear) */
+	mpf_shared_frame_t   source_frame;
+	/** Linear frame decoded from the source frame (the source frame itself, if source is linear) */
+	mpf_shared_frame_t  *linear_frame;
+	/** Indicates whether the linear frame is referenced by sinks */
+	apt_bool_t           linear_frame_used;
+	/** Array of frames encoded from the linear frame (mpf_shared_frame_t*) */
+	apr_array_header_t  *encoded_frame_arr;
 };
 
+static APR_INLINE void mpf_shared_frame_header_copy(mpf_frame_t *frame, const mpf_frame_t *src_frame)
+{
+	frame->type = src_frame->type;
+	frame->marker = src_frame->marker;
+	if((src_frame->type & MEDIA_FRAME_TYPE_EVENT) == MEDIA_FRAME_TYPE_EVENT) {
+		frame->event_frame = src_frame->event_frame;
+	}
+}
+
 static apt_bool_t mpf_multiplier_process(mpf_object_t *object)
 {
+	int j;
 	apr_size_t i;
 	mpf_audio_stream_t *sink;
+	mpf_shared_frame_t *encoded_frame;
 	mpf_multiplier_t *multiplier = (mpf_multiplier_t*) object;
+	mpf_shared_frame_t *source_frame = &multiplier->source_frame;
+	mpf_shared_frame_t *linear_frame = multiplier->linear_frame;
+
+	source_frame->frame.type = MEDIA_FRAME_TYPE_NONE;
+	source_frame->frame.marker = MPF_MARKER_NONE;
+	multiplier->source->vtable->read_frame(multiplier->source,&source_frame->frame);
 
-	multiplier->frame.type = MEDIA_FRAME_TYPE_NONE;
-	multiplier->frame.marker = MPF_MARKER_NONE;
-	multiplier->source->vtable->read_frame(multiplier->source,&multiplier->frame);
-	
-	if((multiplier->frame.type & MEDIA_FRAME_TYPE_AUDIO) == 0) {
-		memset(	multiplier->frame.codec_frame.buffer,
-				0,
-				multiplier->frame.codec_frame.size);
+	if((source_frame->frame.type & MEDIA_FRAME_TYPE_AUDIO) == 0) {
+		if(source_frame->codec) {
+			/* generate silence frame */
+			mpf_codec_initialize(source_frame->codec,&source_frame->frame.codec_frame);
+		}
+		else {
+			memset(	source_frame->frame.codec_frame.buffer,
+					0,
+					source_frame->frame.codec_frame.size);
+		}
 	}
 
+	if(linear_frame != source_frame && multiplier->linear_frame_used == TRUE) {
+		/* decode once for all the sinks */
+		mpf_shared_frame_header_copy(&linear_frame->frame,&source_frame->frame);
+		if((source_frame->frame.type & MEDIA_FRAME_TYPE_AUDIO) == MEDIA_FRAME_TYPE_AUDIO) {
+			mpf_codec_decode(source_frame->codec,&source_frame->frame.codec_frame,&linear_frame->frame.codec_frame);
+		}
+		else {
+			memset(	linear_frame->frame.codec_frame.buffer,
+					0,
+					linear_frame->frame.codec_frame.size);
+		}
+	}
+
+	for(j=0; j<multiplier->encoded_frame_arr->nelts; j++) {
+		/* encode once for all the sinks of the same codec */
+		encoded_frame = APR_ARRAY_IDX(multiplier->encoded_frame_arr,j,mpf_shared_frame_t*);
+		mpf_shared_frame_header_copy(&encoded_frame->frame,&linear_frame->frame);
+		if((linear_frame->frame.type & MEDIA_FRAME_TYPE_AUDIO) == MEDIA_FRAME_TYPE_AUDIO) {
+			mpf_codec_encode(encoded_frame->codec,&linear_frame->frame.codec_frame,&encoded_frame->frame.codec_frame);
+		}
+	}
+
+	/* sinks get read-only frames by reference, no data is copied */
 	for(i=0; i<multiplier->sink_count; i++)	{
 		sink = multiplier->sink_arr[i];
 		if(sink) {
-			sink->vtable->write_frame(sink,&multiplier->frame);
+			sink->vtable->write_frame(sink,&multiplier->sink_frame_arr[i]->frame);
 		}
 	}
 	return TRUE;
@@ -65,18 +124,27 @@ static apt_bool_t mpf_multiplier_process(mpf_object_t *object)
 
 static apt_bool_t mpf_multiplier_destroy(mpf_object_t *object)
 {
+	int j;
 	apr_size_t i;
 	mpf_audio_stream_t *sink;
+	mpf_shared_frame_t *encoded_frame;
 	mpf_multiplier_t *multiplier = (mpf_multiplier_t*) object;
 
 	apt_log(MPF_LOG_MARK,APT_PRIO_DEBUG,"Destroy Multiplier %s",object->name);
 	mpf_audio_stream_rx_close(multiplier->source);
+	if(multiplier->linear_frame != &multiplier->source_frame && multiplier->linear_frame_used == TRUE) {
+		mpf_codec_close(multiplier->source_frame.codec);
+	}
 	for(i=0; i<multiplier->sink_count; i++)	{
 		sink = multiplier->sink_arr[i];
 		if(sink) {
 			mpf_audio_stream_tx_close(sink);
 		}
 	}
+	for(j=0; j<multiplier->encoded_frame_arr->nelts; j++) {
+		encoded_frame = APR_ARRAY_IDX(multiplier->encoded_frame_arr,j,mpf_shared_frame_t*);
+		mpf_codec_close(encoded_frame->codec);
+	}
 	return TRUE;
 }
 
@@ -85,6 +153,7 @@ static void mpf_multiplier_trace(mpf_object_t *object)
 	mpf_multiplier_t *multiplier = (mpf_multiplier_t*) object;
 	apr_size_t i;
 	mpf_audio_stream_t *sink;
+	mpf_shared_frame_t *sink_frame;
 	char buf[2048];
 	apr_size_t offset;
 
@@ -92,7 +161,12 @@ static void mpf_multiplier_trace(mpf_object_t *object)
 	apt_text_stream_init(&output,buf,sizeof(buf)-1);
 
 	mpf_audio_stream_trace(multiplier->source,STREAM_DIRECTION_RECEIVE,&output);
-	
+	if(multiplier->linear_frame != &multiplier->source_frame && multiplier->linear_frame_used == TRUE) {
+		offset = output.pos - output.text.buf;
+		output.pos += apr_snprintf(output.pos, output.text.length - offset,
+			"->Decoder");
+	}
+
 	offset = output.pos - output.text.buf;
 	output.pos += apr_snprintf(output.pos, output.text.length - offset,
 		"->Multiplier->");
@@ -100,6 +174,12 @@ static void mpf_multiplier_trace(mpf_object_t *object)
 	for(i=0; i<multiplier->sink_count; i++)	{
 		sink = multiplier->sink_arr[i];
 		if(sink) {
+			sink_frame = multiplier->sink_frame_arr[i];
+			if(sink_frame->codec && sink_frame != &multiplier->source_frame) {
+				offset = output.pos - output.text.buf;
+				output.pos += apr_snprintf(output.pos, output.text.length - offset,
+					"Encoder->");
+			}
 			mpf_audio_stream_trace(sink,STREAM_DIRECTION_SEND,&output);
 			apt_text_char_insert(&output,';');
 		}
@@ -111,6 +191,61 @@ static void mpf_multiplier_trace(mpf_object_t *object)
 		output.text.buf);
 }
 
+static void mpf_shared_frame_init(mpf_shared_frame_t *shared_frame, mpf_codec_t *codec, mpf_codec_descriptor_t *descriptor, apr_pool_t *pool)
+{
+	apr_size_t frame_size;
+	if(codec) {
+		frame_size = mpf_codec_frame_size_calculate(descriptor,codec->attribs);
+	}
+	else {
+		frame_size = mpf_codec_linear_frame_size_calculate(descriptor->sampling_rate,descriptor->channel_count);
+	}
+	shared_frame->codec = codec;
+	shared_frame->descriptor = descriptor;
+	shared_frame->frame.type = MEDIA_FRAME_TYPE_NONE;
+	shared_frame->frame.marker = MPF_MARKER_NONE;
+	shared_frame->frame.codec_frame.size = frame_size;
+	shared_frame->frame.codec_frame.buffer = apr_palloc(pool,frame_size);
+}
+
+/** Find or create the frame to write to the sink of the specified codec descriptor */
+static mpf_shared_frame_t* mpf_multiplier_sink_frame_get(mpf_multiplier_t *multiplier, mpf_codec_descriptor_t *descriptor, const mpf_codec_manager_t *codec_manager, apr_pool_t *pool)
+{
+	int j;
+	mpf_codec_t *codec;
+	mpf_shared_frame_t *encoded_frame;
+	mpf_shared_frame_t *source_frame = &multiplier->source_frame;
+
+	if(source_frame->codec && mpf_codec_descriptors_match(source_frame->descriptor,descriptor) == TRUE) {
+		/* pass encoded source frame through */
+		return source_frame;
+	}
+
+	if(mpf_codec_lpcm_descriptor_match(descriptor) == FALSE) {
+		for(j=0; j<multiplier->encoded_frame_arr->nelts; j++) {
+			encoded_frame = APR_ARRAY_IDX(multiplier->encoded_frame_arr,j,mpf_shared_frame_t*);
+			if(mpf_codec_descriptors_match(encoded_frame->descriptor,descriptor) == TRUE) {
+				multiplier->linear_frame_used = TRUE;
+				return encoded_frame;
+			}
+		}
+
+		codec = mpf_codec_manager_codec_get(codec_manager,descriptor,pool);
+		if(codec) {
+			/* set encoder after multiplier */
+			encoded_frame = apr_palloc(pool,sizeof(mpf_shared_frame_t));
+			mpf_shared_frame_init(encoded_frame,codec,descriptor,pool);
+			mpf_codec_open(codec);
+			APR_ARRAY_PUSH(multiplier->encoded_frame_arr,mpf_shared_frame_t*) = encoded_frame;
+			multiplier->linear_frame_used = TRUE;
+			return encoded_frame;
+		}
+	}
+
+	multiplier->linear_frame_used = TRUE;
+	return multiplier->linear_frame;
+}
+
 MPF_DECLARE(mpf_object_t*) mpf_multiplier_create(
 								mpf_audio_stream_t *source,
 								mpf_audio_stream_t **sink_arr,
@@ -120,9 +255,10 @@ MPF_DECLARE(mpf_object_t*) mpf_multiplier_create(
 								apr_pool_t *pool)
 {
 	apr_size_t i;
-	apr_size_t frame_size;
+	mpf_codec_t *codec = NULL;
 	mpf_codec_descriptor_t *descriptor;
 	mpf_audio_stream_t *sink;
+	mpf_shared_frame_t *sink_frame;
 	mpf_multiplier_t *multiplier;
 	if(!source || !sink_arr || !sink_count) {
 		return NULL;
@@ -132,7 +268,11 @@ MPF_DECLARE(mpf_object_t*) mpf_multiplier_create(
 	multiplier = apr_palloc(pool,sizeof(mpf_multiplier_t));
 	multiplier->source = NULL;
 	multiplier->sink_arr = NULL;
+	multiplier->sink_frame_arr = NULL;
 	multiplier->sink_count = 0;
+	multiplier->linear_frame = NULL;
+	multiplier->linear_frame_used = FALSE;
+	multiplier->encoded_frame_arr = apr_array_make(pool,1,sizeof(mpf_shared_frame_t*));
 	mpf_object_init(&multiplier->base,name);
 	multiplier->base.process = mpf_multiplier_process;
 	multiplier->base.destroy = mpf_multiplier_destroy;
@@ -143,43 +283,45 @@ MPF_DECLARE(mpf_object_t*) mpf_multiplier_create(
 	}
 
 	descriptor = source->rx_descriptor;
-	if(descriptor && mpf_codec_lpcm_descriptor_match(descriptor) == FALSE) {
-		mpf_codec_t *codec = mpf_codec_manager_codec_get(codec_manager,descriptor,pool);
-		if(codec) {
-			/* set decoder before bridge */
-			mpf_audio_stream_t *decoder = mpf_decoder_create(source,codec,pool);
-			source = decoder;
-		}
+	if(mpf_codec_lpcm_descriptor_match(descriptor) == FALSE) {
+		codec = mpf_codec_manager_codec_get(codec_manager,descriptor,pool);
 	}
-	multiplier->source = source;
-	mpf_audio_stream_rx_open(source,NULL);
-	
+	mpf_shared_frame_init(&multiplier->source_frame,codec,descriptor,pool);
+	if(codec) {
+		/* decoder is set before multiplier, if any of the sinks needs linear frame */
+		multiplier->linear_frame = apr_palloc(pool,sizeof(mpf_shared_frame_t));
+		mpf_shared_frame_init(
+			multiplier->linear_frame,
+			NULL,
+			mpf_codec_lpcm_descriptor_create(descriptor->sampling_rate,descriptor->channel_count,pool),
+			pool);
+	}
+	else {
+		multiplier->linear_frame = &multiplier->source_frame;
+	}
+
+	multiplier->sink_frame_arr = apr_palloc(pool,sink_count * sizeof(mpf_shared_frame_t*));
 	for(i=0; i<sink_count; i++)	{
+		multiplier->sink_frame_arr[i] = NULL;
 		sink = sink_arr[i];
 		if(!sink) continue;
 
-		if(mpf_audio_stream_tx_validate(sink,NULL,NULL,pool) == FALSE) {
+		if(mpf_audio_stream_tx_validate(sink,source->rx_descriptor,source->rx_event_descriptor,pool) == FALSE) {
+			sink_arr[i] = NULL;
 			continue;
 		}
 
-		descriptor = sink->tx_descriptor;
-		if(descriptor && mpf_codec_lpcm_descriptor_match(descriptor) == FALSE) {
-			mpf_codec_t *codec = mpf_codec_manager_codec_get(codec_manager,descriptor,pool);
-			if(codec) {
-				/* set encoder after bridge */
-				mpf_audio_stream_t *encoder = mpf_encoder_create(sink,codec,pool);
-				sink = encoder;
-			}
-		}
-		sink_arr[i] = sink;
-		mpf_audio_stream_tx_open(sink,NULL);
+		sink_frame = mpf_multiplier_sink_frame_get(multiplier,sink->tx_descriptor,codec_manager,pool);
+		multiplier->sink_frame_arr[i] = sink_frame;
+		mpf_audio_stream_tx_open(sink,sink_frame->codec);
 	}
 	multiplier->sink_arr = sink_arr;
 	multiplier->sink_count = sink_count;
-	
-	descriptor = source->rx_descriptor;
-	frame_size = mpf_codec_linear_frame_size_calculate(descriptor->sampling_rate,descriptor->channel_count);
-	multiplier->frame.codec_frame.size = frame_size;
-	multiplier->frame.codec_frame.buffer = apr_palloc(pool,frame_size);
+
+	if(codec && multiplier->linear_frame_used == TRUE) {
+		mpf_codec_open(codec);
+	}
+	multiplier->source = source;
+	mpf_audio_stream_rx_open(source,codec);
 	return &multiplier->base;
 }
@@ -0,0 +1,254 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mpf_vad_backend.h"
+#include "mpf_codec_descriptor.h"
+#include "apt_log.h"
+#include "webrtc/common_audio/vad/include/webrtc_vad.h"
+
+/** Max number of registered backends (built-in and external) */
+#define MPF_VAD_BACKEND_MAX_COUNT 8
+
+/** Default aggressiveness mode of the WebRTC VAD */
+#define MPF_WEBRTC_VAD_DEFAULT_MODE 1
+/** Default average absolute level threshold of the energy backend */
+#define MPF_ENERGY_VAD_DEFAULT_LEVEL 30
+
+
+typedef struct mpf_energy_vad_t mpf_energy_vad_t;
+
+/** State of the energy backend */
+struct mpf_energy_vad_t {
+	/* average absolute level threshold */
+	apr_size_t level_threshold;
+};
+
+static mpf_vad_state_t* mpf_energy_vad_create(apr_pool_t *pool)
+{
+	mpf_energy_vad_t *vad = apr_palloc(pool,sizeof(mpf_energy_vad_t));
+	vad->level_threshold = MPF_ENERGY_VAD_DEFAULT_LEVEL;
+	return vad;
+}
+
+static apt_bool_t mpf_energy_vad_open(mpf_vad_state_t *state, apr_uint16_t sampling_rate)
+{
+	return TRUE;
+}
+
+static void mpf_energy_vad_reset(mpf_vad_state_t *state)
+{
+}
+
+static apt_bool_t mpf_energy_vad_param_set(mpf_vad_state_t *state, const char *name, apr_size_t value)
+{
+	mpf_energy_vad_t *vad = state;
+	if(apr_strnatcasecmp(name,MPF_VAD_PARAM_LEVEL) == 0) {
+		vad->level_threshold = value;
+		return TRUE;
+	}
+	return FALSE;
+}
+
+static apt_bool_t mpf_energy_vad_process(mpf_vad_state_t *state, const apr_int16_t *samples, apr_size_t count)
+{
+	mpf_energy_vad_t *vad = state;
+	apr_size_t sum = 0;
+	const apr_int16_t *cur = samples;
+	const apr_int16_t *end = cur + count;
+
+	if(!count) {
+		return FALSE;
+	}
+
+	for(; cur < end; cur++) {
+		if(*cur < 0) {
+			sum -= *cur;
+		}
+		else {
+			sum += *cur;
+		}
+	}
+
+	return (sum / count >= vad->level_threshold) ? TRUE : FALSE;
+}
+
+static const mpf_vad_backend_t mpf_energy_vad_backend = {
+	MPF_VAD_BACKEND_ENERGY,
+	mpf_energy_vad_create,
+	mpf_energy_vad_open,
+	mpf_energy_vad_reset,
+	mpf_energy_vad_param_set,
+	mpf_energy_vad_process
+};
+
+
+typedef struct mpf_webrtc_vad_t mpf_webrtc_vad_t;
+
+/** State of the WebRTC backend */
+struct mpf_webrtc_vad_t {
+	/* WebRTC VAD instance kept for the lifetime of the state */
+	VadInst     *inst;
+	/* aggressiveness mode */
+	int          mode;
+	/* sampling rate */
+	apr_uint16_t sampling_rate;
+	/* number of samples per analysis window (10 msec) */
+	apr_size_t   window_size;
+};
+
+static apr_status_t mpf_webrtc_vad_free(void *data)
+{
+	mpf_webrtc_vad_t *vad = data;
+	if(vad->inst) {
+		WebRtcVad_Free(vad->inst);
+		vad->inst = NULL;
+	}
+	return APR_SUCCESS;
+}
+
+static mpf_vad_state_t* mpf_webrtc_vad_create(apr_pool_t *pool)
+{
+	mpf_webrtc_vad_t *vad = apr_palloc(pool,sizeof(mpf_webrtc_vad_t));
+	vad->inst = NULL;
+	vad->mode = MPF_WEBRTC_VAD_DEFAULT_MODE;
+	vad->sampling_rate = 0;
+	vad->window_size = 0;
+	if(WebRtcVad_Create(&vad->inst) != 0) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"Failed to Create WebRTC VAD");
+		return NULL;
+	}
+	apr_pool_cleanup_register(pool,vad,mpf_webrtc_vad_free,apr_pool_cleanup_null);
+	return vad;
+}
+
+static apt_bool_t mpf_webrtc_vad_init(mpf_webrtc_vad_t *vad)
+{
+	if(WebRtcVad_Init(vad->inst) != 0 || WebRtcVad_set_mode(vad->inst,vad->mode) != 0) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"Failed to Initialize WebRTC VAD [mode %d]",vad->mode);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static apt_bool_t mpf_webrtc_vad_open(mpf_vad_state_t *state, apr_uint16_t sampling_rate)
+{
+	mpf_webrtc_vad_t *vad = state;
+	apr_size_t window_size = sampling_rate * CODEC_FRAME_TIME_BASE / 1000;
+	if(WebRtcVad_ValidRateAndFrameLength(sampling_rate,(int)window_size) != 0) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_NOTICE,"Unsupported WebRTC VAD Sampling Rate [%d]",sampling_rate);
+		return FALSE;
+	}
+	vad->sampling_rate = sampling_rate;
+	vad->window_size = window_size;
+	return mpf_webrtc_vad_init(vad);
+}
+
+static void mpf_webrtc_vad_reset(mpf_vad_state_t *state)
+{
+	mpf_webrtc_vad_t *vad = state;
+	if(vad->sampling_rate) {
+		mpf_webrtc_vad_init(vad);
+	}
+}
+
+static apt_bool_t mpf_webrtc_vad_param_set(mpf_vad_state_t *state, const char *name, apr_size_t value)
+{
+	mpf_webrtc_vad_t *vad = state;
+	if(apr_strnatcasecmp(name,MPF_VAD_PARAM_MODE) == 0) {
+		if(value > 3) {
+			return FALSE;
+		}
+		vad->mode = (int)value;
+		if(vad->sampling_rate) {
+			WebRtcVad_set_mode(vad->inst,vad->mode);
+		}
+		return TRUE;
+	}
+	return FALSE;
+}
+
+/** Run the VAD over the samples in 10 msec windows, return TRUE if any window is voiced */
+static apt_bool_t mpf_webrtc_vad_process(mpf_vad_state_t *state, const apr_int16_t *samples, apr_size_t count)
+{
+	mpf_webrtc_vad_t *vad = state;
+	const apr_int16_t *cur = samples;
+	const apr_int16_t *end = samples + count;
+	for(; cur + vad->window_size <= end; cur += vad->window_size) {
+		if(WebRtcVad_Process(vad->inst,vad->sampling_rate,cur,(int)vad->window_size) == 1) {
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+static const mpf_vad_backend_t mpf_webrtc_vad_backend = {
+	MPF_VAD_BACKEND_WEBRTC,
+	mpf_webrtc_vad_create,
+	mpf_webrtc_vad_open,
+	mpf_webrtc_vad_reset,
+	mpf_webrtc_vad_param_set,
+	mpf_webrtc_vad_process
+};
+
+
+/** Registered backends, built-in ones go first */
+static const mpf_vad_backend_t *mpf_vad_backends[MPF_VAD_BACKEND_MAX_COUNT] = {
+	&mpf_webrtc_vad_backend,
+	&mpf_energy_vad_backend
+};
+
+MPF_DECLARE(apt_bool_t) mpf_vad_backend_register(const mpf_vad_backend_t *backend)
+{
+	apr_size_t i;
+	if(!backend || !backend->name || !backend->create || !backend->open || !backend->process) {
+		return FALSE;
+	}
+	if(mpf_vad_backend_find(backend->name)) {
+		apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"VAD Backend [%s] Already Registered",backend->name);
+		return FALSE;
+	}
+	for(i=0; i<MPF_VAD_BACKEND_MAX_COUNT; i++) {
+		if(!mpf_vad_backends[i]) {
+			apt_log(MPF_LOG_MARK,APT_PRIO_INFO,"Register VAD Backend [%s]",backend->name);
+			mpf_vad_backends[i] = backend;
+			return TRUE;
+		}
+	}
+	apt_log(MPF_LOG_MARK,APT_PRIO_WARNING,"Failed to Register VAD Backend [%s]: too many backends",backend->name);
+	return FALSE;
+}
+
+MPF_DECLARE(const mpf_vad_backend_t*) mpf_vad_backend_find(const char *name)
+{
+	apr_size_t i;
+	if(!name) {
+		return NULL;
+	}
+	for(i=0; i<MPF_VAD_BACKEND_MAX_COUNT && mpf_vad_backends[i]; i++) {
+		if(apr_strnatcasecmp(mpf_vad_backends[i]->name,name) == 0) {
+			return mpf_vad_backends[i];
+		}
+	}
+	return NULL;
+}
+
+MPF_DECLARE(const mpf_vad_backend_t*) mpf_vad_backend_get(apr_size_t index)
+{
+	if(index >= MPF_VAD_BACKEND_MAX_COUNT) {
+		return NULL;
+	}
+	return mpf_vad_backends[index];
+}
@@ -62,7 +62,13 @@ mrcp_engine_channel_t* mrcp_engine_channel_create(
 					mpf_termination_t *termination,
 					apr_pool_t *pool);
 
-/** Create audio termination */
+/**
+ * Create audio termination.
+ * @remark Encoded codecs (e.g. PCMU, PCMA) listed in the capabilities are negotiated as is,
+ * and frames of a matching RTP stream are passed to the audio stream without transcoding.
+ * Use mrcp_engine_sink_stream_codec_get() or mrcp_engine_source_stream_codec_get() to find out
+ * the codec selected for the stream.
+ */
 mpf_termination_t* mrcp_engine_audio_termination_create(
 								void *obj,
 								const mpf_audio_stream_vtable_t *stream_vtable,
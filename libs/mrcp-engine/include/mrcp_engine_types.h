@@ -43,6 +43,8 @@ typedef struct mrcp_engine_channel_t mrcp_engine_channel_t;
 typedef struct mrcp_engine_channel_method_vtable_t mrcp_engine_channel_method_vtable_t;
 /** MRCP engine channel virtual event table declaration */
 typedef struct mrcp_engine_channel_event_vtable_t mrcp_engine_channel_event_vtable_t;
+/** Synthesized audio cache declaration */
+typedef struct mrcp_synth_cache_t mrcp_synth_cache_t;
 
 /** Table of channel virtual methods */
 struct mrcp_engine_channel_method_vtable_t {
@@ -134,6 +136,8 @@ struct mrcp_engine_t {
 	apr_size_t                         cur_channel_count;
 	/** Is engine successfully opened */
 	apt_bool_t                         is_open;
+	/** Cache of synthesized audio, if enabled */
+	mrcp_synth_cache_t                *synth_cache;
 	/** Pool to allocate memory from */
 	apr_pool_t                        *pool;
 
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MRCP_SYNTH_CACHE_H
+#define MRCP_SYNTH_CACHE_H
+
+/**
+ * @file mrcp_synth_cache.h
+ * @brief Cache of Synthesized Audio
+ */
+
+/**
+ * The cache sits between the MRCP server and a synthesizer engine. SPEAK
+ * requests are keyed by the body, content type, voice and prosody headers
+ * and the codec of the channel. The audio rendered by the engine for a
+ * request which completes normally is stored in the var directory; next
+ * identical requests are served from the memory-mapped file straight into
+ * the audio stream of the channel, without calling the engine.
+ *
+ * The cache is enabled per engine by the generic parameters
+ *    <param name="synth-cache-max-size" value="67108864"/>
+ *    <param name="synth-cache-max-count" value="1000"/>
+ */
+
+#include "mrcp_engine_types.h"
+
+APT_BEGIN_EXTERN_C
+
+/** Default limit of the number of cached entries */
+#define MRCP_SYNTH_CACHE_DEFAULT_MAX_COUNT 1000
+
+/** Synthesized audio cache statistics */
+typedef struct mrcp_synth_cache_stats_t mrcp_synth_cache_stats_t;
+
+/** Synthesized audio cache statistics */
+struct mrcp_synth_cache_stats_t {
+	/** Number of SPEAK requests served from the cache */
+	apr_size_t hits;
+	/** Number of SPEAK requests passed to the engine */
+	apr_size_t misses;
+	/** Number of entries stored */
+	apr_size_t stores;
+	/** Number of entries evicted to stay within the limits */
+	apr_size_t evictions;
+	/** Number of entries currently cached */
+	apr_size_t entry_count;
+	/** Total size of the entries currently cached (bytes) */
+	apr_size_t size;
+};
+
+/**
+ * Create synthesized audio cache of the engine according to the params of the engine.
+ * @param engine the synthesizer engine to create the cache for
+ * @return the cache or NULL if the cache is not enabled for the engine
+ */
+mrcp_synth_cache_t* mrcp_synth_cache_create(mrcp_engine_t *engine);
+
+/**
+ * Destroy synthesized audio cache and remove the stored files.
+ * @param cache the cache to destroy
+ */
+void mrcp_synth_cache_destroy(mrcp_synth_cache_t *cache);
+
+/**
+ * Start the cache (its background writer).
+ * @param cache the cache to start
+ */
+apt_bool_t mrcp_synth_cache_start(mrcp_synth_cache_t *cache);
+
+/**
+ * Stop the cache (its background writer).
+ * @param cache the cache to stop
+ */
+apt_bool_t mrcp_synth_cache_stop(mrcp_synth_cache_t *cache);
+
+/**
+ * Put the engine channel behind the cache.
+ * @param cache the cache to serve the channel by
+ * @param channel the engine channel to attach to
+ * @return TRUE if the channel is served by the cache
+ */
+apt_bool_t mrcp_synth_cache_channel_attach(mrcp_synth_cache_t *cache, mrcp_engine_channel_t *channel);
+
+/**
+ * Get statistics of synthesized audio cache.
+ * @param cache the cache to get statistics of
+ * @param stats the statistics to fill
+ */
+void mrcp_synth_cache_stats_get(mrcp_synth_cache_t *cache, mrcp_synth_cache_stats_t *stats);
+
+APT_END_EXTERN_C
+
+#endif /* MRCP_SYNTH_CACHE_H */
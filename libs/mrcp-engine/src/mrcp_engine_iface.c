@@ -15,11 +15,16 @@
  */
 
 #include "mrcp_engine_iface.h"
+#include "mrcp_synth_cache.h"
 #include "apt_log.h"
 
 /** Destroy engine */
 apt_bool_t mrcp_engine_virtual_destroy(mrcp_engine_t *engine)
 {
+	if(engine->synth_cache) {
+		mrcp_synth_cache_destroy(engine->synth_cache);
+		engine->synth_cache = NULL;
+	}
 	return engine->method_vtable->destroy(engine);
 }
 
@@ -40,6 +45,15 @@ void mrcp_engine_on_open(mrcp_engine_t *engine, apt_bool_t status)
 		engine->id,
 		status == TRUE ? "success" : "failure");
 	engine->is_open = status;
+	if(status == TRUE) {
+		/* the cache is in front of the engine, which is only usable once open */
+		if(!engine->synth_cache) {
+			engine->synth_cache = mrcp_synth_cache_create(engine);
+		}
+		if(engine->synth_cache) {
+			mrcp_synth_cache_start(engine->synth_cache);
+		}
+	}
 }
 
 /** Close engine */
@@ -48,6 +62,9 @@ apt_bool_t mrcp_engine_virtual_close(mrcp_engine_t *engine)
 	if(engine->is_open == TRUE) {
 		engine->is_open = FALSE;
 		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Close Engine [%s]",engine->id);
+		if(engine->synth_cache) {
+			mrcp_synth_cache_stop(engine->synth_cache);
+		}
 		return engine->method_vtable->close(engine);
 	}
 	return FALSE;
@@ -76,6 +93,9 @@ mrcp_engine_channel_t* mrcp_engine_channel_virtual_create(mrcp_engine_t *engine,
 	if(channel) {
 		channel->mrcp_version = mrcp_version;
 		engine->cur_channel_count++;
+		if(engine->synth_cache) {
+			mrcp_synth_cache_channel_attach(engine->synth_cache,channel);
+		}
 	}
 	return channel;
 }
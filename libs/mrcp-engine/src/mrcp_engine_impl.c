@@ -36,6 +36,7 @@ mrcp_engine_t* mrcp_engine_create(
 	engine->dir_layout = NULL;
 	engine->cur_channel_count = 0;
 	engine->is_open = FALSE;
+	engine->synth_cache = NULL;
 	engine->pool = pool;
 	engine->create_state_machine = NULL;
 	return engine;
@@ -0,0 +1,916 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifdef WIN32
+#pragma warning(disable: 4127)
+#endif
+#include <stdlib.h>
+#include <apr_ring.h>
+#include <apr_hash.h>
+#include <apr_file_io.h>
+#include <apr_thread_mutex.h>
+#include "mrcp_synth_cache.h"
+#include "mrcp_synth_engine.h"
+#include "mpf_termination.h"
+#include "mpf_termination_factory.h"
+#include "apt_file_cache.h"
+#include "apt_file_writer.h"
+#include "apt_atomic.h"
+#include "apt_log.h"
+
+typedef struct synth_cache_entry_t synth_cache_entry_t;
+typedef struct synth_cache_channel_t synth_cache_channel_t;
+
+/** States of cache entry */
+typedef enum {
+	SYNTH_CACHE_ENTRY_RECORDING, /**< audio is being rendered by the engine */
+	SYNTH_CACHE_ENTRY_FLUSHING,  /**< audio is rendered, but may not be on disk yet */
+	SYNTH_CACHE_ENTRY_READY,     /**< audio is stored */
+	SYNTH_CACHE_ENTRY_DISCARDED, /**< entry is to be removed */
+	SYNTH_CACHE_ENTRY_REMOVED    /**< file of the entry is removed */
+} synth_cache_entry_state_e;
+
+/** Cache entry (rendered audio of a SPEAK request) */
+struct synth_cache_entry_t {
+	/** Ring entry of the list of ready or discarded entries */
+	APR_RING_ENTRY(synth_cache_entry_t) link;
+	/** Pool the entry is allocated from, destroyed on removal */
+	apr_pool_t                         *pool;
+	/** Key of the entry */
+	const char                         *key;
+	/** Path of the file the audio is stored in */
+	const char                         *path;
+	/** Size of the audio */
+	apr_size_t                          size;
+	/** State of the entry */
+	synth_cache_entry_state_e           state;
+};
+
+/** List of entries */
+APR_RING_HEAD(synth_cache_head_t, synth_cache_entry_t);
+
+/** Cache of synthesized audio */
+struct mrcp_synth_cache_t {
+	/** Pool to allocate memory from */
+	apr_pool_t                *pool;
+	/** Engine the cache is created for */
+	mrcp_engine_t             *engine;
+	/** Limit of the total size of the entries */
+	apr_size_t                 max_size;
+	/** Limit of the number of the entries */
+	apr_size_t                 max_count;
+	/** Mapped files the audio is played from */
+	apt_file_cache_t          *file_cache;
+	/** Writer of the audio rendered by the engine */
+	apt_file_writer_t         *file_writer;
+
+	/** Guards the entries and the statistics */
+	apr_thread_mutex_t        *guard;
+	/** Table of entries by key */
+	apr_hash_t                *entries;
+	/** Ready entries, least recently used first */
+	struct synth_cache_head_t  lru;
+	/** Discarded entries, which files are to be removed */
+	struct synth_cache_head_t  garbage;
+	/** Discarded entries taken by the collector, which files are being removed without the lock */
+	struct synth_cache_head_t  collected;
+	/** Whether the garbage is being collected */
+	apt_bool_t                 collecting;
+	/** Sequence number of the last file */
+	apr_size_t                 file_seq;
+	/** Statistics */
+	mrcp_synth_cache_stats_t   stats;
+};
+
+/** Modes of cache channel */
+typedef enum {
+	SYNTH_CACHE_CHANNEL_IDLE,      /**< the engine is in charge of the stream */
+	SYNTH_CACHE_CHANNEL_PLAYING,   /**< cached audio is played */
+	SYNTH_CACHE_CHANNEL_STOPPING,  /**< cached audio is played, STOP is pending */
+	SYNTH_CACHE_CHANNEL_RECORDING  /**< audio rendered by the engine is recorded */
+} synth_cache_channel_mode_e;
+
+/** Endings of recording */
+typedef enum {
+	SYNTH_CACHE_RECORD_NONE,
+	SYNTH_CACHE_RECORD_COMMIT,
+	SYNTH_CACHE_RECORD_DISCARD
+} synth_cache_record_end_e;
+
+/** Cache channel (state of the engine channel served by the cache) */
+struct synth_cache_channel_t {
+	/** Cache the channel is served by */
+	mrcp_synth_cache_t                        *cache;
+	/** Engine channel */
+	mrcp_engine_channel_t                     *channel;
+	/** Methods of the engine channel */
+	const mrcp_engine_channel_method_vtable_t *method_vtable;
+	/** Event handlers of the user of the engine channel */
+	const mrcp_engine_channel_event_vtable_t  *event_vtable;
+	/** Methods of the audio stream of the engine channel */
+	const mpf_audio_stream_vtable_t           *stream_vtable;
+
+	/** Mode of the channel (synth_cache_channel_mode_e), left by the media thread only */
+	volatile apr_uint32_t                      mode;
+
+	/** SPEAK request served from the cache */
+	mrcp_message_t                            *speak_request;
+	/** Pending STOP response */
+	mrcp_message_t                            *stop_response;
+	/** Mapped file played */
+	apt_file_cache_entry_t                    *file;
+	/** Audio played */
+	const char                                *data;
+	/** Size of the audio played */
+	apr_size_t                                 size;
+	/** Offset of the next frame in the audio played */
+	apr_size_t                                 offset;
+	/** Is playing paused */
+	volatile apr_uint32_t                      paused;
+
+	/** Entry recorded */
+	synth_cache_entry_t                       *entry;
+	/** Identifier of the SPEAK request recorded */
+	mrcp_request_id                            record_request_id;
+	/** File the audio is recorded to */
+	apt_file_writer_file_t                    *record_file;
+	/** Size of the audio recorded */
+	apr_size_t                                 record_size;
+	/** Whether some audio has been lost */
+	apt_bool_t                                 record_failed;
+	/** Ending of recording (synth_cache_record_end_e) */
+	volatile apr_uint32_t                      record_end;
+};
+
+/** Synthesizer headers the rendered audio depends on */
+static const apr_size_t synth_cache_key_headers[] = {
+	SYNTHESIZER_HEADER_VOICE_GENDER,
+	SYNTHESIZER_HEADER_VOICE_AGE,
+	SYNTHESIZER_HEADER_VOICE_VARIANT,
+	SYNTHESIZER_HEADER_VOICE_NAME,
+	SYNTHESIZER_HEADER_PROSODY_VOLUME,
+	SYNTHESIZER_HEADER_PROSODY_RATE,
+	SYNTHESIZER_HEADER_SPEECH_LANGUAGE,
+	SYNTHESIZER_HEADER_LOAD_LEXICON,
+	SYNTHESIZER_HEADER_LEXICON_SEARCH_ORDER
+};
+
+static apt_bool_t synth_cache_channel_destroy(mrcp_engine_channel_t *channel);
+static apt_bool_t synth_cache_channel_open(mrcp_engine_channel_t *channel);
+static apt_bool_t synth_cache_channel_close(mrcp_engine_channel_t *channel);
+static apt_bool_t synth_cache_channel_request_process(mrcp_engine_channel_t *channel, mrcp_message_t *request);
+
+static const mrcp_engine_channel_method_vtable_t synth_cache_method_vtable = {
+	synth_cache_channel_destroy,
+	synth_cache_channel_open,
+	synth_cache_channel_close,
+	synth_cache_channel_request_process
+};
+
+static apt_bool_t synth_cache_on_channel_open(mrcp_engine_channel_t *channel, apt_bool_t status);
+static apt_bool_t synth_cache_on_channel_close(mrcp_engine_channel_t *channel);
+static apt_bool_t synth_cache_on_channel_message(mrcp_engine_channel_t *channel, mrcp_message_t *message);
+
+static const mrcp_engine_channel_event_vtable_t synth_cache_event_vtable = {
+	synth_cache_on_channel_open,
+	synth_cache_on_channel_close,
+	synth_cache_on_channel_message
+};
+
+static apt_bool_t synth_cache_stream_destroy(mpf_audio_stream_t *stream);
+static apt_bool_t synth_cache_stream_open(mpf_audio_stream_t *stream, mpf_codec_t *codec);
+static apt_bool_t synth_cache_stream_close(mpf_audio_stream_t *stream);
+static apt_bool_t synth_cache_stream_read(mpf_audio_stream_t *stream, mpf_frame_t *frame);
+static void synth_cache_stream_trace(mpf_audio_stream_t *stream, mpf_stream_direction_e direction, apt_text_stream_t *output);
+
+static const mpf_audio_stream_vtable_t synth_cache_stream_vtable = {
+	synth_cache_stream_destroy,
+	synth_cache_stream_open,
+	synth_cache_stream_close,
+	synth_cache_stream_read,
+	NULL,
+	NULL,
+	NULL,
+	synth_cache_stream_trace
+};
+
+
+mrcp_synth_cache_t* mrcp_synth_cache_create(mrcp_engine_t *engine)
+{
+	mrcp_synth_cache_t *cache;
+	apr_size_t max_size = 0;
+	apr_size_t max_count = MRCP_SYNTH_CACHE_DEFAULT_MAX_COUNT;
+	const char *value;
+
+	if(engine->resource_id != MRCP_SYNTHESIZER_RESOURCE) {
+		return NULL;
+	}
+
+	value = mrcp_engine_param_get(engine,"synth-cache-max-size");
+	if(value) {
+		max_size = (apr_size_t)atol(value);
+	}
+	if(!max_size) {
+		/* cache is not enabled */
+		return NULL;
+	}
+	value = mrcp_engine_param_get(engine,"synth-cache-max-count");
+	if(value) {
+		max_count = (apr_size_t)atol(value);
+	}
+
+	cache = apr_palloc(engine->pool,sizeof(mrcp_synth_cache_t));
+	cache->pool = engine->pool;
+	cache->engine = engine;
+	cache->max_size = max_size;
+	cache->max_count = max_count;
+	cache->guard = NULL;
+	if(apr_thread_mutex_create(&cache->guard,APR_THREAD_MUTEX_DEFAULT,cache->pool) != APR_SUCCESS) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Synth Cache [%s]",engine->id);
+		return NULL;
+	}
+	cache->file_cache = apt_file_cache_create(max_size,cache->pool);
+	cache->file_writer = apt_file_writer_create(
+							APT_FILE_WRITER_DEFAULT_BUFFER_SIZE,
+							APT_FILE_WRITER_DEFAULT_INTERVAL,
+							cache->pool);
+	if(!cache->file_cache || !cache->file_writer) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Synth Cache [%s]",engine->id);
+		return NULL;
+	}
+	cache->entries = apr_hash_make(cache->pool);
+	APR_RING_INIT(&cache->lru, synth_cache_entry_t, link);
+	APR_RING_INIT(&cache->garbage, synth_cache_entry_t, link);
+	APR_RING_INIT(&cache->collected, synth_cache_entry_t, link);
+	cache->collecting = FALSE;
+	cache->file_seq = 0;
+	memset(&cache->stats,0,sizeof(cache->stats));
+
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Create Synth Cache [%s] max size [%"APR_SIZE_T_FMT"] max count [%"APR_SIZE_T_FMT"]",
+		engine->id,
+		max_size,
+		max_count);
+	return cache;
+}
+
+/** Remove the files of the discarded entries, which are no longer in use, return FALSE if some are left */
+static apt_bool_t synth_cache_garbage_collect(mrcp_synth_cache_t *cache)
+{
+	synth_cache_entry_t *entry;
+	apr_status_t status;
+	apt_bool_t collected;
+
+	apr_thread_mutex_lock(cache->guard);
+	if(cache->collecting == TRUE || APR_RING_EMPTY(&cache->garbage, synth_cache_entry_t, link)) {
+		collected = APR_RING_EMPTY(&cache->garbage, synth_cache_entry_t, link);
+		apr_thread_mutex_unlock(cache->guard);
+		return collected;
+	}
+	/* the discarded entries are referred to by the collector only */
+	cache->collecting = TRUE;
+	APR_RING_CONCAT(&cache->collected,&cache->garbage,synth_cache_entry_t,link);
+	apr_thread_mutex_unlock(cache->guard);
+
+	/* the disk is accessed without holding the lock, the media thread takes it too */
+	for(entry = APR_RING_FIRST(&cache->collected);
+			entry != APR_RING_SENTINEL(&cache->collected, synth_cache_entry_t, link);
+				entry = APR_RING_NEXT(entry,link)) {
+		if(apt_file_cache_invalidate(cache->file_cache,entry->path) == FALSE) {
+			/* still played by some channels, mapped files cannot be removed on all platforms */
+			continue;
+		}
+
+		status = apr_file_remove(entry->path,entry->pool);
+		if(status != APR_SUCCESS && !APR_STATUS_IS_ENOENT(status)) {
+			/* e.g. still open by the file writer, retry on the next collection */
+			continue;
+		}
+		entry->state = SYNTH_CACHE_ENTRY_REMOVED;
+	}
+
+	apr_thread_mutex_lock(cache->guard);
+	while(!APR_RING_EMPTY(&cache->collected, synth_cache_entry_t, link)) {
+		entry = APR_RING_FIRST(&cache->collected);
+		APR_RING_REMOVE(entry,link);
+		if(entry->state == SYNTH_CACHE_ENTRY_REMOVED) {
+			apr_pool_destroy(entry->pool);
+		}
+		else {
+			APR_RING_INSERT_TAIL(&cache->garbage,entry,synth_cache_entry_t,link);
+		}
+	}
+	cache->collecting = FALSE;
+	collected = APR_RING_EMPTY(&cache->garbage, synth_cache_entry_t, link);
+	apr_thread_mutex_unlock(cache->guard);
+	return collected;
+}
+
+/** Discard the entry (guarded) */
+static void synth_cache_entry_discard(mrcp_synth_cache_t *cache, synth_cache_entry_t *entry)
+{
+	if(entry->state == SYNTH_CACHE_ENTRY_READY) {
+		APR_RING_REMOVE(entry,link);
+	}
+	apr_hash_set(cache->entries,entry->key,APR_HASH_KEY_STRING,NULL);
+	cache->stats.entry_count--;
+	cache->stats.size -= entry->size;
+	entry->state = SYNTH_CACHE_ENTRY_DISCARDED;
+	/* the file is removed out of the media thread */
+	APR_RING_INSERT_TAIL(&cache->garbage,entry,synth_cache_entry_t,link);
+}
+
+/** Evict the least recently used entries to fit in the limits (guarded) */
+static void synth_cache_evict(mrcp_synth_cache_t *cache, apr_size_t count)
+{
+	synth_cache_entry_t *entry;
+	while((cache->stats.size > cache->max_size || cache->stats.entry_count + count > cache->max_count) &&
+		!APR_RING_EMPTY(&cache->lru, synth_cache_entry_t, link)) {
+		entry = APR_RING_FIRST(&cache->lru);
+		apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Evict Synth Cache Entry [%s]",entry->path);
+		synth_cache_entry_discard(cache,entry);
+		cache->stats.evictions++;
+	}
+}
+
+/** Create an entry to record (guarded) */
+static synth_cache_entry_t* synth_cache_entry_create(mrcp_synth_cache_t *cache, const char *key)
+{
+	synth_cache_entry_t *entry;
+	apr_pool_t *pool;
+	const char *file_name;
+
+	synth_cache_evict(cache,1);
+	if(cache->stats.entry_count >= cache->max_count) {
+		/* all the entries are in use */
+		return NULL;
+	}
+
+	apr_pool_create(&pool,cache->pool);
+	entry = apr_palloc(pool,sizeof(synth_cache_entry_t));
+	entry->pool = pool;
+	entry->key = apr_pstrdup(pool,key);
+	/* file names are never reused as stale mappings may still be cached */
+	file_name = apr_psprintf(pool,"synth-cache-%s-%"APR_SIZE_T_FMT".pcm",cache->engine->id,++cache->file_seq);
+	entry->path = apt_vardir_filepath_get(cache->engine->dir_layout,file_name,pool);
+	entry->size = 0;
+	entry->state = SYNTH_CACHE_ENTRY_RECORDING;
+	APR_RING_ELEM_INIT(entry,link);
+	if(!entry->path) {
+		apr_pool_destroy(pool);
+		return NULL;
+	}
+
+	apr_hash_set(cache->entries,entry->key,APR_HASH_KEY_STRING,entry);
+	cache->stats.entry_count++;
+	return entry;
+}
+
+/** Check whether the audio of the entry of the key has been flushed to disk, make the entry ready if so */
+static void synth_cache_entry_flush_check(mrcp_synth_cache_t *cache, const char *key, apr_pool_t *pool)
+{
+	synth_cache_entry_t *entry;
+	apr_finfo_t finfo;
+	const char *path = NULL;
+	apr_size_t size = 0;
+
+	apr_thread_mutex_lock(cache->guard);
+	entry = apr_hash_get(cache->entries,key,APR_HASH_KEY_STRING);
+	if(entry && entry->state == SYNTH_CACHE_ENTRY_FLUSHING) {
+		path = apr_pstrdup(pool,entry->path);
+		size = entry->size;
+	}
+	apr_thread_mutex_unlock(cache->guard);
+
+	/* the disk is accessed without holding the lock, the media thread takes it too */
+	if(!path || apr_stat(&finfo,path,APR_FINFO_SIZE,pool) != APR_SUCCESS || (apr_size_t)finfo.size != size) {
+		return;
+	}
+
+	apr_thread_mutex_lock(cache->guard);
+	entry = apr_hash_get(cache->entries,key,APR_HASH_KEY_STRING);
+	/* file names are never reused, the same file stands for the same entry */
+	if(entry && entry->state == SYNTH_CACHE_ENTRY_FLUSHING && strcmp(entry->path,path) == 0) {
+		entry->state = SYNTH_CACHE_ENTRY_READY;
+		APR_RING_INSERT_TAIL(&cache->lru,entry,synth_cache_entry_t,link);
+	}
+	apr_thread_mutex_unlock(cache->guard);
+}
+
+/** Build the key of SPEAK request, the key includes everything the rendered audio depends on */
+static const char* synth_cache_key_build(mrcp_message_t *request, const mpf_codec_descriptor_t *descriptor)
+{
+	const apt_header_section_t *header_section = &request->header.header_section;
+	const apt_header_field_t *header_field;
+	char *key;
+	apr_size_t i;
+
+	if(!descriptor || !request->body.length) {
+		return NULL;
+	}
+
+	key = apr_psprintf(request->pool,"%s/%d/%d\n",
+			descriptor->name.buf,
+			descriptor->sampling_rate,
+			descriptor->channel_count);
+	header_field = apt_header_section_field_get(header_section,GENERIC_HEADER_CONTENT_TYPE);
+	if(header_field) {
+		key = apr_psprintf(request->pool,"%sContent-Type: %s\n",key,header_field->value.buf);
+	}
+	header_field = apt_header_section_field_get(header_section,GENERIC_HEADER_CONTENT_BASE);
+	if(header_field) {
+		key = apr_psprintf(request->pool,"%sContent-Base: %s\n",key,header_field->value.buf);
+	}
+	for(i = 0; i < sizeof(synth_cache_key_headers) / sizeof(synth_cache_key_headers[0]); i++) {
+		header_field = apt_header_section_field_get(header_section,synth_cache_key_headers[i] + GENERIC_HEADER_COUNT);
+		if(header_field) {
+			key = apr_psprintf(request->pool,"%s%s: %s\n",key,header_field->name.buf,header_field->value.buf);
+		}
+	}
+	return apr_psprintf(request->pool,"%s\n%.*s",key,(int)request->body.length,request->body.buf);
+}
+
+static APR_INLINE synth_cache_channel_t* synth_cache_channel_get(mrcp_engine_channel_t *channel)
+{
+	return channel->termination->obj;
+}
+
+apt_bool_t mrcp_synth_cache_channel_attach(mrcp_synth_cache_t *cache, mrcp_engine_channel_t *channel)
+{
+	synth_cache_channel_t *cache_channel;
+	mpf_audio_stream_t *audio_stream;
+
+	if(!channel->termination || channel->termination->obj) {
+		return FALSE;
+	}
+	audio_stream = mpf_termination_audio_stream_get(channel->termination);
+	if(!audio_stream || !(audio_stream->direction & STREAM_DIRECTION_RECEIVE) || !audio_stream->vtable->read_frame) {
+		return FALSE;
+	}
+
+	cache_channel = apr_palloc(channel->pool,sizeof(synth_cache_channel_t));
+	cache_channel->cache = cache;
+	cache_channel->channel = channel;
+	cache_channel->method_vtable = channel->method_vtable;
+	cache_channel->event_vtable = NULL;
+	cache_channel->stream_vtable = audio_stream->vtable;
+	cache_channel->mode = SYNTH_CACHE_CHANNEL_IDLE;
+	cache_channel->speak_request = NULL;
+	cache_channel->stop_response = NULL;
+	cache_channel->file = NULL;
+	cache_channel->data = NULL;
+	cache_channel->size = 0;
+	cache_channel->offset = 0;
+	cache_channel->paused = FALSE;
+	cache_channel->entry = NULL;
+	cache_channel->record_request_id = 0;
+	cache_channel->record_file = NULL;
+	cache_channel->record_size = 0;
+	cache_channel->record_failed = FALSE;
+	cache_channel->record_end = SYNTH_CACHE_RECORD_NONE;
+
+	/* the engine keeps its own objects of the channel and the stream, the
+	cache channel is associated with the otherwise unused object of the termination */
+	channel->termination->obj = cache_channel;
+	channel->method_vtable = &synth_cache_method_vtable;
+	audio_stream->vtable = &synth_cache_stream_vtable;
+	return TRUE;
+}
+
+/** Close the file recorded, commit or discard the entry (media thread) */
+static void synth_cache_record_finish(synth_cache_channel_t *cache_channel, apt_bool_t commit)
+{
+	mrcp_synth_cache_t *cache = cache_channel->cache;
+	synth_cache_entry_t *entry = cache_channel->entry;
+
+	apt_file_writer_close(cache_channel->record_file);
+	cache_channel->record_file = NULL;
+	cache_channel->entry = NULL;
+
+	if(cache_channel->record_failed == TRUE || !cache_channel->record_size) {
+		commit = FALSE;
+	}
+
+	apr_thread_mutex_lock(cache->guard);
+	if(commit == TRUE) {
+		entry->size = cache_channel->record_size;
+		entry->state = SYNTH_CACHE_ENTRY_FLUSHING;
+		cache->stats.size += entry->size;
+		cache->stats.stores++;
+	}
+	else {
+		synth_cache_entry_discard(cache,entry);
+	}
+	apr_thread_mutex_unlock(cache->guard);
+
+	apt_atomic_store32_release(&cache_channel->mode,SYNTH_CACHE_CHANNEL_IDLE);
+}
+
+/** Release the audio played (out of the media thread) */
+static void synth_cache_play_release(synth_cache_channel_t *cache_channel)
+{
+	cache_channel->speak_request = NULL;
+	if(cache_channel->file) {
+		apt_file_cache_release(cache_channel->cache->file_cache,cache_channel->file);
+		cache_channel->file = NULL;
+		cache_channel->data = NULL;
+		cache_channel->size = 0;
+	}
+}
+
+/** Serve SPEAK request from the cache or start recording the audio rendered by the engine */
+static apt_bool_t synth_cache_speak_process(synth_cache_channel_t *cache_channel, mrcp_message_t *request)
+{
+	mrcp_synth_cache_t *cache = cache_channel->cache;
+	synth_cache_entry_t *entry;
+	synth_cache_entry_t *record_entry = NULL;
+	apt_file_cache_entry_t *file = NULL;
+	const void *data = NULL;
+	apr_size_t size = 0;
+	const char *key;
+
+	if(apt_atomic_load32_acquire(&cache_channel->mode) != SYNTH_CACHE_CHANNEL_IDLE) {
+		/* the previous request hasn't been finished by the media thread yet */
+		return FALSE;
+	}
+	/* the previous request is over, the media thread no longer reads its audio */
+	synth_cache_play_release(cache_channel);
+
+	key = synth_cache_key_build(request,mrcp_engine_source_stream_codec_get(cache_channel->channel));
+	if(!key) {
+		return FALSE;
+	}
+
+	synth_cache_garbage_collect(cache);
+	synth_cache_entry_flush_check(cache,key,request->pool);
+
+	apr_thread_mutex_lock(cache->guard);
+	entry = apr_hash_get(cache->entries,key,APR_HASH_KEY_STRING);
+	if(entry) {
+		if(entry->state == SYNTH_CACHE_ENTRY_READY) {
+			file = apt_file_cache_acquire(cache->file_cache,entry->path,&data,&size);
+			if(file && size == entry->size) {
+				/* move to the most recently used end */
+				APR_RING_REMOVE(entry,link);
+				APR_RING_INSERT_TAIL(&cache->lru,entry,synth_cache_entry_t,link);
+			}
+			else {
+				if(file) {
+					apt_file_cache_release(cache->file_cache,file);
+					file = NULL;
+				}
+				synth_cache_entry_discard(cache,entry);
+			}
+		}
+		/* otherwise the same audio is being rendered for another channel */
+	}
+	else {
+		record_entry = synth_cache_entry_create(cache,key);
+	}
+
+	if(file) {
+		cache->stats.hits++;
+	}
+	else {
+		cache->stats.misses++;
+	}
+	apr_thread_mutex_unlock(cache->guard);
+
+	if(file) {
+		mrcp_message_t *response = mrcp_response_create(request,request->pool);
+		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Serve SPEAK Request from Synth Cache [%s] " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
+			cache->engine->id,
+			MRCP_MESSAGE_SIDRES(request),
+			request->start_line.request_id);
+		cache_channel->speak_request = request;
+		cache_channel->file = file;
+		cache_channel->data = data;
+		cache_channel->size = size;
+		cache_channel->offset = 0;
+		cache_channel->paused = FALSE;
+		response->start_line.request_state = MRCP_REQUEST_STATE_INPROGRESS;
+		mrcp_engine_channel_message_send(cache_channel->channel,response);
+		apt_atomic_store32_release(&cache_channel->mode,SYNTH_CACHE_CHANNEL_PLAYING);
+		return TRUE;
+	}
+
+	if(record_entry) {
+		cache_channel->record_file = apt_file_writer_open(cache->file_writer,record_entry->path);
+		if(!cache_channel->record_file) {
+			apr_thread_mutex_lock(cache->guard);
+			synth_cache_entry_discard(cache,record_entry);
+			apr_thread_mutex_unlock(cache->guard);
+			return FALSE;
+		}
+		cache_channel->entry = record_entry;
+		cache_channel->record_request_id = request->start_line.request_id;
+		cache_channel->record_size = 0;
+		cache_channel->record_failed = FALSE;
+		cache_channel->record_end = SYNTH_CACHE_RECORD_NONE;
+		apt_atomic_store32_release(&cache_channel->mode,SYNTH_CACHE_CHANNEL_RECORDING);
+	}
+	return FALSE;
+}
+
+/** Process request to the SPEAK request served from the cache */
+static apt_bool_t synth_cache_play_control(synth_cache_channel_t *cache_channel, mrcp_message_t *request)
+{
+	mrcp_message_t *response = mrcp_response_create(request,request->pool);
+	switch(request->start_line.method_id) {
+		case SYNTHESIZER_STOP:
+		case SYNTHESIZER_BARGE_IN_OCCURRED:
+			cache_channel->stop_response = response;
+			if(apr_atomic_cas32(&cache_channel->mode,SYNTH_CACHE_CHANNEL_STOPPING,SYNTH_CACHE_CHANNEL_PLAYING) == SYNTH_CACHE_CHANNEL_PLAYING) {
+				/* the media thread sends the response once it stops reading the audio */
+				return TRUE;
+			}
+			cache_channel->stop_response = NULL;
+			/* playing is already complete */
+			break;
+		case SYNTHESIZER_PAUSE:
+			apt_atomic_store32_release(&cache_channel->paused,TRUE);
+			break;
+		case SYNTHESIZER_RESUME:
+			apt_atomic_store32_release(&cache_channel->paused,FALSE);
+			break;
+		case SYNTHESIZER_CONTROL:
+			break;
+		default:
+			return FALSE;
+	}
+	return mrcp_engine_channel_message_send(cache_channel->channel,response);
+}
+
+static apt_bool_t synth_cache_channel_destroy(mrcp_engine_channel_t *channel)
+{
+	synth_cache_channel_t *cache_channel = synth_cache_channel_get(channel);
+	/* the media termination is already destroyed */
+	synth_cache_play_release(cache_channel);
+	if(cache_channel->mode == SYNTH_CACHE_CHANNEL_RECORDING) {
+		synth_cache_record_finish(cache_channel,FALSE);
+	}
+	return cache_channel->method_vtable->destroy(channel);
+}
+
+static apt_bool_t synth_cache_channel_open(mrcp_engine_channel_t *channel)
+{
+	synth_cache_channel_t *cache_channel = synth_cache_channel_get(channel);
+	if(channel->event_vtable != &synth_cache_event_vtable) {
+		/* intercept the responses and events of the engine */
+		cache_channel->event_vtable = channel->event_vtable;
+		channel->event_vtable = &synth_cache_event_vtable;
+	}
+	return cache_channel->method_vtable->open(channel);
+}
+
+static apt_bool_t synth_cache_channel_close(mrcp_engine_channel_t *channel)
+{
+	synth_cache_channel_t *cache_channel = synth_cache_channel_get(channel);
+	return cache_channel->method_vtable->close(channel);
+}
+
+static apt_bool_t synth_cache_channel_request_process(mrcp_engine_channel_t *channel, mrcp_message_t *request)
+{
+	synth_cache_channel_t *cache_channel = synth_cache_channel_get(channel);
+	if(request->start_line.method_id == SYNTHESIZER_SPEAK) {
+		if(synth_cache_speak_process(cache_channel,request) == TRUE) {
+			return TRUE;
+		}
+	}
+	else if(cache_channel->speak_request) {
+		/* the in-progress SPEAK request is served from the cache */
+		if(synth_cache_play_control(cache_channel,request) == TRUE) {
+			return TRUE;
+		}
+	}
+	return cache_channel->method_vtable->process_request(channel,request);
+}
+
+static apt_bool_t synth_cache_on_channel_open(mrcp_engine_channel_t *channel, apt_bool_t status)
+{
+	synth_cache_channel_t *cache_channel = synth_cache_channel_get(channel);
+	return cache_channel->event_vtable->on_open(channel,status);
+}
+
+static apt_bool_t synth_cache_on_channel_close(mrcp_engine_channel_t *channel)
+{
+	synth_cache_channel_t *cache_channel = synth_cache_channel_get(channel);
+	return cache_channel->event_vtable->on_close(channel);
+}
+
+static apt_bool_t synth_cache_on_channel_message(mrcp_engine_channel_t *channel, mrcp_message_t *message)
+{
+	synth_cache_channel_t *cache_channel = synth_cache_channel_get(channel);
+	if(apt_atomic_load32_acquire(&cache_channel->mode) == SYNTH_CACHE_CHANNEL_RECORDING &&
+		cache_channel->record_end == SYNTH_CACHE_RECORD_NONE) {
+		/* the media thread finishes recording on its next read */
+		synth_cache_record_end_e record_end = SYNTH_CACHE_RECORD_NONE;
+		if(message->start_line.message_type == MRCP_MESSAGE_TYPE_EVENT) {
+			if(message->start_line.method_id == SYNTHESIZER_SPEAK_COMPLETE &&
+				message->start_line.request_id == cache_channel->record_request_id) {
+				mrcp_synth_header_t *synth_header = mrcp_resource_header_get(message);
+				record_end = SYNTH_CACHE_RECORD_COMMIT;
+				if(synth_header && mrcp_resource_header_property_check(message,SYNTHESIZER_HEADER_COMPLETION_CAUSE) == TRUE &&
+					synth_header->completion_cause != SYNTHESIZER_COMPLETION_CAUSE_NORMAL) {
+					record_end = SYNTH_CACHE_RECORD_DISCARD;
+				}
+			}
+		}
+		else if(message->start_line.message_type == MRCP_MESSAGE_TYPE_RESPONSE) {
+			if(message->start_line.method_id == SYNTHESIZER_STOP ||
+				message->start_line.method_id == SYNTHESIZER_BARGE_IN_OCCURRED) {
+				record_end = SYNTH_CACHE_RECORD_DISCARD;
+			}
+			else if(message->start_line.method_id == SYNTHESIZER_SPEAK &&
+				message->start_line.status_code != MRCP_STATUS_CODE_SUCCESS &&
+				message->start_line.status_code != MRCP_STATUS_CODE_SUCCESS_WITH_IGNORE) {
+				record_end = SYNTH_CACHE_RECORD_DISCARD;
+			}
+		}
+		if(record_end != SYNTH_CACHE_RECORD_NONE) {
+			apt_atomic_store32_release(&cache_channel->record_end,record_end);
+		}
+	}
+	return cache_channel->event_vtable->on_message(channel,message);
+}
+
+static apt_bool_t synth_cache_stream_destroy(mpf_audio_stream_t *stream)
+{
+	synth_cache_channel_t *cache_channel = stream->termination->obj;
+	if(cache_channel->stream_vtable->destroy) {
+		return cache_channel->stream_vtable->destroy(stream);
+	}
+	return TRUE;
+}
+
+static apt_bool_t synth_cache_stream_open(mpf_audio_stream_t *stream, mpf_codec_t *codec)
+{
+	synth_cache_channel_t *cache_channel = stream->termination->obj;
+	if(cache_channel->stream_vtable->open_rx) {
+		return cache_channel->stream_vtable->open_rx(stream,codec);
+	}
+	return TRUE;
+}
+
+static apt_bool_t synth_cache_stream_close(mpf_audio_stream_t *stream)
+{
+	synth_cache_channel_t *cache_channel = stream->termination->obj;
+	if(cache_channel->stream_vtable->close_rx) {
+		return cache_channel->stream_vtable->close_rx(stream);
+	}
+	return TRUE;
+}
+
+/** Play the next frame of the cached audio (media thread) */
+static apt_bool_t synth_cache_stream_play(synth_cache_channel_t *cache_channel, apr_uint32_t mode, mpf_frame_t *frame)
+{
+	mrcp_message_t *message;
+	apr_size_t size;
+
+	if(mode == SYNTH_CACHE_CHANNEL_STOPPING) {
+		message = cache_channel->stop_response;
+		cache_channel->stop_response = NULL;
+		apt_atomic_store32_release(&cache_channel->mode,SYNTH_CACHE_CHANNEL_IDLE);
+		return mrcp_engine_channel_message_send(cache_channel->channel,message);
+	}
+
+	if(apt_atomic_load32_acquire(&cache_channel->paused) == TRUE) {
+		return TRUE;
+	}
+
+	size = cache_channel->size - cache_channel->offset;
+	if(size) {
+		if(size > frame->codec_frame.size) {
+			size = frame->codec_frame.size;
+		}
+		memcpy(frame->codec_frame.buffer,cache_channel->data + cache_channel->offset,size);
+		if(size < frame->codec_frame.size) {
+			memset((char*)frame->codec_frame.buffer + size,0,frame->codec_frame.size - size);
+		}
+		cache_channel->offset += size;
+		frame->type |= MEDIA_FRAME_TYPE_AUDIO;
+		return TRUE;
+	}
+
+	if(apr_atomic_cas32(&cache_channel->mode,SYNTH_CACHE_CHANNEL_IDLE,SYNTH_CACHE_CHANNEL_PLAYING) != SYNTH_CACHE_CHANNEL_PLAYING) {
+		/* STOP has just been requested, complete it on the next read */
+		return TRUE;
+	}
+
+	/* raise SPEAK-COMPLETE event */
+	message = mrcp_event_create(
+				cache_channel->speak_request,
+				SYNTHESIZER_SPEAK_COMPLETE,
+				cache_channel->speak_request->pool);
+	if(message) {
+		mrcp_synth_header_t *synth_header = mrcp_resource_header_prepare(message);
+		if(synth_header) {
+			synth_header->completion_cause = SYNTHESIZER_COMPLETION_CAUSE_NORMAL;
+			mrcp_resource_header_property_add(message,SYNTHESIZER_HEADER_COMPLETION_CAUSE);
+		}
+		message->start_line.request_state = MRCP_REQUEST_STATE_COMPLETE;
+		mrcp_engine_channel_message_send(cache_channel->channel,message);
+	}
+	return TRUE;
+}
+
+static apt_bool_t synth_cache_stream_read(mpf_audio_stream_t *stream, mpf_frame_t *frame)
+{
+	synth_cache_channel_t *cache_channel = stream->termination->obj;
+	apr_uint32_t mode = apt_atomic_load32_acquire(&cache_channel->mode);
+	apt_bool_t status;
+
+	if(mode == SYNTH_CACHE_CHANNEL_PLAYING || mode == SYNTH_CACHE_CHANNEL_STOPPING) {
+		/* the engine is not involved */
+		return synth_cache_stream_play(cache_channel,mode,frame);
+	}
+
+	status = cache_channel->stream_vtable->read_frame(stream,frame);
+	if(mode == SYNTH_CACHE_CHANNEL_RECORDING) {
+		apr_uint32_t record_end = apt_atomic_load32_acquire(&cache_channel->record_end);
+		if((frame->type & MEDIA_FRAME_TYPE_AUDIO) && cache_channel->record_failed == FALSE) {
+			if(apt_file_writer_write(cache_channel->record_file,frame->codec_frame.buffer,frame->codec_frame.size) == TRUE) {
+				cache_channel->record_size += frame->codec_frame.size;
+			}
+			else {
+				cache_channel->record_failed = TRUE;
+			}
+		}
+		if(record_end != SYNTH_CACHE_RECORD_NONE) {
+			synth_cache_record_finish(cache_channel,record_end == SYNTH_CACHE_RECORD_COMMIT);
+		}
+	}
+	return status;
+}
+
+static void synth_cache_stream_trace(mpf_audio_stream_t *stream, mpf_stream_direction_e direction, apt_text_stream_t *output)
+{
+	synth_cache_channel_t *cache_channel = stream->termination->obj;
+	if(cache_channel->stream_vtable->trace) {
+		cache_channel->stream_vtable->trace(stream,direction,output);
+	}
+}
+
+apt_bool_t mrcp_synth_cache_start(mrcp_synth_cache_t *cache)
+{
+	return apt_file_writer_start(cache->file_writer);
+}
+
+apt_bool_t mrcp_synth_cache_stop(mrcp_synth_cache_t *cache)
+{
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Synth Cache [%s] hits [%"APR_SIZE_T_FMT"] misses [%"APR_SIZE_T_FMT"] stores [%"APR_SIZE_T_FMT"] evictions [%"APR_SIZE_T_FMT"]",
+		cache->engine->id,
+		cache->stats.hits,
+		cache->stats.misses,
+		cache->stats.stores,
+		cache->stats.evictions);
+	return apt_file_writer_stop(cache->file_writer);
+}
+
+void mrcp_synth_cache_destroy(mrcp_synth_cache_t *cache)
+{
+	synth_cache_entry_t *entry;
+	apr_hash_index_t *it;
+	void *val;
+
+	apr_thread_mutex_lock(cache->guard);
+	for(it = apr_hash_first(cache->pool,cache->entries); it; it = apr_hash_next(it)) {
+		apr_hash_this(it,NULL,NULL,&val);
+		entry = val;
+		if(entry->state == SYNTH_CACHE_ENTRY_READY) {
+			APR_RING_REMOVE(entry,link);
+		}
+		entry->state = SYNTH_CACHE_ENTRY_DISCARDED;
+		APR_RING_INSERT_TAIL(&cache->garbage,entry,synth_cache_entry_t,link);
+	}
+	apr_hash_clear(cache->entries);
+	cache->stats.entry_count = 0;
+	cache->stats.size = 0;
+	apr_thread_mutex_unlock(cache->guard);
+
+	if(synth_cache_garbage_collect(cache) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Remove Files of Synth Cache [%s]",cache->engine->id);
+	}
+
+	apt_file_cache_destroy(cache->file_cache);
+	apr_thread_mutex_destroy(cache->guard);
+}
+
+void mrcp_synth_cache_stats_get(mrcp_synth_cache_t *cache, mrcp_synth_cache_stats_t *stats)
+{
+	apr_thread_mutex_lock(cache->guard);
+	*stats = cache->stats;
+	apr_thread_mutex_unlock(cache->guard);
+}
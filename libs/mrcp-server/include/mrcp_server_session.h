@@ -135,7 +135,7 @@ struct mrcp_server_profile_t {
 };
 
 /** Create server session */
-mrcp_server_session_t* mrcp_server_session_create(void);
+mrcp_server_session_t* mrcp_server_session_create(apt_pool_recycler_t *pool_recycler);
 
 /** Process signaling message */
 apt_bool_t mrcp_server_signaling_message_process(mrcp_signaling_message_t *signaling_message);
@@ -60,6 +60,8 @@ struct mrcp_server_t {
 
 	/** Table of sessions */
 	apr_hash_t              *session_table;
+	/** Recycler of session pools */
+	apt_pool_recycler_t     *session_pool_recycler;
 
 	/** Connection task message pool */
 	apt_task_msg_pool_t     *connection_msg_pool;
@@ -206,11 +208,12 @@ MRCP_DECLARE(mrcp_server_t*) mrcp_server_create(apt_dir_layout_t *dir_layout)
 	server->rtp_settings_table = NULL;
 	server->profile_table = NULL;
 	server->session_table = NULL;
+	server->session_pool_recycler = NULL;
 	server->connection_msg_pool = NULL;
 	server->engine_msg_pool = NULL;
 	server->shutdown_requested = FALSE;
 
-	msg_pool = apt_task_msg_pool_create_dynamic(0,pool);
+	msg_pool = apt_task_msg_pool_create_static(0,APT_TASK_MSG_POOL_DEFAULT_SIZE,pool);
 
 	server->task = apt_consumer_task_create(server,msg_pool,pool);
 	if(!server->task) {
@@ -242,6 +245,11 @@ MRCP_DECLARE(mrcp_server_t*) mrcp_server_create(apt_dir_layout_t *dir_layout)
 	server->profile_table = apr_hash_make(server->pool);
 	
 	server->session_table = apr_hash_make(server->pool);
+	server->session_pool_recycler = apt_pool_recycler_create(
+										"Session",
+										APT_POOL_RECYCLER_DEFAULT_MAX_COUNT,
+										APT_POOL_RECYCLER_DEFAULT_MAX_FREE_SIZE,
+										server->pool);
 	return server;
 }
 
@@ -323,6 +331,11 @@ MRCP_DECLARE(apt_bool_t) mrcp_server_destroy(mrcp_server_t *server)
 	task = apt_consumer_task_base_get(server->task);
 	apt_task_destroy(task);
 
+	if(server->session_pool_recycler) {
+		apt_pool_recycler_destroy(server->session_pool_recycler);
+		server->session_pool_recycler = NULL;
+	}
+
 	apr_pool_destroy(server->pool);
 	return TRUE;
 }
@@ -346,7 +359,7 @@ MRCP_DECLARE(apt_bool_t) mrcp_server_engine_register(mrcp_server_t *server, mrcp
 	}
 	
 	if(!server->engine_msg_pool) {
-		server->engine_msg_pool = apt_task_msg_pool_create_dynamic(sizeof(engine_task_msg_data_t),server->pool);
+		server->engine_msg_pool = apt_task_msg_pool_create_static(sizeof(engine_task_msg_data_t),APT_TASK_MSG_POOL_DEFAULT_SIZE,server->pool);
 	}
 	engine->codec_manager = server->codec_manager;
 	engine->dir_layout = server->dir_layout;
@@ -452,7 +465,7 @@ MRCP_DECLARE(apt_bool_t) mrcp_server_signaling_agent_register(mrcp_server_t *ser
 	signaling_agent->parent = server;
 	signaling_agent->resource_factory = server->resource_factory;
 	signaling_agent->create_server_session = mrcp_server_sig_agent_session_create;
-	signaling_agent->msg_pool = apt_task_msg_pool_create_dynamic(sizeof(mrcp_signaling_message_t*),server->pool);
+	signaling_agent->msg_pool = apt_task_msg_pool_create_static(sizeof(mrcp_signaling_message_t*),APT_TASK_MSG_POOL_DEFAULT_SIZE,server->pool);
 	apr_hash_set(server->sig_agent_table,signaling_agent->id,APR_HASH_KEY_STRING,signaling_agent);
 	if(server->task) {
 		apt_task_t *task = apt_consumer_task_base_get(server->task);
@@ -481,7 +494,7 @@ MRCP_DECLARE(apt_bool_t) mrcp_server_connection_agent_register(mrcp_server_t *se
 	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Register Connection Agent [%s]",id);
 	mrcp_server_connection_resource_factory_set(connection_agent,server->resource_factory);
 	mrcp_server_connection_agent_handler_set(connection_agent,server,&connection_method_vtable);
-	server->connection_msg_pool = apt_task_msg_pool_create_dynamic(sizeof(connection_agent_task_msg_data_t),server->pool);
+	server->connection_msg_pool = apt_task_msg_pool_create_static(sizeof(connection_agent_task_msg_data_t),APT_TASK_MSG_POOL_DEFAULT_SIZE,server->pool);
 	apr_hash_set(server->cnt_agent_table,id,APR_HASH_KEY_STRING,connection_agent);
 	if(server->task) {
 		apt_task_t *task = apt_consumer_task_base_get(server->task);
@@ -963,7 +976,10 @@ static mrcp_server_profile_t* mrcp_server_profile_get_by_agent(mrcp_server_t *se
 static mrcp_session_t* mrcp_server_sig_agent_session_create(mrcp_sig_agent_t *signaling_agent)
 {
 	mrcp_server_t *server = signaling_agent->parent;
-	mrcp_server_session_t *session = mrcp_server_session_create();
+	mrcp_server_session_t *session = mrcp_server_session_create(server->session_pool_recycler);
+	if(!session) {
+		return NULL;
+	}
 	session->server = server;
 	session->profile = mrcp_server_profile_get_by_agent(server,session,signaling_agent);
 	if(!session->profile) {
@@ -99,9 +99,12 @@ static apt_bool_t state_machine_on_deactivate(mrcp_state_machine_t *state_machin
 
 static apt_bool_t mrcp_session_offers_compare(const mrcp_session_descriptor_t *offer1, const mrcp_session_descriptor_t *offer2);
 
-mrcp_server_session_t* mrcp_server_session_create()
+mrcp_server_session_t* mrcp_server_session_create(apt_pool_recycler_t *pool_recycler)
 {
-	mrcp_server_session_t *session = (mrcp_server_session_t*) mrcp_session_create(sizeof(mrcp_server_session_t)-sizeof(mrcp_session_t));
+	mrcp_server_session_t *session = (mrcp_server_session_t*) mrcp_session_create_recycled(pool_recycler,sizeof(mrcp_server_session_t)-sizeof(mrcp_session_t));
+	if(!session) {
+		return NULL;
+	}
 	session->context = NULL;
 	session->terminations = apr_array_make(session->base.pool,2,sizeof(mrcp_termination_slot_t));
 	session->channels = apr_array_make(session->base.pool,2,sizeof(mrcp_channel_t*));
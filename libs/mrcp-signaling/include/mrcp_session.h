@@ -25,6 +25,7 @@
 #include "mrcp_sig_types.h"
 #include "mpf_types.h"
 #include "apt_string.h"
+#include "apt_pool.h"
 
 APT_BEGIN_EXTERN_C
 
@@ -51,6 +52,8 @@ struct mrcp_session_t {
 	apr_pool_t       *pool;
 	/** Whether the memory pool is self-owned or not */
 	apt_bool_t        self_owned;
+	/** Recycler the self-owned memory pool is acquired from, if any */
+	apt_pool_recycler_t *pool_recycler;
 	/** External object associated with session */
 	void             *obj;
 	/** External logger object associated with session */
@@ -119,6 +122,9 @@ MRCP_DECLARE(mrcp_session_t*) mrcp_session_create(apr_size_t padding);
 /** Allocate session object from the provided memory pool. Take over the ownership of the pool, if take_ownership is TRUE */
 MRCP_DECLARE(mrcp_session_t*) mrcp_session_create_ex(apr_pool_t *pool, apt_bool_t take_ownership, apr_size_t padding);
 
+/** Acquire memory pool from the recycler and allocate session object from the pool. */
+MRCP_DECLARE(mrcp_session_t*) mrcp_session_create_recycled(apt_pool_recycler_t *pool_recycler, apr_size_t padding);
+
 /** Destroy session and assosiated memory pool. */
 MRCP_DECLARE(void) mrcp_session_destroy(mrcp_session_t *session);
 
@@ -104,11 +104,30 @@ MRCP_DECLARE(mrcp_session_t*) mrcp_session_create(apr_size_t padding)
 	return mrcp_session_create_ex(pool,TRUE,padding);
 }
 
+MRCP_DECLARE(mrcp_session_t*) mrcp_session_create_recycled(apt_pool_recycler_t *pool_recycler, apr_size_t padding)
+{
+	mrcp_session_t *session;
+	apr_pool_t *pool;
+	if(!pool_recycler) {
+		return mrcp_session_create(padding);
+	}
+
+	pool = apt_pool_recycler_acquire(pool_recycler);
+	if(!pool) {
+		return NULL;
+	}
+
+	session = mrcp_session_create_ex(pool,TRUE,padding);
+	session->pool_recycler = pool_recycler;
+	return session;
+}
+
 MRCP_DECLARE(mrcp_session_t*) mrcp_session_create_ex(apr_pool_t *pool, apt_bool_t take_ownership, apr_size_t padding)
 {
 	mrcp_session_t *session;
 	session = apr_palloc(pool,sizeof(mrcp_session_t)+padding);
 	session->self_owned = take_ownership;
+	session->pool_recycler = NULL;
 	session->pool = pool;
 	session->obj = NULL;
 	session->log_obj = NULL;
@@ -129,6 +148,11 @@ MRCP_DECLARE(mrcp_session_t*) mrcp_session_create_ex(apr_pool_t *pool, apt_bool_
 MRCP_DECLARE(void) mrcp_session_destroy(mrcp_session_t *session)
 {
 	if(session->pool && session->self_owned == TRUE) {
-		apr_pool_destroy(session->pool);
+		if(session->pool_recycler) {
+			apt_pool_recycler_release(session->pool_recycler,session->pool);
+		}
+		else {
+			apr_pool_destroy(session->pool);
+		}
 	}
 }
@@ -43,6 +43,20 @@ MRCP_DECLARE(void) mrcp_parser_resource_set(mrcp_parser_t *parser, const apt_str
 /** Set verbose mode for the parser */
 MRCP_DECLARE(void) mrcp_parser_verbose_set(mrcp_parser_t *parser, apt_bool_t verbose);
 
+/**
+ * Set lazy mode for the parser.
+ * @param parser the parser to set the mode for
+ * @param lazy whether to defer parsing of header field values till they are accessed
+ * @remark See mrcp_header_fields_defer().
+ */
+MRCP_DECLARE(void) mrcp_parser_lazy_set(mrcp_parser_t *parser, apt_bool_t lazy);
+
+/** Get the part of the message body remaining to receive in place (if the body is being parsed) */
+MRCP_DECLARE(apr_size_t) mrcp_parser_body_window_get(mrcp_parser_t *parser, char **buf);
+
+/** Advance the body being parsed by the data received in place */
+MRCP_DECLARE(void) mrcp_parser_body_window_advance(mrcp_parser_t *parser, apr_size_t length);
+
 /** Parse MRCP stream */
 MRCP_DECLARE(apt_message_status_e) mrcp_parser_run(mrcp_parser_t *parser, apt_text_stream_t *stream, mrcp_message_t **message);
 
@@ -57,6 +71,9 @@ MRCP_DECLARE(void) mrcp_generator_verbose_set(mrcp_generator_t *generator, apt_b
 /** Generate MRCP stream */
 MRCP_DECLARE(apt_message_status_e) mrcp_generator_run(mrcp_generator_t *generator, mrcp_message_t *message, apt_text_stream_t *stream);
 
+/** Generate MRCP message start line and header section, return the body to send as is */
+MRCP_DECLARE(apt_message_status_e) mrcp_generator_header_run(mrcp_generator_t *generator, mrcp_message_t *message, apt_text_stream_t *stream, apt_str_t *body);
+
 
 /** Generate MRCP message (excluding message body) */
 MRCP_DECLARE(apt_bool_t) mrcp_message_generate(const mrcp_resource_factory_t *resource_factory, mrcp_message_t *message, apt_text_stream_t *stream);
@@ -26,6 +26,7 @@ struct mrcp_parser_t {
 	apt_message_parser_t          *base;
 	const mrcp_resource_factory_t *resource_factory;
 	mrcp_resource_t               *resource;
+	apt_bool_t                     lazy;
 };
 
 /** MRCP generator */
@@ -64,6 +65,7 @@ MRCP_DECLARE(mrcp_parser_t*) mrcp_parser_create(const mrcp_resource_factory_t *r
 	parser->base = apt_message_parser_create(parser,&parser_vtable,pool);
 	parser->resource_factory = resource_factory;
 	parser->resource = NULL;
+	parser->lazy = FALSE;
 	return parser;
 }
 
@@ -81,6 +83,24 @@ MRCP_DECLARE(void) mrcp_parser_verbose_set(mrcp_parser_t *parser, apt_bool_t ver
 	apt_message_parser_verbose_set(parser->base,verbose);
 }
 
+/** Set lazy mode for the parser */
+MRCP_DECLARE(void) mrcp_parser_lazy_set(mrcp_parser_t *parser, apt_bool_t lazy)
+{
+	parser->lazy = lazy;
+}
+
+/** Get the part of the message body remaining to receive in place */
+MRCP_DECLARE(apr_size_t) mrcp_parser_body_window_get(mrcp_parser_t *parser, char **buf)
+{
+	return apt_message_parser_body_window_get(parser->base,buf);
+}
+
+/** Advance the body being parsed by the data received in place */
+MRCP_DECLARE(void) mrcp_parser_body_window_advance(mrcp_parser_t *parser, apr_size_t length)
+{
+	apt_message_parser_body_window_advance(parser->base,length);
+}
+
 /** Parse MRCP stream */
 MRCP_DECLARE(apt_message_status_e) mrcp_parser_run(mrcp_parser_t *parser, apt_text_stream_t *stream, mrcp_message_t **message)
 {
@@ -129,13 +149,12 @@ static apt_bool_t mrcp_parser_on_start(apt_message_parser_t *parser, apt_message
 static apt_bool_t mrcp_parser_on_header_complete(apt_message_parser_t *parser, apt_message_context_t *context)
 {
 	mrcp_message_t *mrcp_message = context->message;
+	mrcp_parser_t *mrcp_parser = apt_message_parser_object_get(parser);
 	if(mrcp_message->start_line.version == MRCP_VERSION_2) {
 		mrcp_resource_t *resource;
-		mrcp_parser_t *mrcp_parser;
 		if(mrcp_channel_id_parse(&mrcp_message->channel_id,&mrcp_message->header,mrcp_message->pool) == FALSE) {
 			return FALSE;
 		}
-		mrcp_parser = apt_message_parser_object_get(parser);
 		/* find resource */
 		resource = mrcp_resource_find(mrcp_parser->resource_factory,&mrcp_message->channel_id.resource_name);
 		if(!resource) {
@@ -147,12 +166,19 @@ static apt_bool_t mrcp_parser_on_header_complete(apt_message_parser_t *parser, a
 		}
 	}
 
-	if(mrcp_header_fields_parse(&mrcp_message->header,mrcp_message->pool) == FALSE) {
+	if(mrcp_parser->lazy == TRUE) {
+		if(mrcp_header_fields_defer(&mrcp_message->header,mrcp_message->pool) == FALSE) {
+			return FALSE;
+		}
+		/* the content length is needed right away, the rest of the values stay deferred */
+		mrcp_header_field_value_resolve(&mrcp_message->header.generic_header_accessor,GENERIC_HEADER_CONTENT_LENGTH);
+	}
+	else if(mrcp_header_fields_parse(&mrcp_message->header,mrcp_message->pool) == FALSE) {
 		return FALSE;
 	}
 
-	if(context->body && mrcp_generic_header_property_check(mrcp_message,GENERIC_HEADER_CONTENT_LENGTH) == TRUE) {
-		mrcp_generic_header_t *generic_header = mrcp_generic_header_get(mrcp_message);
+	if(context->body && apt_header_section_field_check(&mrcp_message->header.header_section,GENERIC_HEADER_CONTENT_LENGTH) == TRUE) {
+		mrcp_generic_header_t *generic_header = mrcp_message->header.generic_header_accessor.data;
 		if(generic_header && generic_header->content_length) {
 			context->body->length = generic_header->content_length;
 		}
@@ -182,6 +208,12 @@ MRCP_DECLARE(apt_message_status_e) mrcp_generator_run(mrcp_generator_t *generato
 	return apt_message_generator_run(generator->base,message,stream);
 }
 
+/** Generate MRCP message start line and header section, return the body to send as is */
+MRCP_DECLARE(apt_message_status_e) mrcp_generator_header_run(mrcp_generator_t *generator, mrcp_message_t *message, apt_text_stream_t *stream, apt_str_t *body)
+{
+	return apt_message_generator_header_run(generator->base,message,stream,body);
+}
+
 /** Initialize by generating message start line and return header section and body */
 apt_bool_t mrcp_generator_on_start(apt_message_generator_t *generator, apt_message_context_t *context, apt_text_stream_t *stream)
 {
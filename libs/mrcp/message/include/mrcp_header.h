@@ -102,6 +102,15 @@ MRCP_DECLARE(apt_bool_t) mrcp_header_fields_inherit(mrcp_message_header_t *heade
 /** Parse MRCP header fields */
 MRCP_DECLARE(apt_bool_t) mrcp_header_fields_parse(mrcp_message_header_t *header, apr_pool_t *pool);
 
+/**
+ * Parse MRCP header field names, deferring parsing of the values till the header data is accessed.
+ * @param header the header to parse the fields of
+ * @param pool the pool to parse the values from
+ * @remark The values are parsed by mrcp_generic_header_get(), mrcp_resource_header_get()
+ * and the property checks. Fields copied to other messages keep their original bytes.
+ */
+MRCP_DECLARE(apt_bool_t) mrcp_header_fields_defer(mrcp_message_header_t *header, apr_pool_t *pool);
+
 
 /** Initialize MRCP channel-identifier */
 MRCP_DECLARE(void) mrcp_channel_id_init(mrcp_channel_id *channel_id);
@@ -24,6 +24,7 @@
 
 #include "apt_text_stream.h"
 #include "apt_header_field.h"
+#include "apt_atomic.h"
 #include "mrcp.h"
 
 APT_BEGIN_EXTERN_C
@@ -53,12 +54,28 @@ struct mrcp_header_vtable_t {
 	apr_size_t                  field_count;
 };
 
+/** States of deferred (lazily parsed) header field values */
+typedef enum {
+	MRCP_HEADER_DEFERRED_NONE,      /**< all the values are parsed into the header data */
+	MRCP_HEADER_DEFERRED_PENDING,   /**< some values are not parsed yet */
+	MRCP_HEADER_DEFERRED_RESOLVING  /**< the values are being parsed */
+} mrcp_header_deferred_state_e;
+
 /** MRCP header accessor */
 struct mrcp_header_accessor_t {
 	/** Actual header data allocated by accessor */
 	void                       *data;
 	/** Header accessor interface */
 	const mrcp_header_vtable_t *vtable;
+
+	/** Header fields whose values are not parsed yet, indexed by id (lazy mode) */
+	const apt_header_field_t  **deferred;
+	/** Entries of the header section the fields are set in, unset if the value fails to parse */
+	apt_header_field_t        **deferred_index;
+	/** Pool owned by the accessor to parse the deferred values from, used by the resolving reader only */
+	apr_pool_t                 *deferred_pool;
+	/** State of the deferred values (mrcp_header_deferred_state_e) */
+	volatile apr_uint32_t       deferred_state;
 };
 
 
@@ -90,13 +107,46 @@ static APR_INLINE void mrcp_header_accessor_init(mrcp_header_accessor_t *accesso
 {
 	accessor->data = NULL;
 	accessor->vtable = NULL;
+	accessor->deferred = NULL;
+	accessor->deferred_index = NULL;
+	accessor->deferred_pool = NULL;
+	accessor->deferred_state = MRCP_HEADER_DEFERRED_NONE;
+}
+
+/**
+ * Parse all the deferred values of header fields.
+ * @param accessor the header accessor to use
+ * @remark The values may be resolved by concurrent readers of the message.
+ */
+MRCP_DECLARE(apt_bool_t) mrcp_header_values_resolve(mrcp_header_accessor_t *accessor);
+
+/**
+ * Check whether the value of header field is deferred (not parsed yet).
+ * @param accessor the header accessor to use
+ * @param id the identifier of the header field
+ * @remark Waits for the values being parsed by a concurrent reader, if any.
+ */
+MRCP_DECLARE(apt_bool_t) mrcp_header_field_value_deferred(const mrcp_header_accessor_t *accessor, apr_size_t id);
+
+/**
+ * Get header data, parsing the deferred values (if any).
+ * @param accessor the header accessor to use
+ * @remark The header data is not changed logically by parsing of the deferred values,
+ * which allows to get it from const messages.
+ */
+static APR_INLINE void* mrcp_header_data_get(const mrcp_header_accessor_t *accessor)
+{
+	if(apt_atomic_load32_acquire(&accessor->deferred_state) != MRCP_HEADER_DEFERRED_NONE) {
+		mrcp_header_values_resolve((mrcp_header_accessor_t*)accessor);
+	}
+	return accessor->data;
 }
 
 /** Allocate header data */
 static APR_INLINE void* mrcp_header_allocate(mrcp_header_accessor_t *accessor, apr_pool_t *pool)
 {
 	if(accessor->data) {
-		return accessor->data;
+		return mrcp_header_data_get(accessor);
 	}
 	if(!accessor->vtable || !accessor->vtable->allocate) {
 		return NULL;
@@ -123,6 +173,36 @@ MRCP_DECLARE(apt_header_field_t*) mrcp_header_field_value_generate(const mrcp_he
 /** Duplicate header field value */
 MRCP_DECLARE(apt_bool_t) mrcp_header_field_value_duplicate(mrcp_header_accessor_t *accessor, const mrcp_header_accessor_t *src_accessor, apr_size_t id, const apt_str_t *value, apr_pool_t *pool);
 
+/**
+ * Find header field by name and defer parsing of its value till the header data is accessed.
+ * @param accessor the header accessor to use
+ * @param header_field the header field to set the id of and defer the value of
+ * @param index the entries of the header section the fields of the accessor are set in (by id)
+ * @param pool the pool of the message
+ * @remark The field is unset from the index, if its value fails to parse later, as if parsed in place.
+ * The values are parsed from a pool of the accessor, created from the pool of the message here,
+ * since the message may be read from another thread by then.
+ */
+MRCP_DECLARE(apt_bool_t) mrcp_header_field_value_defer(mrcp_header_accessor_t *accessor, apt_header_field_t *header_field, apt_header_field_t **index, apr_pool_t *pool);
+
+/**
+ * Defer parsing of the value of header field, identified already.
+ * @param accessor the header accessor to use
+ * @param id the identifier of the header field
+ * @param header_field the header field holding the value
+ * @param index the entries of the header section the fields of the accessor are set in (by id)
+ * @param pool the pool of the message
+ */
+MRCP_DECLARE(apt_bool_t) mrcp_header_field_value_defer_by_id(mrcp_header_accessor_t *accessor, apr_size_t id, const apt_header_field_t *header_field, apt_header_field_t **index, apr_pool_t *pool);
+
+/**
+ * Parse the deferred value of header field (if deferred).
+ * @param accessor the header accessor to use
+ * @param id the identifier of the header field
+ * @remark The value may be resolved by concurrent readers of the message.
+ */
+MRCP_DECLARE(apt_bool_t) mrcp_header_field_value_resolve(mrcp_header_accessor_t *accessor, apr_size_t id);
+
 
 APT_END_EXTERN_C
 
@@ -113,7 +113,7 @@ MRCP_DECLARE(void) mrcp_message_destroy(mrcp_message_t *message);
  */
 static APR_INLINE mrcp_generic_header_t* mrcp_generic_header_get(const mrcp_message_t *message)
 {
-	return (mrcp_generic_header_t*) message->header.generic_header_accessor.data;
+	return (mrcp_generic_header_t*) mrcp_header_data_get(&message->header.generic_header_accessor);
 }
 
 /**
@@ -161,6 +161,11 @@ static APR_INLINE apt_bool_t mrcp_generic_header_property_remove(mrcp_message_t
  */
 static APR_INLINE apt_bool_t mrcp_generic_header_property_check(const mrcp_message_t *message, apr_size_t id)
 {
+	if(apt_header_section_field_check(&message->header.header_section,id) == FALSE) {
+		return FALSE;
+	}
+	/* the value of the field is about to be read, the field is unset if the value fails to parse */
+	mrcp_header_data_get(&message->header.generic_header_accessor);
 	return apt_header_section_field_check(&message->header.header_section,id);
 }
 
@@ -171,7 +176,7 @@ static APR_INLINE apt_bool_t mrcp_generic_header_property_check(const mrcp_messa
  */
 static APR_INLINE void* mrcp_resource_header_get(const mrcp_message_t *message)
 {
-	return message->header.resource_header_accessor.data;
+	return mrcp_header_data_get(&message->header.resource_header_accessor);
 }
 
 /**
@@ -219,6 +224,11 @@ static APR_INLINE apt_bool_t mrcp_resource_header_property_remove(mrcp_message_t
  */
 static APR_INLINE apt_bool_t mrcp_resource_header_property_check(const mrcp_message_t *message, apr_size_t id)
 {
+	if(apt_header_section_field_check(&message->header.header_section,id + GENERIC_HEADER_COUNT) == FALSE) {
+		return FALSE;
+	}
+	/* the value of the field is about to be read, the field is unset if the value fails to parse */
+	mrcp_header_data_get(&message->header.resource_header_accessor);
 	return apt_header_section_field_check(&message->header.header_section,id + GENERIC_HEADER_COUNT);
 }
 
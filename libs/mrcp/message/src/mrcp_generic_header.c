@@ -19,22 +19,22 @@
 
 /** String table of mrcp generic-header fields (mrcp_generic_header_id) */
 static const apt_str_table_item_t generic_header_string_table[] = {
-	{{"Active-Request-Id-List",    22},3},
-	{{"Proxy-Sync-Id",             13},0},
-	{{"Accept-Charset",            14},7},
-	{{"Content-Type",              12},9},
-	{{"Content-Id",                10},9},
-	{{"Content-Base",              12},8},
-	{{"Content-Encoding",          16},9},
-	{{"Content-Location",          16},9},
-	{{"Content-Length",            14},10},
-	{{"Cache-Control",             13},1},
-	{{"Logging-Tag",               11},0},
-	{{"Vendor-Specific-Parameters",26},0},
-	{{"Accept",                     6},6},
-	{{"Fetch-Timeout",             13},0},
-	{{"Set-Cookie",                10},10},
-	{{"Set-Cookie2",               11},10}
+	{{"Active-Request-Id-List",    22},3,1,1},
+	{{"Proxy-Sync-Id",             13},0,1,5},
+	{{"Accept-Charset",            14},7,1,7},
+	{{"Content-Type",              12},9,1,8},
+	{{"Content-Id",                10},9,1,10},
+	{{"Content-Base",              12},8,1,12},
+	{{"Content-Encoding",          16},9,1,6},
+	{{"Content-Location",          16},9,2,4},
+	{{"Content-Length",            14},10,10,14},
+	{{"Cache-Control",             13},1,1,9},
+	{{"Logging-Tag",               11},0,4,2},
+	{{"Vendor-Specific-Parameters",26},0,5,13},
+	{{"Accept",                     6},6,7,3},
+	{{"Fetch-Timeout",             13},0,1,0},
+	{{"Set-Cookie",                10},10,3,15},
+	{{"Set-Cookie2",               11},10,20,11}
 };
 
 /** Parse mrcp request-id list */
@@ -34,10 +34,10 @@ MRCP_DECLARE(apt_bool_t) mrcp_message_header_data_alloc(
 		return FALSE;
 	}
 
-	header->generic_header_accessor.data = NULL;
+	mrcp_header_accessor_init(&header->generic_header_accessor);
 	header->generic_header_accessor.vtable = generic_header_vtable;
 
-	header->resource_header_accessor.data = NULL;
+	mrcp_header_accessor_init(&header->resource_header_accessor);
 	header->resource_header_accessor.vtable = resource_header_vtable;
 
 	apt_header_section_array_alloc(
@@ -104,28 +104,64 @@ MRCP_DECLARE(apt_bool_t) mrcp_header_fields_parse(mrcp_message_header_t *header,
 	return TRUE;
 }
 
+/** Get the entries of the header section the fields of the accessor are set in */
+static apt_header_field_t** mrcp_header_accessor_index_get(mrcp_message_header_t *header, const mrcp_header_accessor_t *accessor)
+{
+	apr_size_t offset = (accessor == &header->resource_header_accessor) ? GENERIC_HEADER_COUNT : 0;
+	if(!header->header_section.arr || offset >= header->header_section.arr_size) {
+		return NULL;
+	}
+	return header->header_section.arr + offset;
+}
+
+/** Parse MRCP header field names, deferring parsing of the values */
+MRCP_DECLARE(apt_bool_t) mrcp_header_fields_defer(mrcp_message_header_t *header, apr_pool_t *pool)
+{
+	apt_header_field_t *header_field;
+	apt_header_field_t **resource_index = mrcp_header_accessor_index_get(header,&header->resource_header_accessor);
+	apt_header_field_t **generic_index = mrcp_header_accessor_index_get(header,&header->generic_header_accessor);
+	for(header_field = APR_RING_FIRST(&header->header_section.ring);
+			header_field != APR_RING_SENTINEL(&header->header_section.ring, apt_header_field_t, link);
+				header_field = APR_RING_NEXT(header_field, link)) {
+
+		if(mrcp_header_field_value_defer(&header->resource_header_accessor,header_field,resource_index,pool) == TRUE) {
+			header_field->id += GENERIC_HEADER_COUNT;
+			apt_header_section_field_set(&header->header_section,header_field);
+		}
+		else if(mrcp_header_field_value_defer(&header->generic_header_accessor,header_field,generic_index,pool) == TRUE) {
+			apt_header_section_field_set(&header->header_section,header_field);
+		}
+		else {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unknown MRCP header field: %s",header_field->name.buf);
+		}
+	}
+
+	return TRUE;
+}
+
 static apt_bool_t mrcp_header_accessor_value_duplicate(mrcp_message_header_t *header, apt_header_field_t *header_field,
 											  const mrcp_message_header_t *src_header, const apt_header_field_t *src_header_field, 
 											  apr_pool_t *pool)
 {
-	apt_bool_t status = FALSE;
+	mrcp_header_accessor_t *accessor;
+	const mrcp_header_accessor_t *src_accessor;
+	apr_size_t id;
 	if(header_field->id < GENERIC_HEADER_COUNT) {
-		status = mrcp_header_field_value_duplicate(
-			&header->generic_header_accessor,
-			&src_header->generic_header_accessor,
-			header_field->id,
-			&header_field->value,
-			pool);
+		accessor = &header->generic_header_accessor;
+		src_accessor = &src_header->generic_header_accessor;
+		id = header_field->id;
 	}
 	else {
-		status = mrcp_header_field_value_duplicate(
-			&header->resource_header_accessor,
-			&src_header->resource_header_accessor,
-			header_field->id - GENERIC_HEADER_COUNT,
-			&header_field->value,
-			pool);
+		accessor = &header->resource_header_accessor;
+		src_accessor = &src_header->resource_header_accessor;
+		id = header_field->id - GENERIC_HEADER_COUNT;
 	}
-	return status;
+
+	if(mrcp_header_field_value_deferred(src_accessor,id) == TRUE) {
+		/* the value is not parsed in the source either, keep the copied original bytes */
+		return mrcp_header_field_value_defer_by_id(accessor,id,header_field,mrcp_header_accessor_index_get(header,accessor),pool);
+	}
+	return mrcp_header_field_value_duplicate(accessor,src_accessor,id,&header_field->value,pool);
 }
 
 /** Set (copy) MRCP header fields */
@@ -14,7 +14,9 @@
  * limitations under the License.
  */
 
+#include <apr_thread_proc.h>
 #include "mrcp_header_accessor.h"
+#include "apt_log.h"
 
 
 /** Parse header field value */
@@ -50,6 +52,9 @@ MRCP_DECLARE(apt_header_field_t*) mrcp_header_field_value_generate(const mrcp_he
 		return NULL;
 	}
 	
+	/* the value of the field may be deferred, while the data is generated from */
+	mrcp_header_field_value_resolve((mrcp_header_accessor_t*)accessor,id);
+
 	header_field = apt_header_field_alloc(pool);
 	name = apt_string_table_str_get(accessor->vtable->field_table,accessor->vtable->field_count,id);
 	if(name) {
@@ -71,6 +76,11 @@ MRCP_DECLARE(apt_bool_t) mrcp_header_field_value_duplicate(mrcp_header_accessor_
 	if(!accessor->vtable) {
 		return FALSE;
 	}
+
+	if(accessor->deferred && id < accessor->vtable->field_count) {
+		/* the value is duplicated from the source, rather than parsed from the field */
+		accessor->deferred[id] = NULL;
+	}
 	
 	if(value->length) {
 		if(accessor->vtable->duplicate_field(accessor,src_accessor,id,value,pool) == FALSE) {
@@ -80,3 +90,140 @@ MRCP_DECLARE(apt_bool_t) mrcp_header_field_value_duplicate(mrcp_header_accessor_
 
 	return TRUE;
 }
+
+/** Defer parsing of the value of header field, identified already */
+MRCP_DECLARE(apt_bool_t) mrcp_header_field_value_defer_by_id(mrcp_header_accessor_t *accessor, apr_size_t id, const apt_header_field_t *header_field, apt_header_field_t **index, apr_pool_t *pool)
+{
+	if(!accessor->vtable || id >= accessor->vtable->field_count) {
+		return FALSE;
+	}
+
+	if(!header_field->value.length) {
+		return TRUE;
+	}
+
+	if(!accessor->deferred) {
+		accessor->deferred = apr_pcalloc(pool,sizeof(const apt_header_field_t*) * accessor->vtable->field_count);
+		/* the pool of the message is not thread-safe, while the values may be parsed by any reader */
+		apr_pool_create(&accessor->deferred_pool,pool);
+	}
+	accessor->deferred[id] = header_field;
+	accessor->deferred_index = index;
+	apt_atomic_store32_release(&accessor->deferred_state,MRCP_HEADER_DEFERRED_PENDING);
+	return TRUE;
+}
+
+/** Find header field by name and defer parsing of its value */
+MRCP_DECLARE(apt_bool_t) mrcp_header_field_value_defer(mrcp_header_accessor_t *accessor, apt_header_field_t *header_field, apt_header_field_t **index, apr_pool_t *pool)
+{
+	apr_size_t id;
+	if(!accessor->vtable) {
+		return FALSE;
+	}
+
+	id = apt_string_table_id_find(accessor->vtable->field_table,accessor->vtable->field_count,&header_field->name);
+	if(id >= accessor->vtable->field_count) {
+		return FALSE;
+	}
+	header_field->id = id;
+
+	return mrcp_header_field_value_defer_by_id(accessor,id,header_field,index,pool);
+}
+
+/** Wait for the deferred values being parsed by another reader, return FALSE if there are none left */
+static apt_bool_t mrcp_header_deferred_wait(const mrcp_header_accessor_t *accessor)
+{
+	apr_uint32_t state;
+	for(;;) {
+		state = apt_atomic_load32_acquire(&accessor->deferred_state);
+		if(state != MRCP_HEADER_DEFERRED_RESOLVING) {
+			return state == MRCP_HEADER_DEFERRED_PENDING ? TRUE : FALSE;
+		}
+
+		/* another reader is parsing the values, which takes no longer than parsing them in place */
+		apr_thread_yield();
+	}
+}
+
+/** Take the exclusive right to parse the deferred values, return FALSE if there are none left */
+static apt_bool_t mrcp_header_deferred_lock(mrcp_header_accessor_t *accessor)
+{
+	do {
+		if(apr_atomic_cas32(&accessor->deferred_state,MRCP_HEADER_DEFERRED_RESOLVING,MRCP_HEADER_DEFERRED_PENDING) == MRCP_HEADER_DEFERRED_PENDING) {
+			return TRUE;
+		}
+	}
+	while(mrcp_header_deferred_wait(accessor) == TRUE);
+	return FALSE;
+}
+
+/** Parse the deferred value, the caller must hold the right to parse */
+static apt_bool_t mrcp_header_deferred_value_parse(mrcp_header_accessor_t *accessor, apr_size_t id)
+{
+	apt_bool_t status = TRUE;
+	const apt_header_field_t *header_field = accessor->deferred[id];
+	if(accessor->vtable->parse_field(accessor,id,&header_field->value,accessor->deferred_pool) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Parse MRCP Header Field: %s",header_field->name.buf);
+		/* unset the field, as if parsed in place, unless replaced meantime */
+		if(accessor->deferred_index && apt_atomic_loadptr_acquire((void**)&accessor->deferred_index[id]) == header_field) {
+			apt_atomic_storeptr_release((void**)&accessor->deferred_index[id],NULL);
+		}
+		status = FALSE;
+	}
+	/* readers, which find the value is not deferred anymore, see it written */
+	apt_atomic_storeptr_release((void**)&accessor->deferred[id],NULL);
+	return status;
+}
+
+/** Check whether the value of header field is deferred (not parsed yet) */
+MRCP_DECLARE(apt_bool_t) mrcp_header_field_value_deferred(const mrcp_header_accessor_t *accessor, apr_size_t id)
+{
+	if(!accessor->vtable || id >= accessor->vtable->field_count) {
+		return FALSE;
+	}
+	if(mrcp_header_deferred_wait(accessor) == FALSE) {
+		return FALSE;
+	}
+	return apt_atomic_loadptr_acquire((void**)&accessor->deferred[id]) ? TRUE : FALSE;
+}
+
+/** Parse the deferred value of header field */
+MRCP_DECLARE(apt_bool_t) mrcp_header_field_value_resolve(mrcp_header_accessor_t *accessor, apr_size_t id)
+{
+	apt_bool_t status = TRUE;
+	if(!accessor->vtable || id >= accessor->vtable->field_count) {
+		return FALSE;
+	}
+	if(mrcp_header_deferred_lock(accessor) == FALSE) {
+		return TRUE;
+	}
+
+	if(accessor->deferred[id]) {
+		status = mrcp_header_deferred_value_parse(accessor,id);
+	}
+	/* the rest of the values (if any) stay deferred */
+	apt_atomic_store32_release(&accessor->deferred_state,MRCP_HEADER_DEFERRED_PENDING);
+	return status;
+}
+
+/** Parse all the deferred values of header fields */
+MRCP_DECLARE(apt_bool_t) mrcp_header_values_resolve(mrcp_header_accessor_t *accessor)
+{
+	apt_bool_t status = TRUE;
+	apr_size_t id;
+
+	if(mrcp_header_deferred_lock(accessor) == FALSE) {
+		return TRUE;
+	}
+
+	for(id = 0; id < accessor->vtable->field_count; id++) {
+		if(accessor->deferred[id]) {
+			if(mrcp_header_deferred_value_parse(accessor,id) == FALSE) {
+				status = FALSE;
+			}
+		}
+	}
+
+	apt_atomic_store32_release(&accessor->deferred_state,MRCP_HEADER_DEFERRED_NONE);
+	return status;
+}
@@ -18,100 +18,100 @@
 
 /** String table of MRCPv1 recognizer header fields (mrcp_recog_header_id) */
 static const apt_str_table_item_t v1_recog_header_string_table[] = {
-	{{"Confidence-Threshold",             20},16},
-	{{"Sensitivity-Level",                17},14},
-	{{"Speed-Vs-Accuracy",                17},4},
-	{{"N-Best-List-Length",               18},1},
-	{{"No-Input-Timeout",                 16},2},
-	{{"Recognition-Timeout",              19},19},
-	{{"Waveform-Url",                     12},4},
-	{{"Completion-Cause",                 16},16},
-	{{"Recognizer-Context-Block",         24},16},
-	{{"Recognizer-Start-Timers",          23},18},
-	{{"Speech-Complete-Timeout",          23},7},
-	{{"Speech-Incomplete-Timeout",        25},12},
-	{{"DTMF-Interdigit-Timeout",          23},10},
-	{{"DTMF-Term-Timeout",                17},14},
-	{{"DTMF-Term-Char",                   14},14},
-	{{"Failed-Uri",                       10},10},
-	{{"Failed-Uri-Cause",                 16},16},
-	{{"Save-Waveform",                    13},5},
-	{{"New-Audio-Channel",                17},17},
-	{{"Speech-Language",                  15},8},
-	{{"Input-Type",                       10},10},
-	{{"Input-Waveform-Uri",               18},6},
-	{{"Completion-Reason",                17},17},
-	{{"Media-Type",                       10},0},
-	{{"Ver-Buffer-Utterance",             20},0},
-	{{"Recognition-Mode",                 16},16},
-	{{"Cancel-If-Queue",                  15},3},
-	{{"Hotword-Max-Duration",             20},10},
-	{{"Hotword-Min-Duration",             20},20},
-	{{"Interpret-Text",                   14},12},
-	{{"DTMF-Buffer-Time",                 16},16},
-	{{"Clear-DTMF-Buffer",                17},11},
-	{{"Early-No-Match",                   14},4},
-	{{"Num-Min-Consistent-Pronunciations",33},1},
-	{{"Consistency-Threshold",            21},16},
-	{{"Clash-Threshold",                  15},2},
-	{{"Personal-Grammar-URI",             20},9},
-	{{"Enroll-Utterance",                 16},10},
-	{{"Phrase-ID",                         9},8},
-	{{"Phrase-NL",                         9},9},
-	{{"Weight",                            6},3},
-	{{"Save-Best-Waveform",               18},10},
-	{{"New-Phrase-ID",                    13},4},
-	{{"Confusable-Phrases-URI",           22},4},
-	{{"Abort-Phrase-Enrollment",          23},0}
+	{{"Confidence-Threshold",             20},16,3,16},
+	{{"Sensitivity-Level",                17},14,1,29},
+	{{"Speed-Vs-Accuracy",                17},4,1,33},
+	{{"N-Best-List-Length",               18},1,1,44},
+	{{"No-Input-Timeout",                 16},2,1,39},
+	{{"Recognition-Timeout",              19},19,2,35},
+	{{"Waveform-Url",                     12},4,2,36},
+	{{"Completion-Cause",                 16},16,1,10},
+	{{"Recognizer-Context-Block",         24},16,1,3},
+	{{"Recognizer-Start-Timers",          23},18,1,2},
+	{{"Speech-Complete-Timeout",          23},7,6,5},
+	{{"Speech-Incomplete-Timeout",        25},12,2,32},
+	{{"DTMF-Interdigit-Timeout",          23},10,1,6},
+	{{"DTMF-Term-Timeout",                17},14,2,8},
+	{{"DTMF-Term-Char",                   14},14,1,19},
+	{{"Failed-Uri",                       10},10,1,7},
+	{{"Failed-Uri-Cause",                 16},16,3,22},
+	{{"Save-Waveform",                    13},5,2,26},
+	{{"New-Audio-Channel",                17},17,4,9},
+	{{"Speech-Language",                  15},8,3,25},
+	{{"Input-Type",                       10},10,3,12},
+	{{"Input-Waveform-Uri",               18},6,1,15},
+	{{"Completion-Reason",                17},17,3,42},
+	{{"Media-Type",                       10},0,1,40},
+	{{"Ver-Buffer-Utterance",             20},0,1,43},
+	{{"Recognition-Mode",                 16},16,4,14},
+	{{"Cancel-If-Queue",                  15},3,3,0},
+	{{"Hotword-Max-Duration",             20},10,1,41},
+	{{"Hotword-Min-Duration",             20},20,19,13},
+	{{"Interpret-Text",                   14},12,3,37},
+	{{"DTMF-Buffer-Time",                 16},16,26,4},
+	{{"Clear-DTMF-Buffer",                17},11,3,18},
+	{{"Early-No-Match",                   14},4,1,34},
+	{{"Num-Min-Consistent-Pronunciations",33},1,1,21},
+	{{"Consistency-Threshold",            21},16,1,20},
+	{{"Clash-Threshold",                  15},2,14,1},
+	{{"Personal-Grammar-URI",             20},9,4,30},
+	{{"Enroll-Utterance",                 16},10,19,11},
+	{{"Phrase-ID",                         9},8,1,38},
+	{{"Phrase-NL",                         9},9,1,17},
+	{{"Weight",                            6},3,64,28},
+	{{"Save-Best-Waveform",               18},10,2,23},
+	{{"New-Phrase-ID",                    13},4,1,31},
+	{{"Confusable-Phrases-URI",           22},4,41,24},
+	{{"Abort-Phrase-Enrollment",          23},0,8,27}
 };
 
 /** String table of MRCPv2 recognizer header fields (mrcp_recog_header_id) */
 static const apt_str_table_item_t v2_recog_header_string_table[] = {
-	{{"Confidence-Threshold",             20},16},
-	{{"Sensitivity-Level",                17},14},
-	{{"Speed-Vs-Accuracy",                17},4},
-	{{"N-Best-List-Length",               18},1},
-	{{"No-Input-Timeout",                 16},2},
-	{{"Recognition-Timeout",              19},19},
-	{{"Waveform-Uri",                     12},4},
-	{{"Completion-Cause",                 16},16},
-	{{"Recognizer-Context-Block",         24},7},
-	{{"Start-Input-Timers",               18},18},
-	{{"Speech-Complete-Timeout",          23},7},
-	{{"Speech-Incomplete-Timeout",        25},12},
-	{{"DTMF-Interdigit-Timeout",          23},10},
-	{{"DTMF-Term-Timeout",                17},14},
-	{{"DTMF-Term-Char",                   14},14},
-	{{"Failed-Uri",                       10},10},
-	{{"Failed-Uri-Cause",                 16},16},
-	{{"Save-Waveform",                    13},5},
-	{{"New-Audio-Channel",                17},17},
-	{{"Speech-Language",                  15},8},
-	{{"Input-Type",                       10},10},
-	{{"Input-Waveform-Uri",               18},6},
-	{{"Completion-Reason",                17},13},
-	{{"Media-Type",                       10},0},
-	{{"Ver-Buffer-Utterance",             20},0},
-	{{"Recognition-Mode",                 16},16},
-	{{"Cancel-If-Queue",                  15},3},
-	{{"Hotword-Max-Duration",             20},10},
-	{{"Hotword-Min-Duration",             20},20},
-	{{"Interpret-Text",                   14},12},
-	{{"DTMF-Buffer-Time",                 16},16},
-	{{"Clear-DTMF-Buffer",                17},11},
-	{{"Early-No-Match",                   14},4},
-	{{"Num-Min-Consistent-Pronunciations",33},1},
-	{{"Consistency-Threshold",            21},16},
-	{{"Clash-Threshold",                  15},15},
-	{{"Personal-Grammar-URI",             20},9},
-	{{"Enroll-Utterance",                 16},10},
-	{{"Phrase-ID",                         9},8},
-	{{"Phrase-NL",                         9},9},
-	{{"Weight",                            6},3},
-	{{"Save-Best-Waveform",               18},10},
-	{{"New-Phrase-ID",                    13},4},
-	{{"Confusable-Phrases-URI",           22},4},
-	{{"Abort-Phrase-Enrollment",          23},0}
+	{{"Confidence-Threshold",             20},16,3,16},
+	{{"Sensitivity-Level",                17},14,1,43},
+	{{"Speed-Vs-Accuracy",                17},4,1,33},
+	{{"N-Best-List-Length",               18},1,1,44},
+	{{"No-Input-Timeout",                 16},2,1,39},
+	{{"Recognition-Timeout",              19},19,2,10},
+	{{"Waveform-Uri",                     12},4,4,36},
+	{{"Completion-Cause",                 16},16,1,3},
+	{{"Recognizer-Context-Block",         24},7,1,40},
+	{{"Start-Input-Timers",               18},18,1,2},
+	{{"Speech-Complete-Timeout",          23},7,4,5},
+	{{"Speech-Incomplete-Timeout",        25},12,2,32},
+	{{"DTMF-Interdigit-Timeout",          23},10,1,34},
+	{{"DTMF-Term-Timeout",                17},14,3,8},
+	{{"DTMF-Term-Char",                   14},14,1,19},
+	{{"Failed-Uri",                       10},10,1,7},
+	{{"Failed-Uri-Cause",                 16},16,3,22},
+	{{"Save-Waveform",                    13},5,2,26},
+	{{"New-Audio-Channel",                17},17,4,28},
+	{{"Speech-Language",                  15},8,3,25},
+	{{"Input-Type",                       10},10,2,12},
+	{{"Input-Waveform-Uri",               18},6,1,15},
+	{{"Completion-Reason",                17},13,3,42},
+	{{"Media-Type",                       10},0,1,6},
+	{{"Ver-Buffer-Utterance",             20},0,1,29},
+	{{"Recognition-Mode",                 16},16,4,14},
+	{{"Cancel-If-Queue",                  15},3,1,0},
+	{{"Hotword-Max-Duration",             20},10,1,41},
+	{{"Hotword-Min-Duration",             20},20,19,13},
+	{{"Interpret-Text",                   14},12,3,37},
+	{{"DTMF-Buffer-Time",                 16},16,14,4},
+	{{"Clear-DTMF-Buffer",                17},11,3,18},
+	{{"Early-No-Match",                   14},4,1,9},
+	{{"Num-Min-Consistent-Pronunciations",33},1,1,21},
+	{{"Consistency-Threshold",            21},16,1,20},
+	{{"Clash-Threshold",                  15},15,8,1},
+	{{"Personal-Grammar-URI",             20},9,4,30},
+	{{"Enroll-Utterance",                 16},10,19,11},
+	{{"Phrase-ID",                         9},8,1,35},
+	{{"Phrase-NL",                         9},9,1,17},
+	{{"Weight",                            6},3,4,38},
+	{{"Save-Best-Waveform",               18},10,9,23},
+	{{"New-Phrase-ID",                    13},4,1,31},
+	{{"Confusable-Phrases-URI",           22},4,41,24},
+	{{"Abort-Phrase-Enrollment",          23},0,8,27}
 };
 
 /** String table of MRCPv1 recognizer completion-cause fields (mrcp_recog_completion_cause_e) */
@@ -20,50 +20,50 @@
 
 /** String table of MRCP recognizer methods (mrcp_recognizer_method_id) */
 static const apt_str_table_item_t v1_recog_method_string_table[] = {
-	{{"SET-PARAMS",               10},10},
-	{{"GET-PARAMS",               10},10},
-	{{"DEFINE-GRAMMAR",           14},2},
-	{{"RECOGNIZE",                 9},7},
-	{{"INTERPRET",                 9},0},
-	{{"GET-RESULT",               10},6},
-	{{"RECOGNITION-START-TIMERS", 24},7},
-	{{"STOP",                      4},2},
-	{{"START-PHRASE-ENROLLMENT",  23},2},
-	{{"ENROLLMENT-ROLLBACK",      19},2},
-	{{"END-PHRASE-ENROLLMENT",    21},5},
-	{{"MODIFY-PHRASE",            13},0},
-	{{"DELETE-PHRASE",            13},2}
+	{{"SET-PARAMS",               10},10,2,2},
+	{{"GET-PARAMS",               10},10,1,3},
+	{{"DEFINE-GRAMMAR",           14},2,1,11},
+	{{"RECOGNIZE",                 9},7,3,8},
+	{{"INTERPRET",                 9},0,1,6},
+	{{"GET-RESULT",               10},6,1,7},
+	{{"RECOGNITION-START-TIMERS", 24},7,1,4},
+	{{"STOP",                      4},2,2,0},
+	{{"START-PHRASE-ENROLLMENT",  23},2,3,1},
+	{{"ENROLLMENT-ROLLBACK",      19},2,3,10},
+	{{"END-PHRASE-ENROLLMENT",    21},5,1,5},
+	{{"MODIFY-PHRASE",            13},0,1,12},
+	{{"DELETE-PHRASE",            13},2,1,9}
 };
 
 /** String table of MRCPv2 recognizer methods (mrcp_recognizer_method_id) */
 static const apt_str_table_item_t v2_recog_method_string_table[] = {
-	{{"SET-PARAMS",               10},10},
-	{{"GET-PARAMS",               10},10},
-	{{"DEFINE-GRAMMAR",           14},2},
-	{{"RECOGNIZE",                 9},0},
-	{{"INTERPRET",                 9},0},
-	{{"GET-RESULT",               10},6},
-	{{"START-INPUT-TIMERS",       18},7},
-	{{"STOP",                      4},2},
-	{{"START-PHRASE-ENROLLMENT",  23},6},
-	{{"ENROLLMENT-ROLLBACK",      19},2},
-	{{"END-PHRASE-ENROLLMENT",    21},5},
-	{{"MODIFY-PHRASE",            13},0},
-	{{"DELETE-PHRASE",            13},2}
+	{{"SET-PARAMS",               10},10,4,3},
+	{{"GET-PARAMS",               10},10,3,6},
+	{{"DEFINE-GRAMMAR",           14},2,1,4},
+	{{"RECOGNIZE",                 9},0,3,8},
+	{{"INTERPRET",                 9},0,1,9},
+	{{"GET-RESULT",               10},6,1,2},
+	{{"START-INPUT-TIMERS",       18},7,1,11},
+	{{"STOP",                      4},2,1,10},
+	{{"START-PHRASE-ENROLLMENT",  23},6,3,0},
+	{{"ENROLLMENT-ROLLBACK",      19},2,6,7},
+	{{"END-PHRASE-ENROLLMENT",    21},5,1,5},
+	{{"MODIFY-PHRASE",            13},0,1,12},
+	{{"DELETE-PHRASE",            13},2,3,1}
 };
 
 /** String table of MRCP recognizer events (mrcp_recognizer_event_id) */
 static const apt_str_table_item_t v1_recog_event_string_table[] = {
-	{{"START-OF-SPEECH",          15},0},
-	{{"RECOGNITION-COMPLETE",     20},0},
-	{{"INTERPRETATION-COMPLETE",  23},0}
+	{{"START-OF-SPEECH",          15},0,1,2},
+	{{"RECOGNITION-COMPLETE",     20},0,5,1},
+	{{"INTERPRETATION-COMPLETE",  23},0,2,0}
 };
 
 /** String table of MRCPv2 recognizer events (mrcp_recognizer_event_id) */
 static const apt_str_table_item_t v2_recog_event_string_table[] = {
-	{{"START-OF-INPUT",           14},0},
-	{{"RECOGNITION-COMPLETE",     20},0},
-	{{"INTERPRETATION-COMPLETE",  23},0}
+	{{"START-OF-INPUT",           14},0,1,2},
+	{{"RECOGNITION-COMPLETE",     20},0,5,1},
+	{{"INTERPRETATION-COMPLETE",  23},0,2,0}
 };
 
 
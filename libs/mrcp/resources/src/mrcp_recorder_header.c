@@ -18,21 +18,21 @@
 
 /** String table of recorder header fields (mrcp_recorder_header_id) */
 static const apt_str_table_item_t recorder_header_string_table[] = {
-	{{"Sensitivity-Level",    17},3},
-	{{"No-Input-Timeout",     16},2},
-	{{"Completion-Cause",     16},16},
-	{{"Completion-Reason",    17},11},
-	{{"Failed-Uri",           10},10},
-	{{"Failed-Uri-Cause",     16},16},
-	{{"Record-Uri",           10},0},
-	{{"Media-Type",           10},2},
-	{{"Max-Time",              8},2},
-	{{"Trim-Length",          11},0},
-	{{"Final-Silence",        13},1},
-	{{"Capture-On-Speech",    17},2},
-	{{"Ver-Buffer-Utterance", 20},0},
-	{{"Start-Input-Timers",   18},1},
-	{{"New-Audio-Channel",    17},2}
+	{{"Sensitivity-Level",    17},3,1,2},
+	{{"No-Input-Timeout",     16},2,1,3},
+	{{"Completion-Cause",     16},16,3,5},
+	{{"Completion-Reason",    17},11,1,9},
+	{{"Failed-Uri",           10},10,1,12},
+	{{"Failed-Uri-Cause",     16},16,4,13},
+	{{"Record-Uri",           10},0,6,11},
+	{{"Media-Type",           10},2,3,1},
+	{{"Max-Time",              8},2,1,7},
+	{{"Trim-Length",          11},0,1,10},
+	{{"Final-Silence",        13},1,3,14},
+	{{"Capture-On-Speech",    17},2,5,4},
+	{{"Ver-Buffer-Utterance", 20},0,2,6},
+	{{"Start-Input-Timers",   18},1,10,0},
+	{{"New-Audio-Channel",    17},2,1,8}
 };
 
 /** String table of recorder completion-cause fields (mrcp_recorder_completion_cause_e) */
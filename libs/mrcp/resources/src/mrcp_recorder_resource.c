@@ -20,17 +20,17 @@
 
 /** String table of MRCP recorder methods (mrcp_recorder_method_id) */
 static const apt_str_table_item_t recorder_method_string_table[] = {
-	{{"SET-PARAMS",         10},10},
-	{{"GET-PARAMS",         10},0},
-	{{"RECORD",              6},0},
-	{{"STOP",                4},2},
-	{{"START-INPUT-TIMERS", 18},2}
+	{{"SET-PARAMS",         10},10,2,1},
+	{{"GET-PARAMS",         10},0,1,0},
+	{{"RECORD",              6},0,4,4},
+	{{"STOP",                4},2,1,2},
+	{{"START-INPUT-TIMERS", 18},2,1,3}
 };
 
 /** String table of MRCP recorder events (mrcp_recorder_event_id) */
 static const apt_str_table_item_t recorder_event_string_table[] = {
-	{{"START-OF-INPUT",     14},0},
-	{{"RECORD-COMPLETE",    15},0}
+	{{"START-OF-INPUT",     14},0,2,1},
+	{{"RECORD-COMPLETE",    15},0,1,0}
 };
 
 static APR_INLINE const apt_str_table_item_t* recorder_method_string_table_get(mrcp_version_e version)
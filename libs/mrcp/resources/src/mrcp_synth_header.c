@@ -18,27 +18,27 @@
 
 /** String table of MRCP synthesizer header fields (mrcp_synthesizer_header_id) */
 static const apt_str_table_item_t synth_header_string_table[] = {
-	{{"Jump-Size",            9},0},
-	{{"Kill-On-Barge-In",    16},0},
-	{{"Speaker-Profile",     15},8},
-	{{"Completion-Cause",    16},16},
-	{{"Completion-Reason",   17},13},
-	{{"Voice-Gender",        12},6},
-	{{"Voice-Age",            9},6},
-	{{"Voice-Variant",       13},6},
-	{{"Voice-Name",          10},8},
-	{{"Prosody-Volume",      14},8},
-	{{"Prosody-Rate",        12},12},
-	{{"Speech-Marker",       13},7},
-	{{"Speech-Language",     15},7},
-	{{"Fetch-Hint",          10},2},
-	{{"Audio-Fetch-Hint",    16},0},
-	{{"Failed-Uri",          10},10},
-	{{"Failed-Uri_Cause",    16},10},
-	{{"Speak-Restart",       13},13},
-	{{"Speak-Length",        12},6},
-	{{"Load-Lexicon",        12},2},
-	{{"Lexicon-Search-Order",20},2}
+	{{"Jump-Size",            9},0,4,10},
+	{{"Kill-On-Barge-In",    16},0,2,5},
+	{{"Speaker-Profile",     15},8,1,12},
+	{{"Completion-Cause",    16},16,1,8},
+	{{"Completion-Reason",   17},13,1,9},
+	{{"Voice-Gender",        12},6,1,19},
+	{{"Voice-Age",            9},6,3,13},
+	{{"Voice-Variant",       13},6,1,14},
+	{{"Voice-Name",          10},8,2,4},
+	{{"Prosody-Volume",      14},8,2,3},
+	{{"Prosody-Rate",        12},12,4,15},
+	{{"Speech-Marker",       13},7,1,2},
+	{{"Speech-Language",     15},7,1,18},
+	{{"Fetch-Hint",          10},2,9,20},
+	{{"Audio-Fetch-Hint",    16},0,1,11},
+	{{"Failed-Uri",          10},10,1,7},
+	{{"Failed-Uri_Cause",    16},10,1,1},
+	{{"Speak-Restart",       13},13,3,16},
+	{{"Speak-Length",        12},6,1,6},
+	{{"Load-Lexicon",        12},2,30,17},
+	{{"Lexicon-Search-Order",20},2,7,0}
 };
 
 /** String table of MRCP speech-unit fields (mrcp_speech_unit_t) */
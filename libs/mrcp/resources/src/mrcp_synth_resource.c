@@ -20,21 +20,21 @@
 
 /** String table of MRCP synthesizer methods (mrcp_synthesizer_method_id) */
 static const apt_str_table_item_t synth_method_string_table[] = {
-	{{"SET-PARAMS",       10},10},
-	{{"GET-PARAMS",       10},0},
-	{{"SPEAK",             5},1},
-	{{"STOP",              4},1},
-	{{"PAUSE",             5},0},
-	{{"RESUME",            6},0},
-	{{"BARGE-IN-OCCURRED",17},0},
-	{{"CONTROL",           7},0},
-	{{"DEFINE-LEXICON",   14},0}
+	{{"SET-PARAMS",       10},10,2,3},
+	{{"GET-PARAMS",       10},0,1,2},
+	{{"SPEAK",             5},1,1,1},
+	{{"STOP",              4},1,1,5},
+	{{"PAUSE",             5},0,1,4},
+	{{"RESUME",            6},0,1,7},
+	{{"BARGE-IN-OCCURRED",17},0,1,0},
+	{{"CONTROL",           7},0,8,6},
+	{{"DEFINE-LEXICON",   14},0,34,8}
 };
 
 /** String table of MRCP synthesizer events (mrcp_synthesizer_event_id) */
 static const apt_str_table_item_t synth_event_string_table[] = {
-	{{"SPEECH-MARKER", 13},3},
-	{{"SPEAK-COMPLETE",14},3}
+	{{"SPEECH-MARKER", 13},3,1,0},
+	{{"SPEAK-COMPLETE",14},3,2,1}
 };
 
 static APR_INLINE const apt_str_table_item_t* synth_method_string_table_get(mrcp_version_e version)
@@ -18,27 +18,27 @@
 
 /** String table of MRCP verifier header fields (mrcp_verifier_header_id) */
 static const apt_str_table_item_t verifier_header_string_table[] = {
-	{{"Repository-URI",              14},0},
-	{{"Voiceprint-Identifier",       21},12},
-	{{"Verification-Mode",           17},6},
-	{{"Adapt-Model",                 11},1},
-	{{"Abort-Model",                 11},11},
-	{{"Min-Verification-Score",      22},1},
-	{{"Num-Min-Verification-Phrases",28},6},
-	{{"Num-Max-Verification-Phrases",28},5},
-	{{"No-Input-Timeout",            16},2},
-	{{"Save-Waveform",               13},4},
-	{{"Media-Type",                  10},2},
-	{{"Waveform-URI",                12},0},
-	{{"Voiceprint-Exists",           17},11},
-	{{"Ver-Buffer-Utterance",        20},4},
-	{{"Input-Waveform-URI",          18},0},
-	{{"Completion-Cause",            16},11},
-	{{"Completion-Reason",           17},15},
-	{{"Speech-Complete-Timeout",     23},1},
-	{{"New-Audio-Channel",           17},2},
-	{{"Abort-Verification",          18},6},
-	{{"Start-Input-Timers",          18},1}
+	{{"Repository-URI",              14},0,1,4},
+	{{"Voiceprint-Identifier",       21},12,3,2},
+	{{"Verification-Mode",           17},6,4,19},
+	{{"Adapt-Model",                 11},1,1,17},
+	{{"Abort-Model",                 11},11,1,6},
+	{{"Min-Verification-Score",      22},1,1,0},
+	{{"Num-Min-Verification-Phrases",28},6,1,5},
+	{{"Num-Max-Verification-Phrases",28},5,2,16},
+	{{"No-Input-Timeout",            16},2,1,3},
+	{{"Save-Waveform",               13},4,1,15},
+	{{"Media-Type",                  10},2,4,1},
+	{{"Waveform-URI",                12},0,1,18},
+	{{"Voiceprint-Exists",           17},11,1,8},
+	{{"Ver-Buffer-Utterance",        20},4,3,13},
+	{{"Input-Waveform-URI",          18},0,1,12},
+	{{"Completion-Cause",            16},11,1,14},
+	{{"Completion-Reason",           17},15,5,7},
+	{{"Speech-Complete-Timeout",     23},1,2,9},
+	{{"New-Audio-Channel",           17},2,14,11},
+	{{"Abort-Verification",          18},6,82,10},
+	{{"Start-Input-Timers",          18},1,1,20}
 };
 
 /** String table of MRCP verifier completion-cause fields (mrcp_verifier_completion_cause_e) */
@@ -20,25 +20,25 @@
 
 /** String table of MRCP verifier methods (mrcp_verifier_method_id) */
 static const apt_str_table_item_t verifier_method_string_table[] = {
-	{{"SET-PARAMS",             10},10},
-	{{"GET-PARAMS",             10},10},
-	{{"START-SESSION",          13},8},
-	{{"END-SESSION",            11},0},
-	{{"QUERY-VOICEPRINT",       16},0},
-	{{"DELETE-VOICEPRINT",      17},0},
-	{{"VERIFY",                  6},6},
-	{{"VERIFY-FROM-BUFFER",     18},7},
-	{{"VERIFY-ROLLBACK",        15},7},
-	{{"STOP",                    4},2},
-	{{"CLEAR-BUFFER",           12},0},
-	{{"START-INPUT-TIMERS",     18},6},
-	{{"GET-INTERMEDIATE-RESULT",23},4},
+	{{"SET-PARAMS",             10},10,2,10},
+	{{"GET-PARAMS",             10},10,1,3},
+	{{"START-SESSION",          13},8,1,11},
+	{{"END-SESSION",            11},0,1,5},
+	{{"QUERY-VOICEPRINT",       16},0,1,12},
+	{{"DELETE-VOICEPRINT",      17},0,1,9},
+	{{"VERIFY",                  6},6,1,8},
+	{{"VERIFY-FROM-BUFFER",     18},7,5,7},
+	{{"VERIFY-ROLLBACK",        15},7,1,1},
+	{{"STOP",                    4},2,1,0},
+	{{"CLEAR-BUFFER",           12},0,1,4},
+	{{"START-INPUT-TIMERS",     18},6,5,2},
+	{{"GET-INTERMEDIATE-RESULT",23},4,2,6},
 };
 
 /** String table of MRCP verifier events (mrcp_verifier_event_id) */
 static const apt_str_table_item_t verifier_event_string_table[] = {
-	{{"START-OF-INPUT",       14},0},
-	{{"VERIFICATION-COMPLETE",21},0},
+	{{"START-OF-INPUT",       14},0,2,1},
+	{{"VERIFICATION-COMPLETE",21},0,1,0},
 };
 
 static APR_INLINE const apt_str_table_item_t* verifier_method_string_table_get(mrcp_version_e version)
@@ -87,6 +87,15 @@ MRCP_DECLARE(void) mrcp_client_connection_rx_size_set(
 								mrcp_connection_agent_t *agent,
 								apr_size_t size);
 
+/**
+ * Set max size the rx buffer grows up to, when a message does not fit it.
+ * @param agent the agent to set buffer size for
+ * @param size the max size of rx buffer to set
+ */
+MRCP_DECLARE(void) mrcp_client_connection_rx_max_size_set(
+								mrcp_connection_agent_t *agent,
+								apr_size_t size);
+
 /**
  * Set tx buffer size.
  * @param agent the agent to set buffer size for
@@ -30,11 +30,14 @@
 #include <apr_ring.h>
 #include "mrcp_connection_types.h"
 #include "mrcp_stream.h"
+#include "apt_pool.h"
 
 APT_BEGIN_EXTERN_C
 
 /** Size of the buffer used for MRCP rx/tx stream */
 #define MRCP_STREAM_BUFFER_SIZE 1024
+/** Max size the buffers used for MRCP rx/tx stream grow up to (by default for rx stream) */
+#define MRCP_STREAM_BUFFER_MAX_SIZE 65536
 
 /** MRCPv2 connection */
 struct mrcp_connection_t {
@@ -43,6 +46,8 @@ struct mrcp_connection_t {
 
 	/** Memory pool */
 	apr_pool_t       *pool;
+	/** Recycler the memory pool is acquired from, if any */
+	apt_pool_recycler_t *pool_recycler;
 
 	/** Accepted/Connected socket */
 	apr_socket_t     *sock;
@@ -66,14 +71,14 @@ struct mrcp_connection_t {
 	apr_size_t        use_count;
 	/** Opaque agent */
 	void             *agent;
+	/** Opaque poller of the agent, serving the connection */
+	void             *poller;
 
 	/** Table of control channels */
 	apr_hash_t       *channel_table;
 
-	/** Rx buffer */
-	char             *rx_buffer;
-	/** Rx buffer size */
-	apr_size_t        rx_buffer_size;
+	/** Rx buffer (grows on demand) */
+	apt_text_rx_buffer_t rx_buffer;
 	/** Rx stream */
 	apt_text_stream_t rx_stream;
 	/** MRCP parser */
@@ -92,8 +97,8 @@ struct mrcp_connection_t {
 	apt_timer_t      *termination_timer;
 };
 
-/** Create MRCP connection. */
-mrcp_connection_t* mrcp_connection_create(void);
+/** Create MRCP connection, acquire memory pool from the recycler, if specified. */
+mrcp_connection_t* mrcp_connection_create(apt_pool_recycler_t *pool_recycler);
 
 /** Destroy MRCP connection. */
 void mrcp_connection_destroy(mrcp_connection_t *connection);
@@ -110,6 +115,12 @@ apt_bool_t mrcp_connection_channel_remove(mrcp_connection_t *connection, mrcp_co
 /** Raise disconnect event for each channel from the specified connection. */
 apt_bool_t mrcp_connection_disconnect_raise(mrcp_connection_t *connection, const mrcp_connection_event_vtable_t *vtable);
 
+/** Generate message header into the tx buffer, which grows up to MRCP_STREAM_BUFFER_MAX_SIZE to fit the header. */
+apt_message_status_e mrcp_connection_header_generate(mrcp_connection_t *connection, mrcp_message_t *message, apt_text_stream_t *stream, apt_str_t *body);
+
+/** Send generated message header and referenced message body by a single gather write. */
+apt_bool_t mrcp_connection_message_send(mrcp_connection_t *connection, const apt_str_t *header, const apt_str_t *body);
+
 APT_END_EXTERN_C
 
 #endif /* MRCP_CONNECTION_H */
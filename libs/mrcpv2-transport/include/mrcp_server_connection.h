@@ -44,6 +44,25 @@ MRCP_DECLARE(mrcp_connection_agent_t*) mrcp_server_connection_agent_create(
 										apt_bool_t force_new_connection,
 										apr_pool_t *pool);
 
+/**
+ * Create connection agent served by the specified number of threads.
+ * @param id the identifier of the engine
+ * @param listen_ip the IP address to listen on
+ * @param listen_port the port to listen on
+ * @param max_connection_count the number of max MRCPv2 connections (per thread)
+ * @param force_new_connection the policy used in o/a for connection establishment
+ * @param thread_count the number of threads, each listening on the same port (SO_REUSEPORT)
+ * @param pool the pool to allocate memory from
+ */
+MRCP_DECLARE(mrcp_connection_agent_t*) mrcp_server_connection_agent_create_ex(
+										const char *id,
+										const char *listen_ip, 
+										apr_port_t listen_port, 
+										apr_size_t max_connection_count,
+										apt_bool_t force_new_connection,
+										apr_size_t thread_count,
+										apr_pool_t *pool);
+
 /**
  * Destroy connection agent.
  * @param agent the agent to destroy
@@ -91,6 +110,15 @@ MRCP_DECLARE(void) mrcp_server_connection_rx_size_set(
 								mrcp_connection_agent_t *agent,
 								apr_size_t size);
 
+/**
+ * Set max size the rx buffer grows up to, when a message does not fit it.
+ * @param agent the agent to set buffer size for
+ * @param size the max size of rx buffer to set
+ */
+MRCP_DECLARE(void) mrcp_server_connection_rx_max_size_set(
+								mrcp_connection_agent_t *agent,
+								apr_size_t size);
+
 /**
  * Set tx buffer size.
  * @param agent the agent to set buffer size for
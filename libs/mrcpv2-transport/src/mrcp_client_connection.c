@@ -36,6 +36,7 @@ struct mrcp_connection_agent_t {
 	apt_bool_t                            offer_new_connection;
 	apr_size_t                            tx_buffer_size;
 	apr_size_t                            rx_buffer_size;
+	apr_size_t                            rx_buffer_max_size;
 
 	void                                 *obj;
 	const mrcp_connection_event_vtable_t *vtable;
@@ -81,9 +82,10 @@ MRCP_DECLARE(mrcp_connection_agent_t*) mrcp_client_connection_agent_create(
 	agent->request_timeout = 0;
 	agent->offer_new_connection = offer_new_connection;
 	agent->rx_buffer_size = MRCP_STREAM_BUFFER_SIZE;
+	agent->rx_buffer_max_size = MRCP_STREAM_BUFFER_MAX_SIZE;
 	agent->tx_buffer_size = MRCP_STREAM_BUFFER_SIZE;
 
-	msg_pool = apt_task_msg_pool_create_dynamic(sizeof(connection_task_msg_t),pool);
+	msg_pool = apt_task_msg_pool_create_static(sizeof(connection_task_msg_t),APT_TASK_MSG_POOL_DEFAULT_SIZE,pool);
 
 	agent->task = apt_poller_task_create(
 					max_connection_count,
@@ -158,6 +160,14 @@ MRCP_DECLARE(void) mrcp_client_connection_rx_size_set(
 	agent->rx_buffer_size = size;
 }
 
+/** Set max size the rx buffer grows up to */
+MRCP_DECLARE(void) mrcp_client_connection_rx_max_size_set(
+								mrcp_connection_agent_t *agent,
+								apr_size_t size)
+{
+	agent->rx_buffer_max_size = size;
+}
+
 /** Set tx buffer size */
 MRCP_DECLARE(void) mrcp_client_connection_tx_size_set(
 								mrcp_connection_agent_t *agent,
@@ -286,7 +296,7 @@ static mrcp_connection_t* mrcp_client_agent_connection_create(mrcp_connection_ag
 {
 	char *local_ip = NULL;
 	char *remote_ip = NULL;
-	mrcp_connection_t *connection = mrcp_connection_create();
+	mrcp_connection_t *connection = mrcp_connection_create(NULL);
 
 	apr_sockaddr_info_get(&connection->r_sockaddr,descriptor->ip.buf,APR_INET,descriptor->port,0,connection->pool);
 	if(!connection->r_sockaddr) {
@@ -343,9 +353,12 @@ static mrcp_connection_t* mrcp_client_agent_connection_create(mrcp_connection_ag
 	connection->tx_buffer_size = agent->tx_buffer_size;
 	connection->tx_buffer = apr_palloc(connection->pool,connection->tx_buffer_size+1);
 
-	connection->rx_buffer_size = agent->rx_buffer_size;
-	connection->rx_buffer = apr_palloc(connection->pool,connection->rx_buffer_size+1);
-	apt_text_stream_init(&connection->rx_stream,connection->rx_buffer,connection->rx_buffer_size);
+	apt_text_rx_buffer_init(
+		&connection->rx_buffer,
+		&connection->rx_stream,
+		apr_palloc(connection->pool,agent->rx_buffer_size+1),
+		agent->rx_buffer_size,
+		agent->rx_buffer_max_size);
 
 	if(apt_log_masking_get() != APT_LOG_MASKING_NONE) {
 		connection->verbose = FALSE;
@@ -511,6 +524,7 @@ static apt_bool_t mrcp_client_agent_messsage_send(mrcp_connection_agent_t *agent
 	mrcp_connection_t *connection = channel->connection;
 	apt_text_stream_t stream;
 	apt_message_status_e result;
+	apt_str_t body;
 
 	if(!connection || !connection->sock) {
 		apt_obj_log(APT_LOG_MARK,APT_PRIO_WARNING,channel->log_obj,"Null MRCPv2 Connection " APT_SIDRES_FMT,MRCP_MESSAGE_SIDRES(message));
@@ -518,33 +532,29 @@ static apt_bool_t mrcp_client_agent_messsage_send(mrcp_connection_agent_t *agent
 		return FALSE;
 	}
 
-	do {
-		apt_text_stream_init(&stream,connection->tx_buffer,connection->tx_buffer_size);
-		result = mrcp_generator_run(connection->generator,message,&stream);
-		if(result != APT_MESSAGE_STATUS_INVALID) {
-			stream.text.length = stream.pos - stream.text.buf;
-			*stream.pos = '\0';
-
-			apt_obj_log(APT_LOG_MARK,APT_PRIO_INFO,channel->log_obj,"Send MRCPv2 Data %s [%"APR_SIZE_T_FMT" bytes]\n%.*s",
-				connection->id,
-				stream.text.length,
-				connection->verbose == TRUE ? stream.text.length : 0,
-				stream.text.buf);
-
-			if(apr_socket_send(connection->sock,stream.text.buf,&stream.text.length) == APR_SUCCESS) {
-				status = TRUE;
-			}
-			else {
-				apt_obj_log(APT_LOG_MARK,APT_PRIO_WARNING,channel->log_obj,"Failed to Send MRCPv2 Data %s",
-					connection->id);
-			}
+	/* generate the header only and send the body as is, from where it is */
+	result = mrcp_connection_header_generate(connection,message,&stream,&body);
+	if(result == APT_MESSAGE_STATUS_COMPLETE) {
+		apt_obj_log(APT_LOG_MARK,APT_PRIO_INFO,channel->log_obj,"Send MRCPv2 Data %s [%"APR_SIZE_T_FMT" bytes]\n%.*s%.*s",
+			connection->id,
+			stream.text.length + body.length,
+			connection->verbose == TRUE ? stream.text.length : 0,
+			stream.text.buf,
+			connection->verbose == TRUE ? body.length : 0,
+			body.buf);
+
+		if(mrcp_connection_message_send(connection,&stream.text,&body) == TRUE) {
+			status = TRUE;
 		}
 		else {
-			apt_obj_log(APT_LOG_MARK,APT_PRIO_WARNING,channel->log_obj,"Failed to Generate MRCPv2 Data %s",
+			apt_obj_log(APT_LOG_MARK,APT_PRIO_WARNING,channel->log_obj,"Failed to Send MRCPv2 Data %s",
 				connection->id);
 		}
 	}
-	while(result == APT_MESSAGE_STATUS_INCOMPLETE);
+	else {
+		apt_obj_log(APT_LOG_MARK,APT_PRIO_WARNING,channel->log_obj,"Failed to Generate MRCPv2 Data %s",
+			connection->id);
+	}
 
 	if(status == TRUE) {
 		channel->active_request = message;
@@ -602,6 +612,8 @@ static apt_bool_t mrcp_client_poller_signal_process(void *obj, const apr_pollfd_
 	apr_status_t status;
 	apr_size_t offset;
 	apr_size_t length;
+	apr_size_t required_length;
+	char *window;
 	apt_text_stream_t *stream;
 	mrcp_message_t *message;
 	apt_message_status_e msg_status;
@@ -613,8 +625,14 @@ static apt_bool_t mrcp_client_poller_signal_process(void *obj, const apr_pollfd_
 
 	/* calculate offset remaining from the previous receive / if any */
 	offset = stream->pos - stream->text.buf;
+	/* grow the buffer to fit the rest of the message body or a line which exceeds the buffer */
+	required_length = offset + mrcp_parser_body_window_get(connection->parser,&window);
+	if(offset == connection->rx_buffer.size) {
+		required_length = offset + 1;
+	}
+	apt_text_rx_buffer_grow(&connection->rx_buffer,stream,required_length);
 	/* calculate available length */
-	length = connection->rx_buffer_size - offset;
+	length = connection->rx_buffer.size - offset;
 
 	status = apr_socket_recv(connection->sock,stream->pos,&length);
 	if(status == APR_EOF || length == 0) {
@@ -649,6 +667,10 @@ static apt_bool_t mrcp_client_poller_signal_process(void *obj, const apr_pollfd_
 
 	/* scroll remaining stream */
 	apt_text_stream_scroll(stream);
+	/* shrink the buffer back, once there is no message in progress */
+	if(!mrcp_parser_body_window_get(connection->parser,&window)) {
+		apt_text_rx_buffer_shrink(&connection->rx_buffer,stream);
+	}
 	return TRUE;
 }
 
@@ -14,19 +14,23 @@
  * limitations under the License.
  */
 
+#define APR_WANT_IOVEC
+#include <apr_want.h>
 #include "mrcp_connection.h"
 #include "apt_pool.h"
+#include "apt_log.h"
 
-mrcp_connection_t* mrcp_connection_create(void)
+mrcp_connection_t* mrcp_connection_create(apt_pool_recycler_t *pool_recycler)
 {
 	mrcp_connection_t *connection;
-	apr_pool_t *pool = apt_pool_create();
+	apr_pool_t *pool = pool_recycler ? apt_pool_recycler_acquire(pool_recycler) : apt_pool_create();
 	if(!pool) {
 		return NULL;
 	}
 	
 	connection = apr_palloc(pool,sizeof(mrcp_connection_t));
 	connection->pool = pool;
+	connection->pool_recycler = pool_recycler;
 	apt_string_reset(&connection->remote_ip);
 	connection->l_sockaddr = NULL;
 	connection->r_sockaddr = NULL;
@@ -35,12 +39,13 @@ mrcp_connection_t* mrcp_connection_create(void)
 	connection->verbose = TRUE;
 	connection->access_count = 0;
 	connection->use_count = 0;
+	connection->agent = NULL;
+	connection->poller = NULL;
 	APR_RING_ELEM_INIT(connection,link);
 	connection->channel_table = apr_hash_make(pool);
 	connection->parser = NULL;
 	connection->generator = NULL;
-	connection->rx_buffer = NULL;
-	connection->rx_buffer_size = 0;
+	memset(&connection->rx_buffer,0,sizeof(connection->rx_buffer));
 	connection->tx_buffer = NULL;
 	connection->tx_buffer_size = 0;
 	connection->inactivity_timer = NULL;
@@ -52,7 +57,13 @@ mrcp_connection_t* mrcp_connection_create(void)
 void mrcp_connection_destroy(mrcp_connection_t *connection)
 {
 	if(connection && connection->pool) {
-		apr_pool_destroy(connection->pool);
+		apt_text_rx_buffer_release(&connection->rx_buffer);
+		if(connection->pool_recycler) {
+			apt_pool_recycler_release(connection->pool_recycler,connection->pool);
+		}
+		else {
+			apr_pool_destroy(connection->pool);
+		}
 	}
 }
 
@@ -87,6 +98,67 @@ apt_bool_t mrcp_connection_channel_remove(mrcp_connection_t *connection, mrcp_co
 	return TRUE;
 }
 
+apt_message_status_e mrcp_connection_header_generate(mrcp_connection_t *connection, mrcp_message_t *message, apt_text_stream_t *stream, apt_str_t *body)
+{
+	apt_message_status_e result;
+	apt_text_stream_init(stream,connection->tx_buffer,connection->tx_buffer_size);
+	result = mrcp_generator_header_run(connection->generator,message,stream,body);
+	while(result == APT_MESSAGE_STATUS_INCOMPLETE && connection->tx_buffer_size < MRCP_STREAM_BUFFER_MAX_SIZE) {
+		/* the header is generated as a whole, grow the buffer to fit it */
+		connection->tx_buffer_size = connection->tx_buffer_size ? connection->tx_buffer_size * 2 : MRCP_STREAM_BUFFER_SIZE;
+		if(connection->tx_buffer_size > MRCP_STREAM_BUFFER_MAX_SIZE) {
+			connection->tx_buffer_size = MRCP_STREAM_BUFFER_MAX_SIZE;
+		}
+		connection->tx_buffer = apr_palloc(connection->pool,connection->tx_buffer_size+1);
+		apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Grow MRCPv2 Tx Buffer %s [%"APR_SIZE_T_FMT" bytes]",
+			connection->id,
+			connection->tx_buffer_size);
+
+		apt_text_stream_init(stream,connection->tx_buffer,connection->tx_buffer_size);
+		result = mrcp_generator_header_run(connection->generator,message,stream,body);
+	}
+
+	if(result == APT_MESSAGE_STATUS_COMPLETE) {
+		stream->text.length = stream->pos - stream->text.buf;
+		*stream->pos = '\0';
+	}
+	return result;
+}
+
+apt_bool_t mrcp_connection_message_send(mrcp_connection_t *connection, const apt_str_t *header, const apt_str_t *body)
+{
+	struct iovec vec[2];
+	apr_int32_t nvec = 0;
+	apr_int32_t i = 0;
+	apr_size_t length;
+
+	vec[nvec].iov_base = header->buf;
+	vec[nvec].iov_len = header->length;
+	nvec++;
+	if(body && body->length) {
+		vec[nvec].iov_base = body->buf;
+		vec[nvec].iov_len = body->length;
+		nvec++;
+	}
+
+	while(i < nvec) {
+		length = 0;
+		if(apr_socket_sendv(connection->sock,vec + i,nvec - i,&length) != APR_SUCCESS) {
+			return FALSE;
+		}
+		/* skip the vectors sent and advance the one sent partially, if any */
+		while(i < nvec && length >= vec[i].iov_len) {
+			length -= vec[i].iov_len;
+			i++;
+		}
+		if(i < nvec) {
+			vec[i].iov_base = (char*)vec[i].iov_base + length;
+			vec[i].iov_len -= length;
+		}
+	}
+	return TRUE;
+}
+
 apt_bool_t mrcp_connection_disconnect_raise(mrcp_connection_t *connection, const mrcp_connection_event_vtable_t *vtable)
 {
 	if(vtable && vtable->on_disconnect) {
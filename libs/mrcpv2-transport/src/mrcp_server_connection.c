@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <apr_thread_mutex.h>
+#include <apr_portable.h>
 #include "mrcp_connection.h"
 #include "mrcp_server_connection.h"
 #include "mrcp_control_descriptor.h"
@@ -25,27 +27,49 @@
 #include "apt_log.h"
 
 
+typedef struct mrcp_connection_poller_t mrcp_connection_poller_t;
+
+/** Poller (thread) of connection agent, serving the connections accepted by its own listener */
+struct mrcp_connection_poller_t {
+	/** Agent the poller belongs to */
+	mrcp_connection_agent_t              *agent;
+	/** Poller task */
+	apt_poller_task_t                    *task;
+
+	/* Listening socket */
+	apr_socket_t                         *listen_sock;
+	apr_pollfd_t                          listen_sock_pfd;
+};
+
 struct mrcp_connection_agent_t {
 	apr_pool_t                           *pool;
-	apt_poller_task_t                    *task;
+	/** Pollers, the first (primary) one is the parent task of the others
+	and processes channel add/modify/remove requests */
+	mrcp_connection_poller_t             *pollers;
+	/** Number of pollers */
+	apr_size_t                            poller_count;
 	const mrcp_resource_factory_t        *resource_factory;
 
+	/** Guards the connection list, the pending channel table and
+	the assignment of channels to connections across the pollers */
+	apr_thread_mutex_t                   *guard;
 	/** List (ring) of MRCP connections */
 	APR_RING_HEAD(mrcp_connection_head_t, mrcp_connection_t) connection_list;
 	/** Table of pending control channels */
 	apr_hash_t                           *pending_channel_table;
+	/** Recycler of connection pools */
+	apt_pool_recycler_t                  *pool_recycler;
 
 	apt_bool_t                            force_new_connection;
 	apr_size_t                            max_shared_use_count;
 	apr_size_t                            tx_buffer_size;
 	apr_size_t                            rx_buffer_size;
+	apr_size_t                            rx_buffer_max_size;
 	apr_uint32_t                          inactivity_timeout;
 	apr_uint32_t                          termination_timeout;
 
-	/* Listening socket */
+	/* Listening address */
 	apr_sockaddr_t                       *sockaddr;
-	apr_socket_t                         *listen_sock;
-	apr_pollfd_t                          listen_sock_pfd;
 
 	void                                 *obj;
 	const mrcp_connection_event_vtable_t *vtable;
@@ -71,8 +95,8 @@ static apt_bool_t mrcp_server_agent_on_destroy(apt_task_t *task);
 static apt_bool_t mrcp_server_agent_msg_process(apt_task_t *task, apt_task_msg_t *task_msg);
 static apt_bool_t mrcp_server_poller_signal_process(void *obj, const apr_pollfd_t *descriptor);
 
-static apt_bool_t mrcp_server_agent_listening_socket_create(mrcp_connection_agent_t *agent);
-static void mrcp_server_agent_listening_socket_destroy(mrcp_connection_agent_t *agent);
+static apt_bool_t mrcp_server_agent_listening_socket_create(mrcp_connection_poller_t *poller);
+static void mrcp_server_agent_listening_socket_destroy(mrcp_connection_poller_t *poller);
 
 static void mrcp_server_inactivity_timer_proc(apt_timer_t *timer, void *obj);
 static void mrcp_server_termination_timer_proc(apt_timer_t *timer, void *obj);
@@ -85,25 +109,82 @@ MRCP_DECLARE(mrcp_connection_agent_t*) mrcp_server_connection_agent_create(
 										apr_size_t max_connection_count,
 										apt_bool_t force_new_connection,
 										apr_pool_t *pool)
+{
+	return mrcp_server_connection_agent_create_ex(id,listen_ip,listen_port,max_connection_count,force_new_connection,1,pool);
+}
+
+/** Create poller of connection agent */
+static apt_bool_t mrcp_server_agent_poller_create(mrcp_connection_agent_t *agent, mrcp_connection_poller_t *poller, const char *name, apr_size_t max_connection_count)
 {
 	apt_task_t *task;
 	apt_task_vtable_t *vtable;
 	apt_task_msg_pool_t *msg_pool;
+
+	poller->agent = agent;
+	poller->listen_sock = NULL;
+
+	msg_pool = apt_task_msg_pool_create_static(sizeof(connection_task_msg_t),APT_TASK_MSG_POOL_DEFAULT_SIZE,agent->pool);
+
+	poller->task = apt_poller_task_create(
+					max_connection_count + 1,
+					mrcp_server_poller_signal_process,
+					poller,
+					msg_pool,
+					agent->pool);
+	if(!poller->task) {
+		return FALSE;
+	}
+
+	task = apt_poller_task_base_get(poller->task);
+	if(task) {
+		apt_task_name_set(task,name);
+	}
+
+	vtable = apt_poller_task_vtable_get(poller->task);
+	if(vtable) {
+		vtable->destroy = mrcp_server_agent_on_destroy;
+		vtable->process_msg = mrcp_server_agent_msg_process;
+	}
+	return TRUE;
+}
+
+/** Create connection agent served by the specified number of threads */
+MRCP_DECLARE(mrcp_connection_agent_t*) mrcp_server_connection_agent_create_ex(
+										const char *id,
+										const char *listen_ip,
+										apr_port_t listen_port,
+										apr_size_t max_connection_count,
+										apt_bool_t force_new_connection,
+										apr_size_t thread_count,
+										apr_pool_t *pool)
+{
 	mrcp_connection_agent_t *agent;
+	apt_task_t *primary_task;
+	apr_size_t i;
 
 	if(!listen_ip) {
 		return NULL;
 	}
-	
-	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Create MRCPv2 Agent [%s] %s:%hu [%"APR_SIZE_T_FMT"]",
-		id,listen_ip,listen_port,max_connection_count);
+
+	if(!thread_count) {
+		thread_count = 1;
+	}
+#ifndef SO_REUSEPORT
+	if(thread_count > 1) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"SO_REUSEPORT is not Supported: Serve MRCPv2 Agent [%s] by Single Thread",id);
+		thread_count = 1;
+	}
+#endif
+
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Create MRCPv2 Agent [%s] %s:%hu [%"APR_SIZE_T_FMT"] threads [%"APR_SIZE_T_FMT"]",
+		id,listen_ip,listen_port,max_connection_count,thread_count);
 	agent = apr_palloc(pool,sizeof(mrcp_connection_agent_t));
 	agent->pool = pool;
 	agent->sockaddr = NULL;
-	agent->listen_sock = NULL;
 	agent->force_new_connection = force_new_connection;
 	agent->max_shared_use_count = 100;
 	agent->rx_buffer_size = MRCP_STREAM_BUFFER_SIZE;
+	agent->rx_buffer_max_size = MRCP_STREAM_BUFFER_MAX_SIZE;
 	agent->tx_buffer_size = MRCP_STREAM_BUFFER_SIZE;
 	agent->inactivity_timeout = 600000; /* 10 min */
 	agent->termination_timeout = 3000; /* 3 sec */
@@ -113,37 +194,41 @@ MRCP_DECLARE(mrcp_connection_agent_t*) mrcp_server_connection_agent_create(
 		return NULL;
 	}
 
-	msg_pool = apt_task_msg_pool_create_dynamic(sizeof(connection_task_msg_t),pool);
-	
-	agent->task = apt_poller_task_create(
-					max_connection_count + 1,
-					mrcp_server_poller_signal_process,
-					agent,
-					msg_pool,
-					pool);
-	if(!agent->task) {
+	agent->guard = NULL;
+	if(apr_thread_mutex_create(&agent->guard,APR_THREAD_MUTEX_DEFAULT,pool) != APR_SUCCESS) {
 		return NULL;
 	}
 
-	task = apt_poller_task_base_get(agent->task);
-	if(task) {
-		apt_task_name_set(task,id);
+	agent->poller_count = thread_count;
+	agent->pollers = apr_palloc(pool,sizeof(mrcp_connection_poller_t) * agent->poller_count);
+	for(i = 0; i < agent->poller_count; i++) {
+		const char *name = i ? apr_psprintf(pool,"%s-%"APR_SIZE_T_FMT,id,i+1) : id;
+		if(mrcp_server_agent_poller_create(agent,&agent->pollers[i],name,max_connection_count) == FALSE) {
+			return NULL;
+		}
 	}
 
-	vtable = apt_poller_task_vtable_get(agent->task);
-	if(vtable) {
-		vtable->destroy = mrcp_server_agent_on_destroy;
-		vtable->process_msg = mrcp_server_agent_msg_process;
+	/* the other pollers are started, terminated and destroyed along with the primary one */
+	primary_task = apt_poller_task_base_get(agent->pollers[0].task);
+	for(i = 1; i < agent->poller_count; i++) {
+		apt_task_add(primary_task,apt_poller_task_base_get(agent->pollers[i].task));
 	}
 
 	APR_RING_INIT(&agent->connection_list, mrcp_connection_t, link);
 	agent->pending_channel_table = apr_hash_make(pool);
-
-	if(mrcp_server_agent_listening_socket_create(agent) != TRUE) {
-		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Listening Socket [%s] %s:%hu", 
-				id,
-				listen_ip,
-				listen_port);
+	agent->pool_recycler = apt_pool_recycler_create(
+								id,
+								APT_POOL_RECYCLER_DEFAULT_MAX_COUNT,
+								APT_POOL_RECYCLER_DEFAULT_MAX_FREE_SIZE,
+								pool);
+
+	for(i = 0; i < agent->poller_count; i++) {
+		if(mrcp_server_agent_listening_socket_create(&agent->pollers[i]) != TRUE) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Listening Socket [%s] %s:%hu", 
+					apt_task_name_get(apt_poller_task_base_get(agent->pollers[i].task)),
+					listen_ip,
+					listen_port);
+		}
 	}
 	return agent;
 }
@@ -151,10 +236,24 @@ MRCP_DECLARE(mrcp_connection_agent_t*) mrcp_server_connection_agent_create(
 static apt_bool_t mrcp_server_agent_on_destroy(apt_task_t *task)
 {
 	apt_poller_task_t *poller_task = apt_task_object_get(task);
-	mrcp_connection_agent_t *agent = apt_poller_task_object_get(poller_task);
+	mrcp_connection_poller_t *poller = apt_poller_task_object_get(poller_task);
+	mrcp_connection_agent_t *agent = poller->agent;
 
-	mrcp_server_agent_listening_socket_destroy(agent);
+	mrcp_server_agent_listening_socket_destroy(poller);
 	apt_poller_task_cleanup(poller_task);
+	if(poller != agent->pollers) {
+		return TRUE;
+	}
+
+	/* the primary poller is destroyed last */
+	if(agent->pool_recycler) {
+		apt_pool_recycler_destroy(agent->pool_recycler);
+		agent->pool_recycler = NULL;
+	}
+	if(agent->guard) {
+		apr_thread_mutex_destroy(agent->guard);
+		agent->guard = NULL;
+	}
 	return TRUE;
 }
 
@@ -163,19 +262,19 @@ MRCP_DECLARE(apt_bool_t) mrcp_server_connection_agent_destroy(mrcp_connection_ag
 {
 	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Destroy MRCPv2 Agent [%s]",
 		mrcp_server_connection_agent_id_get(agent));
-	return apt_poller_task_destroy(agent->task);
+	return apt_poller_task_destroy(agent->pollers[0].task);
 }
 
 /** Start connection agent. */
 MRCP_DECLARE(apt_bool_t) mrcp_server_connection_agent_start(mrcp_connection_agent_t *agent)
 {
-	return apt_poller_task_start(agent->task);
+	return apt_poller_task_start(agent->pollers[0].task);
 }
 
 /** Terminate connection agent. */
 MRCP_DECLARE(apt_bool_t) mrcp_server_connection_agent_terminate(mrcp_connection_agent_t *agent)
 {
-	return apt_poller_task_terminate(agent->task);
+	return apt_poller_task_terminate(agent->pollers[0].task);
 }
 
 /** Set connection event handler. */
@@ -207,6 +306,14 @@ MRCP_DECLARE(void) mrcp_server_connection_rx_size_set(
 	agent->rx_buffer_size = size;
 }
 
+/** Set max size the rx buffer grows up to */
+MRCP_DECLARE(void) mrcp_server_connection_rx_max_size_set(
+								mrcp_connection_agent_t *agent,
+								apr_size_t size)
+{
+	agent->rx_buffer_max_size = size;
+}
+
 /** Set tx buffer size */
 MRCP_DECLARE(void) mrcp_server_connection_tx_size_set(
 								mrcp_connection_agent_t *agent,
@@ -246,7 +353,7 @@ MRCP_DECLARE(void) mrcp_server_connection_term_timeout_set(
 /** Get task */
 MRCP_DECLARE(apt_task_t*) mrcp_server_connection_agent_task_get(const mrcp_connection_agent_t *agent)
 {
-	return apt_poller_task_base_get(agent->task);
+	return apt_poller_task_base_get(agent->pollers[0].task);
 }
 
 /** Get external object */
@@ -258,7 +365,7 @@ MRCP_DECLARE(void*) mrcp_server_connection_agent_object_get(const mrcp_connectio
 /** Get string identifier */
 MRCP_DECLARE(const char*) mrcp_server_connection_agent_id_get(const mrcp_connection_agent_t *agent)
 {
-	apt_task_t *task = apt_poller_task_base_get(agent->task);
+	apt_task_t *task = apt_poller_task_base_get(agent->pollers[0].task);
 	return apt_task_name_get(task);
 }
 
@@ -290,15 +397,16 @@ MRCP_DECLARE(apt_bool_t) mrcp_server_control_channel_destroy(mrcp_control_channe
 	return TRUE;
 }
 
-/** Signal task message */
-static apt_bool_t mrcp_server_control_message_signal(
+/** Signal task message to the poller */
+static apt_bool_t mrcp_server_poller_message_signal(
+								mrcp_connection_poller_t *poller,
 								connection_task_msg_type_e type,
 								mrcp_connection_agent_t *agent,
 								mrcp_control_channel_t *channel,
 								mrcp_control_descriptor_t *descriptor,
 								mrcp_message_t *message)
 {
-	apt_task_t *task = apt_poller_task_base_get(agent->task);
+	apt_task_t *task = apt_poller_task_base_get(poller->task);
 	apt_task_msg_t *task_msg = apt_task_msg_get(task);
 	if(task_msg) {
 		connection_task_msg_t *msg = (connection_task_msg_t*)task_msg->data;
@@ -312,6 +420,23 @@ static apt_bool_t mrcp_server_control_message_signal(
 	return TRUE;
 }
 
+/** Signal task message */
+static apt_bool_t mrcp_server_control_message_signal(
+								connection_task_msg_type_e type,
+								mrcp_connection_agent_t *agent,
+								mrcp_control_channel_t *channel,
+								mrcp_control_descriptor_t *descriptor,
+								mrcp_message_t *message)
+{
+	/* requests are processed by the primary poller, messages are sent by the poller
+	serving the connection, which the channel is assigned to before any request is received */
+	mrcp_connection_poller_t *poller = agent->pollers;
+	if(type == CONNECTION_TASK_MSG_SEND_MESSAGE && channel->connection && channel->connection->poller) {
+		poller = channel->connection->poller;
+	}
+	return mrcp_server_poller_message_signal(poller,type,agent,channel,descriptor,message);
+}
+
 /** Add MRCPv2 control channel */
 MRCP_DECLARE(apt_bool_t) mrcp_server_control_channel_add(mrcp_control_channel_t *channel, mrcp_control_descriptor_t *descriptor)
 {
@@ -337,47 +462,60 @@ MRCP_DECLARE(apt_bool_t) mrcp_server_control_message_send(mrcp_control_channel_t
 }
 
 /** Create listening socket and add it to pollset */
-static apt_bool_t mrcp_server_agent_listening_socket_create(mrcp_connection_agent_t *agent)
+static apt_bool_t mrcp_server_agent_listening_socket_create(mrcp_connection_poller_t *poller)
 {
 	apr_status_t status;
+	mrcp_connection_agent_t *agent = poller->agent;
 	if(!agent->sockaddr) {
 		return FALSE;
 	}
 
 	/* create listening socket */
-	status = apr_socket_create(&agent->listen_sock, agent->sockaddr->family, SOCK_STREAM, APR_PROTO_TCP, agent->pool);
+	status = apr_socket_create(&poller->listen_sock, agent->sockaddr->family, SOCK_STREAM, APR_PROTO_TCP, agent->pool);
 	if(status != APR_SUCCESS) {
 		return FALSE;
 	}
 
-	apr_socket_opt_set(agent->listen_sock, APR_SO_NONBLOCK, 0);
-	apr_socket_timeout_set(agent->listen_sock, -1);
-	apr_socket_opt_set(agent->listen_sock, APR_SO_REUSEADDR, 1);
+	apr_socket_opt_set(poller->listen_sock, APR_SO_NONBLOCK, 0);
+	apr_socket_timeout_set(poller->listen_sock, -1);
+	apr_socket_opt_set(poller->listen_sock, APR_SO_REUSEADDR, 1);
+#ifdef SO_REUSEPORT
+	if(agent->poller_count > 1) {
+		/* each poller listens on the same port, connections are distributed by the kernel */
+		apr_os_sock_t os_sock;
+		int reuse_port = 1;
+		if(apr_os_sock_get(&os_sock,poller->listen_sock) != APR_SUCCESS ||
+			setsockopt(os_sock,SOL_SOCKET,SO_REUSEPORT,(void*)&reuse_port,sizeof(reuse_port)) != 0) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Set SO_REUSEPORT [%s]",
+				apt_task_name_get(apt_poller_task_base_get(poller->task)));
+		}
+	}
+#endif
 
-	status = apr_socket_bind(agent->listen_sock, agent->sockaddr);
+	status = apr_socket_bind(poller->listen_sock, agent->sockaddr);
 	if(status != APR_SUCCESS) {
-		apr_socket_close(agent->listen_sock);
-		agent->listen_sock = NULL;
+		apr_socket_close(poller->listen_sock);
+		poller->listen_sock = NULL;
 		return FALSE;
 	}
-	status = apr_socket_listen(agent->listen_sock, SOMAXCONN);
+	status = apr_socket_listen(poller->listen_sock, SOMAXCONN);
 	if(status != APR_SUCCESS) {
-		apr_socket_close(agent->listen_sock);
-		agent->listen_sock = NULL;
+		apr_socket_close(poller->listen_sock);
+		poller->listen_sock = NULL;
 		return FALSE;
 	}
 
 	/* add listening socket to pollset */
-	memset(&agent->listen_sock_pfd,0,sizeof(apr_pollfd_t));
-	agent->listen_sock_pfd.desc_type = APR_POLL_SOCKET;
-	agent->listen_sock_pfd.reqevents = APR_POLLIN;
-	agent->listen_sock_pfd.desc.s = agent->listen_sock;
-	agent->listen_sock_pfd.client_data = agent->listen_sock;
-	if(apt_poller_task_descriptor_add(agent->task, &agent->listen_sock_pfd) != TRUE) {
+	memset(&poller->listen_sock_pfd,0,sizeof(apr_pollfd_t));
+	poller->listen_sock_pfd.desc_type = APR_POLL_SOCKET;
+	poller->listen_sock_pfd.reqevents = APR_POLLIN;
+	poller->listen_sock_pfd.desc.s = poller->listen_sock;
+	poller->listen_sock_pfd.client_data = poller->listen_sock;
+	if(apt_poller_task_descriptor_add(poller->task, &poller->listen_sock_pfd) != TRUE) {
 		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Add Listening Socket to Pollset [%s]",
-			apt_task_name_get(apt_poller_task_base_get(agent->task)));
-		apr_socket_close(agent->listen_sock);
-		agent->listen_sock = NULL;
+			apt_task_name_get(apt_poller_task_base_get(poller->task)));
+		apr_socket_close(poller->listen_sock);
+		poller->listen_sock = NULL;
 		return FALSE;
 	}
 
@@ -385,12 +523,12 @@ static apt_bool_t mrcp_server_agent_listening_socket_create(mrcp_connection_agen
 }
 
 /** Remove from pollset and destroy listening socket */
-static void mrcp_server_agent_listening_socket_destroy(mrcp_connection_agent_t *agent)
+static void mrcp_server_agent_listening_socket_destroy(mrcp_connection_poller_t *poller)
 {
-	if(agent->listen_sock) {
-		apt_poller_task_descriptor_remove(agent->task,&agent->listen_sock_pfd);
-		apr_socket_close(agent->listen_sock);
-		agent->listen_sock = NULL;
+	if(poller->listen_sock) {
+		apt_poller_task_descriptor_remove(poller->task,&poller->listen_sock_pfd);
+		apr_socket_close(poller->listen_sock);
+		poller->listen_sock = NULL;
 	}
 }
 
@@ -405,6 +543,7 @@ static mrcp_control_channel_t* mrcp_connection_channel_associate(mrcp_connection
 	apt_id_resource_generate(&message->channel_id.session_id,&message->channel_id.resource_name,'@',&identifier,connection->pool);
 	channel = mrcp_connection_channel_find(connection,&identifier);
 	if(!channel) {
+		apr_thread_mutex_lock(agent->guard);
 		channel = apr_hash_get(agent->pending_channel_table,identifier.buf,identifier.length);
 		if(channel) {
 			apr_hash_set(agent->pending_channel_table,identifier.buf,identifier.length,NULL);
@@ -415,6 +554,7 @@ static mrcp_control_channel_t* mrcp_connection_channel_associate(mrcp_connection
 				apr_hash_count(agent->pending_channel_table),
 				apr_hash_count(connection->channel_table));
 		}
+		apr_thread_mutex_unlock(agent->guard);
 	}
 	return channel;
 }
@@ -439,7 +579,9 @@ static mrcp_connection_t* mrcp_connection_find(mrcp_connection_agent_t *agent, c
 
 static apt_bool_t mrcp_connection_add(mrcp_connection_agent_t *agent, mrcp_connection_t *connection)
 {
+	apr_thread_mutex_lock(agent->guard);
 	APR_RING_INSERT_TAIL(&agent->connection_list,connection,mrcp_connection_t,link);
+	apr_thread_mutex_unlock(agent->guard);
 	if(connection->inactivity_timer) {
 		apt_timer_set(connection->inactivity_timer,agent->inactivity_timeout);
 	}
@@ -451,18 +593,22 @@ static apt_bool_t mrcp_connection_remove(mrcp_connection_agent_t *agent, mrcp_co
 	if(connection->inactivity_timer) {
 		apt_timer_kill(connection->inactivity_timer);
 	}
+	apr_thread_mutex_lock(agent->guard);
 	APR_RING_REMOVE(connection,link);
+	apr_thread_mutex_unlock(agent->guard);
 	return TRUE;
 }
 
-static apt_bool_t mrcp_server_agent_connection_accept(mrcp_connection_agent_t *agent)
+static apt_bool_t mrcp_server_agent_connection_accept(mrcp_connection_poller_t *poller)
 {
 	char *local_ip = NULL;
 	char *remote_ip = NULL;
+	apr_size_t pending_channel_count;
+	mrcp_connection_agent_t *agent = poller->agent;
 	
-	mrcp_connection_t *connection = mrcp_connection_create();
+	mrcp_connection_t *connection = mrcp_connection_create(agent->pool_recycler);
 
-	if(apr_socket_accept(&connection->sock,agent->listen_sock,connection->pool) != APR_SUCCESS) {
+	if(apr_socket_accept(&connection->sock,poller->listen_sock,connection->pool) != APR_SUCCESS) {
 		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Accept Connection");
 		mrcp_connection_destroy(connection);
 		return FALSE;
@@ -483,7 +629,10 @@ static apt_bool_t mrcp_server_agent_connection_accept(mrcp_connection_agent_t *a
 		local_ip,connection->l_sockaddr->port,
 		remote_ip,connection->r_sockaddr->port);
 
-	if(apr_hash_count(agent->pending_channel_table) == 0) {
+	apr_thread_mutex_lock(agent->guard);
+	pending_channel_count = apr_hash_count(agent->pending_channel_table);
+	apr_thread_mutex_unlock(agent->guard);
+	if(pending_channel_count == 0) {
 		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Reject Unexpected TCP/MRCPv2 Connection %s",connection->id);
 		apr_socket_close(connection->sock);
 		mrcp_connection_destroy(connection);
@@ -495,7 +644,7 @@ static apt_bool_t mrcp_server_agent_connection_accept(mrcp_connection_agent_t *a
 	connection->sock_pfd.reqevents = APR_POLLIN;
 	connection->sock_pfd.desc.s = connection->sock;
 	connection->sock_pfd.client_data = connection;
-	if(apt_poller_task_descriptor_add(agent->task, &connection->sock_pfd) != TRUE) {
+	if(apt_poller_task_descriptor_add(poller->task, &connection->sock_pfd) != TRUE) {
 		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Add to Pollset %s",connection->id);
 		apr_socket_close(connection->sock);
 		mrcp_connection_destroy(connection);
@@ -504,16 +653,22 @@ static apt_bool_t mrcp_server_agent_connection_accept(mrcp_connection_agent_t *a
 
 	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Accepted TCP/MRCPv2 Connection %s",connection->id);
 	connection->agent = agent;
+	connection->poller = poller;
 
 	connection->parser = mrcp_parser_create(agent->resource_factory,connection->pool);
+	/* header values of requests are parsed on demand by the server and the engines */
+	mrcp_parser_lazy_set(connection->parser,TRUE);
 	connection->generator = mrcp_generator_create(agent->resource_factory,connection->pool);
 
 	connection->tx_buffer_size = agent->tx_buffer_size;
 	connection->tx_buffer = apr_palloc(connection->pool,connection->tx_buffer_size+1);
 
-	connection->rx_buffer_size = agent->rx_buffer_size;
-	connection->rx_buffer = apr_palloc(connection->pool,connection->rx_buffer_size+1);
-	apt_text_stream_init(&connection->rx_stream,connection->rx_buffer,connection->rx_buffer_size);
+	apt_text_rx_buffer_init(
+		&connection->rx_buffer,
+		&connection->rx_stream,
+		apr_palloc(connection->pool,agent->rx_buffer_size+1),
+		agent->rx_buffer_size,
+		agent->rx_buffer_max_size);
 
 	if(apt_log_masking_get() != APT_LOG_MASKING_NONE) {
 		connection->verbose = FALSE;
@@ -523,7 +678,7 @@ static apt_bool_t mrcp_server_agent_connection_accept(mrcp_connection_agent_t *a
 
 	if(agent->inactivity_timeout) {
 		connection->inactivity_timer = apt_poller_task_timer_create(
-										agent->task,
+										poller->task,
 										mrcp_server_inactivity_timer_proc,
 										connection,
 										connection->pool);
@@ -535,8 +690,9 @@ static apt_bool_t mrcp_server_agent_connection_accept(mrcp_connection_agent_t *a
 
 static apt_bool_t mrcp_server_agent_connection_close(mrcp_connection_agent_t *agent, mrcp_connection_t *connection, apt_bool_t timedout)
 {
+	mrcp_connection_poller_t *poller = connection->poller;
 	if(connection->sock) {
-		apt_poller_task_descriptor_remove(agent->task,&connection->sock_pfd);
+		apt_poller_task_descriptor_remove(poller->task,&connection->sock_pfd);
 		apr_socket_close(connection->sock);
 		connection->sock = NULL;
 	}
@@ -548,7 +704,7 @@ static apt_bool_t mrcp_server_agent_connection_close(mrcp_connection_agent_t *ag
 		else {
 			if(agent->termination_timeout) {
 				connection->termination_timer = apt_poller_task_timer_create(
-												agent->task,
+												poller->task,
 												mrcp_server_termination_timer_proc,
 												connection,
 												connection->pool);
@@ -598,6 +754,8 @@ static apt_bool_t mrcp_server_agent_channel_add(mrcp_connection_agent_t *agent,
 	if(offer->port) {
 		answer->port = agent->sockaddr->port;
 	}
+	/* connections are served by all the pollers */
+	apr_thread_mutex_lock(agent->guard);
 	if(offer->connection_type == MRCP_CONNECTION_TYPE_EXISTING) {
 		if(agent->force_new_connection == TRUE) {
 			/* force client to establish new connection */
@@ -627,6 +785,7 @@ static apt_bool_t mrcp_server_agent_channel_add(mrcp_connection_agent_t *agent,
 	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Add Pending Control Channel <%s> [%d]",
 			channel->identifier.buf,
 			apr_hash_count(agent->pending_channel_table));
+	apr_thread_mutex_unlock(agent->guard);
 	/* send response */
 	return mrcp_control_channel_add_respond(agent->vtable,channel,answer,TRUE);
 }
@@ -642,9 +801,26 @@ static apt_bool_t mrcp_server_agent_channel_modify(mrcp_connection_agent_t *agen
 	return mrcp_control_channel_modify_respond(agent->vtable,channel,answer,TRUE);
 }
 
-static apt_bool_t mrcp_server_agent_channel_remove(mrcp_connection_agent_t *agent, mrcp_control_channel_t *channel)
+static apt_bool_t mrcp_server_agent_channel_remove(mrcp_connection_poller_t *poller, mrcp_control_channel_t *channel)
 {
-	mrcp_connection_t *connection = channel->connection;
+	mrcp_connection_agent_t *agent = poller->agent;
+	mrcp_connection_t *connection;
+
+	apr_thread_mutex_lock(agent->guard);
+	connection = channel->connection;
+	if(connection && connection->poller != poller) {
+		apr_thread_mutex_unlock(agent->guard);
+		/* the channel is assigned to a connection of another poller, let that poller remove it */
+		return mrcp_server_poller_message_signal(connection->poller,CONNECTION_TASK_MSG_REMOVE_CHANNEL,agent,channel,NULL,NULL);
+	}
+	if(!connection) {
+		apr_hash_set(agent->pending_channel_table,channel->identifier.buf,channel->identifier.length,NULL);
+		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Remove Pending Control Channel <%s> [%d]",
+				channel->identifier.buf,
+				apr_hash_count(agent->pending_channel_table));
+	}
+	apr_thread_mutex_unlock(agent->guard);
+
 	if(connection) {
 		mrcp_connection_channel_remove(connection,channel);
 		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Remove Control Channel <%s> [%d]",
@@ -663,12 +839,6 @@ static apt_bool_t mrcp_server_agent_channel_remove(mrcp_connection_agent_t *agen
 			}
 		}
 	}
-	else {
-		apr_hash_set(agent->pending_channel_table,channel->identifier.buf,channel->identifier.length,NULL);
-		apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Remove Pending Control Channel <%s> [%d]",
-				channel->identifier.buf,
-				apr_hash_count(agent->pending_channel_table));
-	}
 	/* send response */
 	return mrcp_control_channel_remove_respond(agent->vtable,channel,TRUE);
 }
@@ -678,37 +848,36 @@ static apt_bool_t mrcp_server_agent_messsage_send(mrcp_connection_agent_t *agent
 	apt_bool_t status = FALSE;
 	apt_text_stream_t stream;
 	apt_message_status_e result;
+	apt_str_t body;
 	if(!connection || !connection->sock) {
 		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Null MRCPv2 Connection " APT_SIDRES_FMT,MRCP_MESSAGE_SIDRES(message));
 		return FALSE;
 	}
 
-	do {
-		apt_text_stream_init(&stream,connection->tx_buffer,connection->tx_buffer_size);
-		result = mrcp_generator_run(connection->generator,message,&stream);
-		if(result != APT_MESSAGE_STATUS_INVALID) {
-			stream.text.length = stream.pos - stream.text.buf;
-			*stream.pos = '\0';
-
-			apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Send MRCPv2 Data %s [%"APR_SIZE_T_FMT" bytes]\n%.*s",
-					connection->id,
-					stream.text.length,
-					connection->verbose == TRUE ? stream.text.length : 0,
-					stream.text.buf);
-
-			if(apr_socket_send(connection->sock,stream.text.buf,&stream.text.length) == APR_SUCCESS) {
-				status = TRUE;
-			}
-			else {
-				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Send MRCPv2 Data");
-			}
-		}
-		else {
-			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Generate MRCPv2 Data");
-		}
+	/* generate the header only and send the body as is, from where it is */
+	result = mrcp_connection_header_generate(connection,message,&stream,&body);
+	if(result != APT_MESSAGE_STATUS_COMPLETE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Generate MRCPv2 Data %s " APT_SIDRES_FMT " [%" MRCP_REQUEST_ID_FMT "]",
+			connection->id,
+			MRCP_MESSAGE_SIDRES(message),
+			message->start_line.request_id);
+		return FALSE;
 	}
-	while(result == APT_MESSAGE_STATUS_INCOMPLETE);
 
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Send MRCPv2 Data %s [%"APR_SIZE_T_FMT" bytes]\n%.*s%.*s",
+			connection->id,
+			stream.text.length + body.length,
+			connection->verbose == TRUE ? stream.text.length : 0,
+			stream.text.buf,
+			connection->verbose == TRUE ? body.length : 0,
+			body.buf);
+
+	if(mrcp_connection_message_send(connection,&stream.text,&body) == TRUE) {
+		status = TRUE;
+	}
+	else {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Send MRCPv2 Data");
+	}
 	return status;
 }
 
@@ -750,17 +919,20 @@ static apt_bool_t mrcp_server_message_handler(mrcp_connection_t *connection, mrc
 /* Receive MRCP message through TCP/MRCPv2 connection */
 static apt_bool_t mrcp_server_poller_signal_process(void *obj, const apr_pollfd_t *descriptor)
 {
-	mrcp_connection_agent_t *agent = obj;
+	mrcp_connection_poller_t *poller = obj;
+	mrcp_connection_agent_t *agent = poller->agent;
 	mrcp_connection_t *connection = descriptor->client_data;
 	apr_status_t status;
 	apr_size_t offset;
 	apr_size_t length;
+	apr_size_t required_length;
+	char *window;
 	apt_text_stream_t *stream;
 	mrcp_message_t *message;
 	apt_message_status_e msg_status;
 
-	if(descriptor->desc.s == agent->listen_sock) {
-		return mrcp_server_agent_connection_accept(agent);
+	if(descriptor->desc.s == poller->listen_sock) {
+		return mrcp_server_agent_connection_accept(poller);
 	}
 
 	if(!connection || !connection->sock) {
@@ -770,8 +942,39 @@ static apt_bool_t mrcp_server_poller_signal_process(void *obj, const apr_pollfd_
 
 	/* calculate offset remaining from the previous receive / if any */
 	offset = stream->pos - stream->text.buf;
+	if(!offset) {
+		length = mrcp_parser_body_window_get(connection->parser,&window);
+		if(length >= connection->rx_buffer.size) {
+			/* receive the rest of a large body straight into the message, bypassing the rx buffer */
+			status = apr_socket_recv(connection->sock,window,&length);
+			if(status == APR_EOF || length == 0) {
+				apt_log(APT_LOG_MARK,APT_PRIO_INFO,"TCP/MRCPv2 Peer Disconnected %s",connection->id);
+				return mrcp_server_agent_connection_close(agent,connection,FALSE);
+			}
+
+			apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Receive MRCPv2 Data %s [%"APR_SIZE_T_FMT" bytes]\n%.*s",
+					connection->id,
+					length,
+					connection->verbose == TRUE ? length : 0,
+					window);
+
+			mrcp_parser_body_window_advance(connection->parser,length);
+
+			/* run the parser on the empty stream to complete the message, once the body is received */
+			stream->text.length = 0;
+			apt_text_stream_reset(stream);
+			msg_status = mrcp_parser_run(connection->parser,stream,&message);
+			return mrcp_server_message_handler(connection,message,msg_status);
+		}
+	}
+	/* grow the buffer to fit the rest of the message body or a line which exceeds the buffer */
+	required_length = offset + mrcp_parser_body_window_get(connection->parser,&window);
+	if(offset == connection->rx_buffer.size) {
+		required_length = offset + 1;
+	}
+	apt_text_rx_buffer_grow(&connection->rx_buffer,stream,required_length);
 	/* calculate available length */
-	length = connection->rx_buffer_size - offset;
+	length = connection->rx_buffer.size - offset;
 
 	status = apr_socket_recv(connection->sock,stream->pos,&length);
 	if(status == APR_EOF || length == 0) {
@@ -802,6 +1005,10 @@ static apt_bool_t mrcp_server_poller_signal_process(void *obj, const apr_pollfd_
 
 	/* scroll remaining stream */
 	apt_text_stream_scroll(stream);
+	/* shrink the buffer back, once there is no message in progress */
+	if(!mrcp_parser_body_window_get(connection->parser,&window)) {
+		apt_text_rx_buffer_shrink(&connection->rx_buffer,stream);
+	}
 	return TRUE;
 }
 
@@ -809,7 +1016,8 @@ static apt_bool_t mrcp_server_poller_signal_process(void *obj, const apr_pollfd_
 static apt_bool_t mrcp_server_agent_msg_process(apt_task_t *task, apt_task_msg_t *task_msg)
 {
 	apt_poller_task_t *poller_task = apt_task_object_get(task);
-	mrcp_connection_agent_t *agent = apt_poller_task_object_get(poller_task);
+	mrcp_connection_poller_t *poller = apt_poller_task_object_get(poller_task);
+	mrcp_connection_agent_t *agent = poller->agent;
 	connection_task_msg_t *msg = (connection_task_msg_t*) task_msg->data;
 	switch(msg->type) {
 		case CONNECTION_TASK_MSG_ADD_CHANNEL:
@@ -819,7 +1027,7 @@ static apt_bool_t mrcp_server_agent_msg_process(apt_task_t *task, apt_task_msg_t
 			mrcp_server_agent_channel_modify(agent,msg->channel,msg->descriptor);
 			break;
 		case CONNECTION_TASK_MSG_REMOVE_CHANNEL:
-			mrcp_server_agent_channel_remove(agent,msg->channel);
+			mrcp_server_agent_channel_remove(poller,msg->channel);
 			break;
 		case CONNECTION_TASK_MSG_SEND_MESSAGE:
 			mrcp_server_agent_messsage_send(agent,msg->channel->connection,msg->message);
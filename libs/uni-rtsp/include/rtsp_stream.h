@@ -39,6 +39,9 @@ RTSP_DECLARE(rtsp_parser_t*) rtsp_parser_create(apr_pool_t *pool);
 /** Parse RTSP stream */
 RTSP_DECLARE(apt_message_status_e) rtsp_parser_run(rtsp_parser_t *parser, apt_text_stream_t *stream, rtsp_message_t **message);
 
+/** Get the part of the message body remaining to receive (if the body is being parsed) */
+RTSP_DECLARE(apr_size_t) rtsp_parser_body_window_get(rtsp_parser_t *parser, char **buf);
+
 
 /** Create RTSP stream generator */
 RTSP_DECLARE(rtsp_generator_t*) rtsp_generator_create(apr_pool_t *pool);
@@ -28,6 +28,7 @@
 #include "apt_log.h"
 
 #define RTSP_STREAM_BUFFER_SIZE 1024
+#define RTSP_STREAM_BUFFER_MAX_SIZE 65536
 
 typedef struct rtsp_client_connection_t rtsp_client_connection_t;
 
@@ -78,9 +79,10 @@ struct rtsp_client_connection_t {
 	/** Last CSeq sent */
 	apr_size_t        last_cseq;
 
-	char              rx_buffer[RTSP_STREAM_BUFFER_SIZE];
-	apt_text_stream_t rx_stream;
-	rtsp_parser_t    *parser;
+	char                 rx_initial_buffer[RTSP_STREAM_BUFFER_SIZE];
+	apt_text_rx_buffer_t rx_buffer;
+	apt_text_stream_t    rx_stream;
+	rtsp_parser_t       *parser;
 
 	char              tx_buffer[RTSP_STREAM_BUFFER_SIZE];
 	apt_text_stream_t tx_stream;
@@ -409,7 +411,12 @@ static apt_bool_t rtsp_client_connection_create(rtsp_client_t *client, rtsp_clie
 	rtsp_connection->handle_table = apr_hash_make(pool);
 	rtsp_connection->session_table = apr_hash_make(pool);
 	rtsp_connection->inprogress_request_queue = apt_list_create(pool);
-	apt_text_stream_init(&rtsp_connection->rx_stream,rtsp_connection->rx_buffer,sizeof(rtsp_connection->rx_buffer)-1);
+	apt_text_rx_buffer_init(
+		&rtsp_connection->rx_buffer,
+		&rtsp_connection->rx_stream,
+		rtsp_connection->rx_initial_buffer,
+		sizeof(rtsp_connection->rx_initial_buffer)-1,
+		RTSP_STREAM_BUFFER_MAX_SIZE);
 	apt_text_stream_init(&rtsp_connection->tx_stream,rtsp_connection->tx_buffer,sizeof(rtsp_connection->tx_buffer)-1);
 	rtsp_connection->parser = rtsp_parser_create(pool);
 	rtsp_connection->generator = rtsp_generator_create(pool);
@@ -428,6 +435,7 @@ static apt_bool_t rtsp_client_connection_destroy(rtsp_client_connection_t *rtsp_
 	APR_RING_REMOVE(rtsp_connection,link);
 	rtsp_client_connection_close(client,rtsp_connection);
 	apt_log(RTSP_LOG_MARK,APT_PRIO_NOTICE,"Destroy RTSP Connection %s",rtsp_connection->id);
+	apt_text_rx_buffer_release(&rtsp_connection->rx_buffer);
 	apr_pool_destroy(rtsp_connection->pool);
 
 	return TRUE;
@@ -910,6 +918,8 @@ static apt_bool_t rtsp_client_poller_signal_process(void *obj, const apr_pollfd_
 	apr_status_t status;
 	apr_size_t offset;
 	apr_size_t length;
+	apr_size_t required_length;
+	char *window;
 	apt_text_stream_t *stream;
 	rtsp_message_t *message;
 	apt_message_status_e msg_status;
@@ -921,8 +931,14 @@ static apt_bool_t rtsp_client_poller_signal_process(void *obj, const apr_pollfd_
 
 	/* calculate offset remaining from the previous receive / if any */
 	offset = stream->pos - stream->text.buf;
+	/* grow the buffer to fit the rest of the message body or a line which exceeds the buffer */
+	required_length = offset + rtsp_parser_body_window_get(rtsp_connection->parser,&window);
+	if(offset == rtsp_connection->rx_buffer.size) {
+		required_length = offset + 1;
+	}
+	apt_text_rx_buffer_grow(&rtsp_connection->rx_buffer,stream,required_length);
 	/* calculate available length */
-	length = sizeof(rtsp_connection->rx_buffer) - 1 - offset;
+	length = rtsp_connection->rx_buffer.size - offset;
 
 	status = apr_socket_recv(rtsp_connection->sock,stream->pos,&length);
 	if(status == APR_EOF || length == 0) {
@@ -950,6 +966,10 @@ static apt_bool_t rtsp_client_poller_signal_process(void *obj, const apr_pollfd_
 
 	/* scroll remaining stream */
 	apt_text_stream_scroll(stream);
+	/* shrink the buffer back, once there is no message in progress */
+	if(!rtsp_parser_body_window_get(rtsp_connection->parser,&window)) {
+		apt_text_rx_buffer_shrink(&rtsp_connection->rx_buffer,stream);
+	}
 	return TRUE;
 }
 
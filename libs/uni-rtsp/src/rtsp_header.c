@@ -20,12 +20,12 @@
 
 /** String table of RTSP header fields (rtsp_header_field_id) */
 static const apt_str_table_item_t rtsp_header_string_table[] = {
-	{{"CSeq",           4},1},
-	{{"Transport",      9},0},
-	{{"Session",        7},0},
-	{{"RTP-Info",       8},0},
-	{{"Content-Type",  12},8},
-	{{"Content-Length",14},8}
+	{{"CSeq",           4},1,3,3},
+	{{"Transport",      9},0,2,0},
+	{{"Session",        7},0,2,2},
+	{{"RTP-Info",       8},0,1,5},
+	{{"Content-Type",  12},8,1,1},
+	{{"Content-Length",14},8,4,4}
 };
 
 /** String table of RTSP content types (rtsp_content_type) */
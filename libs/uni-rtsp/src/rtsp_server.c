@@ -29,6 +29,7 @@
 
 #define RTSP_SESSION_ID_HEX_STRING_LENGTH 16
 #define RTSP_STREAM_BUFFER_SIZE 1024
+#define RTSP_STREAM_BUFFER_MAX_SIZE 65536
 
 typedef struct rtsp_server_connection_t rtsp_server_connection_t;
 
@@ -43,6 +44,9 @@ struct rtsp_server_t {
 	apr_uint32_t                inactivity_timeout;
 	apt_bool_t                  online;
 
+	/** Recycler of session pools */
+	apt_pool_recycler_t        *session_pool_recycler;
+
 	/* Listening socket descriptor */
 	apr_sockaddr_t             *sockaddr;
 	apr_socket_t               *listen_sock;
@@ -74,9 +78,10 @@ struct rtsp_server_connection_t {
 	/** Session table (rtsp_server_session_t*) */
 	apr_hash_t        *session_table;
 
-	char               rx_buffer[RTSP_STREAM_BUFFER_SIZE];
-	apt_text_stream_t  rx_stream;
-	rtsp_parser_t     *parser;
+	char                 rx_initial_buffer[RTSP_STREAM_BUFFER_SIZE];
+	apt_text_rx_buffer_t rx_buffer;
+	apt_text_stream_t    rx_stream;
+	rtsp_parser_t       *parser;
 
 	char               tx_buffer[RTSP_STREAM_BUFFER_SIZE];
 	apt_text_stream_t  tx_stream;
@@ -213,6 +218,15 @@ RTSP_DECLARE(rtsp_server_t*) rtsp_server_create(
 
 	APR_RING_INIT(&server->connection_list, rtsp_server_connection_t, link);
 
+	server->session_pool_recycler = apt_pool_recycler_create(
+										id,
+										APT_POOL_RECYCLER_DEFAULT_MAX_COUNT,
+										APT_POOL_RECYCLER_DEFAULT_MAX_FREE_SIZE,
+										pool);
+	if(!server->session_pool_recycler) {
+		return NULL;
+	}
+
 	if(rtsp_server_listening_socket_create(server) != TRUE) {
 		apt_log(RTSP_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Listening Socket [%s] %s:%hu", 
 				id,
@@ -229,6 +243,10 @@ static apt_bool_t rtsp_server_on_destroy(apt_task_t *task)
 
 	rtsp_server_listening_socket_destroy(server);
 	apt_poller_task_cleanup(poller_task);
+	if(server->session_pool_recycler) {
+		apt_pool_recycler_destroy(server->session_pool_recycler);
+		server->session_pool_recycler = NULL;
+	}
 	return TRUE;
 }
 
@@ -339,7 +357,10 @@ RTSP_DECLARE(apt_bool_t) rtsp_server_session_release(rtsp_server_t *server, rtsp
 static rtsp_server_session_t* rtsp_server_session_create(rtsp_server_t *server)
 {
 	rtsp_server_session_t *session;
-	apr_pool_t *pool = apt_pool_create();
+	apr_pool_t *pool = apt_pool_recycler_acquire(server->session_pool_recycler);
+	if(!pool) {
+		return NULL;
+	}
 	session = apr_palloc(pool,sizeof(rtsp_server_session_t));
 	session->pool = pool;
 	session->obj = NULL;
@@ -352,19 +373,19 @@ static rtsp_server_session_t* rtsp_server_session_create(rtsp_server_t *server)
 	apt_unique_id_generate(&session->id,RTSP_SESSION_ID_HEX_STRING_LENGTH,pool);
 	apt_log(RTSP_LOG_MARK,APT_PRIO_NOTICE,"Create RTSP Session " APT_SID_FMT,session->id.buf);
 	if(server->vtable->create_session(server,session) != TRUE) {
-		apr_pool_destroy(pool);
+		apt_pool_recycler_release(server->session_pool_recycler,pool);
 		return NULL;
 	}
 	return session;
 }
 
 /* Destroy RTSP session */
-static void rtsp_server_session_destroy(rtsp_server_session_t *session)
+static void rtsp_server_session_destroy(rtsp_server_t *server, rtsp_server_session_t *session)
 {
 	apt_log(RTSP_LOG_MARK,APT_PRIO_NOTICE,"Destroy RTSP Session " APT_SID_FMT,
 		session ? session->id.buf : "(null)");
 	if(session && session->pool) {
-		apr_pool_destroy(session->pool);
+		apt_pool_recycler_release(server->session_pool_recycler,session->pool);
 	}
 }
 
@@ -372,6 +393,7 @@ static void rtsp_server_session_destroy(rtsp_server_session_t *session)
 static void rtsp_server_connection_destroy(rtsp_server_connection_t *rtsp_connection)
 {
 	apt_log(RTSP_LOG_MARK,APT_PRIO_NOTICE,"Destroy RTSP Connection %s",rtsp_connection->id);
+	apt_text_rx_buffer_release(&rtsp_connection->rx_buffer);
 	apr_pool_destroy(rtsp_connection->pool);
 }
 
@@ -399,7 +421,7 @@ static apt_bool_t rtsp_server_session_do_terminate(rtsp_server_t *server, rtsp_s
 	if(rtsp_connection) {
 		apr_hash_set(rtsp_connection->session_table,session->id.buf,session->id.length,NULL);
 	}
-	rtsp_server_session_destroy(session);
+	rtsp_server_session_destroy(server,session);
 
 	if(rtsp_connection && !rtsp_connection->sock) {
 		if(apr_hash_count(rtsp_connection->session_table) == 0) {
@@ -520,7 +542,7 @@ static apt_bool_t rtsp_server_session_request_process(rtsp_server_t *server, rts
 		if(session) {
 			session->active_request = message;
 			if(rtsp_server_session_message_handle(server,session,message) != TRUE) {
-				rtsp_server_session_destroy(session);
+				rtsp_server_session_destroy(server,session);
 			}
 		}
 		else {
@@ -818,7 +840,12 @@ static apt_bool_t rtsp_server_connection_accept(rtsp_server_t *server)
 
 	apt_log(RTSP_LOG_MARK,APT_PRIO_NOTICE,"Accepted RTSP Connection %s",rtsp_connection->id);
 	rtsp_connection->session_table = apr_hash_make(rtsp_connection->pool);
-	apt_text_stream_init(&rtsp_connection->rx_stream,rtsp_connection->rx_buffer,sizeof(rtsp_connection->rx_buffer)-1);
+	apt_text_rx_buffer_init(
+		&rtsp_connection->rx_buffer,
+		&rtsp_connection->rx_stream,
+		rtsp_connection->rx_initial_buffer,
+		sizeof(rtsp_connection->rx_initial_buffer)-1,
+		RTSP_STREAM_BUFFER_MAX_SIZE);
 	apt_text_stream_init(&rtsp_connection->tx_stream,rtsp_connection->tx_buffer,sizeof(rtsp_connection->tx_buffer)-1);
 	rtsp_connection->parser = rtsp_parser_create(rtsp_connection->pool);
 	rtsp_connection->generator = rtsp_generator_create(rtsp_connection->pool);
@@ -900,6 +927,8 @@ static apt_bool_t rtsp_server_poller_signal_process(void *obj, const apr_pollfd_
 	apr_status_t status;
 	apr_size_t offset;
 	apr_size_t length;
+	apr_size_t required_length;
+	char *window;
 	apt_text_stream_t *stream;
 	rtsp_message_t *message;
 	apt_message_status_e msg_status;
@@ -915,8 +944,14 @@ static apt_bool_t rtsp_server_poller_signal_process(void *obj, const apr_pollfd_
 
 	/* calculate offset remaining from the previous receive / if any */
 	offset = stream->pos - stream->text.buf;
+	/* grow the buffer to fit the rest of the message body or a line which exceeds the buffer */
+	required_length = offset + rtsp_parser_body_window_get(rtsp_connection->parser,&window);
+	if(offset == rtsp_connection->rx_buffer.size) {
+		required_length = offset + 1;
+	}
+	apt_text_rx_buffer_grow(&rtsp_connection->rx_buffer,stream,required_length);
 	/* calculate available length */
-	length = sizeof(rtsp_connection->rx_buffer) - 1 - offset;
+	length = rtsp_connection->rx_buffer.size - offset;
 
 	status = apr_socket_recv(rtsp_connection->sock,stream->pos,&length);
 	if(status == APR_EOF || length == 0) {
@@ -943,6 +978,10 @@ static apt_bool_t rtsp_server_poller_signal_process(void *obj, const apr_pollfd_
 
 	/* scroll remaining stream */
 	apt_text_stream_scroll(stream);
+	/* shrink the buffer back, once there is no message in progress */
+	if(!rtsp_parser_body_window_get(rtsp_connection->parser,&window)) {
+		apt_text_rx_buffer_shrink(&rtsp_connection->rx_buffer,stream);
+	}
 	return TRUE;
 }
 
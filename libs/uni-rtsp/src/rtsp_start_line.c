@@ -30,11 +30,11 @@ APT_LOG_SOURCE_IMPLEMENT(RTSP,rtsp_log_source,"RTSP")
 
 /** String table of RTSP methods (rtsp_method_id) */
 static const apt_str_table_item_t rtsp_method_string_table[] = {
-	{{"SETUP",    5},0},
-	{{"ANNOUNCE", 8},0},
-	{{"TEARDOWN", 8},0},
-	{{"DESCRIBE", 8},0},
-	{{"OPTIONS",  7},0}
+	{{"SETUP",    5},0,1,0},
+	{{"ANNOUNCE", 8},0,1,4},
+	{{"TEARDOWN", 8},0,4,1},
+	{{"DESCRIBE", 8},0,2,3},
+	{{"OPTIONS",  7},0,2,2}
 };
 
 /** String table of RTSP reason phrases (rtsp_reason_phrase_e) */
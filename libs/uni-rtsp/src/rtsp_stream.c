@@ -63,6 +63,12 @@ RTSP_DECLARE(apt_message_status_e) rtsp_parser_run(rtsp_parser_t *parser, apt_te
 	return apt_message_parser_run(parser->base,stream,(void**)message);
 }
 
+/** Get the part of the message body remaining to receive */
+RTSP_DECLARE(apr_size_t) rtsp_parser_body_window_get(rtsp_parser_t *parser, char **buf)
+{
+	return apt_message_parser_body_window_get(parser->base,buf);
+}
+
 /** Create message and read start line */
 static apt_bool_t rtsp_parser_on_start(apt_message_parser_t *parser, apt_message_context_t *context, apt_text_stream_t *stream, apr_pool_t *pool)
 {
@@ -610,7 +610,7 @@ ASR_CLIENT_DECLARE(asr_session_t*) asr_session_create(asr_engine_t *engine, cons
 	apr_thread_cond_create(&asr_session->wait_object,pool);
 
 	/* Create media buffer */
-	asr_session->media_buffer = mpf_frame_buffer_create(160,20,pool);
+	asr_session->media_buffer = mpf_frame_buffer_create_ex(160,20,MPF_FRAME_BUFFER_SPSC,pool);
 
 	/* Send add channel request and wait for the response */
 	apr_thread_mutex_lock(asr_session->mutex);
@@ -508,6 +508,7 @@ static apt_bool_t unimrcp_client_mrcpv2_uac_load(unimrcp_client_loader_t *loader
 	apr_size_t max_connection_count = 100;
 	apt_bool_t offer_new_connection = FALSE;
 	const char *rx_buffer_size = NULL;
+	const char *rx_buffer_max_size = NULL;
 	const char *tx_buffer_size = NULL;
 	const char *request_timeout = NULL;
 
@@ -529,6 +530,11 @@ static apt_bool_t unimrcp_client_mrcpv2_uac_load(unimrcp_client_loader_t *loader
 				rx_buffer_size = cdata_text_get(elem);
 			}
 		}
+		else if(strcasecmp(elem->name,"rx-buffer-max-size") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				rx_buffer_max_size = cdata_text_get(elem);
+			}
+		}
 		else if(strcasecmp(elem->name,"tx-buffer-size") == 0) {
 			if(is_cdata_valid(elem) == TRUE) {
 				tx_buffer_size = cdata_text_get(elem);
@@ -549,6 +555,9 @@ static apt_bool_t unimrcp_client_mrcpv2_uac_load(unimrcp_client_loader_t *loader
 		if(rx_buffer_size) {
 			mrcp_client_connection_rx_size_set(agent,atol(rx_buffer_size));
 		}
+		if(rx_buffer_max_size) {
+			mrcp_client_connection_rx_max_size_set(agent,atol(rx_buffer_max_size));
+		}
 		if(tx_buffer_size) {
 			mrcp_client_connection_tx_size_set(agent,atol(tx_buffer_size));
 		}
@@ -495,7 +495,9 @@ static apt_bool_t unimrcp_server_mrcpv2_uas_load(unimrcp_server_loader_t *loader
 	apt_bool_t force_new_connection = FALSE;
 	apr_size_t inactivity_timeout = 600; /* sec */
 	apr_size_t termination_timeout = 3; /* sec */
+	apr_size_t thread_count = 1;
 	apr_size_t rx_buffer_size = 0;
+	apr_size_t rx_buffer_max_size = 0;
 	apr_size_t tx_buffer_size = 0;
 
 	apt_log(APT_LOG_MARK,APT_PRIO_DEBUG,"Loading MRCPv2 Agent <%s>",id);
@@ -519,6 +521,11 @@ static apt_bool_t unimrcp_server_mrcpv2_uas_load(unimrcp_server_loader_t *loader
 				force_new_connection = cdata_bool_get(elem);
 			}
 		}
+		else if(strcasecmp(elem->name,"threads") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				thread_count = atol(cdata_text_get(elem));
+			}
+		}
 		else if(strcasecmp(elem->name,"max-shared-use-count") == 0) {
 			if(is_cdata_valid(elem) == TRUE) {
 				max_shared_use_count = atol(cdata_text_get(elem));
@@ -539,6 +546,11 @@ static apt_bool_t unimrcp_server_mrcpv2_uas_load(unimrcp_server_loader_t *loader
 				rx_buffer_size = atol(cdata_text_get(elem));
 			}
 		}
+		else if(strcasecmp(elem->name,"rx-buffer-max-size") == 0) {
+			if(is_cdata_valid(elem) == TRUE) {
+				rx_buffer_max_size = atol(cdata_text_get(elem));
+			}
+		}
 		else if(strcasecmp(elem->name,"tx-buffer-size") == 0) {
 			if(is_cdata_valid(elem) == TRUE) {
 				tx_buffer_size = atol(cdata_text_get(elem));
@@ -554,11 +566,14 @@ static apt_bool_t unimrcp_server_mrcpv2_uas_load(unimrcp_server_loader_t *loader
 		mrcp_ip = apr_pstrdup(loader->pool,loader->ip);
 	}
 
-	agent = mrcp_server_connection_agent_create(id,mrcp_ip,mrcp_port,max_connection_count,force_new_connection,loader->pool);
+	agent = mrcp_server_connection_agent_create_ex(id,mrcp_ip,mrcp_port,max_connection_count,force_new_connection,thread_count,loader->pool);
 	if(agent) {
 		if(rx_buffer_size) {
 			mrcp_server_connection_rx_size_set(agent,rx_buffer_size);
 		}
+		if(rx_buffer_max_size) {
+			mrcp_server_connection_rx_max_size_set(agent,rx_buffer_max_size);
+		}
 		if(tx_buffer_size) {
 			mrcp_server_connection_tx_size_set(agent,tx_buffer_size);
 		}
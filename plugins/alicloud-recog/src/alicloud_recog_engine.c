@@ -30,6 +30,7 @@
 #include "mrcp_recog_engine.h"
 #include "mpf_activity_detector.h"
 #include "apt_consumer_task.h"
+#include "apt_file_writer.h"
 #include "apt_log.h"
 
 #define RECOG_ENGINE_TASK_NAME "Alicloud Recog Engine"
@@ -85,6 +86,8 @@ static const mpf_audio_stream_vtable_t audio_stream_vtable = {
 /** Declaration of alicloud recognizer engine */
 struct alicloud_recog_engine_t {
 	apt_consumer_task_t    *task;
+	/** Writer of utterance files */
+	apt_file_writer_t      *file_writer;
 };
 
 /** Declaration of alicloud recognizer channel */
@@ -103,7 +106,7 @@ struct alicloud_recog_channel_t {
 	/** Voice activity detector */
 	mpf_activity_detector_t *detector;
 	/** File to write utterance to */
-	FILE                    *audio_out;
+	apt_file_writer_file_t  *audio_out;
 };
 
 typedef enum {
@@ -150,6 +153,10 @@ MRCP_PLUGIN_DECLARE(mrcp_engine_t*) mrcp_plugin_create(apr_pool_t *pool)
 	if(!alicloud_engine->task) {
 		return NULL;
 	}
+	alicloud_engine->file_writer = apt_file_writer_create(
+						APT_FILE_WRITER_DEFAULT_BUFFER_SIZE,
+						APT_FILE_WRITER_DEFAULT_INTERVAL,
+						pool);
 	task = apt_consumer_task_base_get(alicloud_engine->task);
 	apt_task_name_set(task,RECOG_ENGINE_TASK_NAME);
 	vtable = apt_task_vtable_get(task);
@@ -195,6 +202,9 @@ static apt_bool_t alicloud_recog_engine_open(mrcp_engine_t *engine)
 		apt_task_t *task = apt_consumer_task_base_get(alicloud_engine->task);
 		apt_task_start(task);
 	}
+	if(alicloud_engine->file_writer) {
+		apt_file_writer_start(alicloud_engine->file_writer);
+	}
 	return mrcp_engine_open_respond(engine,TRUE);
 }
 
@@ -208,6 +218,10 @@ static apt_bool_t alicloud_recog_engine_close(mrcp_engine_t *engine)
 		apt_task_t *task = apt_consumer_task_base_get(alicloud_engine->task);
 		apt_task_terminate(task,TRUE);
 	}
+	if(alicloud_engine->file_writer) {
+		/* flush and close the remaining files */
+		apt_file_writer_stop(alicloud_engine->file_writer);
+	}
 	return mrcp_engine_close_respond(engine);
 }
 
@@ -296,6 +310,8 @@ static apt_bool_t alicloud_recog_channel_recognize(mrcp_engine_channel_t *channe
 		return FALSE;
 	}
 
+	mpf_activity_detector_codec_set(recog_channel->detector,descriptor);
+
 	recog_channel->timers_started = TRUE;
 
 	/* get recognizer header */
@@ -320,9 +336,8 @@ static apt_bool_t alicloud_recog_channel_recognize(mrcp_engine_channel_t *channe
 		char *file_path = apt_vardir_filepath_get(dir_layout,file_name,channel->pool);
 		if(file_path) {
 			apt_log(RECOG_LOG_MARK,APT_PRIO_INFO,"Open Utterance Output File [%s] for Writing",file_path);
-			recog_channel->audio_out = fopen(file_path,"wb");
-			if(!recog_channel->audio_out) {
-				apt_log(RECOG_LOG_MARK,APT_PRIO_WARNING,"Failed to Open Utterance Output File [%s] for Writing",file_path);
+			if(recog_channel->alicloud_engine->file_writer) {
+				recog_channel->audio_out = apt_file_writer_open(recog_channel->alicloud_engine->file_writer,file_path);
 			}
 		}
 	}
@@ -557,7 +572,7 @@ static apt_bool_t alicloud_recog_stream_write(mpf_audio_stream_t *stream, const
 		}
 
 		if(recog_channel->audio_out) {
-			fwrite(frame->codec_frame.buffer,1,frame->codec_frame.size,recog_channel->audio_out);
+			apt_file_writer_write(recog_channel->audio_out,frame->codec_frame.buffer,frame->codec_frame.size);
 		}
 	}
 	return TRUE;
@@ -600,7 +615,7 @@ static apt_bool_t alicloud_recog_msg_process(apt_task_t *task, apt_task_msg_t *m
 			/* close channel, make sure there is no activity and send asynch response */
 			alicloud_recog_channel_t *recog_channel = alicloud_msg->channel->method_obj;
 			if(recog_channel->audio_out) {
-				fclose(recog_channel->audio_out);
+				apt_file_writer_close(recog_channel->audio_out);
 				recog_channel->audio_out = NULL;
 			}
 
@@ -30,6 +30,7 @@
 #include "mrcp_recog_engine.h"
 #include "mpf_activity_detector.h"
 #include "apt_consumer_task.h"
+#include "apt_file_writer.h"
 #include "apt_log.h"
 
 #define RECOG_ENGINE_TASK_NAME "Demo Recog Engine"
@@ -85,6 +86,8 @@ static const mpf_audio_stream_vtable_t audio_stream_vtable = {
 /** Declaration of demo recognizer engine */
 struct demo_recog_engine_t {
 	apt_consumer_task_t    *task;
+	/** Writer of utterance files */
+	apt_file_writer_t      *file_writer;
 };
 
 /** Declaration of demo recognizer channel */
@@ -103,7 +106,7 @@ struct demo_recog_channel_t {
 	/** Voice activity detector */
 	mpf_activity_detector_t *detector;
 	/** File to write utterance to */
-	FILE                    *audio_out;
+	apt_file_writer_file_t  *audio_out;
 };
 
 typedef enum {
@@ -148,6 +151,10 @@ MRCP_PLUGIN_DECLARE(mrcp_engine_t*) mrcp_plugin_create(apr_pool_t *pool)
 	if(!demo_engine->task) {
 		return NULL;
 	}
+	demo_engine->file_writer = apt_file_writer_create(
+						APT_FILE_WRITER_DEFAULT_BUFFER_SIZE,
+						APT_FILE_WRITER_DEFAULT_INTERVAL,
+						pool);
 	task = apt_consumer_task_base_get(demo_engine->task);
 	apt_task_name_set(task,RECOG_ENGINE_TASK_NAME);
 	vtable = apt_task_vtable_get(task);
@@ -183,6 +190,9 @@ static apt_bool_t demo_recog_engine_open(mrcp_engine_t *engine)
 		apt_task_t *task = apt_consumer_task_base_get(demo_engine->task);
 		apt_task_start(task);
 	}
+	if(demo_engine->file_writer) {
+		apt_file_writer_start(demo_engine->file_writer);
+	}
 	return mrcp_engine_open_respond(engine,TRUE);
 }
 
@@ -194,6 +204,10 @@ static apt_bool_t demo_recog_engine_close(mrcp_engine_t *engine)
 		apt_task_t *task = apt_consumer_task_base_get(demo_engine->task);
 		apt_task_terminate(task,TRUE);
 	}
+	if(demo_engine->file_writer) {
+		/* flush and close the remaining files */
+		apt_file_writer_stop(demo_engine->file_writer);
+	}
 	return mrcp_engine_close_respond(engine);
 }
 
@@ -273,6 +287,8 @@ static apt_bool_t demo_recog_channel_recognize(mrcp_engine_channel_t *channel, m
 		return FALSE;
 	}
 
+	mpf_activity_detector_codec_set(recog_channel->detector,descriptor);
+
 	recog_channel->timers_started = TRUE;
 
 	/* get recognizer header */
@@ -297,9 +313,8 @@ static apt_bool_t demo_recog_channel_recognize(mrcp_engine_channel_t *channel, m
 		char *file_path = apt_vardir_filepath_get(dir_layout,file_name,channel->pool);
 		if(file_path) {
 			apt_log(RECOG_LOG_MARK,APT_PRIO_INFO,"Open Utterance Output File [%s] for Writing",file_path);
-			recog_channel->audio_out = fopen(file_path,"wb");
-			if(!recog_channel->audio_out) {
-				apt_log(RECOG_LOG_MARK,APT_PRIO_WARNING,"Failed to Open Utterance Output File [%s] for Writing",file_path);
+			if(recog_channel->demo_engine->file_writer) {
+				recog_channel->audio_out = apt_file_writer_open(recog_channel->demo_engine->file_writer,file_path);
 			}
 		}
 	}
@@ -515,7 +530,7 @@ static apt_bool_t demo_recog_stream_write(mpf_audio_stream_t *stream, const mpf_
 		}
 
 		if(recog_channel->audio_out) {
-			fwrite(frame->codec_frame.buffer,1,frame->codec_frame.size,recog_channel->audio_out);
+			apt_file_writer_write(recog_channel->audio_out,frame->codec_frame.buffer,frame->codec_frame.size);
 		}
 	}
 	return TRUE;
@@ -554,7 +569,7 @@ static apt_bool_t demo_recog_msg_process(apt_task_t *task, apt_task_msg_t *msg)
 			/* close channel, make sure there is no activity and send asynch response */
 			demo_recog_channel_t *recog_channel = demo_msg->channel->method_obj;
 			if(recog_channel->audio_out) {
-				fclose(recog_channel->audio_out);
+				apt_file_writer_close(recog_channel->audio_out);
 				recog_channel->audio_out = NULL;
 			}
 
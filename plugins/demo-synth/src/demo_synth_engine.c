@@ -29,6 +29,7 @@
 
 #include "mrcp_synth_engine.h"
 #include "apt_consumer_task.h"
+#include "apt_file_cache.h"
 #include "apt_log.h"
 
 #define SYNTH_ENGINE_TASK_NAME "Demo Synth Engine"
@@ -84,6 +85,8 @@ static const mpf_audio_stream_vtable_t audio_stream_vtable = {
 /** Declaration of demo synthesizer engine */
 struct demo_synth_engine_t {
 	apt_consumer_task_t    *task;
+	/** Prompts shared by all the channels */
+	apt_file_cache_t       *prompt_cache;
 };
 
 /** Declaration of demo synthesizer channel */
@@ -102,7 +105,13 @@ struct demo_synth_channel_t {
 	/** Is paused */
 	apt_bool_t             paused;
 	/** Speech source (used instead of actual synthesis) */
-	FILE                  *audio_file;
+	apt_file_cache_entry_t *prompt;
+	/** Mapped content of the speech source */
+	const char            *prompt_data;
+	/** Size of the speech source */
+	apr_size_t             prompt_size;
+	/** Offset of the next frame in the speech source */
+	apr_size_t             prompt_offset;
 };
 
 typedef enum {
@@ -144,6 +153,9 @@ MRCP_PLUGIN_DECLARE(mrcp_engine_t*) mrcp_plugin_create(apr_pool_t *pool)
 	apt_task_vtable_t *vtable;
 	apt_task_msg_pool_t *msg_pool;
 
+	/* create cache of prompts */
+	demo_engine->prompt_cache = apt_file_cache_create(APT_FILE_CACHE_DEFAULT_MAX_SIZE,pool);
+
 	/* create task/thread to run demo engine in the context of this task */
 	msg_pool = apt_task_msg_pool_create_dynamic(sizeof(demo_synth_msg_t),pool);
 	demo_engine->task = apt_consumer_task_create(demo_engine,msg_pool,pool);
@@ -174,6 +186,10 @@ static apt_bool_t demo_synth_engine_destroy(mrcp_engine_t *engine)
 		apt_task_destroy(task);
 		demo_engine->task = NULL;
 	}
+	if(demo_engine->prompt_cache) {
+		apt_file_cache_destroy(demo_engine->prompt_cache);
+		demo_engine->prompt_cache = NULL;
+	}
 	return TRUE;
 }
 
@@ -212,8 +228,11 @@ static mrcp_engine_channel_t* demo_synth_engine_channel_create(mrcp_engine_t *en
 	synth_channel->stop_response = NULL;
 	synth_channel->time_to_complete = 0;
 	synth_channel->paused = FALSE;
-	synth_channel->audio_file = NULL;
-	
+	synth_channel->prompt = NULL;
+	synth_channel->prompt_data = NULL;
+	synth_channel->prompt_size = 0;
+	synth_channel->prompt_offset = 0;
+
 	capabilities = mpf_source_stream_capabilities_create(pool);
 	mpf_codec_capabilities_add(
 			&capabilities->codecs,
@@ -238,10 +257,23 @@ static mrcp_engine_channel_t* demo_synth_engine_channel_create(mrcp_engine_t *en
 	return synth_channel->channel;
 }
 
+/** Release the prompt of the channel, never called from the media thread as the prompt may get unmapped */
+static void demo_synth_prompt_release(demo_synth_channel_t *synth_channel)
+{
+	if(synth_channel->prompt) {
+		apt_file_cache_release(synth_channel->demo_engine->prompt_cache,synth_channel->prompt);
+		synth_channel->prompt = NULL;
+		synth_channel->prompt_data = NULL;
+		synth_channel->prompt_size = 0;
+	}
+}
+
 /** Destroy engine channel */
 static apt_bool_t demo_synth_channel_destroy(mrcp_engine_channel_t *channel)
 {
-	/* nothing to destroy */
+	demo_synth_channel_t *synth_channel = channel->method_obj;
+	/* the media termination is already destroyed */
+	demo_synth_prompt_release(synth_channel);
 	return TRUE;
 }
 
@@ -281,9 +313,18 @@ static apt_bool_t demo_synth_channel_speak(mrcp_engine_channel_t *channel, mrcp_
 		char *file_name = apr_psprintf(channel->pool,"demo-%dkHz.pcm",descriptor->sampling_rate/1000);
 		file_path = apt_datadir_filepath_get(channel->engine->dir_layout,file_name,channel->pool);
 	}
-	if(file_path) {
-		synth_channel->audio_file = fopen(file_path,"rb");
-		if(synth_channel->audio_file) {
+	/* the prompt of the previous request is no longer read by the media thread */
+	demo_synth_prompt_release(synth_channel);
+	if(file_path && synth_channel->demo_engine->prompt_cache) {
+		const void *data;
+		synth_channel->prompt = apt_file_cache_acquire(
+									synth_channel->demo_engine->prompt_cache,
+									file_path,
+									&data,
+									&synth_channel->prompt_size);
+		if(synth_channel->prompt) {
+			synth_channel->prompt_data = data;
+			synth_channel->prompt_offset = 0;
 			apt_log(SYNTH_LOG_MARK,APT_PRIO_INFO,"Set [%s] as Speech Source " APT_SIDRES_FMT,
 				file_path,
 				MRCP_MESSAGE_SIDRES(request));
@@ -457,10 +498,6 @@ static apt_bool_t demo_synth_stream_read(mpf_audio_stream_t *stream, mpf_frame_t
 		synth_channel->stop_response = NULL;
 		synth_channel->speak_request = NULL;
 		synth_channel->paused = FALSE;
-		if(synth_channel->audio_file) {
-			fclose(synth_channel->audio_file);
-			synth_channel->audio_file = NULL;
-		}
 		return TRUE;
 	}
 
@@ -468,10 +505,12 @@ static apt_bool_t demo_synth_stream_read(mpf_audio_stream_t *stream, mpf_frame_t
 	if(synth_channel->speak_request && synth_channel->paused == FALSE) {
 		/* normal processing */
 		apt_bool_t completed = FALSE;
-		if(synth_channel->audio_file) {
-			/* read speech from file */
+		if(synth_channel->prompt) {
+			/* read speech from the mapped file */
 			apr_size_t size = frame->codec_frame.size;
-			if(fread(frame->codec_frame.buffer,1,size,synth_channel->audio_file) == size) {
+			if(synth_channel->prompt_size - synth_channel->prompt_offset >= size) {
+				memcpy(frame->codec_frame.buffer,synth_channel->prompt_data + synth_channel->prompt_offset,size);
+				synth_channel->prompt_offset += size;
 				frame->type |= MEDIA_FRAME_TYPE_AUDIO;
 			}
 			else {
@@ -508,10 +547,6 @@ static apt_bool_t demo_synth_stream_read(mpf_audio_stream_t *stream, mpf_frame_t
 				message->start_line.request_state = MRCP_REQUEST_STATE_COMPLETE;
 
 				synth_channel->speak_request = NULL;
-				if(synth_channel->audio_file) {
-					fclose(synth_channel->audio_file);
-					synth_channel->audio_file = NULL;
-				}
 				/* send asynch event */
 				mrcp_engine_channel_message_send(synth_channel->channel,message);
 			}
@@ -30,6 +30,7 @@
 #include "mrcp_verifier_engine.h"
 #include "mpf_activity_detector.h"
 #include "apt_consumer_task.h"
+#include "apt_file_writer.h"
 #include "apt_log.h"
 
 #define VERIFIER_ENGINE_TASK_NAME "Demo Verifier Engine"
@@ -85,6 +86,8 @@ static const mpf_audio_stream_vtable_t audio_stream_vtable = {
 /** Declaration of demo verification engine */
 struct demo_verifier_engine_t {
 	apt_consumer_task_t    *task;
+	/** Writer of utterance files */
+	apt_file_writer_t      *file_writer;
 };
 
 /** Declaration of demo verification channel */
@@ -103,7 +106,7 @@ struct demo_verifier_channel_t {
 	/** Voice activity detector */
 	mpf_activity_detector_t *detector;
 	/** File to write voiceprint to */
-	FILE                    *audio_out;
+	apt_file_writer_file_t  *audio_out;
 };
 
 typedef enum {
@@ -150,6 +153,10 @@ MRCP_PLUGIN_DECLARE(mrcp_engine_t*) mrcp_plugin_create(apr_pool_t *pool)
 	if(!demo_engine->task) {
 		return NULL;
 	}
+	demo_engine->file_writer = apt_file_writer_create(
+						APT_FILE_WRITER_DEFAULT_BUFFER_SIZE,
+						APT_FILE_WRITER_DEFAULT_INTERVAL,
+						pool);
 	task = apt_consumer_task_base_get(demo_engine->task);
 	apt_task_name_set(task,VERIFIER_ENGINE_TASK_NAME);
 	vtable = apt_task_vtable_get(task);
@@ -185,6 +192,9 @@ static apt_bool_t demo_verifier_engine_open(mrcp_engine_t *engine)
 		apt_task_t *task = apt_consumer_task_base_get(demo_engine->task);
 		apt_task_start(task);
 	}
+	if(demo_engine->file_writer) {
+		apt_file_writer_start(demo_engine->file_writer);
+	}
 	return mrcp_engine_open_respond(engine,TRUE);
 }
 
@@ -196,6 +206,10 @@ static apt_bool_t demo_verifier_engine_close(mrcp_engine_t *engine)
 		apt_task_t *task = apt_consumer_task_base_get(demo_engine->task);
 		apt_task_terminate(task,TRUE);
 	}
+	if(demo_engine->file_writer) {
+		/* flush and close the remaining files */
+		apt_file_writer_stop(demo_engine->file_writer);
+	}
 	return mrcp_engine_close_respond(engine);
 }
 
@@ -275,6 +289,8 @@ static apt_bool_t demo_verifier_channel_verify(mrcp_engine_channel_t *channel, m
 		return FALSE;
 	}
 
+	mpf_activity_detector_codec_set(verifier_channel->detector,descriptor);
+
 	verifier_channel->timers_started = TRUE;
 
 	/* get verifier header */
@@ -299,9 +315,8 @@ static apt_bool_t demo_verifier_channel_verify(mrcp_engine_channel_t *channel, m
 		char *file_path = apt_vardir_filepath_get(dir_layout,file_name,channel->pool);
 		if(file_path) {
 			apt_log(VERIF_LOG_MARK,APT_PRIO_INFO,"Open Utterance Output File [%s] for Writing",file_path);
-			verifier_channel->audio_out = fopen(file_path,"wb");
-			if(!verifier_channel->audio_out) {
-				apt_log(VERIF_LOG_MARK,APT_PRIO_WARNING,"Failed to Open Utterance Output File [%s] for Writing",file_path);
+			if(verifier_channel->demo_engine->file_writer) {
+				verifier_channel->audio_out = apt_file_writer_open(verifier_channel->demo_engine->file_writer,file_path);
 			}
 		}
 	}
@@ -540,7 +555,7 @@ static apt_bool_t demo_verifier_stream_write(mpf_audio_stream_t *stream, const m
 		}
 
 		if(verifier_channel->audio_out) {
-			fwrite(frame->codec_frame.buffer,1,frame->codec_frame.size,verifier_channel->audio_out);
+			apt_file_writer_write(verifier_channel->audio_out,frame->codec_frame.buffer,frame->codec_frame.size);
 		}
 	}
 	return TRUE;
@@ -579,7 +594,7 @@ static apt_bool_t demo_verifier_msg_process(apt_task_t *task, apt_task_msg_t *ms
 			/* close channel, make sure there is no activity and send asynch response */
 			demo_verifier_channel_t *verifier_channel = demo_msg->channel->method_obj;
 			if(verifier_channel->audio_out) {
-				fclose(verifier_channel->audio_out);
+				apt_file_writer_close(verifier_channel->audio_out);
 				verifier_channel->audio_out = NULL;
 			}
 
@@ -29,6 +29,8 @@
 
 #include "mrcp_recorder_engine.h"
 #include "mpf_activity_detector.h"
+#include "apt_file_writer.h"
+#include <apr_atomic.h>
 #include "apt_log.h"
 
 #define RECORDER_ENGINE_TASK_NAME "Recorder Engine"
@@ -101,7 +103,18 @@ struct recorder_channel_t {
 	/** File name of the recording */
 	const char              *file_name;
 	/** File to write to */
-	FILE                    *audio_out;
+	apt_file_writer_file_t  *audio_out;
+	/** References held by the channel and by the completions being sent from the file writer */
+	volatile apr_uint32_t    ref_count;
+};
+
+/** Completion to send once the recording is closed */
+typedef struct recorder_completion_t recorder_completion_t;
+struct recorder_completion_t {
+	/** Recorder channel */
+	recorder_channel_t *recorder_channel;
+	/** RECORD-COMPLETE event or response to STOP request */
+	mrcp_message_t     *message;
 };
 
 /** Declare this macro to set plugin version */
@@ -120,10 +133,16 @@ MRCP_PLUGIN_LOG_SOURCE_IMPLEMENT(RECORD_PLUGIN,"RECORD-PLUGIN")
 /** Create recorder engine */
 MRCP_PLUGIN_DECLARE(mrcp_engine_t*) mrcp_plugin_create(apr_pool_t *pool)
 {
+	/* create writer of recordings */
+	apt_file_writer_t *file_writer = apt_file_writer_create(
+						APT_FILE_WRITER_DEFAULT_BUFFER_SIZE,
+						APT_FILE_WRITER_DEFAULT_INTERVAL,
+						pool);
+
 	/* create engine base */
 	return mrcp_engine_create(
 				MRCP_RECORDER_RESOURCE,    /* MRCP resource identifier */
-				NULL,                      /* object to associate */
+				file_writer,               /* object to associate */
 				&engine_vtable,            /* virtual methods table of engine */
 				pool);                     /* pool to allocate memory from */
 }
@@ -137,12 +156,21 @@ static apt_bool_t recorder_engine_destroy(mrcp_engine_t *engine)
 /** Open recorder engine */
 static apt_bool_t recorder_engine_open(mrcp_engine_t *engine)
 {
+	apt_file_writer_t *file_writer = engine->obj;
+	if(file_writer) {
+		apt_file_writer_start(file_writer);
+	}
 	return mrcp_engine_open_respond(engine,TRUE);
 }
 
 /** Close recorder engine */
 static apt_bool_t recorder_engine_close(mrcp_engine_t *engine)
 {
+	apt_file_writer_t *file_writer = engine->obj;
+	if(file_writer) {
+		/* flush and close the remaining files */
+		apt_file_writer_stop(file_writer);
+	}
 	return mrcp_engine_close_respond(engine);
 }
 
@@ -161,6 +189,7 @@ static mrcp_engine_channel_t* recorder_engine_channel_create(mrcp_engine_t *engi
 	recorder_channel->cur_size = 0;
 	recorder_channel->file_name = NULL;
 	recorder_channel->audio_out = NULL;
+	recorder_channel->ref_count = 1;
 
 	capabilities = mpf_sink_stream_capabilities_create(pool);
 	mpf_codec_capabilities_add(
@@ -203,16 +232,52 @@ static apt_bool_t recorder_channel_open(mrcp_engine_channel_t *channel)
 /** Close engine channel (asynchronous response MUST be sent)*/
 static apt_bool_t recorder_channel_close(mrcp_engine_channel_t *channel)
 {
+	recorder_channel_t *recorder_channel = channel->method_obj;
+	/* the last completion being sent from the file writer responds instead, if any */
+	if(apr_atomic_dec32(&recorder_channel->ref_count) != 0) {
+		return TRUE;
+	}
 	/* close channel, make sure there is no activity and send asynch response */
 	return mrcp_engine_channel_close_respond(channel);
 }
 
+/** Send the completion once the recording is closed (file writer context) */
+static void recorder_completion_send(void *obj)
+{
+	recorder_completion_t *completion = obj;
+	recorder_channel_t *recorder_channel = completion->recorder_channel;
+	mrcp_engine_channel_message_send(recorder_channel->channel,completion->message);
+	if(apr_atomic_dec32(&recorder_channel->ref_count) == 0) {
+		/* the channel is closed meantime */
+		mrcp_engine_channel_close_respond(recorder_channel->channel);
+	}
+}
+
+/** Close the recording and send the message once the file is complete, never blocks the media thread */
+static apt_bool_t recorder_completion_post(recorder_channel_t *recorder_channel, mrcp_message_t *message)
+{
+	recorder_completion_t *completion;
+	if(!recorder_channel->audio_out) {
+		return mrcp_engine_channel_message_send(recorder_channel->channel,message);
+	}
+
+	/* the file must be complete by the time the Record-URI is sent */
+	completion = apr_palloc(recorder_channel->channel->pool,sizeof(recorder_completion_t));
+	completion->recorder_channel = recorder_channel;
+	completion->message = message;
+	apr_atomic_inc32(&recorder_channel->ref_count);
+	apt_file_writer_close_ex(recorder_channel->audio_out,recorder_completion_send,completion);
+	recorder_channel->audio_out = NULL;
+	return TRUE;
+}
+
 /** Open file to record */
 static apt_bool_t recorder_file_open(recorder_channel_t *recorder_channel, mrcp_message_t *request)
 {
 	char *file_path;
 	char *file_name;
 	mrcp_engine_channel_t *channel = recorder_channel->channel;
+	apt_file_writer_t *file_writer = channel->engine->obj;
 	const apt_dir_layout_t *dir_layout = channel->engine->dir_layout;
 	const mpf_codec_descriptor_t *descriptor = mrcp_engine_sink_stream_codec_get(channel);
 
@@ -221,24 +286,25 @@ static apt_bool_t recorder_file_open(recorder_channel_t *recorder_channel, mrcp_
 		return FALSE;
 	}
 
+	mpf_activity_detector_codec_set(recorder_channel->detector,descriptor);
+
 	file_name = apr_psprintf(channel->pool,"rec-%dkHz-%s-%"MRCP_REQUEST_ID_FMT".pcm",
 		descriptor->sampling_rate/1000,
 		request->channel_id.session_id.buf,
 		request->start_line.request_id);
 	file_path = apt_vardir_filepath_get(dir_layout,file_name,channel->pool);
-	if(!file_path) {
+	if(!file_path || !file_writer) {
 		return FALSE;
 	}
 
 	if(recorder_channel->audio_out) {
-		fclose(recorder_channel->audio_out);
+		apt_file_writer_close(recorder_channel->audio_out);
 		recorder_channel->audio_out = NULL;
 	}
 
 	apt_log(RECORD_LOG_MARK,APT_PRIO_INFO,"Open Utterance Output File [%s] for Writing",file_path);
-	recorder_channel->audio_out = fopen(file_path,"wb");
+	recorder_channel->audio_out = apt_file_writer_open(file_writer,file_path);
 	if(!recorder_channel->audio_out) {
-		apt_log(RECORD_LOG_MARK,APT_PRIO_WARNING,"Failed to Open Utterance Output File [%s] for Writing",file_path);
 		return FALSE;
 	}
 
@@ -386,11 +452,6 @@ static apt_bool_t recorder_record_complete(recorder_channel_t *recorder_channel,
 		return FALSE;
 	}
 
-	if(recorder_channel->audio_out) {
-		fclose(recorder_channel->audio_out);
-		recorder_channel->audio_out = NULL;
-	}
-
 	/* get/allocate recorder header */
 	recorder_header = mrcp_resource_header_prepare(message);
 	if(recorder_header) {
@@ -404,8 +465,8 @@ static apt_bool_t recorder_record_complete(recorder_channel_t *recorder_channel,
 	message->start_line.request_state = MRCP_REQUEST_STATE_COMPLETE;
 
 	recorder_channel->record_request = NULL;
-	/* send asynch event */
-	return mrcp_engine_channel_message_send(recorder_channel->channel,message);
+	/* send asynch event once the recording is closed */
+	return recorder_completion_post(recorder_channel,message);
 }
 
 /** Callback is called from MPF engine context to destroy any additional data associated with audio stream */
@@ -431,17 +492,12 @@ static apt_bool_t recorder_stream_write(mpf_audio_stream_t *stream, const mpf_fr
 {
 	recorder_channel_t *recorder_channel = stream->obj;
 	if(recorder_channel->stop_response) {
-		if(recorder_channel->audio_out) {
-			fclose(recorder_channel->audio_out);
-			recorder_channel->audio_out = NULL;
-		}
-		
 		if(recorder_channel->record_request){
 			/* set record-uri */
 			recorder_channel_uri_set(recorder_channel,recorder_channel->stop_response);
 		}
-		/* send asynchronous response to STOP request */
-		mrcp_engine_channel_message_send(recorder_channel->channel,recorder_channel->stop_response);
+		/* send asynchronous response to STOP request once the recording is closed */
+		recorder_completion_post(recorder_channel,recorder_channel->stop_response);
 		recorder_channel->stop_response = NULL;
 		recorder_channel->record_request = NULL;
 		return TRUE;
@@ -472,9 +528,14 @@ static apt_bool_t recorder_stream_write(mpf_audio_stream_t *stream, const mpf_fr
 		}
 
 		if(recorder_channel->audio_out) {
-			fwrite(frame->codec_frame.buffer,1,frame->codec_frame.size,recorder_channel->audio_out);
-			
-			recorder_channel->cur_size += frame->codec_frame.size;
+			if(apt_file_writer_write(recorder_channel->audio_out,frame->codec_frame.buffer,frame->codec_frame.size) == TRUE) {
+				recorder_channel->cur_size += frame->codec_frame.size;
+			}
+			else {
+				apt_log(RECORD_LOG_MARK,APT_PRIO_WARNING,"Dropped %"APR_SIZE_T_FMT" bytes of Recording " APT_SIDRES_FMT,
+					frame->codec_frame.size,
+					MRCP_MESSAGE_SIDRES(recorder_channel->record_request));
+			}
 			recorder_channel->cur_time += CODEC_FRAME_TIME_BASE;
 			if(recorder_channel->max_time && recorder_channel->cur_time >= recorder_channel->max_time) {
 				recorder_record_complete(recorder_channel,RECORDER_COMPLETION_CAUSE_SUCCESS_MAXTIME);
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <apr_time.h>
+#include <apr_thread_proc.h>
+#include "apt_test_suite.h"
+#include "apt_consumer_task.h"
+#include "apt_log.h"
+
+/** Default number of messages signaled by each producer */
+#define MSG_POOL_SUITE_MSG_COUNT      500000
+/** Number of producer threads */
+#define MSG_POOL_SUITE_PRODUCER_COUNT 2
+
+typedef struct {
+	apr_uint32_t producer;
+	apr_uint32_t number;
+} msg_pool_suite_data_t;
+
+/** State shared by the producers and the consumer task */
+typedef struct {
+	/** Pool of messages under test */
+	apt_task_msg_pool_t *msg_pool;
+	/** Consumer task */
+	apt_task_t          *task;
+	/** Number of messages to signal by each producer */
+	apr_uint32_t         count;
+	/** Number of messages processed by the consumer task */
+	apr_uint32_t         processed;
+	/** Next message number expected from each producer */
+	apr_uint32_t         expected[MSG_POOL_SUITE_PRODUCER_COUNT];
+	/** Set if messages are processed out of order */
+	apt_bool_t           failed;
+} msg_pool_suite_t;
+
+typedef struct {
+	msg_pool_suite_t *suite;
+	apr_uint32_t      producer;
+} msg_pool_producer_t;
+
+static apt_bool_t msg_pool_task_msg_process(apt_task_t *task, apt_task_msg_t *msg)
+{
+	msg_pool_suite_t *suite = apt_consumer_task_object_get(apt_task_object_get(task));
+	msg_pool_suite_data_t *data = (msg_pool_suite_data_t*)msg->data;
+	if(data->number != suite->expected[data->producer]) {
+		suite->failed = TRUE;
+	}
+	suite->expected[data->producer] = data->number + 1;
+	suite->processed++;
+	return TRUE;
+}
+
+static void* APR_THREAD_FUNC msg_pool_producer(apr_thread_t *thread, void *obj)
+{
+	msg_pool_producer_t *producer = obj;
+	msg_pool_suite_t *suite = producer->suite;
+	msg_pool_suite_data_t *data;
+	apt_task_msg_t *msg;
+	apr_uint32_t i;
+
+	for(i = 0; i < suite->count; i++) {
+		msg = apt_task_msg_acquire(suite->msg_pool);
+		msg->type = TASK_MSG_USER;
+		data = (msg_pool_suite_data_t*) msg->data;
+		data->producer = producer->producer;
+		data->number = i;
+		apt_task_msg_signal(suite->task,msg);
+	}
+	return NULL;
+}
+
+/** Signal messages from the producers to the consumer task and report the rate */
+static apt_bool_t msg_pool_test_run(apt_test_suite_t *test_suite, const char *name, apt_task_msg_pool_t *msg_pool, apr_uint32_t count)
+{
+	msg_pool_suite_t suite;
+	msg_pool_producer_t producers[MSG_POOL_SUITE_PRODUCER_COUNT];
+	apr_thread_t *threads[MSG_POOL_SUITE_PRODUCER_COUNT];
+	apt_consumer_task_t *consumer_task;
+	apt_task_vtable_t *vtable;
+	apr_time_t start;
+	apr_time_t elapsed;
+	apr_status_t rv;
+	apr_uint32_t total = count * MSG_POOL_SUITE_PRODUCER_COUNT;
+	apr_uint32_t i;
+
+	if(!msg_pool) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create [%s] Message Pool",name);
+		return FALSE;
+	}
+
+	memset(&suite,0,sizeof(suite));
+	suite.msg_pool = msg_pool;
+	suite.count = count;
+
+	consumer_task = apt_consumer_task_create(&suite,msg_pool,test_suite->pool);
+	if(!consumer_task) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Consumer Task");
+		return FALSE;
+	}
+	suite.task = apt_consumer_task_base_get(consumer_task);
+	vtable = apt_task_vtable_get(suite.task);
+	if(vtable) {
+		vtable->process_msg = msg_pool_task_msg_process;
+	}
+	if(apt_task_start(suite.task) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Start Task");
+		apt_task_destroy(suite.task);
+		return FALSE;
+	}
+
+	start = apr_time_now();
+	for(i = 0; i < MSG_POOL_SUITE_PRODUCER_COUNT; i++) {
+		producers[i].suite = &suite;
+		producers[i].producer = i;
+		apr_thread_create(&threads[i],NULL,msg_pool_producer,&producers[i],test_suite->pool);
+	}
+	for(i = 0; i < MSG_POOL_SUITE_PRODUCER_COUNT; i++) {
+		apr_thread_join(&rv,threads[i]);
+	}
+	/* the terminate request is queued after all the messages */
+	apt_task_terminate(suite.task,TRUE);
+	elapsed = apr_time_now() - start;
+	apt_task_destroy(suite.task);
+
+	if(suite.processed != total || suite.failed == TRUE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"[%s] Message Pool: %u of %u Messages Processed%s",
+			name,suite.processed,total,suite.failed == TRUE ? " out of order" : "");
+		return FALSE;
+	}
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"[%s] Message Pool: %u Messages in %" APR_TIME_T_FMT " usec, %.0f msg/s",
+		name,
+		total,
+		elapsed,
+		elapsed ? (double)total * APR_USEC_PER_SEC / elapsed : 0.0);
+	return TRUE;
+}
+
+static apt_bool_t msg_pool_test_run_all(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	apr_uint32_t count = MSG_POOL_SUITE_MSG_COUNT;
+	apt_task_msg_pool_t *msg_pool;
+	apt_bool_t status = TRUE;
+
+	if(argc > 0) {
+		/* number of messages signaled by each producer */
+		count = (apr_uint32_t)atol(argv[0]);
+	}
+
+	msg_pool = apt_task_msg_pool_create_dynamic(sizeof(msg_pool_suite_data_t),suite->pool);
+	if(msg_pool_test_run(suite,"dynamic",msg_pool,count) == FALSE) {
+		status = FALSE;
+	}
+
+	msg_pool = apt_task_msg_pool_create_static(sizeof(msg_pool_suite_data_t),APT_TASK_MSG_POOL_DEFAULT_SIZE,suite->pool);
+	if(msg_pool_test_run(suite,"static",msg_pool,count) == FALSE) {
+		status = FALSE;
+	}
+	if(msg_pool) {
+		apt_task_msg_pool_destroy(msg_pool);
+	}
+	return status;
+}
+
+apt_test_suite_t* msg_pool_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"msgpool",NULL,msg_pool_test_run_all);
+	return suite;
+}
@@ -0,0 +1,251 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "apt_test_suite.h"
+#include "apt_text_stream.h"
+#include "apt_log.h"
+
+/** Size of the initial buffer */
+#define RX_BUFFER_SUITE_INITIAL_SIZE 16
+/** Max size to grow the buffer up to (not a power of 2 multiple of the initial size) */
+#define RX_BUFFER_SUITE_MAX_SIZE     100
+
+/** Check the stream is laid over the current buffer, with the offset of the data received so far */
+static apt_bool_t rx_buffer_stream_check(const apt_text_rx_buffer_t *buffer, const apt_text_stream_t *stream, apr_size_t offset)
+{
+	if(stream->text.buf != buffer->buf || stream->text.length != buffer->size ||
+		stream->end != buffer->buf + buffer->size || stream->pos != buffer->buf + offset) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Stream is not Laid over Buffer [%"APR_SIZE_T_FMT" bytes]",buffer->size);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/** Grow the buffer and check the resulting size */
+static apt_bool_t rx_buffer_grow_check(apt_text_rx_buffer_t *buffer, apt_text_stream_t *stream, apr_size_t required_size, apt_bool_t grown, apr_size_t size)
+{
+	if(apt_text_rx_buffer_grow(buffer,stream,required_size) != grown || buffer->size != size) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Growth for %"APR_SIZE_T_FMT" bytes: %"APR_SIZE_T_FMT" bytes, expected %"APR_SIZE_T_FMT,
+			required_size,buffer->size,size);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/** Grow the buffer geometrically up to the max size */
+static apt_bool_t rx_buffer_growth_test(void)
+{
+	char initial[RX_BUFFER_SUITE_INITIAL_SIZE + 1];
+	apt_text_rx_buffer_t buffer;
+	apt_text_stream_t stream;
+	apt_bool_t status = FALSE;
+
+	apt_text_rx_buffer_init(&buffer,&stream,initial,RX_BUFFER_SUITE_INITIAL_SIZE,RX_BUFFER_SUITE_MAX_SIZE);
+	do {
+		/* fits already */
+		if(rx_buffer_grow_check(&buffer,&stream,RX_BUFFER_SUITE_INITIAL_SIZE,FALSE,RX_BUFFER_SUITE_INITIAL_SIZE) == FALSE) {
+			break;
+		}
+		/* doubled */
+		if(rx_buffer_grow_check(&buffer,&stream,20,TRUE,32) == FALSE) {
+			break;
+		}
+		/* doubled as many times as needed at once */
+		if(rx_buffer_grow_check(&buffer,&stream,33,TRUE,64) == FALSE) {
+			break;
+		}
+		/* capped by the max size */
+		if(rx_buffer_grow_check(&buffer,&stream,80,TRUE,RX_BUFFER_SUITE_MAX_SIZE) == FALSE) {
+			break;
+		}
+		/* never beyond the max size */
+		if(rx_buffer_grow_check(&buffer,&stream,1000,FALSE,RX_BUFFER_SUITE_MAX_SIZE) == FALSE) {
+			break;
+		}
+		if(buffer.buf == buffer.initial || rx_buffer_stream_check(&buffer,&stream,0) == FALSE) {
+			break;
+		}
+		status = TRUE;
+	}
+	while(0);
+
+	apt_text_rx_buffer_release(&buffer);
+	return status;
+}
+
+/** Keep the data received before the position of the stream across grows */
+static apt_bool_t rx_buffer_data_test(void)
+{
+	char initial[RX_BUFFER_SUITE_INITIAL_SIZE + 1];
+	const char data[] = "MRCP/2.0 1234 SPEAK 1\r\nChannel-Identifier: 32AECB23433802@speechsynth\r\n";
+	apr_size_t length = sizeof(data) - 1;
+	apr_size_t offset = 0;
+	apr_size_t chunk;
+	apt_text_rx_buffer_t buffer;
+	apt_text_stream_t stream;
+	apt_bool_t status = TRUE;
+
+	apt_text_rx_buffer_init(&buffer,&stream,initial,RX_BUFFER_SUITE_INITIAL_SIZE,RX_BUFFER_SUITE_MAX_SIZE);
+	/* receive the data into the free space, growing the buffer once full, as the connections do */
+	while(offset < length) {
+		if(offset == buffer.size) {
+			if(apt_text_rx_buffer_grow(&buffer,&stream,offset + 1) == FALSE) {
+				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Grow Buffer [%"APR_SIZE_T_FMT" bytes]",buffer.size);
+				status = FALSE;
+				break;
+			}
+			if(memcmp(buffer.buf,data,offset) != 0) {
+				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Data is not Kept across Grow [%"APR_SIZE_T_FMT" bytes]",offset);
+				status = FALSE;
+				break;
+			}
+			if(rx_buffer_stream_check(&buffer,&stream,offset) == FALSE) {
+				status = FALSE;
+				break;
+			}
+		}
+
+		chunk = buffer.size - offset;
+		if(chunk > length - offset) {
+			chunk = length - offset;
+		}
+		memcpy(stream.pos,data + offset,chunk);
+		stream.pos += chunk;
+		offset += chunk;
+	}
+
+	if(status == TRUE && memcmp(buffer.buf,data,length) != 0) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Received Data Mismatch");
+		status = FALSE;
+	}
+	apt_text_rx_buffer_release(&buffer);
+	return status;
+}
+
+/** Shrink back to the initial buffer only once the stream holds no data */
+static apt_bool_t rx_buffer_shrink_test(void)
+{
+	char initial[RX_BUFFER_SUITE_INITIAL_SIZE + 1];
+	apt_text_rx_buffer_t buffer;
+	apt_text_stream_t stream;
+	apt_bool_t status = FALSE;
+
+	apt_text_rx_buffer_init(&buffer,&stream,initial,RX_BUFFER_SUITE_INITIAL_SIZE,RX_BUFFER_SUITE_MAX_SIZE);
+	do {
+		/* nothing to shrink */
+		apt_text_rx_buffer_shrink(&buffer,&stream);
+		if(buffer.buf != initial || rx_buffer_stream_check(&buffer,&stream,0) == FALSE) {
+			break;
+		}
+
+		memcpy(stream.pos,"MRCP/2.0",8);
+		stream.pos += 8;
+		if(rx_buffer_grow_check(&buffer,&stream,40,TRUE,64) == FALSE) {
+			break;
+		}
+
+		/* the rest of the message is awaited, keep the grown buffer */
+		apt_text_rx_buffer_shrink(&buffer,&stream);
+		if(buffer.buf == initial || buffer.size != 64) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Buffer is Shrunk while Data is Pending");
+			break;
+		}
+		if(rx_buffer_stream_check(&buffer,&stream,8) == FALSE || memcmp(buffer.buf,"MRCP/2.0",8) != 0) {
+			break;
+		}
+
+		/* the message is processed and scrolled out, the stream is idle */
+		stream.pos = stream.text.buf;
+		apt_text_rx_buffer_shrink(&buffer,&stream);
+		if(buffer.buf != initial || buffer.size != RX_BUFFER_SUITE_INITIAL_SIZE) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Buffer is not Shrunk once Idle");
+			break;
+		}
+		if(rx_buffer_stream_check(&buffer,&stream,0) == FALSE) {
+			break;
+		}
+
+		/* grows again for the next large message */
+		if(rx_buffer_grow_check(&buffer,&stream,20,TRUE,32) == FALSE) {
+			break;
+		}
+		status = TRUE;
+	}
+	while(0);
+
+	apt_text_rx_buffer_release(&buffer);
+	if(buffer.buf != initial || buffer.size != RX_BUFFER_SUITE_INITIAL_SIZE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Buffer is not Released");
+		status = FALSE;
+	}
+	return status;
+}
+
+/** Never grow, if the max size is less than the initial size */
+static apt_bool_t rx_buffer_max_size_test(void)
+{
+	char initial[RX_BUFFER_SUITE_INITIAL_SIZE + 1];
+	apt_text_rx_buffer_t buffer;
+	apt_text_stream_t stream;
+	apt_bool_t status = TRUE;
+
+	apt_text_rx_buffer_init(&buffer,&stream,initial,RX_BUFFER_SUITE_INITIAL_SIZE,RX_BUFFER_SUITE_INITIAL_SIZE / 2);
+	stream.pos += 4;
+	if(rx_buffer_grow_check(&buffer,&stream,RX_BUFFER_SUITE_INITIAL_SIZE * 4,FALSE,RX_BUFFER_SUITE_INITIAL_SIZE) == FALSE ||
+		buffer.buf != initial || rx_buffer_stream_check(&buffer,&stream,4) == FALSE) {
+		status = FALSE;
+	}
+
+	stream.pos = stream.text.buf;
+	apt_text_rx_buffer_shrink(&buffer,&stream);
+	if(buffer.buf != initial || buffer.size != RX_BUFFER_SUITE_INITIAL_SIZE) {
+		status = FALSE;
+	}
+	apt_text_rx_buffer_release(&buffer);
+	return status;
+}
+
+static apt_bool_t rx_buffer_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	apt_bool_t status = TRUE;
+	if(rx_buffer_growth_test() == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Rx Buffer Growth Test Failed");
+		status = FALSE;
+	}
+	if(rx_buffer_data_test() == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Rx Buffer Data Test Failed");
+		status = FALSE;
+	}
+	if(rx_buffer_shrink_test() == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Rx Buffer Shrink Test Failed");
+		status = FALSE;
+	}
+	if(rx_buffer_max_size_test() == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Rx Buffer Max Size Test Failed");
+		status = FALSE;
+	}
+
+	if(status == TRUE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Rx Buffer Tests Passed");
+	}
+	return status;
+}
+
+apt_test_suite_t* rx_buffer_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"rxbuffer",NULL,rx_buffer_test_run);
+	return suite;
+}
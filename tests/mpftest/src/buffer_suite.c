@@ -0,0 +1,292 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <apr_thread_proc.h>
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "apt_atomic.h"
+#include "mpf_frame_buffer.h"
+#include "mpf_buffer.h"
+
+/** Default number of frames passed from the writer to the reader */
+#define BUFFER_SUITE_FRAME_COUNT   1000000
+/** Size of a frame in bytes */
+#define BUFFER_SUITE_FRAME_SIZE    160
+/** Capacity of the frame buffer in frames */
+#define BUFFER_SUITE_BUFFER_FRAMES 20
+/** The writer restarts the frame buffer every so many frames */
+#define BUFFER_SUITE_RESTART_RATE  10007
+
+/** State shared by the writer thread and the reader */
+typedef struct {
+	/** Frame buffer under test */
+	mpf_frame_buffer_t *frame_buffer;
+	/** Byte buffer under test */
+	mpf_buffer_t       *buffer;
+	/** Number of frames (or bytes) to write */
+	apr_uint32_t        count;
+	/** Number of events written to the byte buffer */
+	apr_uint32_t        event_count;
+	/** Set by the writer once all the frames (or bytes) have been written */
+	volatile apr_uint32_t done;
+} buffer_suite_t;
+
+/** Fill the frame with the bytes derived from its sequence number */
+static void buffer_suite_frame_fill(apr_byte_t *data, apr_uint32_t seq)
+{
+	apr_size_t i;
+	memcpy(data,&seq,sizeof(seq));
+	for(i = sizeof(seq); i < BUFFER_SUITE_FRAME_SIZE; i++) {
+		data[i] = (apr_byte_t)(seq + i);
+	}
+}
+
+/** Check the bytes of the frame against its sequence number */
+static apt_bool_t buffer_suite_frame_check(const apr_byte_t *data, apr_uint32_t *seq)
+{
+	apr_size_t i;
+	memcpy(seq,data,sizeof(*seq));
+	for(i = sizeof(*seq); i < BUFFER_SUITE_FRAME_SIZE; i++) {
+		if(data[i] != (apr_byte_t)(*seq + i)) {
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/** Byte of the stream passed via the byte buffer, never zero to tell it from silence */
+#define BUFFER_SUITE_STREAM_BYTE(pos) ((apr_byte_t)(1 + (pos) % 251))
+
+static void* APR_THREAD_FUNC frame_buffer_writer(apr_thread_t *thread, void *data)
+{
+	buffer_suite_t *suite = data;
+	apr_byte_t raw[BUFFER_SUITE_FRAME_SIZE];
+	mpf_frame_t frame;
+	apr_uint32_t seq = 1;
+
+	frame.type = MEDIA_FRAME_TYPE_AUDIO;
+	frame.marker = MPF_MARKER_NONE;
+	frame.codec_frame.buffer = raw;
+	frame.codec_frame.size = sizeof(raw);
+	while(seq <= suite->count) {
+		buffer_suite_frame_fill(raw,seq);
+		if(mpf_frame_buffer_write(suite->frame_buffer,&frame) == FALSE) {
+			/* buffer is full */
+			apr_thread_yield();
+			continue;
+		}
+		if(seq % BUFFER_SUITE_RESTART_RATE == 0) {
+			mpf_frame_buffer_restart(suite->frame_buffer);
+		}
+		seq++;
+	}
+	apt_atomic_store32_release(&suite->done,TRUE);
+	return NULL;
+}
+
+static void* APR_THREAD_FUNC buffer_writer(apr_thread_t *thread, void *data)
+{
+	buffer_suite_t *suite = data;
+	apr_byte_t chunk[BUFFER_SUITE_FRAME_SIZE * 3];
+	apr_uint32_t pos = 0;
+	apr_size_t size;
+	apr_size_t i;
+
+	while(pos < suite->count) {
+		size = 1 + rand() % sizeof(chunk);
+		if(size > suite->count - pos) {
+			size = suite->count - pos;
+		}
+		for(i = 0; i < size; i++) {
+			chunk[i] = BUFFER_SUITE_STREAM_BYTE(pos + i);
+		}
+		while(mpf_buffer_audio_write(suite->buffer,chunk,size) == FALSE) {
+			/* buffer is full */
+			apr_thread_yield();
+		}
+		pos += (apr_uint32_t)size;
+		if(size % 4 == 0) {
+			while(mpf_buffer_event_write(suite->buffer,MEDIA_FRAME_TYPE_EVENT) == FALSE) {
+				apr_thread_yield();
+			}
+			suite->event_count++;
+		}
+	}
+	apt_atomic_store32_release(&suite->done,TRUE);
+	return NULL;
+}
+
+/** Pass frames from the writer thread to the reader, check that none is corrupted or reordered */
+static apt_bool_t frame_buffer_test_run(mpf_frame_buffer_mode_e mode, apr_uint32_t count, apr_pool_t *pool)
+{
+	buffer_suite_t suite;
+	apr_thread_t *thread;
+	apr_status_t rv;
+	apr_byte_t raw[BUFFER_SUITE_FRAME_SIZE];
+	mpf_frame_t frame;
+	apr_uint32_t last_seq = 0;
+	apr_uint32_t seq;
+	apr_uint32_t received = 0;
+	apr_uint32_t errors = 0;
+	apr_time_t start = apr_time_now();
+
+	suite.frame_buffer = mpf_frame_buffer_create_ex(BUFFER_SUITE_FRAME_SIZE,BUFFER_SUITE_BUFFER_FRAMES,mode,pool);
+	suite.buffer = NULL;
+	suite.count = count;
+	suite.event_count = 0;
+	suite.done = FALSE;
+	if(apr_thread_create(&thread,NULL,frame_buffer_writer,&suite,pool) != APR_SUCCESS) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Writer Thread");
+		return FALSE;
+	}
+
+	frame.codec_frame.buffer = raw;
+	for(;;) {
+		apr_uint32_t done = apt_atomic_load32_acquire(&suite.done);
+		frame.codec_frame.size = sizeof(raw);
+		mpf_frame_buffer_read(suite.frame_buffer,&frame);
+		if(!(frame.type & MEDIA_FRAME_TYPE_AUDIO)) {
+			if(done) {
+				/* the writer had finished before the buffer was found empty */
+				break;
+			}
+			apr_thread_yield();
+			continue;
+		}
+
+		if(buffer_suite_frame_check(raw,&seq) == FALSE || seq <= last_seq || seq > count) {
+			errors++;
+		}
+		/* frames may only be skipped by restart */
+		else if(seq != last_seq + 1 && mode == MPF_FRAME_BUFFER_SPSC &&
+			(seq - 1) / BUFFER_SUITE_RESTART_RATE == last_seq / BUFFER_SUITE_RESTART_RATE) {
+			errors++;
+		}
+		last_seq = seq;
+		received++;
+	}
+	apr_thread_join(&rv,thread);
+	mpf_frame_buffer_destroy(suite.frame_buffer);
+
+	apt_log(APT_LOG_MARK,errors ? APT_PRIO_WARNING : APT_PRIO_INFO,
+		"Frame Buffer [%s]: %u of %u frames received, %u errors, %"APR_TIME_T_FMT" usec",
+		mode == MPF_FRAME_BUFFER_SPSC ? "spsc" : "locked",
+		received,count,errors,apr_time_now() - start);
+	return errors ? FALSE : TRUE;
+}
+
+/** Pass a byte stream with events from the writer thread to the reader frame by frame */
+static apt_bool_t buffer_test_run(apr_uint32_t count, apr_pool_t *pool)
+{
+	buffer_suite_t suite;
+	apr_thread_t *thread;
+	apr_status_t rv;
+	apr_byte_t raw[BUFFER_SUITE_FRAME_SIZE];
+	mpf_frame_t frame;
+	apr_uint32_t pos = 0;
+	apr_uint32_t events = 0;
+	apr_uint32_t errors = 0;
+	apr_size_t size;
+	apr_time_t start = apr_time_now();
+
+	suite.frame_buffer = NULL;
+	suite.buffer = mpf_buffer_create_ex(BUFFER_SUITE_FRAME_SIZE * BUFFER_SUITE_BUFFER_FRAMES,pool);
+	suite.count = count * BUFFER_SUITE_FRAME_SIZE;
+	suite.event_count = 0;
+	suite.done = FALSE;
+	if(apr_thread_create(&thread,NULL,buffer_writer,&suite,pool) != APR_SUCCESS) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Writer Thread");
+		return FALSE;
+	}
+
+	frame.codec_frame.buffer = raw;
+	frame.codec_frame.size = sizeof(raw);
+	for(;;) {
+		apr_uint32_t done = apt_atomic_load32_acquire(&suite.done);
+		frame.type = MEDIA_FRAME_TYPE_NONE;
+		mpf_buffer_frame_read(suite.buffer,&frame);
+		if(frame.type & MEDIA_FRAME_TYPE_EVENT) {
+			events++;
+		}
+		if(!(frame.type & MEDIA_FRAME_TYPE_AUDIO)) {
+			if(done && mpf_buffer_get_size(suite.buffer) == 0) {
+				break;
+			}
+			apr_thread_yield();
+			continue;
+		}
+
+		/* audio is followed by silence only if the buffer ran dry */
+		for(size = 0; size < sizeof(raw) && raw[size]; size++) {
+			if(raw[size] != BUFFER_SUITE_STREAM_BYTE(pos + size)) {
+				errors++;
+				break;
+			}
+		}
+		pos += (apr_uint32_t)size;
+		for(; size < sizeof(raw); size++) {
+			if(raw[size]) {
+				errors++;
+				break;
+			}
+		}
+	}
+	apr_thread_join(&rv,thread);
+	mpf_buffer_destroy(suite.buffer);
+
+	/* events of the same frame are merged */
+	if(pos < suite.count || !events || events > suite.event_count) {
+		errors++;
+	}
+
+	apt_log(APT_LOG_MARK,errors ? APT_PRIO_WARNING : APT_PRIO_INFO,
+		"Buffer: %u bytes received, %u of %u events, %u errors, %"APR_TIME_T_FMT" usec",
+		pos,events,suite.event_count,errors,apr_time_now() - start);
+	return errors ? FALSE : TRUE;
+}
+
+/** Stress frame and byte buffers with concurrent writer and reader */
+static apt_bool_t buffer_test_run_all(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	apr_uint32_t count = BUFFER_SUITE_FRAME_COUNT;
+	apt_bool_t status = TRUE;
+	apr_pool_t *pool;
+
+	if(argc > 0) {
+		/* number of frames to pass */
+		count = (apr_uint32_t)atol(argv[0]);
+	}
+
+	apr_pool_create(&pool,suite->pool);
+	if(frame_buffer_test_run(MPF_FRAME_BUFFER_SPSC,count,pool) == FALSE) {
+		status = FALSE;
+	}
+	if(frame_buffer_test_run(MPF_FRAME_BUFFER_LOCKED,count,pool) == FALSE) {
+		status = FALSE;
+	}
+	if(buffer_test_run(count,pool) == FALSE) {
+		status = FALSE;
+	}
+	apr_pool_destroy(pool);
+	return status;
+}
+
+apt_test_suite_t* buffer_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"buffer",NULL,buffer_test_run_all);
+	return suite;
+}
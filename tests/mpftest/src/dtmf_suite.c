@@ -0,0 +1,275 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <math.h>
+#include "apt_test_suite.h"
+#include "apt_log.h"
+#include "mpf_stream.h"
+#include "mpf_dtmf_detector.h"
+#include "mpf_dtmf_generator.h"
+
+#ifndef M_PI
+#	define M_PI 3.141592653589793238462643
+#endif
+
+/** Synthesized signal fed to the in-band DTMF detector along with the digits expected to be detected */
+typedef struct {
+	/** Informative name of the case */
+	const char  *name;
+	/** Sampling rate */
+	apr_uint16_t sampling_rate;
+	/** Digits to synthesize */
+	const char  *digits;
+	/** Peak amplitude of the row (low group) tone */
+	double       row_level;
+	/** Peak amplitude of the column (high group) tone */
+	double       col_level;
+	/** Peak amplitude of the white noise added to the signal */
+	double       noise_level;
+	/** Duration of a digit (msec) */
+	apr_size_t   tone_duration;
+	/** Duration of the pause after a digit (msec) */
+	apr_size_t   pause_duration;
+	/** Digits the detector is expected to report */
+	const char  *expected;
+} dtmf_suite_case_t;
+
+#define DTMF_SUITE_ALL_DIGITS "123A456B789C*0#D"
+
+static const dtmf_suite_case_t dtmf_suite_cases[] = {
+	{"nominal-8k",         8000, DTMF_SUITE_ALL_DIGITS, 8000, 8000,    0, 100, 100, DTMF_SUITE_ALL_DIGITS},
+	{"nominal-16k",       16000, DTMF_SUITE_ALL_DIGITS, 8000, 8000,    0, 100, 100, DTMF_SUITE_ALL_DIGITS},
+	{"nominal-48k",       48000, DTMF_SUITE_ALL_DIGITS, 8000, 8000,    0, 100, 100, DTMF_SUITE_ALL_DIGITS},
+	{"loud-8k",            8000, DTMF_SUITE_ALL_DIGITS,16000,16000,    0, 100, 100, DTMF_SUITE_ALL_DIGITS},
+	{"short-8k",           8000, DTMF_SUITE_ALL_DIGITS, 8000, 8000,    0,  40,  40, "12A46B79C*#D"},
+	{"threshold-low-8k",   8000, "159",                 5000, 5000,    0, 100, 100, ""},
+	{"threshold-high-8k",  8000, "159",                 6500, 6500,    0, 100, 100, "159"},
+	{"threshold-low-16k", 16000, "159",                 3500, 3500,    0, 100, 100, ""},
+	{"threshold-high-16k",16000, "159",                 4500, 4500,    0, 100, 100, "159"},
+	{"twist-3dB-8k",       8000, "2580",                8000,11300,    0, 100, 100, "2580"},
+	{"twist-6dB-8k",       8000, "2580",                8000,16000,    0, 100, 100, ""},
+	{"reverse-twist-6dB-8k",8000,"2580",               16000, 8000,    0, 100, 100, "2580"},
+	{"reverse-twist-10dB-8k",8000,"2580",              25300, 8000,    0, 100, 100, ""},
+	{"noise-8k",           8000, "1470",                8000, 8000, 2000, 100, 100, "1470"},
+	{"loud-noise-8k",      8000, "1470",                8000, 8000,20000, 100, 100, "1470"},
+	{"noise-16k",         16000, "1470",                8000, 8000, 2000, 100, 100, "1470"},
+	{"row-only-8k",        8000, "5",                   8000,    0,    0, 300, 100, ""},
+	{"col-only-8k",        8000, "5",                      0, 8000,    0, 300, 100, ""},
+	{"repeated-8k",        8000, "1111",                8000, 8000,    0, 100, 100, "1111"},
+	{"no-pause-8k",        8000, "1212",                8000, 8000,    0, 100,   0, "1212"}
+};
+
+/** Row and column frequencies of a digit */
+static apt_bool_t dtmf_suite_digit_freqs(char digit, double *row_freq, double *col_freq)
+{
+	static const char digits[] = "123A456B789C*0#D";
+	static const double row_freqs[4] = {697, 770, 852, 941};
+	static const double col_freqs[4] = {1209, 1336, 1477, 1633};
+	const char *pos = strchr(digits,digit);
+	if(!pos || !digit) {
+		return FALSE;
+	}
+	*row_freq = row_freqs[(pos - digits) / 4];
+	*col_freq = col_freqs[(pos - digits) % 4];
+	return TRUE;
+}
+
+/** Synthesize the signal of the case */
+static apr_int16_t* dtmf_suite_signal_create(const dtmf_suite_case_t *test_case, apr_size_t *count, apr_pool_t *pool)
+{
+	apr_size_t tone_samples = test_case->tone_duration * test_case->sampling_rate / 1000;
+	apr_size_t pause_samples = test_case->pause_duration * test_case->sampling_rate / 1000;
+	apr_size_t total = (tone_samples + pause_samples) * strlen(test_case->digits) + pause_samples;
+	apr_int16_t *samples = apr_pcalloc(pool,total * sizeof(apr_int16_t));
+	apr_uint32_t seed = 12345;
+	apr_size_t pos = 0;
+	apr_size_t i;
+	const char *digit;
+	double row_freq;
+	double col_freq;
+	double value;
+
+	for(digit = test_case->digits; *digit; digit++) {
+		if(dtmf_suite_digit_freqs(*digit,&row_freq,&col_freq) == FALSE) {
+			continue;
+		}
+		for(i = 0; i < tone_samples; i++) {
+			double t = (double)i / test_case->sampling_rate;
+			value = test_case->row_level * sin(2 * M_PI * row_freq * t) +
+					test_case->col_level * sin(2 * M_PI * col_freq * t);
+			if(value > 32767) value = 32767;
+			if(value < -32768) value = -32768;
+			samples[pos++] = (apr_int16_t)value;
+		}
+		pos += pause_samples;
+	}
+
+	/* add deterministic white noise */
+	for(i = 0; i < total && test_case->noise_level > 0; i++) {
+		seed = seed * 1103515245 + 12345;
+		value = samples[i] + test_case->noise_level * ((double)((seed >> 16) & 0x7fff) / 16384.0 - 1.0);
+		if(value > 32767) value = 32767;
+		if(value < -32768) value = -32768;
+		samples[i] = (apr_int16_t)value;
+	}
+
+	*count = total;
+	return samples;
+}
+
+/** Run the detector over the signal of the case, return TRUE if the detected digits are the expected ones */
+static apt_bool_t dtmf_suite_case_run(const dtmf_suite_case_t *test_case, apr_pool_t *pool)
+{
+	mpf_audio_stream_t stream;
+	mpf_dtmf_detector_t *detector;
+	mpf_frame_t frame;
+	apr_int16_t *samples;
+	apr_size_t count;
+	apr_size_t frame_samples = test_case->sampling_rate * CODEC_FRAME_TIME_BASE / 1000;
+	apr_size_t i;
+	char detected[64];
+	apr_size_t detected_count = 0;
+	char digit;
+
+	memset(&stream,0,sizeof(stream));
+	stream.tx_descriptor = mpf_codec_lpcm_descriptor_create(test_case->sampling_rate,1,pool);
+	detector = mpf_dtmf_detector_create_ex(&stream,MPF_DTMF_DETECTOR_INBAND,pool);
+	if(!detector) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create DTMF Detector");
+		return FALSE;
+	}
+
+	samples = dtmf_suite_signal_create(test_case,&count,pool);
+	frame.type = MEDIA_FRAME_TYPE_AUDIO;
+	frame.marker = MPF_MARKER_NONE;
+	frame.codec_frame.size = frame_samples * sizeof(apr_int16_t);
+	for(i = 0; i + frame_samples <= count; i += frame_samples) {
+		frame.codec_frame.buffer = samples + i;
+		mpf_dtmf_detector_get_frame(detector,&frame);
+		while((digit = mpf_dtmf_detector_digit_get(detector)) != 0) {
+			if(detected_count < sizeof(detected) - 1) {
+				detected[detected_count++] = digit;
+			}
+		}
+	}
+	detected[detected_count] = '\0';
+	mpf_dtmf_detector_destroy(detector);
+
+	if(strcmp(detected,test_case->expected) != 0) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"DTMF Case [%s] Failed: detected [%s] expected [%s]",
+			test_case->name,detected,test_case->expected);
+		return FALSE;
+	}
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"DTMF Case [%s] Passed: detected [%s]",test_case->name,detected);
+	return TRUE;
+}
+
+/** Sampling rates the generator is looped back to the detector at */
+static const apr_uint16_t dtmf_suite_loopback_rates[] = {8000, 16000, 32000, 48000};
+
+/** Feed the output of the in-band DTMF generator to the detector, return TRUE if all the digits came back */
+static apt_bool_t dtmf_suite_loopback_run(apr_uint16_t sampling_rate, apr_pool_t *pool)
+{
+	mpf_audio_stream_t stream;
+	mpf_dtmf_generator_t *generator;
+	mpf_dtmf_detector_t *detector;
+	mpf_frame_t frame;
+	apr_size_t frame_size = sampling_rate * CODEC_FRAME_TIME_BASE / 1000 * sizeof(apr_int16_t);
+	char detected[64];
+	apr_size_t detected_count = 0;
+	apr_size_t trailing_frames = 10;
+	apr_size_t i;
+	char digit;
+
+	memset(&stream,0,sizeof(stream));
+	stream.rx_descriptor = mpf_codec_lpcm_descriptor_create(sampling_rate,1,pool);
+	stream.tx_descriptor = stream.rx_descriptor;
+	generator = mpf_dtmf_generator_create_ex(&stream,MPF_DTMF_GENERATOR_INBAND,70,50,pool);
+	detector = mpf_dtmf_detector_create_ex(&stream,MPF_DTMF_DETECTOR_INBAND,pool);
+	if(!generator || !detector) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create DTMF Generator/Detector");
+		return FALSE;
+	}
+
+	mpf_dtmf_generator_enqueue(generator,DTMF_SUITE_ALL_DIGITS);
+	frame.codec_frame.buffer = apr_palloc(pool,frame_size);
+	frame.codec_frame.size = frame_size;
+	/* keep going for a while past the last digit to let the detector report it */
+	for(i = 0; i < 1000 && trailing_frames; i++) {
+		if(mpf_dtmf_generator_sending(generator) == FALSE) {
+			trailing_frames--;
+		}
+		frame.type = MEDIA_FRAME_TYPE_NONE;
+		frame.marker = MPF_MARKER_NONE;
+		if(mpf_dtmf_generator_put_frame(generator,&frame) == FALSE) {
+			memset(frame.codec_frame.buffer,0,frame_size);
+		}
+		frame.type = MEDIA_FRAME_TYPE_AUDIO;
+		mpf_dtmf_detector_get_frame(detector,&frame);
+		while((digit = mpf_dtmf_detector_digit_get(detector)) != 0) {
+			if(detected_count < sizeof(detected) - 1) {
+				detected[detected_count++] = digit;
+			}
+		}
+	}
+	detected[detected_count] = '\0';
+	mpf_dtmf_detector_destroy(detector);
+	mpf_dtmf_generator_destroy(generator);
+
+	if(strcmp(detected,DTMF_SUITE_ALL_DIGITS) != 0) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"DTMF Loopback [%d Hz] Failed: detected [%s] expected [%s]",
+			sampling_rate,detected,DTMF_SUITE_ALL_DIGITS);
+		return FALSE;
+	}
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"DTMF Loopback [%d Hz] Passed: detected [%s]",sampling_rate,detected);
+	return TRUE;
+}
+
+/** Run in-band DTMF detector over the corpus of synthesized signals */
+static apt_bool_t dtmf_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	apr_size_t i;
+	apr_size_t failed = 0;
+	apr_size_t total = sizeof(dtmf_suite_cases)/sizeof(dtmf_suite_cases[0]);
+	apr_pool_t *pool;
+
+	for(i = 0; i < total; i++) {
+		apr_pool_create(&pool,suite->pool);
+		if(dtmf_suite_case_run(&dtmf_suite_cases[i],pool) == FALSE) {
+			failed++;
+		}
+		apr_pool_destroy(pool);
+	}
+
+	for(i = 0; i < sizeof(dtmf_suite_loopback_rates)/sizeof(dtmf_suite_loopback_rates[0]); i++) {
+		apr_pool_create(&pool,suite->pool);
+		if(dtmf_suite_loopback_run(dtmf_suite_loopback_rates[i],pool) == FALSE) {
+			failed++;
+		}
+		total++;
+		apr_pool_destroy(pool);
+	}
+
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"DTMF Corpus: %"APR_SIZE_T_FMT" of %"APR_SIZE_T_FMT" cases passed",
+		total - failed,total);
+	return failed ? FALSE : TRUE;
+}
+
+apt_test_suite_t* dtmf_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"dtmf",NULL,dtmf_test_run);
+	return suite;
+}
@@ -18,6 +18,9 @@
 #include "apt_log.h"
 
 apt_test_suite_t* mpf_suite_create(apr_pool_t *pool);
+apt_test_suite_t* vad_suite_create(apr_pool_t *pool);
+apt_test_suite_t* dtmf_suite_create(apr_pool_t *pool);
+apt_test_suite_t* buffer_suite_create(apr_pool_t *pool);
 
 int main(int argc, const char * const *argv)
 {
@@ -38,6 +41,15 @@ int main(int argc, const char * const *argv)
 	test_suite = mpf_suite_create(pool);
 	apt_test_framework_suite_add(test_framework,test_suite);
 
+	test_suite = vad_suite_create(pool);
+	apt_test_framework_suite_add(test_framework,test_suite);
+
+	test_suite = dtmf_suite_create(pool);
+	apt_test_framework_suite_add(test_framework,test_suite);
+
+	test_suite = buffer_suite_create(pool);
+	apt_test_framework_suite_add(test_framework,test_suite);
+
 	/* run tests */
 	apt_test_framework_run(test_framework,argc,argv);
 
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "apt_test_suite.h"
+#include "apt_dir_layout.h"
+#include "apt_log.h"
+#include "mpf_activity_detector.h"
+#include "mpf_vad_backend.h"
+
+/** Number of times each file is processed to measure CPU time */
+#define VAD_SUITE_PASSES 20
+
+/** Input file of the benchmark */
+typedef struct {
+	/** File name in the data directory */
+	const char  *name;
+	/** Sampling rate of the file */
+	apr_uint16_t sampling_rate;
+} vad_suite_file_t;
+
+static const vad_suite_file_t vad_suite_files[] = {
+	{"demo-8kHz.pcm",       8000},
+	{"demo-16kHz.pcm",     16000},
+	{"johnsmith-8kHz.pcm",  8000},
+	{"johnsmith-16kHz.pcm",16000},
+	{"one-8kHz.pcm",        8000},
+	{"one-16kHz.pcm",      16000}
+};
+
+/** Load the whole file into memory */
+static apr_int16_t* vad_suite_file_load(const char *file_path, apr_size_t *samples, apr_pool_t *pool)
+{
+	apr_int16_t *buffer;
+	long size;
+	FILE *file = fopen(file_path,"rb");
+	if(!file) {
+		return NULL;
+	}
+	fseek(file,0,SEEK_END);
+	size = ftell(file);
+	fseek(file,0,SEEK_SET);
+	if(size <= 0) {
+		fclose(file);
+		return NULL;
+	}
+	buffer = apr_palloc(pool,size);
+	*samples = fread(buffer,1,size,file) / sizeof(apr_int16_t);
+	fclose(file);
+	return buffer;
+}
+
+/** Run the backend over the samples, report CPU time per frame and start/end of speech */
+static void vad_suite_backend_run(const mpf_vad_backend_t *backend, const vad_suite_file_t *file, apr_int16_t *samples, apr_size_t count, apr_pool_t *pool)
+{
+	mpf_activity_detector_t *detector;
+	mpf_activity_detector_stats_t stats;
+	mpf_codec_descriptor_t *descriptor;
+	mpf_detector_event_e det_event;
+	mpf_frame_t frame;
+	apr_size_t frame_samples = file->sampling_rate * CODEC_FRAME_TIME_BASE / 1000;
+	apr_size_t frame_count = count / frame_samples;
+	apr_size_t i;
+	int pass;
+	long speech_start = -1;
+	long speech_end = -1;
+	apr_time_t start_time;
+	apr_time_t elapsed;
+
+	if(!frame_count) {
+		return;
+	}
+
+	descriptor = mpf_codec_lpcm_descriptor_create(file->sampling_rate,1,pool);
+	detector = mpf_activity_detector_create_ex(backend->name,pool);
+	mpf_activity_detector_codec_set(detector,descriptor);
+
+	frame.type = MEDIA_FRAME_TYPE_AUDIO;
+	frame.marker = MPF_MARKER_NONE;
+	frame.codec_frame.size = frame_samples * sizeof(apr_int16_t);
+
+	start_time = apr_time_now();
+	for(pass = 0; pass < VAD_SUITE_PASSES; pass++) {
+		mpf_activity_detector_reset(detector);
+		for(i = 0; i < frame_count; i++) {
+			frame.codec_frame.buffer = samples + i * frame_samples;
+			det_event = mpf_activity_detector_process(detector,&frame);
+			if(pass) {
+				continue;
+			}
+			if(det_event == MPF_DETECTOR_EVENT_ACTIVITY && speech_start < 0) {
+				speech_start = (long)(i * CODEC_FRAME_TIME_BASE);
+			}
+			else if(det_event == MPF_DETECTOR_EVENT_INACTIVITY && speech_start >= 0 && speech_end < 0) {
+				speech_end = (long)(i * CODEC_FRAME_TIME_BASE);
+			}
+		}
+	}
+	elapsed = apr_time_now() - start_time;
+	mpf_activity_detector_stats_get(detector,&stats);
+
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"VAD [%s] %s: %.3f usec/frame, speech start %ld msec, end %ld msec, gated %"APR_SIZE_T_FMT"/%"APR_SIZE_T_FMT" frames",
+		backend->name,
+		file->name,
+		(double)elapsed / (VAD_SUITE_PASSES * frame_count),
+		speech_start,
+		speech_end,
+		stats.silence_gated + stats.voice_gated,
+		stats.silence_gated + stats.voice_gated + stats.vad_processed);
+}
+
+/** Run VAD benchmark over the PCM files in the data directory */
+static apt_bool_t vad_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	const mpf_vad_backend_t *backend;
+	const vad_suite_file_t *file;
+	apt_dir_layout_t *dir_layout;
+	const char *backend_name = NULL;
+	const char *file_path;
+	apr_int16_t *samples;
+	apr_size_t count;
+	apr_size_t i;
+	apr_size_t j;
+	apr_pool_t *pool;
+
+	if(argc > 0) {
+		/* run the specified backend only */
+		backend_name = argv[0];
+	}
+
+	dir_layout = apt_default_dir_layout_create(NULL,suite->pool);
+	for(i = 0; i < sizeof(vad_suite_files)/sizeof(vad_suite_files[0]); i++) {
+		file = &vad_suite_files[i];
+		file_path = apt_datadir_filepath_get(dir_layout,file->name,suite->pool);
+		samples = file_path ? vad_suite_file_load(file_path,&count,suite->pool) : NULL;
+		if(!samples) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Load File [%s]",file->name);
+			continue;
+		}
+
+		for(j = 0; (backend = mpf_vad_backend_get(j)) != NULL; j++) {
+			if(backend_name && apr_strnatcasecmp(backend_name,backend->name) != 0) {
+				continue;
+			}
+			apr_pool_create(&pool,suite->pool);
+			vad_suite_backend_run(backend,file,samples,count,pool);
+			apr_pool_destroy(pool);
+		}
+	}
+	return TRUE;
+}
+
+apt_test_suite_t* vad_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"vad",NULL,vad_test_run);
+	return suite;
+}
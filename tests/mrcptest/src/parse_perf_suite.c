@@ -0,0 +1,506 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <apr_time.h>
+#include <apr_file_info.h>
+#include <apr_file_io.h>
+#include "apt_test_suite.h"
+#include "apt_text_stream.h"
+#include "apt_text_message.h"
+#include "apt_log.h"
+#include "mrcp_resource_loader.h"
+#include "mrcp_resource_factory.h"
+#include "mrcp_resource.h"
+#include "mrcp_message.h"
+#include "mrcp_stream.h"
+
+/** Default number of times the corpus is parsed */
+#define PARSE_PERF_SUITE_ITERATION_COUNT 20000
+/** Default size of the segments the corpus is received in */
+#define PARSE_PERF_SUITE_SEGMENT_SIZE    500
+/** Max number of files in the corpus */
+#define PARSE_PERF_SUITE_MAX_FILE_COUNT  32
+/** Max number of messages in a file compared in eager and lazy modes */
+#define PARSE_PERF_SUITE_MAX_MESSAGE_COUNT 16
+/** Size of the buffer messages are generated into */
+#define PARSE_PERF_SUITE_TEXT_SIZE       65536
+
+/** Message corpus */
+typedef struct {
+	/** Content of the files */
+	apt_str_t    files[PARSE_PERF_SUITE_MAX_FILE_COUNT];
+	/** Number of the files */
+	apr_size_t   file_count;
+	/** Total size of the files */
+	apr_size_t   size;
+} parse_perf_corpus_t;
+
+/** Load the MRCPv2 message corpus into memory */
+static apt_bool_t parse_perf_corpus_load(parse_perf_corpus_t *corpus, apr_pool_t *pool)
+{
+	apr_status_t rv;
+	apr_dir_t *dir;
+	const char *dir_name = "v2";
+
+	corpus->file_count = 0;
+	corpus->size = 0;
+	if(apr_dir_open(&dir,dir_name,pool) != APR_SUCCESS) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Cannot Open Directory [%s]",dir_name);
+		return FALSE;
+	}
+
+	do {
+		apr_finfo_t finfo;
+		rv = apr_dir_read(&finfo,APR_FINFO_DIRENT,dir);
+		if(rv == APR_SUCCESS && finfo.filetype == APR_REG && finfo.name &&
+			corpus->file_count < PARSE_PERF_SUITE_MAX_FILE_COUNT) {
+			char *file_path;
+			apr_file_t *file;
+			apr_finfo_t file_info;
+			apt_str_t *content = &corpus->files[corpus->file_count];
+
+			apr_filepath_merge(&file_path,dir_name,finfo.name,APR_FILEPATH_NATIVE,pool);
+			if(apr_file_open(&file,file_path,APR_FOPEN_READ | APR_FOPEN_BINARY,APR_OS_DEFAULT,pool) != APR_SUCCESS) {
+				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Open File [%s]",file_path);
+				continue;
+			}
+			if(apr_file_info_get(&file_info,APR_FINFO_SIZE,file) == APR_SUCCESS && file_info.size > 0) {
+				content->length = (apr_size_t)file_info.size;
+				content->buf = apr_palloc(pool,content->length);
+				if(apr_file_read_full(file,content->buf,content->length,NULL) == APR_SUCCESS) {
+					corpus->size += content->length;
+					corpus->file_count++;
+				}
+			}
+			apr_file_close(file);
+		}
+	}
+	while(rv == APR_SUCCESS);
+
+	apr_dir_close(dir);
+	return corpus->file_count ? TRUE : FALSE;
+}
+
+/** Parse the content received in segments, return the number of complete messages (stored if messages is set) */
+static apr_size_t parse_perf_content_parse(mrcp_parser_t *parser, const apt_str_t *content, char *buffer, apr_size_t segment_size, mrcp_message_t **messages)
+{
+	apt_text_stream_t stream;
+	mrcp_message_t *message;
+	apr_size_t offset;
+	apr_size_t length;
+	apr_size_t consumed = 0;
+	apr_size_t count = 0;
+
+	apt_text_stream_init(&stream,buffer,segment_size);
+	do {
+		/* calculate offset remaining from the previous receive / if any */
+		offset = stream.pos - stream.text.buf;
+		/* calculate available length */
+		length = segment_size - offset;
+		if(length > content->length - consumed) {
+			length = content->length - consumed;
+		}
+		memcpy(stream.pos,content->buf + consumed,length);
+		consumed += length;
+
+		/* calculate actual length of the stream */
+		stream.text.length = offset + length;
+		stream.pos[length] = '\0';
+		apt_text_stream_reset(&stream);
+
+		do {
+			if(mrcp_parser_run(parser,&stream,&message) == APT_MESSAGE_STATUS_COMPLETE) {
+				if(messages && count < PARSE_PERF_SUITE_MAX_MESSAGE_COUNT) {
+					messages[count] = message;
+				}
+				count++;
+			}
+		}
+		while(apt_text_is_eos(&stream) == FALSE);
+
+		/* scroll remaining stream */
+		apt_text_stream_scroll(&stream);
+	}
+	while(consumed < content->length);
+	return count;
+}
+
+/** Parse the corpus the number of times and report the throughput */
+static apt_bool_t parse_perf_test_run(apt_test_suite_t *suite, mrcp_resource_factory_t *factory, const parse_perf_corpus_t *corpus,
+									apr_size_t iteration_count, apr_size_t segment_size, apt_bool_t lazy, const char *name, apr_size_t *message_count)
+{
+	apr_pool_t *pool;
+	mrcp_parser_t *parser;
+	char *buffer;
+	apr_time_t start;
+	apr_time_t elapsed;
+	apr_size_t i;
+	apr_size_t j;
+	double seconds;
+
+	buffer = apr_palloc(suite->pool,segment_size + 1);
+	*message_count = 0;
+
+	start = apr_time_now();
+	for(i = 0; i < iteration_count; i++) {
+		/* messages are allocated from the pool of the parser */
+		apr_pool_create(&pool,suite->pool);
+		parser = mrcp_parser_create(factory,pool);
+		mrcp_parser_lazy_set(parser,lazy);
+		for(j = 0; j < corpus->file_count; j++) {
+			*message_count += parse_perf_content_parse(parser,&corpus->files[j],buffer,segment_size,NULL);
+		}
+		apr_pool_destroy(pool);
+	}
+	elapsed = apr_time_now() - start;
+
+	seconds = (double)elapsed / APR_USEC_PER_SEC;
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"[%s] Parsed %"APR_SIZE_T_FMT" Messages in %"APR_TIME_T_FMT" usec, %.1f MB/s, %.0f msg/s",
+		name,
+		*message_count,
+		elapsed,
+		seconds > 0 ? (double)corpus->size * iteration_count / (1024 * 1024) / seconds : 0.0,
+		seconds > 0 ? (double)*message_count / seconds : 0.0);
+	return TRUE;
+}
+
+/** Compare strings byte-for-byte */
+static apt_bool_t parse_perf_text_compare(const apt_str_t *text, const apt_str_t *lazy_text)
+{
+	if(text->length != lazy_text->length) {
+		return FALSE;
+	}
+	return (!text->length || memcmp(text->buf,lazy_text->buf,text->length) == 0) ? TRUE : FALSE;
+}
+
+/** Generate the entire message, continuing till complete */
+static apt_bool_t parse_perf_message_generate(mrcp_generator_t *generator, mrcp_message_t *message, apt_str_t *text, apr_pool_t *pool)
+{
+	apt_text_stream_t stream;
+	apt_message_status_e status;
+
+	text->buf = apr_palloc(pool,PARSE_PERF_SUITE_TEXT_SIZE);
+	text->length = 0;
+	do {
+		apt_text_stream_init(&stream,text->buf + text->length,PARSE_PERF_SUITE_TEXT_SIZE - 1 - text->length);
+		status = mrcp_generator_run(generator,message,&stream);
+		text->length += stream.pos - stream.text.buf;
+	}
+	while(status == APT_MESSAGE_STATUS_INCOMPLETE && text->length < PARSE_PERF_SUITE_TEXT_SIZE - 1);
+	return status == APT_MESSAGE_STATUS_COMPLETE ? TRUE : FALSE;
+}
+
+/** Generate the header section */
+static apt_bool_t parse_perf_header_generate(const mrcp_message_header_t *header, apt_str_t *text, apr_pool_t *pool)
+{
+	apt_text_stream_t stream;
+	char *buffer = apr_palloc(pool,PARSE_PERF_SUITE_TEXT_SIZE);
+
+	apt_text_stream_init(&stream,buffer,PARSE_PERF_SUITE_TEXT_SIZE - 1);
+	if(apt_header_section_generate(&header->header_section,&stream) == FALSE) {
+		return FALSE;
+	}
+	text->buf = buffer;
+	text->length = stream.pos - buffer;
+	return TRUE;
+}
+
+/** Check whether any value of the header is deferred */
+static apt_bool_t parse_perf_header_deferred(const mrcp_message_header_t *header)
+{
+	return (apt_atomic_load32_acquire(&header->generic_header_accessor.deferred_state) != MRCP_HEADER_DEFERRED_NONE ||
+		apt_atomic_load32_acquire(&header->resource_header_accessor.deferred_state) != MRCP_HEADER_DEFERRED_NONE) ? TRUE : FALSE;
+}
+
+/** Compare the header data parsed eagerly and lazily field by field, as generated from the data */
+static apt_bool_t parse_perf_accessor_compare(
+						const mrcp_message_header_t *header, const mrcp_header_accessor_t *accessor,
+						const mrcp_message_header_t *lazy_header, const mrcp_header_accessor_t *lazy_accessor,
+						apr_size_t offset, apr_pool_t *pool)
+{
+	apr_size_t id;
+	apt_bool_t set;
+	apt_header_field_t *header_field;
+	apt_header_field_t *lazy_header_field;
+
+	if(!accessor->vtable || !lazy_accessor->vtable) {
+		return accessor->vtable == lazy_accessor->vtable ? TRUE : FALSE;
+	}
+
+	/* parse the deferred values, the fields failed to parse are unset */
+	mrcp_header_data_get(lazy_accessor);
+	for(id = 0; id < accessor->vtable->field_count; id++) {
+		set = apt_header_section_field_check(&header->header_section,id + offset);
+		if(set != apt_header_section_field_check(&lazy_header->header_section,id + offset)) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch of Header Field Presence [%"APR_SIZE_T_FMT"]",id + offset);
+			return FALSE;
+		}
+		if(set == FALSE) {
+			continue;
+		}
+
+		header_field = mrcp_header_field_value_generate(accessor,id,FALSE,pool);
+		lazy_header_field = mrcp_header_field_value_generate(lazy_accessor,id,FALSE,pool);
+		if(!header_field || !lazy_header_field) {
+			if(header_field != lazy_header_field) {
+				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch of Header Field Generation [%"APR_SIZE_T_FMT"]",id + offset);
+				return FALSE;
+			}
+			continue;
+		}
+		if(parse_perf_text_compare(&header_field->value,&lazy_header_field->value) == FALSE) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch of Header Field Value %s: [%.*s] lazy [%.*s]",
+				header_field->name.buf,
+				(int)header_field->value.length,header_field->value.buf,
+				(int)lazy_header_field->value.length,lazy_header_field->value.buf);
+			return FALSE;
+		}
+	}
+	return TRUE;
+}
+
+/** Compare the headers parsed eagerly and lazily, both the data and the generated header section */
+static apt_bool_t parse_perf_header_compare(const mrcp_message_header_t *header, const mrcp_message_header_t *lazy_header, const char *name, apr_pool_t *pool)
+{
+	apt_str_t text;
+	apt_str_t lazy_text;
+
+	/* generated from the original bytes, whether deferred or not */
+	if(parse_perf_header_generate(header,&text,pool) == FALSE ||
+		parse_perf_header_generate(lazy_header,&lazy_text,pool) == FALSE ||
+		parse_perf_text_compare(&text,&lazy_text) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch of Generated Header Section [%s]",name);
+		return FALSE;
+	}
+
+	if(parse_perf_accessor_compare(
+			header,&header->generic_header_accessor,
+			lazy_header,&lazy_header->generic_header_accessor,
+			0,pool) == FALSE ||
+		parse_perf_accessor_compare(
+			header,&header->resource_header_accessor,
+			lazy_header,&lazy_header->resource_header_accessor,
+			GENERIC_HEADER_COUNT,pool) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch of Header Data [%s]",name);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/** Header fields copied from a message, as done by the engine state machines */
+typedef struct {
+	/** Properties set (SET-PARAMS) */
+	mrcp_message_header_t *properties;
+	/** Properties got (GET-PARAMS), masked by the message */
+	mrcp_message_header_t *params;
+	/** Properties inherited (events, responses) */
+	mrcp_message_header_t *inherited;
+} parse_perf_copies_t;
+
+/** Copy the header fields of the message */
+static void parse_perf_copies_create(parse_perf_copies_t *copies, const mrcp_message_t *message, apr_pool_t *pool)
+{
+	const mrcp_header_vtable_t *generic_header_vtable = mrcp_generic_header_vtable_get(message->start_line.version);
+	const mrcp_header_vtable_t *resource_header_vtable = message->resource->get_resource_header_vtable(message->start_line.version);
+
+	copies->properties = mrcp_message_header_create(generic_header_vtable,resource_header_vtable,pool);
+	mrcp_header_fields_set(copies->properties,&message->header,pool);
+
+	copies->params = mrcp_message_header_create(generic_header_vtable,resource_header_vtable,pool);
+	mrcp_header_fields_get(copies->params,copies->properties,&message->header,pool);
+
+	copies->inherited = mrcp_message_header_create(generic_header_vtable,resource_header_vtable,pool);
+	mrcp_header_fields_inherit(copies->inherited,copies->properties,pool);
+}
+
+/** Compare a message parsed eagerly and lazily, including the header fields copied from it */
+static apt_bool_t parse_perf_message_compare(mrcp_generator_t *generator, mrcp_message_t *message, mrcp_message_t *lazy_message,
+											apr_size_t *deferred_count, apr_pool_t *pool)
+{
+	parse_perf_copies_t copies;
+	parse_perf_copies_t lazy_copies;
+	apt_str_t text;
+	apt_str_t lazy_text;
+
+	if(!message->resource || message->resource != lazy_message->resource) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch of Message Resource");
+		return FALSE;
+	}
+
+	/* copy the fields while the values of the source are still deferred */
+	if(parse_perf_header_deferred(&lazy_message->header) == TRUE) {
+		(*deferred_count)++;
+	}
+	parse_perf_copies_create(&copies,message,pool);
+	parse_perf_copies_create(&lazy_copies,lazy_message,pool);
+
+	/* compare the copies first, they are resolved independently of the source */
+	if(parse_perf_header_compare(copies.properties,lazy_copies.properties,"set",pool) == FALSE ||
+		parse_perf_header_compare(copies.params,lazy_copies.params,"get",pool) == FALSE ||
+		parse_perf_header_compare(copies.inherited,lazy_copies.inherited,"inherit",pool) == FALSE) {
+		return FALSE;
+	}
+
+	/* the entire message is generated byte-for-byte the same */
+	if(parse_perf_message_generate(generator,message,&text,pool) == FALSE ||
+		parse_perf_message_generate(generator,lazy_message,&lazy_text,pool) == FALSE ||
+		parse_perf_text_compare(&text,&lazy_text) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch of Generated Message");
+		return FALSE;
+	}
+
+	return parse_perf_header_compare(&message->header,&lazy_message->header,"message",pool);
+}
+
+/** Parse the corpus eagerly and lazily, compare the messages and the header fields copied from them */
+static apt_bool_t parse_perf_lazy_compare(apt_test_suite_t *suite, mrcp_resource_factory_t *factory, const parse_perf_corpus_t *corpus, apr_size_t segment_size)
+{
+	apr_pool_t *pool;
+	mrcp_parser_t *parser;
+	mrcp_parser_t *lazy_parser;
+	mrcp_generator_t *generator;
+	mrcp_message_t *messages[PARSE_PERF_SUITE_MAX_MESSAGE_COUNT];
+	mrcp_message_t *lazy_messages[PARSE_PERF_SUITE_MAX_MESSAGE_COUNT];
+	apr_size_t count;
+	apr_size_t lazy_count;
+	apr_size_t compared_count = 0;
+	apr_size_t deferred_count = 0;
+	apr_size_t i;
+	apr_size_t j;
+	char *buffer;
+	apt_bool_t status = TRUE;
+
+	apr_pool_create(&pool,suite->pool);
+	buffer = apr_palloc(pool,segment_size + 1);
+	parser = mrcp_parser_create(factory,pool);
+	lazy_parser = mrcp_parser_create(factory,pool);
+	mrcp_parser_lazy_set(lazy_parser,TRUE);
+	generator = mrcp_generator_create(factory,pool);
+
+	for(i = 0; i < corpus->file_count && status == TRUE; i++) {
+		count = parse_perf_content_parse(parser,&corpus->files[i],buffer,segment_size,messages);
+		lazy_count = parse_perf_content_parse(lazy_parser,&corpus->files[i],buffer,segment_size,lazy_messages);
+		if(count != lazy_count) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch of Parsed Messages in File %"APR_SIZE_T_FMT": eager %"APR_SIZE_T_FMT" lazy %"APR_SIZE_T_FMT,
+				i,count,lazy_count);
+			status = FALSE;
+			break;
+		}
+		if(count > PARSE_PERF_SUITE_MAX_MESSAGE_COUNT) {
+			count = PARSE_PERF_SUITE_MAX_MESSAGE_COUNT;
+		}
+
+		for(j = 0; j < count; j++) {
+			if(parse_perf_message_compare(generator,messages[j],lazy_messages[j],&deferred_count,pool) == FALSE) {
+				apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch of Message %"APR_SIZE_T_FMT" in File %"APR_SIZE_T_FMT,j,i);
+				status = FALSE;
+				break;
+			}
+			compared_count++;
+		}
+	}
+
+	if(status == TRUE && !deferred_count) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"No Deferred Values Copied");
+		status = FALSE;
+	}
+
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Compared %"APR_SIZE_T_FMT" Messages Parsed Eagerly and Lazily, %"APR_SIZE_T_FMT" Copied while Deferred: %s",
+		compared_count,deferred_count,status == TRUE ? "OK" : "Failed");
+	apr_pool_destroy(pool);
+	return status;
+}
+
+static apt_bool_t parse_perf_test_run_all(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	mrcp_resource_factory_t *factory;
+	mrcp_resource_loader_t *resource_loader;
+	parse_perf_corpus_t corpus;
+	apr_size_t iteration_count = PARSE_PERF_SUITE_ITERATION_COUNT;
+	apr_size_t segment_size = PARSE_PERF_SUITE_SEGMENT_SIZE;
+	apr_size_t scalar_count;
+	apr_size_t vectorized_count;
+	apr_size_t lazy_count;
+	apt_bool_t status = TRUE;
+
+	if(argc > 0) {
+		iteration_count = (apr_size_t)atol(argv[0]);
+	}
+	if(argc > 1) {
+		segment_size = (apr_size_t)atol(argv[1]);
+		if(!segment_size) {
+			segment_size = PARSE_PERF_SUITE_SEGMENT_SIZE;
+		}
+	}
+
+	if(parse_perf_corpus_load(&corpus,suite->pool) == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Load Message Corpus");
+		return FALSE;
+	}
+
+	resource_loader = mrcp_resource_loader_create(TRUE,suite->pool);
+	if(!resource_loader) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Resource Loader");
+		return FALSE;
+	}
+
+	factory = mrcp_resource_factory_get(resource_loader);
+	if(!factory) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Resource Factory");
+		return FALSE;
+	}
+
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Parse %"APR_SIZE_T_FMT" Files [%"APR_SIZE_T_FMT" bytes] x %"APR_SIZE_T_FMT" in %"APR_SIZE_T_FMT" byte Segments",
+		corpus.file_count,corpus.size,iteration_count,segment_size);
+
+	/* lazy parsing must not change what is read from and generated for the messages */
+	if(parse_perf_lazy_compare(suite,factory,&corpus,segment_size) == FALSE) {
+		status = FALSE;
+	}
+
+	apt_text_scan_vectorized_set(FALSE);
+	parse_perf_test_run(suite,factory,&corpus,iteration_count,segment_size,FALSE,"scalar",&scalar_count);
+
+	if(apt_text_scan_vectorized_set(TRUE) == TRUE) {
+		parse_perf_test_run(suite,factory,&corpus,iteration_count,segment_size,FALSE,"vectorized",&vectorized_count);
+		if(vectorized_count != scalar_count) {
+			apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch of Parsed Messages: scalar %"APR_SIZE_T_FMT" vectorized %"APR_SIZE_T_FMT,
+				scalar_count,vectorized_count);
+			status = FALSE;
+		}
+	}
+	else {
+		apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Vectorized Scanning is not Supported");
+	}
+
+	/* header values left unparsed, as they are by the server till accessed */
+	parse_perf_test_run(suite,factory,&corpus,iteration_count,segment_size,TRUE,"lazy",&lazy_count);
+	if(lazy_count != scalar_count) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Mismatch of Parsed Messages: scalar %"APR_SIZE_T_FMT" lazy %"APR_SIZE_T_FMT,
+			scalar_count,lazy_count);
+		status = FALSE;
+	}
+
+	mrcp_resource_factory_destroy(factory);
+	return status;
+}
+
+apt_test_suite_t* parse_perf_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"parse-perf",NULL,parse_perf_test_run_all);
+	return suite;
+}
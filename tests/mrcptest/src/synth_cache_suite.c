@@ -0,0 +1,436 @@
+/*
+ * Copyright 2008-2015 Arsen Chaloyan
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include <apr_file_io.h>
+#include <apr_file_info.h>
+#include <apr_tables.h>
+#include "apt_test_suite.h"
+#include "apt_dir_layout.h"
+#include "apt_log.h"
+#include "mrcp_resource_loader.h"
+#include "mrcp_resource_factory.h"
+#include "mrcp_message.h"
+#include "mrcp_generic_header.h"
+#include "mrcp_synth_header.h"
+#include "mrcp_synth_resource.h"
+#include "mrcp_engine_iface.h"
+#include "mrcp_engine_impl.h"
+#include "mrcp_synth_cache.h"
+#include "mpf_termination_factory.h"
+#include "mpf_codec_descriptor.h"
+
+/** Identifier of the engine, which is also a part of the names of the cached files */
+#define SYNTH_CACHE_SUITE_ENGINE_ID   "synth-cache-test"
+/** Number of frames rendered per SPEAK request */
+#define SYNTH_CACHE_SUITE_FRAME_COUNT 5
+/** Size of a frame (LPCM/8000/1, 10 msec) */
+#define SYNTH_CACHE_SUITE_FRAME_SIZE  160
+/** Max number of frames read per SPEAK request */
+#define SYNTH_CACHE_SUITE_MAX_READS   100
+
+/** Synthesizer channel emulated by the suite */
+typedef struct {
+	/** Engine channel */
+	mrcp_engine_channel_t *channel;
+	/** In-progress SPEAK request */
+	mrcp_message_t        *speak_request;
+	/** Number of frames left to render */
+	apr_size_t             frame_count;
+	/** Number of requests processed by the engine */
+	apr_size_t             request_count;
+	/** Number of IN-PROGRESS responses received */
+	apr_size_t             inprogress_count;
+	/** Whether SPEAK-COMPLETE event has been received */
+	apt_bool_t             complete;
+	/** Last request identifier */
+	mrcp_request_id        last_request_id;
+} synth_cache_suite_channel_t;
+
+static apt_bool_t synth_cache_suite_engine_destroy(mrcp_engine_t *engine);
+static apt_bool_t synth_cache_suite_engine_open(mrcp_engine_t *engine);
+static apt_bool_t synth_cache_suite_engine_close(mrcp_engine_t *engine);
+static mrcp_engine_channel_t* synth_cache_suite_engine_channel_create(mrcp_engine_t *engine, apr_pool_t *pool);
+
+static const mrcp_engine_method_vtable_t engine_vtable = {
+	synth_cache_suite_engine_destroy,
+	synth_cache_suite_engine_open,
+	synth_cache_suite_engine_close,
+	synth_cache_suite_engine_channel_create
+};
+
+static apt_bool_t synth_cache_suite_on_engine_open(mrcp_engine_t *engine, apt_bool_t status);
+static apt_bool_t synth_cache_suite_on_engine_close(mrcp_engine_t *engine);
+
+static const mrcp_engine_event_vtable_t engine_event_vtable = {
+	synth_cache_suite_on_engine_open,
+	synth_cache_suite_on_engine_close
+};
+
+static apt_bool_t synth_cache_suite_channel_destroy(mrcp_engine_channel_t *channel);
+static apt_bool_t synth_cache_suite_channel_open(mrcp_engine_channel_t *channel);
+static apt_bool_t synth_cache_suite_channel_close(mrcp_engine_channel_t *channel);
+static apt_bool_t synth_cache_suite_channel_request_process(mrcp_engine_channel_t *channel, mrcp_message_t *request);
+
+static const mrcp_engine_channel_method_vtable_t channel_vtable = {
+	synth_cache_suite_channel_destroy,
+	synth_cache_suite_channel_open,
+	synth_cache_suite_channel_close,
+	synth_cache_suite_channel_request_process
+};
+
+static apt_bool_t synth_cache_suite_on_channel_open(mrcp_engine_channel_t *channel, apt_bool_t status);
+static apt_bool_t synth_cache_suite_on_channel_close(mrcp_engine_channel_t *channel);
+static apt_bool_t synth_cache_suite_on_channel_message(mrcp_engine_channel_t *channel, mrcp_message_t *message);
+
+static const mrcp_engine_channel_event_vtable_t channel_event_vtable = {
+	synth_cache_suite_on_channel_open,
+	synth_cache_suite_on_channel_close,
+	synth_cache_suite_on_channel_message
+};
+
+static apt_bool_t synth_cache_suite_stream_read(mpf_audio_stream_t *stream, mpf_frame_t *frame);
+
+static const mpf_audio_stream_vtable_t stream_vtable = {
+	NULL,
+	NULL,
+	NULL,
+	synth_cache_suite_stream_read,
+	NULL,
+	NULL,
+	NULL,
+	NULL
+};
+
+
+static apt_bool_t synth_cache_suite_engine_destroy(mrcp_engine_t *engine)
+{
+	return TRUE;
+}
+
+static apt_bool_t synth_cache_suite_engine_open(mrcp_engine_t *engine)
+{
+	return mrcp_engine_open_respond(engine,TRUE);
+}
+
+static apt_bool_t synth_cache_suite_engine_close(mrcp_engine_t *engine)
+{
+	return mrcp_engine_close_respond(engine);
+}
+
+static mrcp_engine_channel_t* synth_cache_suite_engine_channel_create(mrcp_engine_t *engine, apr_pool_t *pool)
+{
+	synth_cache_suite_channel_t *suite_channel = apr_palloc(pool,sizeof(synth_cache_suite_channel_t));
+	memset(suite_channel,0,sizeof(synth_cache_suite_channel_t));
+	suite_channel->channel = mrcp_engine_source_channel_create(
+			engine,
+			&channel_vtable,
+			&stream_vtable,
+			suite_channel,
+			mpf_codec_lpcm_descriptor_create(8000,1,pool),
+			pool);
+	return suite_channel->channel;
+}
+
+/* the server side of the engine, the one the engine reports to */
+static apt_bool_t synth_cache_suite_on_engine_open(mrcp_engine_t *engine, apt_bool_t status)
+{
+	mrcp_engine_on_open(engine,status);
+	return TRUE;
+}
+
+static apt_bool_t synth_cache_suite_on_engine_close(mrcp_engine_t *engine)
+{
+	mrcp_engine_on_close(engine);
+	return TRUE;
+}
+
+static apt_bool_t synth_cache_suite_channel_destroy(mrcp_engine_channel_t *channel)
+{
+	return TRUE;
+}
+
+static apt_bool_t synth_cache_suite_channel_open(mrcp_engine_channel_t *channel)
+{
+	return mrcp_engine_channel_open_respond(channel,TRUE);
+}
+
+static apt_bool_t synth_cache_suite_channel_close(mrcp_engine_channel_t *channel)
+{
+	return mrcp_engine_channel_close_respond(channel);
+}
+
+static apt_bool_t synth_cache_suite_channel_request_process(mrcp_engine_channel_t *channel, mrcp_message_t *request)
+{
+	synth_cache_suite_channel_t *suite_channel = channel->method_obj;
+	mrcp_message_t *response = mrcp_response_create(request,request->pool);
+	suite_channel->request_count++;
+	if(request->start_line.method_id == SYNTHESIZER_SPEAK) {
+		suite_channel->speak_request = request;
+		suite_channel->frame_count = SYNTH_CACHE_SUITE_FRAME_COUNT;
+		response->start_line.request_state = MRCP_REQUEST_STATE_INPROGRESS;
+	}
+	return mrcp_engine_channel_message_send(channel,response);
+}
+
+static apt_bool_t synth_cache_suite_stream_read(mpf_audio_stream_t *stream, mpf_frame_t *frame)
+{
+	synth_cache_suite_channel_t *suite_channel = stream->obj;
+	mrcp_message_t *message;
+	mrcp_synth_header_t *synth_header;
+
+	if(!suite_channel->speak_request) {
+		return TRUE;
+	}
+
+	/* every rendering differs from the others, so that the audio played tells where it comes from */
+	memset(frame->codec_frame.buffer,
+		(int)(suite_channel->speak_request->start_line.request_id * 16 + suite_channel->frame_count),
+		frame->codec_frame.size);
+	frame->type |= MEDIA_FRAME_TYPE_AUDIO;
+	if(--suite_channel->frame_count) {
+		return TRUE;
+	}
+
+	message = mrcp_event_create(
+				suite_channel->speak_request,
+				SYNTHESIZER_SPEAK_COMPLETE,
+				suite_channel->speak_request->pool);
+	suite_channel->speak_request = NULL;
+	if(!message) {
+		return FALSE;
+	}
+	synth_header = mrcp_resource_header_prepare(message);
+	if(synth_header) {
+		synth_header->completion_cause = SYNTHESIZER_COMPLETION_CAUSE_NORMAL;
+		mrcp_resource_header_property_add(message,SYNTHESIZER_HEADER_COMPLETION_CAUSE);
+	}
+	message->start_line.request_state = MRCP_REQUEST_STATE_COMPLETE;
+	return mrcp_engine_channel_message_send(suite_channel->channel,message);
+}
+
+static apt_bool_t synth_cache_suite_on_channel_open(mrcp_engine_channel_t *channel, apt_bool_t status)
+{
+	return TRUE;
+}
+
+static apt_bool_t synth_cache_suite_on_channel_close(mrcp_engine_channel_t *channel)
+{
+	return TRUE;
+}
+
+static apt_bool_t synth_cache_suite_on_channel_message(mrcp_engine_channel_t *channel, mrcp_message_t *message)
+{
+	synth_cache_suite_channel_t *suite_channel = channel->event_obj;
+	if(message->start_line.request_id != suite_channel->last_request_id) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Request Id [%"MRCP_REQUEST_ID_FMT"]",
+			message->start_line.request_id);
+		return FALSE;
+	}
+	if(message->start_line.message_type == MRCP_MESSAGE_TYPE_RESPONSE) {
+		if(message->start_line.request_state == MRCP_REQUEST_STATE_INPROGRESS) {
+			suite_channel->inprogress_count++;
+		}
+	}
+	else if(message->start_line.message_type == MRCP_MESSAGE_TYPE_EVENT) {
+		if(message->start_line.method_id == SYNTHESIZER_SPEAK_COMPLETE) {
+			suite_channel->complete = TRUE;
+		}
+	}
+	return TRUE;
+}
+
+/** Send SPEAK request and read the audio played till SPEAK-COMPLETE */
+static apr_size_t synth_cache_suite_speak(mrcp_resource_factory_t *factory, synth_cache_suite_channel_t *suite_channel,
+										const char *voice_name, char *audio, apr_size_t max_size, apr_pool_t *pool)
+{
+	mrcp_message_t *request;
+	mrcp_generic_header_t *generic_header;
+	mrcp_synth_header_t *synth_header;
+	mpf_audio_stream_t *audio_stream;
+	mpf_frame_t frame;
+	char buffer[SYNTH_CACHE_SUITE_FRAME_SIZE];
+	apr_size_t size = 0;
+	apr_size_t i;
+
+	request = mrcp_request_create(mrcp_resource_get(factory,MRCP_SYNTHESIZER_RESOURCE),MRCP_VERSION_2,SYNTHESIZER_SPEAK,pool);
+	if(!request) {
+		return 0;
+	}
+	request->start_line.request_id = ++suite_channel->last_request_id;
+	generic_header = mrcp_generic_header_prepare(request);
+	if(generic_header) {
+		apt_string_assign(&generic_header->content_type,"text/plain",request->pool);
+		mrcp_generic_header_property_add(request,GENERIC_HEADER_CONTENT_TYPE);
+	}
+	synth_header = mrcp_resource_header_prepare(request);
+	if(synth_header) {
+		apt_string_assign(&synth_header->voice_param.name,voice_name,request->pool);
+		mrcp_resource_header_property_add(request,SYNTHESIZER_HEADER_VOICE_NAME);
+	}
+	apt_string_assign(&request->body,"Hello World",request->pool);
+
+	suite_channel->complete = FALSE;
+	mrcp_engine_channel_request_process(suite_channel->channel,request);
+
+	/* the audio is read the way the media thread reads it */
+	audio_stream = mpf_termination_audio_stream_get(suite_channel->channel->termination);
+	for(i = 0; i < SYNTH_CACHE_SUITE_MAX_READS && suite_channel->complete == FALSE; i++) {
+		frame.type = MEDIA_FRAME_TYPE_NONE;
+		frame.marker = MPF_MARKER_NONE;
+		frame.codec_frame.buffer = buffer;
+		frame.codec_frame.size = sizeof(buffer);
+		audio_stream->vtable->read_frame(audio_stream,&frame);
+		if((frame.type & MEDIA_FRAME_TYPE_AUDIO) && size + sizeof(buffer) <= max_size) {
+			memcpy(audio + size,buffer,sizeof(buffer));
+			size += sizeof(buffer);
+		}
+	}
+	if(suite_channel->complete == FALSE) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"No SPEAK-COMPLETE Received");
+		return 0;
+	}
+	return size;
+}
+
+/** Test SPEAK requests are keyed, looked up and recorded by the cache */
+static apt_bool_t synth_cache_test_run(apt_test_suite_t *suite, int argc, const char * const *argv)
+{
+	mrcp_resource_loader_t *resource_loader;
+	mrcp_resource_factory_t *factory;
+	apt_dir_layout_t *dir_layout;
+	mrcp_engine_t *engine;
+	mrcp_engine_channel_t *channel;
+	synth_cache_suite_channel_t *suite_channel;
+	mrcp_synth_cache_stats_t stats;
+	apr_finfo_t finfo;
+	const char *var_dir_path = NULL;
+	const char *file_path;
+	char first_audio[SYNTH_CACHE_SUITE_FRAME_SIZE * SYNTH_CACHE_SUITE_FRAME_COUNT];
+	char audio[SYNTH_CACHE_SUITE_FRAME_SIZE * SYNTH_CACHE_SUITE_FRAME_COUNT];
+	apr_size_t first_size;
+	apr_size_t size;
+	apt_bool_t status = TRUE;
+
+	resource_loader = mrcp_resource_loader_create(TRUE,suite->pool);
+	if(!resource_loader) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Resource Loader");
+		return FALSE;
+	}
+	factory = mrcp_resource_factory_get(resource_loader);
+	if(!factory) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Resource Factory");
+		return FALSE;
+	}
+
+	if(apr_temp_dir_get(&var_dir_path,suite->pool) != APR_SUCCESS) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Get Temp Directory");
+		mrcp_resource_factory_destroy(factory);
+		return FALSE;
+	}
+	dir_layout = apt_dir_layout_create(suite->pool);
+	apt_dir_layout_path_set(dir_layout,APT_LAYOUT_VAR_DIR,var_dir_path,suite->pool);
+
+	engine = mrcp_engine_create(MRCP_SYNTHESIZER_RESOURCE,NULL,&engine_vtable,suite->pool);
+	engine->id = SYNTH_CACHE_SUITE_ENGINE_ID;
+	engine->dir_layout = dir_layout;
+	engine->event_vtable = &engine_event_vtable;
+	engine->config = mrcp_engine_config_alloc(suite->pool);
+	engine->config->params = apr_table_make(suite->pool,1);
+	apr_table_set(engine->config->params,"synth-cache-max-size","1048576");
+
+	/* the cache is created and started once the engine is open */
+	mrcp_engine_virtual_open(engine);
+	if(!engine->synth_cache) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Synth Cache");
+		mrcp_engine_virtual_destroy(engine);
+		mrcp_resource_factory_destroy(factory);
+		return FALSE;
+	}
+
+	channel = mrcp_engine_channel_virtual_create(engine,MRCP_VERSION_2,suite->pool);
+	if(!channel) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Failed to Create Engine Channel");
+		mrcp_engine_virtual_close(engine);
+		mrcp_engine_virtual_destroy(engine);
+		mrcp_resource_factory_destroy(factory);
+		return FALSE;
+	}
+	suite_channel = channel->method_obj;
+	channel->event_vtable = &channel_event_vtable;
+	channel->event_obj = suite_channel;
+	mrcp_engine_channel_virtual_open(channel);
+
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Test SPEAK Request Rendered by Engine");
+	first_size = synth_cache_suite_speak(factory,suite_channel,"alice",first_audio,sizeof(first_audio),suite->pool);
+	if(first_size != sizeof(first_audio) || suite_channel->request_count != 1) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Rendering [%"APR_SIZE_T_FMT" bytes]",first_size);
+		status = FALSE;
+	}
+
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Test SPEAK Request of Another Voice Rendered by Engine");
+	size = synth_cache_suite_speak(factory,suite_channel,"bob",audio,sizeof(audio),suite->pool);
+	if(size != sizeof(audio) || suite_channel->request_count != 2) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Rendering [%"APR_SIZE_T_FMT" bytes]",size);
+		status = FALSE;
+	}
+
+	/* flush the recorded audio to disk */
+	mrcp_synth_cache_stop(engine->synth_cache);
+	mrcp_synth_cache_start(engine->synth_cache);
+
+	apt_log(APT_LOG_MARK,APT_PRIO_NOTICE,"Test SPEAK Request Served from Cache");
+	size = synth_cache_suite_speak(factory,suite_channel,"alice",audio,sizeof(audio),suite->pool);
+	if(size != first_size || memcmp(audio,first_audio,size) != 0 || suite_channel->request_count != 2) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Audio Served from Cache Differs from Rendered [%"APR_SIZE_T_FMT" bytes]",size);
+		status = FALSE;
+	}
+	if(suite_channel->inprogress_count != 3) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Number of IN-PROGRESS Responses [%"APR_SIZE_T_FMT"]",
+			suite_channel->inprogress_count);
+		status = FALSE;
+	}
+
+	mrcp_synth_cache_stats_get(engine->synth_cache,&stats);
+	apt_log(APT_LOG_MARK,APT_PRIO_INFO,"Synth Cache hits [%"APR_SIZE_T_FMT"] misses [%"APR_SIZE_T_FMT"] stores [%"APR_SIZE_T_FMT"] entries [%"APR_SIZE_T_FMT"] size [%"APR_SIZE_T_FMT"]",
+		stats.hits,stats.misses,stats.stores,stats.entry_count,stats.size);
+	if(stats.hits != 1 || stats.misses != 2 || stats.stores != 2 ||
+		stats.entry_count != 2 || stats.size != 2 * sizeof(first_audio)) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"Unexpected Synth Cache Statistics");
+		status = FALSE;
+	}
+
+	mrcp_engine_channel_virtual_close(channel);
+	mrcp_engine_channel_virtual_destroy(channel);
+	mrcp_engine_virtual_close(engine);
+	mrcp_engine_virtual_destroy(engine);
+
+	/* the files are removed along with the cache */
+	file_path = apt_vardir_filepath_get(dir_layout,"synth-cache-" SYNTH_CACHE_SUITE_ENGINE_ID "-1.pcm",suite->pool);
+	if(file_path && apr_stat(&finfo,file_path,APR_FINFO_SIZE,suite->pool) == APR_SUCCESS) {
+		apt_log(APT_LOG_MARK,APT_PRIO_WARNING,"File of Synth Cache is not Removed [%s]",file_path);
+		status = FALSE;
+	}
+
+	mrcp_resource_factory_destroy(factory);
+	return status;
+}
+
+apt_test_suite_t* synth_cache_test_suite_create(apr_pool_t *pool)
+{
+	apt_test_suite_t *suite = apt_test_suite_create(pool,"synth-cache",NULL,synth_cache_test_run);
+	return suite;
+}
@@ -52,6 +52,82 @@ static apt_bool_t string_table_key_generate(apt_str_table_item_t table[], apr_si
 	return TRUE;
 }
 
+#define STRING_TABLE_MAX_COUNT 100
+#define STRING_TABLE_MAX_SEED   0xFFFF
+
+/* Place the strings of the bucket to the free slots by the hash with the seed */
+static apt_bool_t string_table_bucket_place(apt_str_table_item_t table[], apr_size_t count,
+							const apr_size_t bucket[], apr_size_t bucket_count, apr_uint32_t seed, apt_bool_t occupied[])
+{
+	apr_size_t slots[STRING_TABLE_MAX_COUNT];
+	apr_size_t i,j;
+	for(i=0; i<bucket_count; i++) {
+		slots[i] = apt_string_table_hash(&table[bucket[i]].value,seed) % count;
+		if(occupied[slots[i]] == TRUE) {
+			return FALSE;
+		}
+		for(j=0; j<i; j++) {
+			if(slots[j] == slots[i]) {
+				return FALSE;
+			}
+		}
+	}
+
+	for(i=0; i<bucket_count; i++) {
+		occupied[slots[i]] = TRUE;
+		table[slots[i]].hash_id = (apr_uint16_t)bucket[i];
+	}
+	return TRUE;
+}
+
+/* Generate minimal perfect hash (hash and displace): the strings are distributed
+to buckets by the hash with seed 0, then the seed which places all the strings
+of the bucket to free slots is searched for the buckets in the order of their sizes */
+static apt_bool_t string_table_hash_generate(apt_str_table_item_t table[], apr_size_t count)
+{
+	apr_size_t buckets[STRING_TABLE_MAX_COUNT][STRING_TABLE_MAX_COUNT];
+	apr_size_t bucket_counts[STRING_TABLE_MAX_COUNT];
+	apt_bool_t occupied[STRING_TABLE_MAX_COUNT];
+	apr_size_t i,b;
+	apr_size_t bucket_count;
+	apr_uint32_t seed;
+
+	for(i=0; i<count; i++) {
+		bucket_counts[i] = 0;
+		occupied[i] = FALSE;
+		/* seeds of empty buckets are never used, but mark the table as hashed */
+		table[i].hash_seed = 1;
+		table[i].hash_id = 0;
+	}
+	for(i=0; i<count; i++) {
+		b = apt_string_table_hash(&table[i].value,0) % count;
+		buckets[b][bucket_counts[b]++] = i;
+	}
+
+	for(bucket_count = count; bucket_count > 0; bucket_count--) {
+		for(b=0; b<count; b++) {
+			if(bucket_counts[b] != bucket_count) {
+				continue;
+			}
+			for(seed=1; seed<=STRING_TABLE_MAX_SEED; seed++) {
+				if(string_table_bucket_place(table,count,buckets[b],bucket_count,seed,occupied) == TRUE) {
+					break;
+				}
+			}
+			if(seed > STRING_TABLE_MAX_SEED) {
+				/* e.g. duplicate strings, leave the table to be looked up by the keys */
+				for(i=0; i<count; i++) {
+					table[i].hash_seed = 0;
+					table[i].hash_id = 0;
+				}
+				return FALSE;
+			}
+			table[b].hash_seed = (apr_uint16_t)seed;
+		}
+	}
+	return TRUE;
+}
+
 #define TEST_BUFFER_SIZE 2048
 static char parse_buffer[TEST_BUFFER_SIZE];
 
@@ -74,6 +150,8 @@ static apr_size_t string_table_read(apt_str_table_item_t table[], apr_size_t max
 		item = &table[count];
 		apt_string_copy(&item->value,&line,pool);
 		item->key = 0;
+		item->hash_seed = 0;
+		item->hash_id = 0;
 		count++;
 	}
 	while(count < max_count);
@@ -87,8 +165,8 @@ static apt_bool_t string_table_write(const apt_str_table_item_t table[], apr_siz
 	const apt_str_table_item_t *item;
 	for(i=0; i<count; i++) {
 		item = &table[i];
-		fprintf(file,"{{\"%s\",%"APR_SIZE_T_FMT"},%"APR_SIZE_T_FMT"},\r\n",
-			item->value.buf, item->value.length, item->key);
+		fprintf(file,"{{\"%s\",%"APR_SIZE_T_FMT"},%"APR_SIZE_T_FMT",%d,%d},\r\n",
+			item->value.buf, item->value.length, item->key, item->hash_seed, item->hash_id);
 	}
 	return TRUE;
 }
@@ -96,7 +174,7 @@ static apt_bool_t string_table_write(const apt_str_table_item_t table[], apr_siz
 int main(int argc, char *argv[])
 {
 	apr_pool_t *pool = NULL;
-	apt_str_table_item_t table[100];
+	apt_str_table_item_t table[STRING_TABLE_MAX_COUNT];
 	apr_size_t count;
 	FILE *file_in, *file_out;
 
@@ -124,10 +202,13 @@ int main(int argc, char *argv[])
 	}
 
 	/* read items (strings) from the file */
-	count = string_table_read(table,100,file_in,pool);
+	count = string_table_read(table,STRING_TABLE_MAX_COUNT,file_in,pool);
 
 	/* generate string table */
 	string_table_key_generate(table,count);
+	if(string_table_hash_generate(table,count) == FALSE) {
+		printf("cannot generate perfect hash, check for duplicate strings\n");
+	}
 	
 	/* dump string table to the file */
 	string_table_write(table,count,file_out);